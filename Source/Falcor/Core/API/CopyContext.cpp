@@ -84,9 +84,13 @@ void CopyContext::flush(bool wait)
     }
 }
 
-CopyContext::ReadTextureTask::SharedPtr CopyContext::asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex)
+CopyContext::ReadTextureTask::SharedPtr CopyContext::asyncReadTextureSubresource(
+    const Texture* pTexture,
+    uint32_t subresourceIndex,
+    ref<Buffer> pStagingBuffer
+)
 {
-    return CopyContext::ReadTextureTask::create(this, pTexture, subresourceIndex);
+    return CopyContext::ReadTextureTask::create(this, pTexture, subresourceIndex, std::move(pStagingBuffer));
 }
 
 std::vector<uint8_t> CopyContext::readTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex)
@@ -267,7 +271,8 @@ void CopyContext::updateTextureSubresources(
 CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(
     CopyContext* pCtx,
     const Texture* pTexture,
-    uint32_t subresourceIndex
+    uint32_t subresourceIndex,
+    ref<Buffer> pStagingBuffer
 )
 {
     SharedPtr pThis = SharedPtr(new ReadTextureTask);
@@ -286,8 +291,11 @@ CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(
     uint64_t rowCount = (pTexture->getHeight(mipLevel) + formatInfo.blockHeight - 1) / formatInfo.blockHeight;
     uint64_t size = pTexture->getDepth(mipLevel) * rowCount * pThis->mRowSize;
 
-    // Create buffer
-    pThis->mpBuffer = Buffer::create(pCtx->getDevice(), size, Buffer::BindFlags::None, Buffer::CpuAccess::Read, nullptr);
+    // Create buffer, or reuse the staging buffer if it is large enough.
+    if (pStagingBuffer && pStagingBuffer->getCpuAccess() == Buffer::CpuAccess::Read && pStagingBuffer->getSize() >= size)
+        pThis->mpBuffer = std::move(pStagingBuffer);
+    else
+        pThis->mpBuffer = Buffer::create(pCtx->getDevice(), size, Buffer::BindFlags::None, Buffer::CpuAccess::Read, nullptr);
 
     // Copy from texture to buffer
     pCtx->resourceBarrier(pTexture, Resource::State::CopySource);
@@ -316,6 +324,11 @@ CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(
     return pThis;
 }
 
+bool CopyContext::ReadTextureTask::isReady() const
+{
+    return mpFence->getGpuValue() + 1 >= mpFence->getCpuValue();
+}
+
 std::vector<uint8_t> CopyContext::ReadTextureTask::getData()
 {
     mpFence->syncCpu();
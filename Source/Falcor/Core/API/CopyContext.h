@@ -48,9 +48,24 @@ public:
     {
     public:
         using SharedPtr = std::shared_ptr<ReadTextureTask>;
-        static SharedPtr create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex);
+        static SharedPtr create(
+            CopyContext* pCtx,
+            const Texture* pTexture,
+            uint32_t subresourceIndex,
+            ref<Buffer> pStagingBuffer = nullptr
+        );
         std::vector<uint8_t> getData();
 
+        /**
+         * Check if the GPU has finished the copy. If true, getData() does not block.
+         */
+        bool isReady() const;
+
+        /**
+         * Get the staging buffer the texture is copied to. It can be passed to a later readback once the data was retrieved.
+         */
+        const ref<Buffer>& getStagingBuffer() const { return mpBuffer; }
+
     private:
         ReadTextureTask() = default;
         ref<GpuFence> mpFence;
@@ -164,8 +179,15 @@ public:
 
     /**
      * Read texture data Asynchronously
+     * @param[in] pTexture Texture to read from.
+     * @param[in] subresourceIndex Subresource to read.
+     * @param[in] pStagingBuffer Optional CPU-readable buffer to copy to. It is used if it is large enough, otherwise a new buffer is created.
      */
-    ReadTextureTask::SharedPtr asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex);
+    ReadTextureTask::SharedPtr asyncReadTextureSubresource(
+        const Texture* pTexture,
+        uint32_t subresourceIndex,
+        ref<Buffer> pStagingBuffer = nullptr
+    );
 
     /**
      * Get the low-level context data
@@ -212,6 +212,67 @@ ref<Texture> Texture::create2DMS(
     return pTexture;
 }
 
+ref<Texture> Texture::createFromBitmaps(
+    ref<Device> pDevice,
+    fstd::span<const Bitmap* const> mips,
+    bool generateMipLevels,
+    bool loadAsSrgb,
+    Texture::BindFlags bindFlags
+)
+{
+    if (mips.empty())
+        return nullptr;
+
+    // Find the number of valid mips.
+    size_t mipCount = 1;
+    size_t combinedSize = mips[0]->getSize();
+    for (; mipCount < mips.size(); ++mipCount)
+    {
+        const Bitmap* pPrev = mips[mipCount - 1];
+        const Bitmap* pMip = mips[mipCount];
+        if (pPrev->getFormat() != pMip->getFormat())
+        {
+            logWarning("Error loading mip {}. Texture format of all mip levels must match.", mipCount);
+            break;
+        }
+        if (std::max(pPrev->getWidth() / 2, 1u) != pMip->getWidth() || std::max(pPrev->getHeight() / 2, 1u) != pMip->getHeight())
+        {
+            logWarning(
+                "Error loading mip {}. Image resolution must decrease by half. ({}, {}) != ({}, {})/2", mipCount, pMip->getWidth(),
+                pMip->getHeight(), pPrev->getWidth(), pPrev->getHeight()
+            );
+            break;
+        }
+        combinedSize += pMip->getSize();
+    }
+
+    ResourceFormat texFormat = mips[0]->getFormat();
+    if (loadAsSrgb)
+        texFormat = linearToSrgbFormat(texFormat);
+
+    if (mipCount == 1)
+    {
+        return Texture::create2D(
+            pDevice, mips[0]->getWidth(), mips[0]->getHeight(), texFormat, 1, generateMipLevels ? Texture::kMaxPossible : 1,
+            mips[0]->getData(), bindFlags
+        );
+    }
+
+    // Combine all the mip data into a single buffer
+    size_t copyDst = 0;
+    std::unique_ptr<uint8_t[]> combinedData(new uint8_t[combinedSize]);
+    for (size_t i = 0; i < mipCount; ++i)
+    {
+        std::memcpy(&combinedData[copyDst], mips[i]->getData(), mips[i]->getSize());
+        copyDst += mips[i]->getSize();
+    }
+
+    // Create mip mapped latent texture
+    return Texture::create2D(
+        pDevice, mips[0]->getWidth(), mips[0]->getHeight(), texFormat, 1, (uint32_t)mipCount, combinedData.get(), bindFlags
+    );
+}
+
 ref<Texture> Texture::createMippedFromFiles(
     ref<Device> pDevice,
     fstd::span<const std::filesystem::path> paths,
@@ -220,9 +281,9 @@ ref<Texture> Texture::createMippedFromFiles(
 )
 {
     std::vector<Bitmap::UniqueConstPtr> mips;
+    std::vector<const Bitmap*> mipPtrs;
     mips.reserve(paths.size());
-    size_t combinedSize = 0;
-    std::filesystem::path fullPathMip0;
+    std::filesystem::path fullPathMip0 = paths.empty() ? std::filesystem::path() : paths[0];
 
     for (const auto& path : paths)
     {
@@ -240,52 +301,11 @@ ref<Texture> Texture::createMippedFromFiles(
             logWarning("Error loading mip {}. Loading failed for image file '{}'.", mips.size(), path);
             break;
         }
-
-        if (!mips.empty())
-        {
-            if (mips.back()->getFormat() != pBitmap->getFormat())
-            {
-                logWarning("Error loading mip {} from file {}. Texture format of all mip levels must match.", mips.size(), path);
-                break;
-            }
-            if (std::max(mips.back()->getWidth() / 2, 1u) != pBitmap->getWidth() ||
-                std::max(mips.back()->getHeight() / 2, 1u) != pBitmap->getHeight())
-            {
-                logWarning(
-                    "Error loading mip {} from file {}. Image resolution must decrease by half. ({}, {}) != ({}, {})/2", mips.size(), path,
-                    pBitmap->getWidth(), pBitmap->getHeight(), mips.back()->getWidth(), mips.back()->getHeight()
-                );
-                break;
-            }
-        }
-        else
-        {
-            fullPathMip0 = path;
-        }
-        combinedSize += pBitmap->getSize();
+        mipPtrs.push_back(pBitmap.get());
         mips.emplace_back(std::move(pBitmap));
     }
 
-    ref<Texture> pTex;
-    if (!mips.empty())
-    {
-        // Combine all the mip data into a single buffer
-        size_t copyDst = 0;
-        std::unique_ptr<uint8_t[]> combinedData(new uint8_t[combinedSize]);
-        for (auto& mip : mips)
-        {
-            std::memcpy(&combinedData[copyDst], mip->getData(), mip->getSize());
-            copyDst += mip->getSize();
-        }
-
-        ResourceFormat texFormat = mips[0]->getFormat();
-        if (loadAsSrgb)
-            texFormat = linearToSrgbFormat(texFormat);
-
-        // Create mip mapped latent texture
-        pTex =
-            Texture::create2D(pDevice, mips[0]->getWidth(), mips[0]->getHeight(), texFormat, 1, mips.size(), combinedData.get(), bindFlags);
-    }
+    ref<Texture> pTex = createFromBitmaps(pDevice, mipPtrs, false, loadAsSrgb, bindFlags);
 
     if (pTex != nullptr)
     {
@@ -334,16 +354,8 @@ ref<Texture> Texture::createFromFile(
         Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(fullPath, kTopDown);
         if (pBitmap)
         {
-            ResourceFormat texFormat = pBitmap->getFormat();
-            if (loadAsSrgb)
-            {
-                texFormat = linearToSrgbFormat(texFormat);
-            }
-
-            pTex = Texture::create2D(
-                pDevice, pBitmap->getWidth(), pBitmap->getHeight(), texFormat, 1, generateMipLevels ? Texture::kMaxPossible : 1,
-                pBitmap->getData(), bindFlags
-            );
+            const Bitmap* pMip = pBitmap.get();
+            pTex = createFromBitmaps(pDevice, fstd::span<const Bitmap* const>(&pMip, 1), generateMipLevels, loadAsSrgb, bindFlags);
         }
     }
 
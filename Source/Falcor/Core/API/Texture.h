@@ -251,6 +251,24 @@ public:
         BindFlags bindFlags = BindFlags::ShaderResource
     );
 
+    /**
+     * Create a new 2D texture object from decoded bitmaps.
+     * All bitmaps must have the same format and each mip must be half the size of the previous one.
+     * Mips that violate this are dropped, together with all following mips.
+     * @param[in] mips Bitmaps of the mips, starting from mip0.
+     * @param[in] generateMipLevels Whether the mip-chain should be generated. Only used if a single bitmap is given.
+     * @param[in] loadAsSrgb Load the texture using sRGB format. Only valid for 3 or 4 component textures.
+     * @param[in] bindFlags The bind flags to create the texture with.
+     * @return A new texture, or nullptr if no bitmaps are given.
+     */
+    static ref<Texture> createFromBitmaps(
+        ref<Device> pDevice,
+        fstd::span<const Bitmap* const> mips,
+        bool generateMipLevels,
+        bool loadAsSrgb,
+        BindFlags bindFlags = BindFlags::ShaderResource
+    );
+
     /**
      * Create a new texture object with mips specified explicitly from individual files.
      * @param[in] paths List of full paths of all mips, starting from mip0.
@@ -45,6 +45,7 @@ namespace Falcor
 /// this file can also be removed as well.
 
 FALCOR_API void setActivePythonSceneBuilder(SceneBuilder* pSceneBuilder);
+FALCOR_API SceneBuilder* getActivePythonSceneBuilder();
 FALCOR_API SceneBuilder& accessActivePythonSceneBuilder();
 
 FALCOR_API void setActivePythonRenderGraphDevice(ref<Device> pDevice);
@@ -29,6 +29,7 @@
 #include "Core/Assert.h"
 #include "Core/Errors.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 #include "Utils/Timing/Profiler.h"
 #include "Utils/Math/MathConstants.slangh"
 #include <algorithm>
@@ -45,6 +46,54 @@ namespace
     const uint32_t kMaxLeafTriangleCount = 1 << PackedNode::kTriangleCountBits;
     const uint32_t kMaxLeafTriangleOffset = 1 << PackedNode::kTriangleOffsetBits;
 
+    // Nodes with at least this many triangles build their two subtrees in parallel.
+    const uint32_t kMinParallelSubtreeTriangleCount = 4096;
+
+    // Number of triangles per chunk when reducing over the triangles of a node (node bounds, binning).
+    // The chunks only depend on the triangle range, so the result is the same for parallel and serial builds.
+    const size_t kTriangleChunkSize = 16384;
+
+    /** Reduce over a range of triangles in fixed-size chunks.
+        The chunk results are combined in order, optionally processing the chunks in parallel.
+        \param[in] parallel Process the chunks in parallel.
+        \param[in] identity Identity value of the reduction.
+        \param[in] map Function called as T map(size_t chunkBegin, size_t chunkEnd, T init).
+        \param[in] reduce Function called as T reduce(T a, const T& b).
+        \return The reduced value.
+    */
+    template<typename T, typename MapFunc, typename ReduceFunc>
+    T reduceTriangles(bool parallel, uint32_t begin, uint32_t end, T identity, const MapFunc& map, const ReduceFunc& reduce)
+    {
+        FALCOR_ASSERT(begin <= end);
+        if (end - begin <= kTriangleChunkSize) return map(begin, end, std::move(identity));
+        if (parallel) return Threading::parallelReduce(begin, end, std::move(identity), map, reduce, kTriangleChunkSize);
+
+        T result = identity;
+        for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += kTriangleChunkSize)
+        {
+            size_t chunkEnd = std::min(chunkBegin + kTriangleChunkSize, (size_t)end);
+            result = reduce(std::move(result), map(chunkBegin, chunkEnd, identity));
+        }
+        return result;
+    }
+
+    /** Append the nodes of a subtree to a list of nodes, offsetting the child indices of the subtree.
+        \return Index of the subtree root node in the list.
+    */
+    uint32_t appendSubtree(std::vector<PackedNode>& nodes, const std::vector<PackedNode>& subtree)
+    {
+        FALCOR_ASSERT(!subtree.empty());
+        FALCOR_ASSERT(nodes.size() + subtree.size() < std::numeric_limits<uint32_t>::max());
+        const uint32_t offset = (uint32_t)nodes.size();
+        nodes.insert(nodes.end(), subtree.begin(), subtree.end());
+        for (size_t nodeIndex = offset; nodeIndex < nodes.size(); ++nodeIndex)
+        {
+            // Internal nodes store the right child index in the first dword (see PackedNode::getInternalNode()).
+            if (!nodes[nodeIndex].isLeaf()) nodes[nodeIndex].data[0].x += offset;
+        }
+        return offset;
+    }
+
     inline float safeACos(float v)
     {
         return std::acos(std::clamp(v, -1.0f, 1.0f));
@@ -281,16 +330,20 @@ namespace Falcor
         // TODO: Better estimate of how many nodes we will need.
         data.nodes.clear();
         data.nodes.reserve(2 * data.trianglesData.size());
-        data.triangleIndices.reserve(data.trianglesData.size());
 
         const uint64_t invalidBitmask = std::numeric_limits<uint64_t>::max();
         data.triangleBitmasks.resize(triangles.size(), invalidBitmask); // This is sized based on input triangle count, as it's indexed by global triangle index.
 
         // Build the tree.
         SplitHeuristicFunction splitFunc = getSplitFunction(mOptions.splitHeuristicSelection);
-        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data);
+        buildInternal(mOptions, splitFunc, 0ull, 0, Range(0, static_cast<uint32_t>(data.trianglesData.size())), data, data.nodes);
         FALCOR_ASSERT(!data.nodes.empty());
 
+        // The leaf nodes reference consecutive ranges of the sorted triangle data in depth-first order.
+        // Gather the triangle indices now that all ranges are sorted.
+        data.triangleIndices.resize(data.trianglesData.size());
+        for (size_t i = 0; i < data.trianglesData.size(); i++) data.triangleIndices[i] = data.trianglesData[i].triangleIndex;
+
         size_t numValid = 0;
         for (auto mask : data.triangleBitmasks)
             if (mask != invalidBitmask) numValid++;
@@ -320,6 +373,7 @@ namespace Falcor
         bool optionsChanged = false;
 
         optionsChanged |= widget.checkbox("Allow refitting", options.allowRefitting);
+        optionsChanged |= widget.checkbox("Parallel build", options.useParallelBuild);
         optionsChanged |= widget.var("Max triangle count per leaf", options.maxTriangleCountPerLeaf, 1u, kMaxLeafTriangleCount);
         optionsChanged |= widget.dropdown("Split heuristic", options.splitHeuristicSelection);
 
@@ -350,24 +404,38 @@ namespace Falcor
         return optionsChanged;
     }
 
-    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data)
+    uint32_t LightBVHBuilder::buildInternal(const Options& options, const SplitHeuristicFunction& splitHeuristic, uint64_t bitmask, uint32_t depth, const Range& triangleRange, BuildingData& data, std::vector<PackedNode>& nodes)
     {
         FALCOR_ASSERT(triangleRange.begin < triangleRange.end);
 
         // Compute the AABB and total flux of the node.
-        float nodeFlux = 0.f;
-        AABB nodeBounds;
-        for (uint32_t dataIndex = triangleRange.begin; dataIndex < triangleRange.end; ++dataIndex)
+        struct NodeBoundsAndFlux
         {
-            nodeBounds |= data.trianglesData[dataIndex].bounds;
-            nodeFlux += data.trianglesData[dataIndex].flux;
-        }
+            AABB bounds;
+            float flux = 0.f;
+        };
+        const NodeBoundsAndFlux nodeData = reduceTriangles(options.useParallelBuild, triangleRange.begin, triangleRange.end, NodeBoundsAndFlux(),
+            [&data](size_t begin, size_t end, NodeBoundsAndFlux result)
+            {
+                for (size_t dataIndex = begin; dataIndex < end; ++dataIndex)
+                {
+                    result.bounds |= data.trianglesData[dataIndex].bounds;
+                    result.flux += data.trianglesData[dataIndex].flux;
+                }
+                return result;
+            },
+            [](NodeBoundsAndFlux a, const NodeBoundsAndFlux& b)
+            {
+                a.bounds |= b.bounds;
+                a.flux += b.flux;
+                return a;
+            });
+        const AABB& nodeBounds = nodeData.bounds;
+        const float nodeFlux = nodeData.flux;
         FALCOR_ASSERT(nodeBounds.valid());
 
-        data.currentNodeFlux = nodeFlux;
-
         bool trySplitting = triangleRange.length() > (options.createLeavesASAP ? options.maxTriangleCountPerLeaf : 1);
-        const SplitResult splitResult = trySplitting ? splitHeuristic(data, triangleRange, nodeBounds, options) : SplitResult();
+        const SplitResult splitResult = trySplitting ? splitHeuristic(data, triangleRange, nodeBounds, nodeFlux, options) : SplitResult();
 
         // If we should split, then create an internal node and split.
         if (splitResult.isValid())
@@ -379,9 +447,9 @@ namespace Falcor
             std::nth_element(std::begin(data.trianglesData) + triangleRange.begin, std::begin(data.trianglesData) + splitResult.triangleIndex, std::begin(data.trianglesData) + triangleRange.end, comp);
 
             // Allocate internal node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)nodes.size();
+            nodes.push_back({});
 
             InternalNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -395,13 +463,39 @@ namespace Falcor
                 throw RuntimeError("BVH depth of {} reached. Maximum of {} allowed.", depth + 1, kMaxBVHDepth);
             }
 
-            uint32_t leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, Range(triangleRange.begin, splitResult.triangleIndex), data);
-            uint32_t rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, Range(splitResult.triangleIndex, triangleRange.end), data);
+            const Range leftRange(triangleRange.begin, splitResult.triangleIndex);
+            const Range rightRange(splitResult.triangleIndex, triangleRange.end);
+            uint32_t leftIndex = 0;
+            uint32_t rightIndex = 0;
+
+            if (options.useParallelBuild && triangleRange.length() >= kMinParallelSubtreeTriangleCount)
+            {
+                // Build the right subtree into a separate list in parallel with the left subtree and append it afterwards.
+                std::vector<PackedNode> rightNodes;
+                Threading::parallelFor(0, 2, [&](size_t child)
+                {
+                    if (child == 0)
+                    {
+                        leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, leftRange, data, nodes);
+                    }
+                    else
+                    {
+                        rightNodes.reserve(2 * rightRange.length());
+                        buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, rightRange, data, rightNodes);
+                    }
+                }, 1);
+                rightIndex = appendSubtree(nodes, rightNodes);
+            }
+            else
+            {
+                leftIndex = buildInternal(options, splitHeuristic, bitmask | (0ull << depth), depth + 1, leftRange, data, nodes);
+                rightIndex = buildInternal(options, splitHeuristic, bitmask | (1ull << depth), depth + 1, rightRange, data, nodes);
+            }
 
             FALCOR_ASSERT(leftIndex == nodeIndex + 1); // The left node should always be placed immediately after the current node.
             node.rightChildIdx = rightIndex;
 
-            data.nodes[nodeIndex].setInternalNode(node);
+            nodes[nodeIndex].setInternalNode(node);
             return nodeIndex;
         }
         else // No split => create leaf node
@@ -409,9 +503,9 @@ namespace Falcor
             FALCOR_ASSERT(triangleRange.length() <= options.maxTriangleCountPerLeaf);
 
             // Allocate leaf node.
-            FALCOR_ASSERT(data.nodes.size() < std::numeric_limits<uint32_t>::max());
-            const uint32_t nodeIndex = (uint32_t)data.nodes.size();
-            data.nodes.push_back({});
+            FALCOR_ASSERT(nodes.size() < std::numeric_limits<uint32_t>::max());
+            const uint32_t nodeIndex = (uint32_t)nodes.size();
+            nodes.push_back({});
 
             LeafNode node = {};
             node.attribs.setAABB(nodeBounds.minPoint, nodeBounds.maxPoint);
@@ -420,20 +514,19 @@ namespace Falcor
             node.attribs.coneDirection = computeLightingCone(triangleRange, data, cosTheta);
             node.attribs.cosConeAngle = cosTheta;
 
+            // The leaves partition the triangle data in depth-first order, so the triangle range is also the leaf's range in the final triangle index list.
             node.triangleCount = triangleRange.length();
-            node.triangleOffset = (uint32_t)data.triangleIndices.size();
+            node.triangleOffset = triangleRange.begin;
             FALCOR_ASSERT(node.triangleCount < kMaxLeafTriangleCount);
             FALCOR_ASSERT(node.triangleOffset < kMaxLeafTriangleOffset);
 
-            for (uint32_t triangleIdx = triangleRange.begin, index = 0; triangleIdx < triangleRange.end; ++triangleIdx, ++index)
+            for (uint32_t triangleIdx = triangleRange.begin; triangleIdx < triangleRange.end; ++triangleIdx)
             {
                 uint32_t globalTriangleIndex = data.trianglesData[triangleIdx].triangleIndex;
-                data.triangleIndices.push_back(globalTriangleIndex);
                 data.triangleBitmasks[globalTriangleIndex] = bitmask;
             }
-            FALCOR_ASSERT(data.triangleIndices.size() == node.triangleOffset + node.triangleCount);
 
-            data.nodes[nodeIndex].setLeafNode(node);
+            nodes[nodeIndex].setLeafNode(node);
             return nodeIndex;
         }
     }
@@ -498,7 +591,7 @@ namespace Falcor
         return coneDirection;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, const Options& /*parameters*/)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithEqual(const BuildingData& /*data*/, const Range& triangleRange, const AABB& nodeBounds, float /*nodeFlux*/, const Options& /*parameters*/)
     {
         // Find the largest dimension.
         float3 dimensions = nodeBounds.extent();
@@ -525,7 +618,7 @@ namespace Falcor
         return cost;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters)
     {
         std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
         FALCOR_ASSERT(!overallBestSplit.second.isValid());
@@ -566,15 +659,22 @@ namespace Falcor
                 return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
             };
 
-            // Reset the bins.
-            for (Bin& bin : bins) bin = Bin();
-
             // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
-            }
+            bins = reduceTriangles(parameters.useParallelBuild, triangleRange.begin, triangleRange.end, std::vector<Bin>(parameters.binCount),
+                [&](size_t begin, size_t end, std::vector<Bin> chunkBins)
+                {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        const auto& td = data.trianglesData[i];
+                        chunkBins[getBinId(td)] |= td;
+                    }
+                    return chunkBins;
+                },
+                [](std::vector<Bin> a, const std::vector<Bin>& b)
+                {
+                    for (size_t i = 0; i < a.size(); ++i) a[i] |= b[i];
+                    return a;
+                });
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
             // Note that the costs vector has n-1 elements when there are n bins; the i:th elements represents the split between bin i and i+1.
@@ -638,7 +738,7 @@ namespace Falcor
         {
             if (triangleRange.length() <= parameters.maxTriangleCountPerLeaf) return SplitResult();
             logWarning("LightBVHBuilder::computeSplitWithBinnedSAH() was not able to compute a proper split: reverting to LightBVHBuilder::computeSplitWithEqual()");
-            return computeSplitWithEqual(data, triangleRange, nodeBounds, parameters);
+            return computeSplitWithEqual(data, triangleRange, nodeBounds, nodeFlux, parameters);
         }
 
         // If the best split we found is more expensive than the cost of a leaf node (and we can create one), then create a leaf node.
@@ -680,7 +780,7 @@ namespace Falcor
         return cost;
     }
 
-    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, const Options& parameters)
+    LightBVHBuilder::SplitResult LightBVHBuilder::computeSplitWithBinnedSAOH(const BuildingData& data, const Range& triangleRange, const AABB& nodeBounds, float nodeFlux, const Options& parameters)
     {
         std::pair<float, SplitResult> overallBestSplit = std::make_pair(std::numeric_limits<float>::infinity(), SplitResult());
         FALCOR_ASSERT(!overallBestSplit.second.isValid());
@@ -736,31 +836,55 @@ namespace Falcor
                 return std::min((uint32_t)((p - bmin) * scale), parameters.binCount - 1);
             };
 
-            // Reset the bins.
-            for (Bin& bin : bins) bin = Bin();
-
             // Fill the bins with all triangles.
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
-            {
-                const auto& td = data.trianglesData[i];
-                bins[getBinId(td)] |= td;
-            }
+            bins = reduceTriangles(parameters.useParallelBuild, triangleRange.begin, triangleRange.end, std::vector<Bin>(parameters.binCount),
+                [&](size_t begin, size_t end, std::vector<Bin> chunkBins)
+                {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        const auto& td = data.trianglesData[i];
+                        chunkBins[getBinId(td)] |= td;
+                    }
+                    return chunkBins;
+                },
+                [](std::vector<Bin> a, const std::vector<Bin>& b)
+                {
+                    for (size_t i = 0; i < a.size(); ++i) a[i] |= b[i];
+                    return a;
+                });
 
             // Compute the lighting cones for each bin.
             // The cone direction is the average direction over all lights in the bin and the cone angle is grown to include all.
             // If the vector is zero length (no lights or if all directions cancelled out), the cone is marked as invalid.
             // TODO: Switch to a more sophisticated algorithm to get narrower cones.
-            for (Bin& bin : bins)
-            {
-                bin.cosConeAngle = length(bin.coneDirection) < FLT_MIN ? kInvalidCosConeAngle : 1.0f;
-                bin.coneDirection = normalize(bin.coneDirection);
-            }
-            for (uint32_t i = triangleRange.begin; i < triangleRange.end; ++i)
+            std::vector<float> cosConeAngles(bins.size());
+            for (size_t i = 0; i < bins.size(); ++i)
             {
-                const auto& td = data.trianglesData[i];
-                Bin& bin = bins[getBinId(td)];
-                bin.cosConeAngle = computeCosConeAngle(bin.coneDirection, bin.cosConeAngle, td.coneDirection, td.cosConeAngle);
+                bins[i].cosConeAngle = length(bins[i].coneDirection) < FLT_MIN ? kInvalidCosConeAngle : 1.0f;
+                bins[i].coneDirection = normalize(bins[i].coneDirection);
+                cosConeAngles[i] = bins[i].cosConeAngle;
             }
+            cosConeAngles = reduceTriangles(parameters.useParallelBuild, triangleRange.begin, triangleRange.end, std::move(cosConeAngles),
+                [&](size_t begin, size_t end, std::vector<float> chunkCosConeAngles)
+                {
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        const auto& td = data.trianglesData[i];
+                        uint32_t binId = getBinId(td);
+                        chunkCosConeAngles[binId] = computeCosConeAngle(bins[binId].coneDirection, chunkCosConeAngles[binId], td.coneDirection, td.cosConeAngle);
+                    }
+                    return chunkCosConeAngles;
+                },
+                [](std::vector<float> a, const std::vector<float>& b)
+                {
+                    // Growing a cone is a min() over the cone angles where an invalid cone stays invalid, so the chunks can be combined exactly.
+                    for (size_t i = 0; i < a.size(); ++i)
+                    {
+                        a[i] = (a[i] == kInvalidCosConeAngle || b[i] == kInvalidCosConeAngle) ? kInvalidCosConeAngle : std::min(a[i], b[i]);
+                    }
+                    return a;
+                });
+            for (size_t i = 0; i < bins.size(); ++i) bins[i].cosConeAngle = cosConeAngles[i];
 
             // First, compute A_j(L) * N_j(L) by sweeping over the bins from left to right.
             // Note that the costs vector has n-1 elements when there are n bins; the i:th elements represents the split between bin i and i+1.
@@ -849,7 +973,7 @@ namespace Falcor
         {
             if (triangleRange.length() <= parameters.maxTriangleCountPerLeaf) return SplitResult();
             logWarning("LightBVHBuilder::computeSplitWithBinnedSAOH() was not able to compute a proper split: reverting to LightBVHBuilder::computeSplitWithEqual()");
-            return computeSplitWithEqual(data, triangleRange, nodeBounds, parameters);
+            return computeSplitWithEqual(data, triangleRange, nodeBounds, nodeFlux, parameters);
         }
 
         // If the best split we found is more expensive than the cost of a leaf node (and we can create one), then create a leaf node.
@@ -859,7 +983,7 @@ namespace Falcor
             // Evaluate the cost metric for the node. This requires us to first compute the cone angle.
             float cosTheta = kInvalidCosConeAngle;
             computeLightingCone(triangleRange, data, cosTheta);
-            float leafCost = evalSAOH(nodeBounds, data.currentNodeFlux, cosTheta, parameters);
+            float leafCost = evalSAOH(nodeBounds, nodeFlux, cosTheta, parameters);
             if (leafCost <= overallBestSplit.first) return SplitResult();
         }
 
@@ -28,9 +28,11 @@
 #include "Animation.h"
 #include "AnimationController.h"
 #include "Utils/ObjectIDPython.h"
+#include "Utils/Threading.h"
 #include "Utils/Math/Common.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Scene/Transform.h"
+#include <algorithm>
 
 namespace Falcor
 {
@@ -38,6 +40,9 @@ namespace Falcor
     {
         const double kEpsilonTime = 1e-5f;
 
+        // Number of animations evaluated per task in animateAll().
+        const size_t kAnimateGrainSize = 256;
+
         const Gui::DropdownList kChannelLoopModeDropdown =
         {
             { (uint32_t)Animation::Behavior::Constant, "Constant" },
@@ -103,6 +108,18 @@ namespace Falcor
             result.time = math::lerp(k1.time, k2.time, (double)t);
             return result;
         }
+
+        // Equivalent to T * R * S but without the full matrix multiplications.
+        float4x4 composeTransform(const Animation::Keyframe& keyframe)
+        {
+            float4x4 transform = math::matrixFromQuat(keyframe.rotation);
+            for (int r = 0; r < 3; r++)
+            {
+                for (int c = 0; c < 3; c++) transform[r][c] *= keyframe.scaling[c];
+                transform[r][3] = keyframe.translation[r];
+            }
+            return transform;
+        }
     }
 
     Animation::Animation(const std::string& name, NodeID nodeID, double duration)
@@ -147,31 +164,56 @@ namespace Falcor
             interpolated = interpolate(mInterpolationMode, time);
         }
 
-        float4x4 T = math::matrixFromTranslation(interpolated.translation);
-        float4x4 R = math::matrixFromQuat(interpolated.rotation);
-        float4x4 S = math::matrixFromScaling(interpolated.scaling);
-        float4x4 transform = mul(mul(T, R), S);
+        return composeTransform(interpolated);
+    }
+
+    void Animation::animateAll(fstd::span<const ref<Animation>> animations, double currentTime, fstd::span<float4x4> transforms)
+    {
+        checkArgument(animations.size() == transforms.size(), "'transforms' must have the same size as 'animations'.");
 
-        return transform;
+        Threading::parallelForRange(
+            0,
+            animations.size(),
+            [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; i++) transforms[i] = animations[i]->animate(currentTime);
+            },
+            kAnimateGrainSize
+        );
     }
 
-    Animation::Keyframe Animation::interpolate(InterpolationMode mode, double time) const
+    size_t Animation::findFrameIndex(double time) const
     {
-        FALCOR_ASSERT(!mKeyframes.empty());
+        FALCOR_ASSERT(!mKeyframeTimes.empty());
+        const size_t count = mKeyframeTimes.size();
 
-        // Validate cached frame index.
-        size_t frameIndex = std::clamp(mCachedFrameIndex, (size_t)0, mKeyframes.size() - 1);
-        if (time < mKeyframes[frameIndex].time) frameIndex = 0;
+        // Check the cached segment and the one after it first, which covers regular playback.
+        auto isInSegment = [&](size_t i) { return mKeyframeTimes[i] <= time && (i + 1 == count || time < mKeyframeTimes[i + 1]); };
 
-        // Find frame index.
-        while (frameIndex < mKeyframes.size() - 1)
+        size_t frameIndex = std::min(mCachedFrameIndex, count - 1);
+        if (!isInSegment(frameIndex))
         {
-            if (mKeyframes[frameIndex + 1].time > time) break;
-            frameIndex++;
+            if (frameIndex + 1 < count && isInSegment(frameIndex + 1))
+            {
+                frameIndex++;
+            }
+            else
+            {
+                // Find the last keyframe at or before the given time, or the first keyframe if there is none.
+                auto it = std::upper_bound(mKeyframeTimes.begin(), mKeyframeTimes.end(), time);
+                frameIndex = it == mKeyframeTimes.begin() ? 0 : (size_t)(it - mKeyframeTimes.begin()) - 1;
+            }
         }
 
-        // Cache frame index;
         mCachedFrameIndex = frameIndex;
+        return frameIndex;
+    }
+
+    Animation::Keyframe Animation::interpolate(InterpolationMode mode, double time) const
+    {
+        FALCOR_ASSERT(!mKeyframes.empty());
+
+        size_t frameIndex = findFrameIndex(time);
 
         // Compute index of adjacent frame including optional warping.
         auto adjacentFrame = [this] (size_t frame, int32_t offset = 1)
@@ -257,59 +299,71 @@ namespace Falcor
     {
         FALCOR_ASSERT(keyframe.time <= mDuration);
 
-        if (mKeyframes.size() == 0 || mKeyframes[0].time > keyframe.time)
+        auto it = std::lower_bound(mKeyframeTimes.begin(), mKeyframeTimes.end(), keyframe.time);
+        size_t index = it - mKeyframeTimes.begin();
+
+        // If we already have a key-frame at the same time, replace it
+        if (it != mKeyframeTimes.end() && *it == keyframe.time)
         {
-            mKeyframes.insert(mKeyframes.begin(), keyframe);
+            mKeyframes[index] = keyframe;
+            return;
         }
-        else if (mKeyframes.back().time < keyframe.time)
+
+        mKeyframes.insert(mKeyframes.begin() + index, keyframe);
+        mKeyframeTimes.insert(it, keyframe.time);
+    }
+
+    void Animation::addKeyframes(fstd::span<const Keyframe> keyframes)
+    {
+        if (keyframes.empty()) return;
+
+        for (const auto& keyframe : keyframes) FALCOR_ASSERT(keyframe.time <= mDuration);
+
+        // Strictly increasing keyframes after the existing ones can be appended directly.
+        bool isSorted = std::adjacent_find(keyframes.begin(), keyframes.end(), [](const Keyframe& a, const Keyframe& b) { return a.time >= b.time; }) == keyframes.end();
+        if (isSorted && (mKeyframes.empty() || mKeyframes.back().time < keyframes.front().time))
         {
-            mKeyframes.push_back(keyframe);
+            mKeyframes.insert(mKeyframes.end(), keyframes.begin(), keyframes.end());
+            updateKeyframeTimes();
+            return;
         }
-        else
-        {
-            for (size_t i = 0; i < mKeyframes.size(); i++)
-            {
-                auto& current = mKeyframes[i];
-                // If we already have a key-frame at the same time, replace it
-                if (current.time == keyframe.time)
-                {
-                    current = keyframe;
-                    return;
-                }
-
-                // If this is not the last frame, Check if we are in between frames
-                if (i < mKeyframes.size() - 1)
-                {
-                    auto& Next = mKeyframes[i + 1];
-                    if (current.time < keyframe.time && Next.time > keyframe.time)
-                    {
-                        mKeyframes.insert(mKeyframes.begin() + i + 1, keyframe);
-                        return;
-                    }
-                }
-            }
 
-            // If we got here, need to push it to the end of the list
-            mKeyframes.push_back(keyframe);
+        // Otherwise merge all keyframes with a stable sort, keeping the last keyframe for each time.
+        std::vector<Keyframe> merged;
+        merged.reserve(mKeyframes.size() + keyframes.size());
+        merged.insert(merged.end(), mKeyframes.begin(), mKeyframes.end());
+        merged.insert(merged.end(), keyframes.begin(), keyframes.end());
+        std::stable_sort(merged.begin(), merged.end(), [](const Keyframe& a, const Keyframe& b) { return a.time < b.time; });
+
+        size_t count = 0;
+        for (size_t i = 0; i < merged.size(); i++)
+        {
+            if (i + 1 < merged.size() && merged[i + 1].time == merged[i].time) continue;
+            merged[count++] = merged[i];
         }
+        merged.resize(count);
+
+        mKeyframes = std::move(merged);
+        updateKeyframeTimes();
+    }
+
+    void Animation::updateKeyframeTimes()
+    {
+        mKeyframeTimes.resize(mKeyframes.size());
+        for (size_t i = 0; i < mKeyframes.size(); i++) mKeyframeTimes[i] = mKeyframes[i].time;
+        mCachedFrameIndex = 0;
     }
 
     const Animation::Keyframe& Animation::getKeyframe(double time) const
     {
-        for (const auto& k : mKeyframes)
-        {
-            if (k.time == time) return k;
-        }
+        auto it = std::lower_bound(mKeyframeTimes.begin(), mKeyframeTimes.end(), time);
+        if (it != mKeyframeTimes.end() && *it == time) return mKeyframes[it - mKeyframeTimes.begin()];
         throw ArgumentError("'time' ({}) does not refer to an existing keyframe", time);
     }
 
     bool Animation::doesKeyframeExists(double time) const
     {
-        for (const auto& k : mKeyframes)
-        {
-            if (k.time == time) return true;
-        }
-        return false;
+        return std::binary_search(mKeyframeTimes.begin(), mKeyframeTimes.end(), time);
     }
 
     void Animation::renderUI(Gui::Widgets& widget)
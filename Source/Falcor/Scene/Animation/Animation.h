@@ -33,6 +33,7 @@
 #include "Utils/Math/Matrix.h"
 #include "Utils/Math/Quaternion.h"
 #include "Utils/UI/Gui.h"
+#include <fstd/span.h> // TODO C++20: Replace with <span>
 #include <memory>
 #include <string>
 #include <vector>
@@ -130,6 +131,13 @@ namespace Falcor
         */
         void addKeyframe(const Keyframe& keyframe);
 
+        /** Add a list of keyframes.
+            The keyframes don't need to be sorted. Keyframes override existing keyframes at the same time, and later keyframes in the list
+            override earlier ones, same as adding them one by one with addKeyframe(). This is much faster for large numbers of keyframes.
+            \param[in] keyframes List of keyframes.
+        */
+        void addKeyframes(fstd::span<const Keyframe> keyframes);
+
         /** Get the keyframe at the specified time.
             If the keyframe doesn't exists, the function will throw an exception. If you don't want to handle exceptions, call doesKeyframeExist() first.
             \param[in] time Time of the keyframe.
@@ -149,13 +157,23 @@ namespace Falcor
         */
         float4x4 animate(double currentTime);
 
+        /** Compute a list of animations.
+            The animations are evaluated in parallel. Each animation may only appear once in the list.
+            \param[in] animations List of animations.
+            \param[in] currentTime The current time in seconds.
+            \param[out] transforms Transform matrix of each animation. Must have the same size as the list of animations.
+        */
+        static void animateAll(fstd::span<const ref<Animation>> animations, double currentTime, fstd::span<float4x4> transforms);
+
         /* Render the UI.
         */
         void renderUI(Gui::Widgets& widget);
 
     private:
         Keyframe interpolate(InterpolationMode mode, double time) const;
+        size_t findFrameIndex(double time) const;
         double calcSampleTime(double currentTime);
+        void updateKeyframeTimes();
 
         std::string mName;
         NodeID mNodeID;
@@ -168,6 +186,7 @@ namespace Falcor
         bool mEnableWarping = false;
 
         std::vector<Keyframe> mKeyframes;
+        std::vector<double> mKeyframeTimes; // Copy of the keyframe times for fast lookup.
         mutable size_t mCachedFrameIndex = 0;
 
         friend class SceneCache;
@@ -27,9 +27,13 @@
  **************************************************************************/
 #include "AnimationController.h"
 #include "Core/API/RenderContext.h"
+#include "Utils/Threading.h"
+#include "Utils/Math/MathHelpers.h"
 #include "Utils/Timing/Profiler.h"
 #include "Scene/Scene.h"
+#include <algorithm>
 #include <fstream>
+#include <iterator>
 
 namespace Falcor
 {
@@ -39,6 +43,51 @@ namespace Falcor
         const std::string kInverseTransposeWorldMatrices = "inverseTransposeWorldMatrices";
         const std::string kPrevWorldMatrices = "prevWorldMatrices";
         const std::string kPrevInverseTransposeWorldMatrices = "prevInverseTransposeWorldMatrices";
+
+        // Minimum number of nodes to update before the update is distributed over worker threads level by level.
+        const size_t kMinParallelUpdateNodeCount = 16384;
+        const size_t kParallelUpdateGrainSize = 1024;
+
+        // Gaps of unchanged matrices up to this size are uploaded along with the surrounding changed ranges.
+        const uint32_t kMaxUploadGap = 16;
+
+        /** Compute the inverse of a transform matrix.
+            Affine matrices are inverted using the inverse of the upper 3x3 part, which is cheaper than a general 4x4 inverse.
+        */
+        float4x4 inverseTransform(const float4x4& m)
+        {
+            if (!isMatrixAffine(m)) return inverse(m);
+
+            float3x3 a;
+            for (int r = 0; r < 3; r++)
+            {
+                for (int c = 0; c < 3; c++) a[r][c] = m[r][c];
+            }
+            float3x3 invA = inverse(a);
+
+            float4x4 result = float4x4::identity();
+            for (int r = 0; r < 3; r++)
+            {
+                for (int c = 0; c < 3; c++) result[r][c] = invA[r][c];
+                result[r][3] = -(invA[r][0] * m[0][3] + invA[r][1] * m[1][3] + invA[r][2] * m[2][3]);
+            }
+            return result;
+        }
+
+        /** Call func(offset, count) for each range of nodes in a sorted node list.
+            Small gaps between changed nodes are merged into the ranges to reduce the number of uploads.
+        */
+        template<typename Func>
+        void forEachNodeRange(const std::vector<uint32_t>& sortedNodes, Func func)
+        {
+            for (size_t i = 0; i < sortedNodes.size();)
+            {
+                size_t j = i + 1;
+                while (j < sortedNodes.size() && sortedNodes[j] - sortedNodes[j - 1] <= kMaxUploadGap) ++j;
+                func(sortedNodes[i], sortedNodes[j - 1] - sortedNodes[i] + 1);
+                i = j;
+            }
+        }
     }
 
     AnimationController::AnimationController(ref<Device> pDevice, Scene* pScene, const StaticVertexVector& staticVertexData, const SkinningVertexVector& skinningVertexData, uint32_t prevVertexCount, const std::vector<ref<Animation>>& animations)
@@ -51,6 +100,8 @@ namespace Falcor
         , mMatricesChanged(pScene->mSceneGraph.size())
         , mpScene(pScene)
     {
+        initNodeHierarchy();
+
         // Create GPU resources.
         FALCOR_ASSERT(mLocalMatrices.size() <= std::numeric_limits<uint32_t>::max());
 
@@ -182,6 +233,80 @@ namespace Falcor
         }
     }
 
+    void AnimationController::setNodeEdited(size_t nodeID)
+    {
+        FALCOR_ASSERT(nodeID < mNodesEdited.size());
+        if (mNodesEdited[nodeID]) return;
+        mNodesEdited[nodeID] = 1;
+        mEditedNodes.push_back((uint32_t)nodeID);
+    }
+
+    void AnimationController::initNodeHierarchy()
+    {
+        // Build a flat child list for each node and compute node levels.
+        // The scene builder guarantees that parents are stored before their children.
+        const auto& sceneGraph = mpScene->mSceneGraph;
+        const size_t nodeCount = sceneGraph.size();
+
+        mChildOffsets.assign(nodeCount + 1, 0);
+        mNodeLevels.assign(nodeCount, 0);
+        mLevelCount = nodeCount > 0 ? 1 : 0;
+
+        for (size_t i = 0; i < nodeCount; i++)
+        {
+            NodeID parent = sceneGraph[i].parent;
+            if (parent == NodeID::Invalid()) continue;
+            checkInvariant(parent.get() < i, "Scene graph node {} has parent {} stored after it.", i, parent.get());
+            mChildOffsets[parent.get() + 1]++;
+            mNodeLevels[i] = mNodeLevels[parent.get()] + 1;
+            mLevelCount = std::max(mLevelCount, mNodeLevels[i] + 1);
+        }
+
+        for (size_t i = 0; i < nodeCount; i++) mChildOffsets[i + 1] += mChildOffsets[i];
+
+        mChildren.resize(mChildOffsets[nodeCount]);
+        std::vector<uint32_t> childCounts(nodeCount, 0);
+        for (size_t i = 0; i < nodeCount; i++)
+        {
+            NodeID parent = sceneGraph[i].parent;
+            if (parent == NodeID::Invalid()) continue;
+            mChildren[mChildOffsets[parent.get()] + childCounts[parent.get()]++] = (uint32_t)i;
+        }
+    }
+
+    void AnimationController::initActiveAnimations()
+    {
+        // Mark all nodes whose matrices are used by the scene.
+        const auto& sceneGraph = mpScene->mSceneGraph;
+        std::vector<uint8_t> referenced(sceneGraph.size(), 0);
+
+        auto markReferenced = [&](NodeID nodeID)
+        {
+            if (nodeID != NodeID::Invalid() && nodeID.get() < referenced.size()) referenced[nodeID.get()] = 1;
+        };
+
+        for (const auto& instance : mpScene->mGeometryInstanceData) markReferenced(NodeID{ instance.globalMatrixID });
+        for (const auto& pCamera : mpScene->getCameras()) markReferenced(pCamera->getNodeID());
+        for (const auto& pLight : mpScene->getLights()) markReferenced(pLight->getNodeID());
+        for (const auto& pGridVolume : mpScene->getGridVolumes()) markReferenced(pGridVolume->getNodeID());
+        for (uint32_t nodeID : mSkinningNodes) referenced[nodeID] = 1;
+
+        // Propagate to ancestors. Children are stored after their parents.
+        for (size_t i = sceneGraph.size(); i-- > 0;)
+        {
+            NodeID parent = sceneGraph[i].parent;
+            if (referenced[i] && parent != NodeID::Invalid()) referenced[parent.get()] = 1;
+        }
+
+        mActiveAnimations.clear();
+        for (const auto& pAnimation : mAnimations)
+        {
+            NodeID nodeID = pAnimation->getNodeID();
+            FALCOR_ASSERT(nodeID.get() < referenced.size());
+            if (referenced[nodeID.get()]) mActiveAnimations.push_back(pAnimation);
+        }
+    }
+
     void AnimationController::initLocalMatrices()
     {
         for (size_t i = 0; i < mLocalMatrices.size(); i++)
@@ -194,21 +319,21 @@ namespace Falcor
     {
         FALCOR_PROFILE(pRenderContext, "animate");
 
-        std::fill(mMatricesChanged.begin(), mMatricesChanged.end(), false);
+        // Reset the change flags of the last frame.
+        for (uint32_t nodeID : mChangedNodes) mMatricesChanged[nodeID] = 0;
+        mChangedNodes.clear();
+        mDirtyNodes.clear();
 
-        // Check for edited scene nodes and update local matrices.
+        // Update local matrices of edited scene nodes.
         const auto& sceneGraph = mpScene->mSceneGraph;
-        bool edited = false;
-        for (size_t i = 0; i < sceneGraph.size(); ++i)
+        bool edited = !mEditedNodes.empty();
+        for (uint32_t nodeID : mEditedNodes)
         {
-            if (mNodesEdited[i])
-            {
-                mLocalMatrices[i] = sceneGraph[i].transform;
-                mNodesEdited[i] = false;
-                mMatricesChanged[i] = true;
-                edited = true;
-            }
+            mLocalMatrices[nodeID] = sceneGraph[nodeID].transform;
+            mNodesEdited[nodeID] = 0;
+            mDirtyNodes.push_back(nodeID);
         }
+        mEditedNodes.clear();
 
         bool changed = false;
         double time = mLoopAnimations ? std::fmod(currentTime, mGlobalAnimationLength) : currentTime;
@@ -218,6 +343,7 @@ namespace Falcor
         // including transformation matrices, dynamic vertex data etc.
         if (mFirstUpdate || mEnabled != mPrevEnabled)
         {
+            initActiveAnimations();
             initLocalMatrices();
             if (mEnabled)
             {
@@ -288,44 +414,115 @@ namespace Falcor
 
     void AnimationController::updateLocalMatrices(double time)
     {
-        for (auto& pAnimation : mAnimations)
+        mAnimationMatrices.resize(mActiveAnimations.size());
+        Animation::animateAll(mActiveAnimations, time, mAnimationMatrices);
+
+        for (size_t i = 0; i < mActiveAnimations.size(); i++)
         {
-            NodeID nodeID = pAnimation->getNodeID();
+            NodeID nodeID = mActiveAnimations[i]->getNodeID();
             FALCOR_ASSERT(nodeID.get() < mLocalMatrices.size());
-            mLocalMatrices[nodeID.get()] = pAnimation->animate(time);
-            mMatricesChanged[nodeID.get()] = true;
+            if (mAnimationMatrices[i] == mLocalMatrices[nodeID.get()]) continue;
+            mLocalMatrices[nodeID.get()] = mAnimationMatrices[i];
+            mDirtyNodes.push_back(nodeID.get());
         }
     }
 
-    void AnimationController::updateWorldMatrices(bool updateAll)
+    void AnimationController::markSubtreeChanged(uint32_t nodeID)
     {
-        const auto& sceneGraph = mpScene->mSceneGraph;
+        // A flagged node always has its entire subtree flagged, so flagged subtrees are skipped.
+        if (mMatricesChanged[nodeID]) return;
 
-        for (size_t i = 0; i < mGlobalMatrices.size(); i++)
+        mMatricesChanged[nodeID] = 1;
+        mTraversalStack.push_back(nodeID);
+        while (!mTraversalStack.empty())
         {
-            // Propagate matrix change flag to children.
-            if (sceneGraph[i].parent != NodeID::Invalid())
+            uint32_t current = mTraversalStack.back();
+            mTraversalStack.pop_back();
+            mChangedNodes.push_back(current);
+
+            for (uint32_t i = mChildOffsets[current]; i < mChildOffsets[current + 1]; i++)
             {
-                mMatricesChanged[i] = mMatricesChanged[i] || mMatricesChanged[sceneGraph[i].parent.get()];
+                uint32_t child = mChildren[i];
+                if (mMatricesChanged[child]) continue;
+                mMatricesChanged[child] = 1;
+                mTraversalStack.push_back(child);
             }
+        }
+    }
 
-            if (!mMatricesChanged[i] && !updateAll) continue;
+    void AnimationController::updateWorldMatrix(uint32_t nodeID)
+    {
+        const auto& node = mpScene->mSceneGraph[nodeID];
 
-            mGlobalMatrices[i] = mLocalMatrices[i];
+        mGlobalMatrices[nodeID] = mLocalMatrices[nodeID];
+        if (node.parent != NodeID::Invalid())
+        {
+            mGlobalMatrices[nodeID] = mul(mGlobalMatrices[node.parent.get()], mGlobalMatrices[nodeID]);
+        }
 
-            if (mpScene->mSceneGraph[i].parent != NodeID::Invalid())
-            {
-                mGlobalMatrices[i] = mul(mGlobalMatrices[sceneGraph[i].parent.get()], mGlobalMatrices[i]);
-            }
+        float4x4 invGlobalMatrix = inverseTransform(mGlobalMatrices[nodeID]);
+        mInvTransposeGlobalMatrices[nodeID] = transpose(invGlobalMatrix);
 
-            mInvTransposeGlobalMatrices[i] = transpose(inverse(mGlobalMatrices[i]));
+        if (mpSkinningPass)
+        {
+            mSkinningMatrices[nodeID] = mul(mGlobalMatrices[nodeID], node.localToBindSpace);
+            mInvTransposeSkinningMatrices[nodeID] = transpose(mul(mInvLocalToBindMatrices[nodeID], invGlobalMatrix));
+        }
+    }
+
+    void AnimationController::updateWorldMatrices(bool updateAll)
+    {
+        // Propagate the changes of dirty nodes to their subtrees.
+        size_t prevChangedCount = mChangedNodes.size();
+        for (uint32_t nodeID : mDirtyNodes) markSubtreeChanged(nodeID);
+        mDirtyNodes.clear();
 
-            if (mpSkinningPass)
+        if (mChangedNodes.size() != prevChangedCount)
+        {
+            // Parents have lower IDs than their children, so sorting the list gives a valid update order.
+            // For large lists, rebuilding from the flags is cheaper than sorting.
+            if (mChangedNodes.size() > mMatricesChanged.size() / 16)
+            {
+                mChangedNodes.clear();
+                for (size_t i = 0; i < mMatricesChanged.size(); i++)
+                {
+                    if (mMatricesChanged[i]) mChangedNodes.push_back((uint32_t)i);
+                }
+            }
+            else
             {
-                mSkinningMatrices[i] = mul(mGlobalMatrices[i], sceneGraph[i].localToBindSpace);
-                mInvTransposeSkinningMatrices[i] = transpose(inverse(mSkinningMatrices[i]));
+                std::sort(mChangedNodes.begin(), mChangedNodes.end());
             }
         }
+
+        const size_t nodeCount = updateAll ? mGlobalMatrices.size() : mChangedNodes.size();
+        auto getNode = [&](size_t i) { return updateAll ? (uint32_t)i : mChangedNodes[i]; };
+
+        if (nodeCount < kMinParallelUpdateNodeCount)
+        {
+            for (size_t i = 0; i < nodeCount; i++) updateWorldMatrix(getNode(i));
+            return;
+        }
+
+        // Group the nodes by level. All nodes of a level only depend on nodes of previous levels and can be updated in parallel.
+        mLevelOffsets.assign(mLevelCount + 1, 0);
+        for (size_t i = 0; i < nodeCount; i++) mLevelOffsets[mNodeLevels[getNode(i)] + 1]++;
+        for (uint32_t level = 0; level < mLevelCount; level++) mLevelOffsets[level + 1] += mLevelOffsets[level];
+
+        mLevelNodes.resize(nodeCount);
+        std::vector<uint32_t> levelCursors(mLevelOffsets.begin(), mLevelOffsets.end() - 1);
+        for (size_t i = 0; i < nodeCount; i++)
+        {
+            uint32_t nodeID = getNode(i);
+            mLevelNodes[levelCursors[mNodeLevels[nodeID]]++] = nodeID;
+        }
+
+        for (uint32_t level = 0; level < mLevelCount; level++)
+        {
+            Threading::parallelFor(
+                mLevelOffsets[level], mLevelOffsets[level + 1], [&](size_t i) { updateWorldMatrix(mLevelNodes[i]); }, kParallelUpdateGrainSize
+            );
+        }
     }
 
     void AnimationController::uploadWorldMatrices(bool uploadAll)
@@ -340,25 +537,22 @@ namespace Falcor
             // Upload all matrices.
             mpWorldMatricesBuffer->setBlob(mGlobalMatrices.data(), 0, mpWorldMatricesBuffer->getSize());
             mpInvTransposeWorldMatricesBuffer->setBlob(mInvTransposeGlobalMatrices.data(), 0, mpInvTransposeWorldMatricesBuffer->getSize());
+            mPrevChangedNodes.clear();
         }
         else
         {
             // Upload changed matrices only.
-            for (size_t i = 0; i < mGlobalMatrices.size();)
-            {
-                // Detect ranges of consecutive matrices that have all changed or not.
-                size_t offset = i;
-                bool changed = mMatricesChanged[i];
-                while (i < mGlobalMatrices.size() && mMatricesChanged[i] == changed) ++i;
+            // The buffers are swapped each update, so the current buffer still holds the matrices from two updates ago.
+            // Matrices changed in the last update are uploaded as well to bring it up to date.
+            mUploadNodes.clear();
+            std::set_union(mChangedNodes.begin(), mChangedNodes.end(), mPrevChangedNodes.begin(), mPrevChangedNodes.end(), std::back_inserter(mUploadNodes));
 
-                // Upload range of changed matrices.
-                if (changed)
-                {
-                    size_t count = i - offset;
-                    mpWorldMatricesBuffer->setBlob(&mGlobalMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
-                    mpInvTransposeWorldMatricesBuffer->setBlob(&mInvTransposeGlobalMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
-                }
-            }
+            forEachNodeRange(mUploadNodes, [&](uint32_t offset, uint32_t count)
+            {
+                mpWorldMatricesBuffer->setBlob(&mGlobalMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
+                mpInvTransposeWorldMatricesBuffer->setBlob(&mInvTransposeGlobalMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
+            });
+            mPrevChangedNodes = mChangedNodes;
         }
     }
 
@@ -410,10 +604,29 @@ namespace Falcor
 
             // Initialize mesh bind transforms
             std::vector<float4x4> meshInvBindMatrices(mMeshBindMatrices.size());
+            mInvLocalToBindMatrices.resize(mMeshBindMatrices.size());
             for (size_t i = 0; i < mpScene->mSceneGraph.size(); i++)
             {
                 mMeshBindMatrices[i] = mpScene->mSceneGraph[i].meshBind;
                 meshInvBindMatrices[i] = inverse(mMeshBindMatrices[i]);
+                mInvLocalToBindMatrices[i] = inverse(mpScene->mSceneGraph[i].localToBindSpace);
+            }
+
+            // Collect the nodes used by skinned vertices.
+            std::vector<uint8_t> skinningNodeFlags(mpScene->mSceneGraph.size(), 0);
+            auto markSkinningNode = [&](uint32_t nodeID)
+            {
+                if (nodeID < skinningNodeFlags.size()) skinningNodeFlags[nodeID] = 1;
+            };
+            for (const auto& v : skinningVertexData)
+            {
+                for (uint32_t j = 0; j < 4; j++) markSkinningNode(v.boneID[j]);
+                markSkinningNode(v.bindMatrixID);
+                markSkinningNode(v.skeletonMatrixID);
+            }
+            for (size_t i = 0; i < skinningNodeFlags.size(); i++)
+            {
+                if (skinningNodeFlags[i]) mSkinningNodes.push_back((uint32_t)i);
             }
 
             // Bind vertex data.
@@ -453,10 +666,21 @@ namespace Falcor
     {
         if (!mpSkinningPass) return;
 
-        // Update matrices.
+        // Update matrices. The skinning matrix buffers are not double buffered, so only changed matrices need uploading.
         FALCOR_ASSERT(mpSkinningMatricesBuffer && mpInvTransposeSkinningMatricesBuffer);
-        mpSkinningMatricesBuffer->setBlob(mSkinningMatrices.data(), 0, mpSkinningMatricesBuffer->getSize());
-        mpInvTransposeSkinningMatricesBuffer->setBlob(mInvTransposeSkinningMatrices.data(), 0, mpInvTransposeSkinningMatricesBuffer->getSize());
+        if (initPrev)
+        {
+            mpSkinningMatricesBuffer->setBlob(mSkinningMatrices.data(), 0, mpSkinningMatricesBuffer->getSize());
+            mpInvTransposeSkinningMatricesBuffer->setBlob(mInvTransposeSkinningMatrices.data(), 0, mpInvTransposeSkinningMatricesBuffer->getSize());
+        }
+        else
+        {
+            forEachNodeRange(mChangedNodes, [&](uint32_t offset, uint32_t count)
+            {
+                mpSkinningMatricesBuffer->setBlob(&mSkinningMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
+                mpInvTransposeSkinningMatricesBuffer->setBlob(&mInvTransposeSkinningMatrices[offset], offset * sizeof(float4x4), count * sizeof(float4x4));
+            });
+        }
 
         // Execute skinning pass.
         auto vars = mpSkinningPass->getRootVar()["gData"];
@@ -99,16 +99,19 @@ namespace Falcor
         /** Mark a scene node as being edited externally.
             Ensures that all global matrices depending on this scene node are updated.
         */
-        void setNodeEdited(size_t nodeID) { mNodesEdited[nodeID] = true; }
+        void setNodeEdited(size_t nodeID);
 
         /** Run the animation system.
+            Only nodes whose local matrix changed, and their subtrees, are updated.
+            Animations are only evaluated if their node, or a node below it, is referenced by a geometry instance,
+            camera, light, grid volume or skinned mesh. The matrices of other animated nodes keep their static transform.
             \return true if a change occurred, otherwise false.
         */
         bool animate(RenderContext* pRenderContext, double currentTime);
 
         /** Check if a matrix changed since last frame.
         */
-        bool isMatrixChanged(NodeID matrixID) const { return mMatricesChanged[matrixID.get()]; }
+        bool isMatrixChanged(NodeID matrixID) const { return mMatricesChanged[matrixID.get()] != 0; }
 
         /** Get the local matrices.
             These represent the current local transform for each scene graph node.
@@ -145,8 +148,12 @@ namespace Falcor
     private:
         friend class SceneBuilder;
 
+        void initNodeHierarchy();
+        void initActiveAnimations();
         void initLocalMatrices();
         void updateLocalMatrices(double time);
+        void markSubtreeChanged(uint32_t nodeID);
+        void updateWorldMatrix(uint32_t nodeID);
         void updateWorldMatrices(bool updateAll = false);
         void uploadWorldMatrices(bool uploadAll = false);
 
@@ -159,11 +166,29 @@ namespace Falcor
 
         // Animation
         std::vector<ref<Animation>> mAnimations;
-        std::vector<bool> mNodesEdited;
+        std::vector<ref<Animation>> mActiveAnimations; ///< Animations affecting referenced nodes.
+        std::vector<float4x4> mAnimationMatrices;   ///< Scratch list of evaluated matrices of the active animations.
+        std::vector<uint8_t> mNodesEdited;          ///< Flag per node, true if node was edited since last frame.
+        std::vector<uint32_t> mEditedNodes;         ///< Nodes edited since last frame.
         std::vector<float4x4> mLocalMatrices;
         std::vector<float4x4> mGlobalMatrices;
         std::vector<float4x4> mInvTransposeGlobalMatrices;
-        std::vector<bool> mMatricesChanged;         ///< Flag per matrix, true if matrix changed since last frame.
+        std::vector<uint8_t> mMatricesChanged;      ///< Flag per matrix, true if matrix changed since last frame.
+
+        // Change tracking
+        std::vector<uint32_t> mDirtyNodes;          ///< Nodes whose local matrix changed in this frame.
+        std::vector<uint32_t> mChangedNodes;        ///< Nodes whose global matrix changed in this frame, sorted by ID.
+        std::vector<uint32_t> mPrevChangedNodes;    ///< Nodes changed in the last incremental update, sorted by ID.
+        std::vector<uint32_t> mUploadNodes;         ///< Scratch list of nodes to upload.
+        std::vector<uint32_t> mTraversalStack;      ///< Scratch stack for subtree traversal.
+        std::vector<uint32_t> mLevelNodes;          ///< Scratch list of nodes to update, grouped by level.
+        std::vector<uint32_t> mLevelOffsets;        ///< Scratch offsets of each level in mLevelNodes.
+
+        // Scene graph hierarchy
+        std::vector<uint32_t> mChildOffsets;        ///< Offset of the children of each node in mChildren. Has one extra entry at the end.
+        std::vector<uint32_t> mChildren;            ///< Children of all nodes.
+        std::vector<uint32_t> mNodeLevels;          ///< Depth of each node in the scene graph.
+        uint32_t mLevelCount = 0;                   ///< Number of levels in the scene graph.
 
         bool mFirstUpdate = true;       ///< True if this is the first update.
         bool mEnabled = true;           ///< True if animations are enabled.
@@ -185,6 +210,8 @@ namespace Falcor
         std::vector<float4x4> mMeshBindMatrices; // Optimization TODO: These are only needed per mesh
         std::vector<float4x4> mSkinningMatrices;
         std::vector<float4x4> mInvTransposeSkinningMatrices;
+        std::vector<float4x4> mInvLocalToBindMatrices;
+        std::vector<uint32_t> mSkinningNodes;       ///< Nodes referenced by skinned vertices.
         uint32_t mSkinningDispatchSize = 0;
 
         ref<Buffer> mpMeshBindMatricesBuffer;
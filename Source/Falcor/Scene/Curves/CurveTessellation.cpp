@@ -32,48 +32,173 @@
 #include "Utils/Math/CubicSpline.h"
 #include "Utils/Math/Matrix.h"
 #include "Utils/Math/Quaternion.h"
+#include "Utils/Threading.h"
+#include <algorithm>
 #include <cmath>
 
 namespace Falcor
 {
-    struct StrandArrays {
-        std::vector<float3> controlPoints;
-        std::vector<float>  widths;
-        std::vector<float2> UVs;
-        uint32_t vertexCount { 0 };
-    };
-
-    struct CurveArrays {
-        const float3* controlPoints;
-        const float* widths;
-        const float2* UVs;
-
-        // Initializer
-        CurveArrays(const float3* paramControlPoints, const float* paramWidths, const float2* paramUVs)
-        {
-            controlPoints = paramControlPoints;
-            widths = paramWidths;
-            UVs = paramUVs;
-        }
-    };
-
-    struct CubicSplineCache
-    {
-        CubicSpline<float3> optSplinePoints;
-        CubicSpline<float>  optSplineWidths;
-        CubicSpline<float2> optSplineUVs;
-
-        CubicSpline<float3> splinePoints;
-        CubicSpline<float>  splineWidths;
-        CubicSpline<float2> splineUVs;
-    };
-
     namespace
     {
         // Curves tessellated to quad-tubes have the width somewhere between curveWidth and (curveWidth / sqrt(2)), depending on the viewing angle.
         // To achieve curveWidth on average, however, we need to scale the initial curveWidth by 1.11 (the number was deducted numerically).
         const float kMeshCompensationScale = 1.11f;
 
+        // Number of strands processed per task.
+        const size_t kStrandsPerTask = 256;
+
+        struct StrandArrays
+        {
+            std::vector<float3> controlPoints;
+            std::vector<float>  widths;
+            std::vector<float2> UVs;
+        };
+
+        struct CurveArrays
+        {
+            const float3* controlPoints;
+            const float* widths;
+            const float2* UVs;
+            const uint32_t* vertexCountsPerStrand;
+        };
+
+        struct CubicSplineCache
+        {
+            CubicSpline<float3> splinePoints;
+            CubicSpline<float>  splineWidths;
+            CubicSpline<float2> splineUVs;
+        };
+
+        // Per-task scratch memory, reused for all strands processed by a task.
+        struct StrandScratch
+        {
+            StrandArrays strandArrays;
+            StrandArrays optimizedStrandArrays;
+            CubicSplineCache splineCache;
+        };
+
+        // Layout of a kept strand, computed in the count pass.
+        struct StrandLayout
+        {
+            uint32_t strandIndex;  // Index of the strand in the input.
+            uint32_t pointOffset;  // Offset of the first control point in the input arrays.
+            uint32_t vertexCount;  // Number of control points after removing duplicates.
+            uint32_t outputOffset; // Offset of the first tessellated point in the output.
+            uint32_t segmentOffset; // Offset of the first segment in the output.
+            uint32_t outputCount;  // Number of tessellated points (zero for strands that collapse to a single point).
+        };
+
+        struct TessellationLayout
+        {
+            std::vector<StrandLayout> strands;
+            uint32_t pointCount = 0;
+            uint32_t segmentCount = 0;
+        };
+
+        // Count pass: compute the number of tessellated points of each kept strand and their offsets in the output.
+        TessellationLayout computeLayout(uint32_t strandCount, const CurveArrays& curveArrays, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand)
+        {
+            TessellationLayout layout;
+            layout.strands.resize(div_round_up(strandCount, keepOneEveryXStrands));
+
+            uint32_t pointOffset = 0;
+            for (uint32_t i = 0; i < strandCount; i++)
+            {
+                if (i % keepOneEveryXStrands == 0)
+                {
+                    auto& strand = layout.strands[i / keepOneEveryXStrands];
+                    strand.strandIndex = i;
+                    strand.pointOffset = pointOffset;
+                }
+                pointOffset += curveArrays.vertexCountsPerStrand[i];
+            }
+
+            // Duplicated consecutive control points are removed before tessellation.
+            Threading::parallelFor(0, layout.strands.size(), [&](size_t i)
+            {
+                auto& strand = layout.strands[i];
+                const float3* points = curveArrays.controlPoints + strand.pointOffset;
+                uint32_t vertexCount = curveArrays.vertexCountsPerStrand[strand.strandIndex];
+
+                strand.vertexCount = vertexCount > 0 ? 1 : 0;
+                for (uint32_t j = 0; j + 1 < vertexCount; j++)
+                {
+                    if (any(points[j] != points[j + 1])) strand.vertexCount++;
+                }
+                strand.outputCount = strand.vertexCount >= 2 ? div_round_up(subdivPerSegment * (strand.vertexCount - 1), keepOneEveryXVerticesPerStrand) + 1 : 0;
+            }, kStrandsPerTask);
+
+            for (auto& strand : layout.strands)
+            {
+                strand.outputOffset = layout.pointCount;
+                strand.segmentOffset = layout.segmentCount;
+                layout.pointCount += strand.outputCount;
+                if (strand.outputCount > 0) layout.segmentCount += strand.outputCount - 1;
+            }
+
+            return layout;
+        }
+
+        // Gather the control points, widths and texture coordinates of a strand with duplicated consecutive points removed.
+        void gatherStrand(const CurveArrays& curveArrays, const StrandLayout& strand, StrandArrays& strandArrays)
+        {
+            strandArrays.controlPoints.clear();
+            strandArrays.widths.clear();
+            strandArrays.UVs.clear();
+
+            uint32_t vertexCount = curveArrays.vertexCountsPerStrand[strand.strandIndex];
+            for (uint32_t j = 0; j < vertexCount; j++)
+            {
+                uint32_t index = strand.pointOffset + j;
+
+                // Always keep the last control point.
+                if (j == vertexCount - 1 || any(curveArrays.controlPoints[index] != curveArrays.controlPoints[index + 1]))
+                {
+                    strandArrays.controlPoints.push_back(curveArrays.controlPoints[index]);
+                    strandArrays.widths.push_back(curveArrays.widths[index]);
+                    if (curveArrays.UVs) strandArrays.UVs.push_back(curveArrays.UVs[index]);
+                }
+            }
+            FALCOR_ASSERT(strandArrays.controlPoints.size() == strand.vertexCount);
+        }
+
+        // Call func(index, segment, t) for the tessellated points of a strand.
+        // Each segment is subdivided into subdivPerSegment sub-segments, keeping one of every keepOneEveryXVerticesPerStrand points.
+        // The last point is always kept.
+        template<typename Func>
+        void forEachTessellatedPoint(const StrandLayout& strand, uint32_t subdivPerSegment, uint32_t keepOneEveryXVerticesPerStrand, Func func)
+        {
+            const uint32_t subdivCount = subdivPerSegment * (strand.vertexCount - 1);
+            uint32_t index = 0;
+            for (uint32_t i = 0; i < subdivCount; i += keepOneEveryXVerticesPerStrand)
+            {
+                uint32_t j = i / subdivPerSegment;
+                uint32_t k = i % subdivPerSegment;
+                func(index++, j, (float)k / (float)subdivPerSegment);
+            }
+            func(index, strand.vertexCount - 2, 1.f);
+            FALCOR_ASSERT(index + 1 == strand.outputCount);
+        }
+
+        // Fill pass: run func(strand, scratch) for all strands with output in parallel.
+        // The strand's control points are gathered into scratch.strandArrays before the call.
+        template<typename Func>
+        void forEachStrand(const TessellationLayout& layout, const CurveArrays& curveArrays, Func func)
+        {
+            Threading::parallelForRange(0, layout.strands.size(), [&](size_t begin, size_t end)
+            {
+                StrandScratch scratch;
+                for (size_t i = begin; i < end; i++)
+                {
+                    const auto& strand = layout.strands[i];
+                    if (strand.outputCount == 0) continue;
+
+                    gatherStrand(curveArrays, strand, scratch.strandArrays);
+                    func(strand, scratch);
+                }
+            }, kStrandsPerTask);
+        }
+
         float4 transformSphere(const float4x4& xform, const float4& sphere)
         {
             // Spheres are represented as (center.x, center.y, center.z, radius).
@@ -91,72 +216,29 @@ namespace Falcor
 #endif
         }
 
-        void optimizeStrandGeometry(CubicSplineCache& splineCache, const CurveArrays& curveArrays, StrandArrays& strandArrays, StrandArrays& optimizedStrandArrays, uint32_t pointOffset, uint32_t subdivPerSegment, uint32_t keepOneEveryXVerticesPerStrand, float widthScale)
+        void optimizeStrandGeometry(CubicSplineCache& splineCache, const StrandLayout& strand, const StrandArrays& strandArrays, StrandArrays& optimizedStrandArrays, uint32_t subdivPerSegment, uint32_t keepOneEveryXVerticesPerStrand, float widthScale)
         {
-            strandArrays.controlPoints.clear();
-            strandArrays.UVs.clear();
-            strandArrays.widths.clear();
+            const CubicSpline<float3>& splinePoints = splineCache.splinePoints.setup(strandArrays.controlPoints.data(), strand.vertexCount);
+            const CubicSpline<float>& splineWidths = splineCache.splineWidths.setup(strandArrays.widths.data(), strand.vertexCount);
 
-            // Optimize geometry by removing duplicates.
-            for (uint32_t j = 0; j < strandArrays.vertexCount - 1; j++)
+            optimizedStrandArrays.controlPoints.resize(strand.outputCount);
+            optimizedStrandArrays.widths.resize(strand.outputCount);
+            forEachTessellatedPoint(strand, subdivPerSegment, keepOneEveryXVerticesPerStrand, [&](uint32_t index, uint32_t j, float t)
             {
-                if (any(curveArrays.controlPoints[pointOffset + j] != curveArrays.controlPoints[pointOffset + j + 1]))
-                {
-                    strandArrays.controlPoints.push_back(curveArrays.controlPoints[pointOffset + j]);
-                    strandArrays.widths.push_back(curveArrays.widths[pointOffset + j]);
-                    if (curveArrays.UVs) strandArrays.UVs.push_back(curveArrays.UVs[pointOffset + j]);
-                }
-            }
-
-            // Add the last control point.
-            strandArrays.controlPoints.push_back(curveArrays.controlPoints[pointOffset + strandArrays.vertexCount - 1]);
-            strandArrays.widths.push_back(curveArrays.widths[pointOffset + strandArrays.vertexCount - 1]);
-            if (curveArrays.UVs) strandArrays.UVs.push_back(curveArrays.UVs[pointOffset + strandArrays.vertexCount - 1]);
-
-            optimizedStrandArrays.vertexCount = static_cast<uint32_t>(strandArrays.controlPoints.size());
-
-            const CubicSpline<float3>& splinePoints = splineCache.optSplinePoints.setup(strandArrays.controlPoints.data(), optimizedStrandArrays.vertexCount);
-            const CubicSpline<float>& splineWidths = splineCache.optSplineWidths.setup(strandArrays.widths.data(), optimizedStrandArrays.vertexCount);
-
-            uint32_t tmpCount = 0;
-            for (uint32_t j = 0; j < optimizedStrandArrays.vertexCount - 1; j++)
-            {
-                for (uint32_t k = 0; k < subdivPerSegment; k++)
-                {
-                    if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
-                    {
-                        float t = (float)k / (float)subdivPerSegment;
-                        optimizedStrandArrays.controlPoints.push_back(splinePoints.interpolate(j, t));
-                        optimizedStrandArrays.widths.push_back(kMeshCompensationScale * widthScale * splineWidths.interpolate(j, t));
-                    }
-                    tmpCount++;
-                }
-            }
-
-            // Always keep the last vertex.
-            optimizedStrandArrays.controlPoints.push_back(splinePoints.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f));
-            optimizedStrandArrays.widths.push_back(kMeshCompensationScale * widthScale * splineWidths.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f));
+                optimizedStrandArrays.controlPoints[index] = splinePoints.interpolate(j, t);
+                optimizedStrandArrays.widths[index] = kMeshCompensationScale * widthScale * splineWidths.interpolate(j, t);
+            });
 
             // Texture coordinates.
-            if (curveArrays.UVs)
+            optimizedStrandArrays.UVs.clear();
+            if (!strandArrays.UVs.empty())
             {
-                const CubicSpline<float2>& splineUVs = splineCache.optSplineUVs.setup(strandArrays.UVs.data(), optimizedStrandArrays.vertexCount);
-                tmpCount = 0;
-                for (uint32_t j = 0; j < optimizedStrandArrays.vertexCount - 1; j++)
+                const CubicSpline<float2>& splineUVs = splineCache.splineUVs.setup(strandArrays.UVs.data(), strand.vertexCount);
+                optimizedStrandArrays.UVs.resize(strand.outputCount);
+                forEachTessellatedPoint(strand, subdivPerSegment, keepOneEveryXVerticesPerStrand, [&](uint32_t index, uint32_t j, float t)
                 {
-                    for (uint32_t k = 0; k < subdivPerSegment; k++)
-                    {
-                        if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
-                        {
-                            float t = (float)k / (float)subdivPerSegment;
-                            optimizedStrandArrays.UVs.push_back(splineUVs.interpolate(j, t));
-                        }
-                        tmpCount++;
-                    }
-                }
-
-                // Always keep the last vertex.
-                optimizedStrandArrays.UVs.push_back(splineUVs.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f));
+                    optimizedStrandArrays.UVs[index] = splineUVs.interpolate(j, t);
+                });
             }
         }
 
@@ -172,14 +254,14 @@ namespace Falcor
             else if (j == 1)
             {
                 prevFwd = normalize(strandArrays.controlPoints[j] - strandArrays.controlPoints[j - 1]);
-                fwd = normalize(strandArrays.controlPoints[j + 1] - strandArrays.controlPoints[j - 1]);
+                fwd = normalize(strandArrays.controlPoints[std::min<size_t>(j + 1, strandArrays.controlPoints.size() - 1)] - strandArrays.controlPoints[j - 1]);
             }
-            else if (j < strandArrays.controlPoints.size() - 2)
+            else if (j < strandArrays.controlPoints.size() - 1)
             {
                 prevFwd = normalize(strandArrays.controlPoints[j] - strandArrays.controlPoints[j - 2]);
                 fwd = normalize(strandArrays.controlPoints[j + 1] - strandArrays.controlPoints[j - 1]);
             }
-            else if (j == strandArrays.controlPoints.size() - 1)
+            else
             {
                 prevFwd = normalize(strandArrays.controlPoints[j] - strandArrays.controlPoints[j - 2]);
                 fwd = normalize(strandArrays.controlPoints[j] - strandArrays.controlPoints[j - 1]);
@@ -191,40 +273,41 @@ namespace Falcor
             t = mul(rotQuat, t);
         }
 
-        void updateMeshResultBuffers(CurveTessellation::MeshResult& result, const CurveArrays& curveArrays, StrandArrays& optimizedStrandArrays, const float3& fwd, const float3& s, const float3& t, uint32_t pointCountPerCrossSection, const float& widthScale, uint32_t j)
+        void updateMeshResultBuffers(CurveTessellation::MeshResult& result, uint32_t meshVertexOffset, const StrandArrays& optimizedStrandArrays, const float3& fwd, const float3& s, const float3& t, const std::vector<float2>& crossSection, uint32_t j)
         {
+            const uint32_t pointCountPerCrossSection = (uint32_t)crossSection.size();
+
             // Mesh vertices, normals, tangents, and texCrds (if any).
             for (uint32_t k = 0; k < pointCountPerCrossSection; k++)
             {
-                float phi = (float)k / (float)pointCountPerCrossSection * (float)M_PI * 2.f;
-                float3 vNormal = std::cos(phi) * s + std::sin(phi) * t;
+                float3 vNormal = crossSection[k].x * s + crossSection[k].y * t;
 
+                uint32_t index = meshVertexOffset + j * pointCountPerCrossSection + k;
                 float curveRadius = 0.5f * optimizedStrandArrays.widths[j];
-                result.vertices.push_back(optimizedStrandArrays.controlPoints[j] + curveRadius * vNormal);
-                result.normals.push_back(vNormal);
-                result.tangents.push_back(float4(fwd.x, fwd.y, fwd.z, 1));
-                result.radii.push_back(curveRadius);
+                result.vertices[index] = optimizedStrandArrays.controlPoints[j] + curveRadius * vNormal;
+                result.normals[index] = vNormal;
+                result.tangents[index] = float4(fwd.x, fwd.y, fwd.z, 1);
+                result.radii[index] = curveRadius;
 
-                if (curveArrays.UVs)
+                if (!optimizedStrandArrays.UVs.empty())
                 {
-                    result.texCrds.push_back(optimizedStrandArrays.UVs[j]);
+                    result.texCrds[index] = optimizedStrandArrays.UVs[j];
                 }
             }
         }
 
-        void connectFaceVertices(CurveTessellation::MeshResult& result, uint32_t meshVertexOffset, uint32_t pointCountPerCrossSection, uint32_t quadCountLimit, uint32_t nextCrossSectionVertexOffset, uint32_t multiplier, uint32_t j)
+        void connectFaceVertices(CurveTessellation::MeshResult& result, uint32_t faceOffset, uint32_t meshVertexOffset, uint32_t pointCountPerCrossSection, uint32_t quadCountLimit, uint32_t nextCrossSectionVertexOffset, uint32_t multiplier, uint32_t j)
         {
+            uint32_t* pIndices = result.faceVertexIndices.data() + 3 * (faceOffset + 2 * j * quadCountLimit);
             for (uint32_t k = 0; k < quadCountLimit; k++)
             {
-                result.faceVertexCounts.push_back(3);
-                result.faceVertexIndices.push_back(meshVertexOffset + multiplier * j * pointCountPerCrossSection + k);
-                result.faceVertexIndices.push_back(meshVertexOffset + multiplier * j * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection);
-                result.faceVertexIndices.push_back(meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection);
-
-                result.faceVertexCounts.push_back(3);
-                result.faceVertexIndices.push_back(meshVertexOffset + multiplier * j * pointCountPerCrossSection + k);
-                result.faceVertexIndices.push_back(meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection);
-                result.faceVertexIndices.push_back(meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + k);
+                *pIndices++ = meshVertexOffset + multiplier * j * pointCountPerCrossSection + k;
+                *pIndices++ = meshVertexOffset + multiplier * j * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection;
+                *pIndices++ = meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection;
+
+                *pIndices++ = meshVertexOffset + multiplier * j * pointCountPerCrossSection + k;
+                *pIndices++ = meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + (k + nextCrossSectionVertexOffset) % pointCountPerCrossSection;
+                *pIndices++ = meshVertexOffset + (multiplier * j + 1) * pointCountPerCrossSection + k;
             }
         }
     }
@@ -238,93 +321,42 @@ namespace Falcor
         FALCOR_ASSERT(degree == 1);
         result.degree = degree;
 
-        uint32_t pointCounts = 0;
-        uint32_t segCounts = 0;
-        uint32_t maxVertexCountsPerStrand = 0;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
-        {
-            uint32_t tmpPointCount = div_round_up(subdivPerSegment * (vertexCountsPerStrand[i] - 1), keepOneEveryXVerticesPerStrand) + 1;
-            pointCounts += tmpPointCount;
-            segCounts += tmpPointCount - 1;
-            maxVertexCountsPerStrand = std::max(maxVertexCountsPerStrand, vertexCountsPerStrand[i]);
-        }
-        result.indices.reserve(segCounts);
-        result.points.reserve(pointCounts);
-        result.radius.reserve(pointCounts);
-        result.texCrds.reserve(pointCounts);
-
-        uint32_t pointOffset = 0;
-
-        StrandArrays strandArrays;
-        strandArrays.controlPoints.reserve(maxVertexCountsPerStrand);
-        strandArrays.widths.reserve(maxVertexCountsPerStrand);
-        strandArrays.UVs.reserve(maxVertexCountsPerStrand);
-        CurveArrays curveArrays(controlPoints, widths, UVs);
-
-        StrandArrays optimizedStrandArrays;
-        CubicSplineCache splineCache;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
-        {
-            optimizedStrandArrays.controlPoints.clear();
-            optimizedStrandArrays.UVs.clear();
-            optimizedStrandArrays.widths.clear();
-            optimizedStrandArrays.vertexCount = 0;
-            strandArrays.vertexCount = vertexCountsPerStrand[i];
+        // Count the output of all strands, then tessellate the strands in parallel directly into the output arrays.
+        CurveArrays curveArrays{controlPoints, widths, UVs, vertexCountsPerStrand};
+        TessellationLayout layout = computeLayout(strandCount, curveArrays, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand);
 
-            optimizeStrandGeometry(splineCache, curveArrays, strandArrays, optimizedStrandArrays, pointOffset, subdivPerSegment, keepOneEveryXVerticesPerStrand, widthScale);
+        result.indices.resize(layout.segmentCount);
+        result.points.resize(layout.pointCount);
+        result.radius.resize(layout.pointCount);
+        if (UVs) result.texCrds.resize(layout.pointCount);
 
-            const CubicSpline<float3>& splinePoints = splineCache.splinePoints.setup(strandArrays.controlPoints.data(), optimizedStrandArrays.vertexCount);
-            const CubicSpline<float>& splineWidths = splineCache.splineWidths.setup(strandArrays.widths.data(), optimizedStrandArrays.vertexCount);
+        forEachStrand(layout, curveArrays, [&](const StrandLayout& strand, StrandScratch& scratch)
+        {
+            const StrandArrays& strandArrays = scratch.strandArrays;
+            CubicSplineCache& splineCache = scratch.splineCache;
+            const CubicSpline<float3>& splinePoints = splineCache.splinePoints.setup(strandArrays.controlPoints.data(), strand.vertexCount);
+            const CubicSpline<float>& splineWidths = splineCache.splineWidths.setup(strandArrays.widths.data(), strand.vertexCount);
 
-            uint32_t tmpCount = 0;
-            for (uint32_t j = 0; j < optimizedStrandArrays.vertexCount - 1; j++)
+            forEachTessellatedPoint(strand, subdivPerSegment, keepOneEveryXVerticesPerStrand, [&](uint32_t index, uint32_t j, float t)
             {
-                for (uint32_t k = 0; k < subdivPerSegment; k++)
-                {
-                    if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
-                    {
-                        float t = (float)k / (float)subdivPerSegment;
-                        result.indices.push_back((uint32_t)result.points.size());
-
-                        // Pre-transform curve points.
-                        float4 sph = transformSphere(xform, float4(splinePoints.interpolate(j, t), splineWidths.interpolate(j, t) * 0.5f * widthScale));
-
-                        result.points.push_back(sph.xyz());
-                        result.radius.push_back(sph.w);
-                    }
-                    tmpCount++;
-                }
-            }
+                if (index + 1 < strand.outputCount) result.indices[strand.segmentOffset + index] = strand.outputOffset + index;
 
-            // Always keep the last vertex.
-            float4 sph = transformSphere(xform, float4(splinePoints.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f), splineWidths.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f) * 0.5f * widthScale));
-            result.points.push_back(sph.xyz());
-            result.radius.push_back(sph.w);
+                // Pre-transform curve points.
+                float4 sph = transformSphere(xform, float4(splinePoints.interpolate(j, t), splineWidths.interpolate(j, t) * 0.5f * widthScale));
+                result.points[strand.outputOffset + index] = sph.xyz();
+                result.radius[strand.outputOffset + index] = sph.w;
+            });
 
             // Texture coordinates.
             if (UVs)
             {
-                const CubicSpline<float2>& splineUVs = splineCache.splineUVs.setup(strandArrays.UVs.data(), optimizedStrandArrays.vertexCount);
-                tmpCount = 0;
-                for (uint32_t j = 0; j < optimizedStrandArrays.vertexCount - 1; j++)
+                const CubicSpline<float2>& splineUVs = splineCache.splineUVs.setup(strandArrays.UVs.data(), strand.vertexCount);
+                forEachTessellatedPoint(strand, subdivPerSegment, keepOneEveryXVerticesPerStrand, [&](uint32_t index, uint32_t j, float t)
                 {
-                    for (uint32_t k = 0; k < subdivPerSegment; k++)
-                    {
-                        if (tmpCount % keepOneEveryXVerticesPerStrand == 0)
-                        {
-                            float t = (float)k / (float)subdivPerSegment;
-                            result.texCrds.push_back(splineUVs.interpolate(j, t));
-                        }
-                        tmpCount++;
-                    }
-                }
-
-                // Always keep the last vertex.
-                result.texCrds.push_back(splineUVs.interpolate(optimizedStrandArrays.vertexCount - 2, 1.f));
+                    result.texCrds[strand.outputOffset + index] = splineUVs.interpolate(j, t);
+                });
             }
-
-            for (uint32_t j = i; j < std::min(strandCount, i + keepOneEveryXStrands); j++) pointOffset += vertexCountsPerStrand[j];
-        }
+        });
 
         return result;
     }
@@ -332,47 +364,36 @@ namespace Falcor
     CurveTessellation::MeshResult CurveTessellation::convertToPolytube(uint32_t strandCount, const uint32_t* vertexCountsPerStrand, const float3* controlPoints, const float* widths, const float2* UVs, uint32_t subdivPerSegment, uint32_t keepOneEveryXStrands, uint32_t keepOneEveryXVerticesPerStrand, float widthScale, uint32_t pointCountPerCrossSection)
     {
         MeshResult result;
-        uint32_t vertexCounts = 0;
-        uint32_t faceCounts = 0;
-        uint32_t maxVertexCountsPerStrand = 0;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
+
+        // Count the output of all strands, then tessellate the strands in parallel directly into the output arrays.
+        CurveArrays curveArrays{controlPoints, widths, UVs, vertexCountsPerStrand};
+        TessellationLayout layout = computeLayout(strandCount, curveArrays, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand);
+
+        const uint32_t vertexCounts = pointCountPerCrossSection * layout.pointCount;
+        const uint32_t faceCounts = 2 * pointCountPerCrossSection * layout.segmentCount;
+        result.vertices.resize(vertexCounts);
+        result.normals.resize(vertexCounts);
+        result.tangents.resize(vertexCounts);
+        if (UVs) result.texCrds.resize(vertexCounts);
+        result.radii.resize(vertexCounts);
+        result.faceVertexCounts.assign(faceCounts, 3);
+        result.faceVertexIndices.resize(faceCounts * 3);
+
+        // Cosine and sine of the angles of the points in a cross-section.
+        std::vector<float2> crossSection(pointCountPerCrossSection);
+        for (uint32_t k = 0; k < pointCountPerCrossSection; k++)
         {
-            uint32_t tmpPointCount = div_round_up(subdivPerSegment * (vertexCountsPerStrand[i] - 1), keepOneEveryXVerticesPerStrand) + 1;
-            vertexCounts += pointCountPerCrossSection * tmpPointCount;
-            faceCounts += 2 * pointCountPerCrossSection * (tmpPointCount - 1);
-            maxVertexCountsPerStrand = std::max(maxVertexCountsPerStrand, vertexCountsPerStrand[i]);
+            float phi = (float)k / (float)pointCountPerCrossSection * (float)M_PI * 2.f;
+            crossSection[k] = float2(std::cos(phi), std::sin(phi));
         }
-        result.vertices.reserve(vertexCounts);
-        result.normals.reserve(vertexCounts);
-        result.tangents.reserve(vertexCounts);
-        result.texCrds.reserve(vertexCounts);
-        result.radii.reserve(vertexCounts);
-        result.faceVertexCounts.reserve(faceCounts);
-        result.faceVertexIndices.reserve(faceCounts * 3);
-
-        uint32_t pointOffset = 0;
-        uint32_t meshVertexOffset = 0;
-
-        StrandArrays strandArrays;
-        strandArrays.controlPoints.reserve(maxVertexCountsPerStrand);
-        strandArrays.widths.reserve(maxVertexCountsPerStrand);
-        strandArrays.UVs.reserve(maxVertexCountsPerStrand);
-        CurveArrays curveArrays(controlPoints, widths, UVs);
-
-        StrandArrays optimizedStrandArrays;
-        CubicSplineCache splineCache;
-        for (uint32_t i = 0; i < strandCount; i += keepOneEveryXStrands)
-        {
-            optimizedStrandArrays.controlPoints.clear();
-            optimizedStrandArrays.UVs.clear();
-            optimizedStrandArrays.widths.clear();
-            optimizedStrandArrays.vertexCount = 0;
-
-            strandArrays.vertexCount = vertexCountsPerStrand[i];
 
-            optimizeStrandGeometry(splineCache, curveArrays, strandArrays, optimizedStrandArrays, pointOffset, subdivPerSegment, keepOneEveryXVerticesPerStrand, widthScale);
+        forEachStrand(layout, curveArrays, [&](const StrandLayout& strand, StrandScratch& scratch)
+        {
+            StrandArrays& optimizedStrandArrays = scratch.optimizedStrandArrays;
+            optimizeStrandGeometry(scratch.splineCache, strand, scratch.strandArrays, optimizedStrandArrays, subdivPerSegment, keepOneEveryXVerticesPerStrand, widthScale);
 
-            for (uint32_t j = i; j < std::min(strandCount, i + keepOneEveryXStrands); j++) pointOffset += vertexCountsPerStrand[j];
+            const uint32_t meshVertexOffset = pointCountPerCrossSection * strand.outputOffset;
+            const uint32_t faceOffset = 2 * pointCountPerCrossSection * strand.segmentOffset;
 
             // Build the initial frame.
             float3 fwd, s, t;
@@ -386,20 +407,17 @@ namespace Falcor
                 updateCurveFrame(optimizedStrandArrays, fwd, s, t, j);
 
                 // Mesh vertices, normals, tangents, and texCrds (if any).
-                updateMeshResultBuffers(result, curveArrays, optimizedStrandArrays, fwd, s, t, pointCountPerCrossSection, widthScale, j);
+                updateMeshResultBuffers(result, meshVertexOffset, optimizedStrandArrays, fwd, s, t, crossSection, j);
 
                 // Mesh faces.
                 if (j < optimizedStrandArrays.controlPoints.size() - 1)
                 {
                     uint32_t quadCountLimit = pointCountPerCrossSection;
-                    connectFaceVertices(result, meshVertexOffset, pointCountPerCrossSection, quadCountLimit, 1, 1, j);
+                    connectFaceVertices(result, faceOffset, meshVertexOffset, pointCountPerCrossSection, quadCountLimit, 1, 1, j);
                 }
             }
+        });
 
-            meshVertexOffset += pointCountPerCrossSection * (uint32_t)optimizedStrandArrays.controlPoints.size();
-        }
         return result;
     }
-
-
 }
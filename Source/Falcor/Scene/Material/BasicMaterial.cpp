@@ -47,6 +47,13 @@ namespace Falcor
 
         // Constants.
         const float kMaxVolumeAnisotropy = 0.99f;
+
+        // Hash a float value consistently with operator==, i.e. -0 and +0 hash to the same value.
+        void hashFloat(FNVHash64& hash, float value)
+        {
+            if (value == 0.f) value = 0.f;
+            hash.insert(&value, sizeof(value));
+        }
     }
 
     BasicMaterial::BasicMaterial(ref<Device> pDevice, const std::string& name, MaterialType type)
@@ -578,6 +585,21 @@ namespace Falcor
         return (*this) == (*other);
     }
 
+    uint64_t BasicMaterial::getHash() const
+    {
+        FNVHash64 hash;
+        hashBase(hash);
+
+        // Hash the most commonly varying parameters. The remaining fields are left to isEqual().
+        hash.insert(&mData.flags, sizeof(mData.flags));
+        hashFloat(hash, mData.emissiveFactor);
+        hash.insert(&mData.baseColor, sizeof(mData.baseColor)); // float16_t compares bitwise.
+        hash.insert(&mData.specular, sizeof(mData.specular));
+        for (int i = 0; i < 3; i++) hashFloat(hash, mData.emissive[i]);
+
+        return hash.get();
+    }
+
     bool BasicMaterial::operator==(const BasicMaterial& other) const
     {
         if (!isBaseEqual(other)) return false;
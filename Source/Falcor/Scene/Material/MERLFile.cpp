@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "MERLFile.h"
+#include "MeasuredBSDFCache.h"
 #include "Utils/Logger.h"
 #include "Utils/Image/ImageIO.h"
 #include "Scene/Material/MERLMaterial.h"
@@ -47,7 +48,15 @@ namespace Falcor
         const double kGreenScale = 1.15 / 1500.0;
         const double kBlueScale = 1.66 / 1500.0;
 
+        const size_t kSampleCount = kBRDFSamplingResThetaH * kBRDFSamplingResThetaD * kBRDFSamplingResPhiD / 2;
+
         const uint32_t kAlbedoLUTSize = MERLMaterialData::kAlbedoLUTSize;
+
+        // Measured BSDF cache entry types and array names. Bump the versions when the conversion changes.
+        const char kCacheType[] = "MERL/1";
+        const char kAlbedoCacheType[] = "MERLAlbedo/1";
+        const char kCacheBRDFArray[] = "brdf";
+        const char kCacheAlbedoLUTArray[] = "albedoLUT";
     }
 
     MERLFile::MERLFile(const std::filesystem::path& path)
@@ -62,6 +71,42 @@ namespace Falcor
         mData.clear();
         mAlbedoLUT.clear();
 
+        mDesc.path = path;
+        mDesc.name = path.stem().string();
+
+        // Load the converted BRDF data from the cache, or from the source file on a cache miss.
+        MeasuredBSDFCache cache;
+        const std::string cacheKey = MeasuredBSDFCache::computeKey(path, kCacheType);
+        if (auto pEntry = cache.load(cacheKey))
+        {
+            size_t count = 0;
+            const float3* pData = pEntry->getArray<float3>(kCacheBRDFArray, count);
+            if (pData && count == kSampleCount)
+                mData.assign(pData, pData + count);
+        }
+
+        if (mData.empty())
+        {
+            if (!loadBinaryFile(path))
+            {
+                mDesc = {};
+                return false;
+            }
+            if (!cacheKey.empty())
+                cache.store(cacheKey, {{kCacheBRDFArray, mData.data(), sizeof(float3), mData.size()}});
+        }
+
+        // Load JSON sidecar file if it exists.
+        const auto jsonPath = std::filesystem::path(path).replace_extension("json");
+        if (!DiffuseSpecularUtils::loadJSONData(jsonPath, mDesc.extraData))
+            logWarning("MERLFile: Failed to load associated JSON data for BRDF '{}'.", mDesc.name);
+
+        logInfo("Loaded MERL BRDF '{}'.", mDesc.name);
+        return true;
+    }
+
+    bool MERLFile::loadBinaryFile(const std::filesystem::path& path)
+    {
         std::ifstream ifs(path, std::ios_base::in | std::ios_base::binary);
         if (!ifs.good())
         {
@@ -74,7 +119,7 @@ namespace Falcor
         ifs.read(reinterpret_cast<char*>(dims), sizeof(int) * 3);
 
         size_t n = (size_t)dims[0] * dims[1] * dims[2];
-        if (n != kBRDFSamplingResThetaH * kBRDFSamplingResThetaD * kBRDFSamplingResPhiD / 2)
+        if (n != kSampleCount)
         {
             logWarning("MERLFile: Dimensions don't match in file '{}'.", path);
             return false;
@@ -89,17 +134,7 @@ namespace Falcor
             return false;
         }
 
-        mDesc.path = path;
-        mDesc.name = path.stem().string();
-
         prepareData(dims, data);
-
-        // Load JSON sidecar file if it exists.
-        const auto jsonPath = std::filesystem::path(path).replace_extension("json");
-        if (!DiffuseSpecularUtils::loadJSONData(jsonPath, mDesc.extraData))
-            logWarning("MERLFile: Failed to load associated JSON data for BRDF '{}'.", mDesc.name);
-
-        logInfo("Loaded MERL BRDF '{}'.", mDesc.name);
         return true;
     }
 
@@ -148,9 +183,23 @@ namespace Falcor
             return mAlbedoLUT;
 
         checkInvariant(!mDesc.path.empty(), "No BRDF loaded");
-        const auto texPath = mDesc.path.replace_extension("dds");
 
-        // Try loading cached albedo lookup table.
+        // Try loading the albedo lookup table from the cache.
+        MeasuredBSDFCache cache;
+        const std::string cacheKey = MeasuredBSDFCache::computeKey(mDesc.path, kAlbedoCacheType);
+        if (auto pEntry = cache.load(cacheKey))
+        {
+            size_t count = 0;
+            const float4* pData = pEntry->getArray<float4>(kCacheAlbedoLUTArray, count);
+            if (pData && count == kAlbedoLUTSize)
+            {
+                mAlbedoLUT.assign(pData, pData + count);
+                return mAlbedoLUT;
+            }
+        }
+
+        // Try loading a precomputed albedo lookup table stored next to the BRDF.
+        const auto texPath = std::filesystem::path(mDesc.path).replace_extension("dds");
         if (std::filesystem::is_regular_file(texPath))
         {
             const auto albedoLut = ImageIO::loadBitmapFromDDS(texPath);
@@ -163,23 +212,20 @@ namespace Falcor
                 std::copy(data, data + kAlbedoLUTSize, mAlbedoLUT.begin());
 
                 logInfo("Loaded albedo LUT from '{}'.", texPath.string());
-                return mAlbedoLUT;
             }
         }
 
         // Failed to load a valid lookup table. We'll recompute it.
-        computeAlbedoLUT(pDevice, kAlbedoLUTSize);
-        FALCOR_ASSERT(mAlbedoLUT.size() == kAlbedoLUTSize);
-
-        // Cache lookup table as texture on disk.
+        if (mAlbedoLUT.empty())
         {
-            const uint8_t* data = reinterpret_cast<const uint8_t*>(mAlbedoLUT.data());
-            const auto albedoLut = Bitmap::create(mAlbedoLUT.size(), 1, kAlbedoLUTFormat, data);
-
-            ImageIO::saveToDDS(texPath, *albedoLut, ImageIO::CompressionMode::None, false);
-            logInfo("Saved albedo LUT to '{}'.", texPath);
+            computeAlbedoLUT(pDevice, kAlbedoLUTSize);
+            FALCOR_ASSERT(mAlbedoLUT.size() == kAlbedoLUTSize);
         }
 
+        // Cache lookup table on disk.
+        if (!cacheKey.empty())
+            cache.store(cacheKey, {{kCacheAlbedoLUTArray, mAlbedoLUT.data(), sizeof(float4), mAlbedoLUT.size()}});
+
         return mAlbedoLUT;
     }
 
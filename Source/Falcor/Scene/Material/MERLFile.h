@@ -60,13 +60,16 @@ namespace Falcor
         MERLFile(const std::filesystem::path& path);
 
         /** Loads a MERL BRDF.
+            The converted BRDF data is stored in the measured BSDF cache (see MeasuredBSDFCache) and loaded
+            from there on subsequent loads of the same file.
             \param[in] path Path to the binary MERL file.
             \return True if the BRDF was successfully loaded.
         */
         bool loadBRDF(const std::filesystem::path& path);
 
         /** Prepare an albedo lookup table.
-            The table is loaded from disk or recomputed if needed.
+            The table is loaded from the measured BSDF cache, or from a DDS file next to the BRDF file,
+            or recomputed if needed. Loaded or recomputed tables are stored in the cache.
             \param[in] pDevice The device.
             \return Albedo lookup table that can be used with `kAlbedoLUTFormat`.
         */
@@ -76,6 +79,7 @@ namespace Falcor
         const std::vector<float3>& getData() const { return mData; }
 
     private:
+        bool loadBinaryFile(const std::filesystem::path& path);
         void prepareData(const int dims[3], const std::vector<double>& data);
         void computeAlbedoLUT(ref<Device> pDevice, const size_t binCount);
 
@@ -145,6 +145,15 @@ namespace Falcor
         return true;
     }
 
+    uint64_t MERLMaterial::getHash() const
+    {
+        FNVHash64 hash;
+        hashBase(hash);
+        size_t pathHash = std::filesystem::hash_value(mPath); // Consistent with path comparison.
+        hash.insert(&pathHash, sizeof(pathHash));
+        return hash.get();
+    }
+
     Program::ShaderModuleList MERLMaterial::getShaderModules() const
     {
         return { Program::ShaderModule(kShaderFile) };
@@ -105,6 +105,22 @@ namespace Falcor
         return changed;
     }
 
+    void Material::setName(const std::string& name)
+    {
+        if (mName != name)
+        {
+            mName = name;
+            if (mNameChangedCallback) mNameChangedCallback();
+        }
+    }
+
+    uint64_t Material::getHash() const
+    {
+        FNVHash64 hash;
+        hashBase(hash);
+        return hash.get();
+    }
+
     void Material::setDoubleSided(bool doubleSided)
     {
         if (mHeader.isDoubleSided() != doubleSided)
@@ -318,6 +334,28 @@ namespace Falcor
         return true;
     }
 
+    void Material::hashBase(FNVHash64& hash) const
+    {
+        // This function hashes the data in the base class that is compared by isBaseEqual() *except* the name.
+        // The texture transform is left out as it is rarely used, and hashing floats consistently with operator== needs care.
+
+        hash.insert(&mHeader.packedData, sizeof(mHeader.packedData));
+
+        for (size_t i = 0; i < mTextureSlotInfo.size(); i++)
+        {
+            auto slot = (TextureSlot)i;
+            if (!hasTextureSlot(slot)) continue;
+
+            const auto& info = mTextureSlotInfo[i];
+            uint32_t slotInfo[2] = { (uint32_t)i, ((uint32_t)info.mask << 1) | (info.srgb ? 1u : 0u) };
+            hash.insert(slotInfo, sizeof(slotInfo));
+            hash.insert(info.name.data(), info.name.size());
+
+            const Texture* pTexture = mTextureSlotData[i].pTexture.get();
+            hash.insert(&pTexture, sizeof(pTexture));
+        }
+    }
+
     NormalMapType Material::detectNormalMapType(const ref<Texture>& pNormalMap)
     {
         NormalMapType type = NormalMapType::None;
@@ -36,6 +36,7 @@
 #include "Core/API/Texture.h"
 #include "Core/API/Sampler.h"
 #include "Utils/Image/TextureAnalyzer.h"
+#include "Utils/Math/FNVHash.h"
 #include "Utils/UI/Gui.h"
 #include "Scene/Transform.h"
 #include "MaterialTypeRegistry.h"
@@ -127,7 +128,7 @@ namespace Falcor
 
         /** Set the material name.
         */
-        virtual void setName(const std::string& name) { mName = name; }
+        virtual void setName(const std::string& name);
 
         /** Get the material name.
         */
@@ -155,6 +156,13 @@ namespace Falcor
         */
         virtual bool isEqual(const ref<Material>& pOther) const = 0;
 
+        /** Compute a hash of the material properties.
+            Materials that are equal according to isEqual() are guaranteed to have the same hash.
+            The name is not included. This is used to quickly find duplicate candidates.
+            \return Hash value.
+        */
+        virtual uint64_t getHash() const;
+
         /** Set the double-sided flag. This flag doesn't affect the cull state, just the shading.
         */
         virtual void setDoubleSided(bool doubleSided);
@@ -333,11 +341,14 @@ namespace Falcor
         using UpdateCallback = std::function<void(Material::UpdateFlags)>;
         void registerUpdateCallback(const UpdateCallback& updateCallback) { mUpdateCallback = updateCallback; }
         void markUpdates(UpdateFlags updates);
+        using NameChangedCallback = std::function<void()>;
+        void registerNameChangedCallback(const NameChangedCallback& nameChangedCallback) { mNameChangedCallback = nameChangedCallback; }
         bool hasTextureSlotData(const TextureSlot slot) const;
         void updateTextureHandle(MaterialSystem* pOwner, const ref<Texture>& pTexture, TextureHandle& handle);
         void updateTextureHandle(MaterialSystem* pOwner, const TextureSlot slot, TextureHandle& handle);
         void updateDefaultTextureSamplerID(MaterialSystem* pOwner, const ref<Sampler>& pSampler);
         bool isBaseEqual(const Material& other) const;
+        void hashBase(FNVHash64& hash) const;
 
         static NormalMapType detectNormalMapType(const ref<Texture>& pNormalMap);
 
@@ -363,6 +374,7 @@ namespace Falcor
 
         mutable UpdateFlags mUpdates = UpdateFlags::None;
         UpdateCallback mUpdateCallback;             ///< Callback to track updates with the material system this material is used with.
+        NameChangedCallback mNameChangedCallback;   ///< Callback to notify the material system this material is used with about name changes.
 
         friend class MaterialSystem;
         friend class SceneCache;
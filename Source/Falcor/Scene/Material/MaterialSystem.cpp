@@ -212,9 +212,9 @@ namespace Falcor
         checkArgument(pMaterial != nullptr, "'pMaterial' is missing");
 
         // Reuse previously added materials.
-        if (auto it = std::find(mMaterials.begin(), mMaterials.end(), pMaterial); it != mMaterials.end())
+        if (auto it = mMaterialIDs.find(pMaterial.get()); it != mMaterialIDs.end())
         {
-            return MaterialID{(size_t)std::distance(mMaterials.begin(), it) };
+            return it->second;
         }
 
         // Add material.
@@ -230,7 +230,10 @@ namespace Falcor
         }
 
         pMaterial->registerUpdateCallback([this](auto flags) { mMaterialUpdates |= flags; });
+        pMaterial->registerNameChangedCallback([this]() { mMaterialNameIndexDirty = true; });
         mMaterials.push_back(pMaterial);
+        mMaterialIDs.emplace(pMaterial.get(), materialID);
+        if (!mMaterialNameIndexDirty) mMaterialNameIndex.emplace(pMaterial->getName(), materialID);
         mMaterialsChanged = true;
 
         return materialID;
@@ -242,9 +245,18 @@ namespace Falcor
         checkArgument(pReplacement != nullptr, "'pReplacement' is missing");
 
         // Find material to replace.
-        if (auto it = std::find(mMaterials.begin(), mMaterials.end(), pMaterial); it != mMaterials.end())
+        if (auto it = mMaterialIDs.find(pMaterial.get()); it != mMaterialIDs.end())
         {
-            *it = pReplacement;
+            const MaterialID materialID = it->second;
+            mMaterials[materialID.get()] = pReplacement;
+
+            // Update the lookup tables. If the replacement was already added, the lowest ID is kept.
+            mMaterialIDs.erase(it);
+            if (auto [replacementIt, inserted] = mMaterialIDs.emplace(pReplacement.get(), materialID); !inserted)
+            {
+                replacementIt->second = std::min(replacementIt->second, materialID);
+            }
+            mMaterialNameIndexDirty = true;
 
             if (pReplacement->getDefaultTextureSampler() == nullptr)
             {
@@ -252,6 +264,7 @@ namespace Falcor
             }
 
             pReplacement->registerUpdateCallback([this](auto flags) { mMaterialUpdates |= flags; });
+            pReplacement->registerNameChangedCallback([this]() { mMaterialNameIndexDirty = true; });
             mMaterialsChanged = true;
         }
         else
@@ -293,11 +306,9 @@ namespace Falcor
 
     ref<Material> MaterialSystem::getMaterialByName(const std::string& name) const
     {
-        for (const auto& pMaterial : mMaterials)
-        {
-            if (pMaterial->getName() == name) return pMaterial;
-        }
-        return nullptr;
+        updateMaterialNameIndex();
+        auto it = mMaterialNameIndex.find(name);
+        return it != mMaterialNameIndex.end() ? mMaterials[it->second.get()] : nullptr;
     }
 
     size_t MaterialSystem::removeDuplicateMaterials(std::vector<MaterialID>& idMap)
@@ -305,33 +316,55 @@ namespace Falcor
         std::vector<ref<Material>> uniqueMaterials;
         idMap.resize(mMaterials.size());
 
+        // Unique materials bucketed by hash. Equal materials are guaranteed to have the same hash,
+        // so only the materials in the same bucket need to be compared. The buckets hold unique material
+        // IDs in increasing order, so the first match is the same as with a linear search.
+        std::unordered_map<uint64_t, std::vector<MaterialID>> buckets;
+        buckets.reserve(mMaterials.size());
+
         // Find unique set of materials.
         for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id)
         {
             const auto& pMaterial = mMaterials[id.get()];
-            auto it = std::find_if(uniqueMaterials.begin(), uniqueMaterials.end(), [&pMaterial](const auto& m) { return m->isEqual(pMaterial); });
-            if (it == uniqueMaterials.end())
+            auto& bucket = buckets[pMaterial->getHash()];
+            auto it = std::find_if(bucket.begin(), bucket.end(), [&](MaterialID uniqueID) { return uniqueMaterials[uniqueID.get()]->isEqual(pMaterial); });
+            if (it == bucket.end())
             {
                 idMap[id.get()] = MaterialID{ uniqueMaterials.size() };
+                bucket.push_back(idMap[id.get()]);
                 uniqueMaterials.push_back(pMaterial);
             }
             else
             {
-                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), (*it)->getName());
-                idMap[id.get()] = MaterialID{ (size_t)std::distance(uniqueMaterials.begin(), it) };
+                logInfo("Removing duplicate material '{}' (duplicate of '{}').", pMaterial->getName(), uniqueMaterials[it->get()]->getName());
+                idMap[id.get()] = *it;
             }
         }
 
         size_t removed = mMaterials.size() - uniqueMaterials.size();
         if (removed > 0)
         {
-            mMaterials = uniqueMaterials;
+            mMaterials = std::move(uniqueMaterials);
             mMaterialsChanged = true;
+
+            mMaterialIDs.clear();
+            for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id) mMaterialIDs.emplace(mMaterials[id.get()].get(), id);
+            mMaterialNameIndexDirty = true;
         }
 
         return removed;
     }
 
+    void MaterialSystem::updateMaterialNameIndex() const
+    {
+        if (!mMaterialNameIndexDirty) return;
+
+        // Rebuild the index. Only the first material with a given name is stored, matching a linear search.
+        mMaterialNameIndex.clear();
+        for (MaterialID id{ 0 }; id.get() < mMaterials.size(); ++id) mMaterialNameIndex.emplace(mMaterials[id.get()]->getName(), id);
+        mMaterialNameIndexDirty = false;
+    }
+
     void MaterialSystem::optimizeMaterials()
     {
         // Gather a list of all textures to analyze.
@@ -359,23 +392,47 @@ namespace Falcor
         // Analyze the textures.
         logInfo("Analyzing {} material textures.", textures.size());
 
-        RenderContext* pRenderContext = mpDevice->getRenderContext();
+        // Use the analysis computed on the CPU at load time where available. The remaining textures are analyzed on the GPU.
+        std::vector<TextureAnalyzer::Result> results(textures.size());
+        std::vector<ref<Texture>> gpuTextures;
+        std::vector<size_t> gpuTextureIndices;
+        for (size_t i = 0; i < textures.size(); i++)
+        {
+            if (auto analysis = mpTextureManager->getTextureAnalysis(textures[i].get()))
+            {
+                results[i] = *analysis;
+            }
+            else
+            {
+                gpuTextures.push_back(textures[i]);
+                gpuTextureIndices.push_back(i);
+            }
+        }
+
+        if (!gpuTextures.empty())
+        {
+            RenderContext* pRenderContext = mpDevice->getRenderContext();
 
-        TextureAnalyzer analyzer(mpDevice);
-        auto pResults = Buffer::create(mpDevice, textures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::UnorderedAccess);
-        analyzer.analyze(pRenderContext, textures, pResults);
+            TextureAnalyzer analyzer(mpDevice);
+            auto pResults = Buffer::create(mpDevice, gpuTextures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::UnorderedAccess);
+            analyzer.analyze(pRenderContext, gpuTextures, pResults);
 
-        // Copy result to staging buffer for readback.
-        // This is mostly to avoid a full flush and the associated perf warning.
-        // We do not have any other useful GPU work, but unrelated GPU tasks can be in flight.
-        auto pResultsStaging = Buffer::create(mpDevice, textures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::None, Buffer::CpuAccess::Read);
-        pRenderContext->copyResource(pResultsStaging.get(), pResults.get());
-        pRenderContext->flush(false);
-        mpFence->gpuSignal(pRenderContext->getLowLevelData()->getCommandQueue());
+            // Copy result to staging buffer for readback.
+            // This is mostly to avoid a full flush and the associated perf warning.
+            // We do not have any other useful GPU work, but unrelated GPU tasks can be in flight.
+            auto pResultsStaging = Buffer::create(mpDevice, gpuTextures.size() * TextureAnalyzer::getResultSize(), ResourceBindFlags::None, Buffer::CpuAccess::Read);
+            pRenderContext->copyResource(pResultsStaging.get(), pResults.get());
+            pRenderContext->flush(false);
+            mpFence->gpuSignal(pRenderContext->getLowLevelData()->getCommandQueue());
 
-        // Wait for results to become available. Then optimize the materials.
-        mpFence->syncCpu();
-        const TextureAnalyzer::Result* results = static_cast<const TextureAnalyzer::Result*>(pResultsStaging->map(Buffer::MapType::Read));
+            // Wait for results to become available.
+            mpFence->syncCpu();
+            const TextureAnalyzer::Result* gpuResults = static_cast<const TextureAnalyzer::Result*>(pResultsStaging->map(Buffer::MapType::Read));
+            for (size_t i = 0; i < gpuTextures.size(); i++) results[gpuTextureIndices[i]] = gpuResults[i];
+            pResultsStaging->unmap();
+        }
+
+        // Optimize the materials.
         Material::TextureOptimizationStats stats = {};
 
         for (size_t i = 0; i < textures.size(); i++)
@@ -383,8 +440,6 @@ namespace Falcor
             materialSlots[i].first->optimizeTexture(materialSlots[i].second, results[i], stats);
         }
 
-        pResultsStaging->unmap();
-
         // Log optimization stats.
         if (size_t totalRemoved = std::accumulate(stats.texturesRemoved.begin(), stats.texturesRemoved.end(), 0ull); totalRemoved > 0)
         {
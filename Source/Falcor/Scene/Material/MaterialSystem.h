@@ -37,6 +37,8 @@
 #include "Utils/Image/TextureManager.h"
 #include "Utils/UI/Gui.h"
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <set>
 
@@ -231,11 +233,15 @@ namespace Falcor
         void updateUI();
         void createParameterBlock();
         void uploadMaterial(const uint32_t materialID);
+        void updateMaterialNameIndex() const;
 
         ref<Device> mpDevice;
 
         std::vector<ref<Material>> mMaterials;                      ///< List of all materials.
         std::vector<Material::UpdateFlags> mMaterialsUpdateFlags;   ///< List of all material update flags, after the update() calls
+        std::unordered_map<const Material*, MaterialID> mMaterialIDs; ///< Map from material to its ID, used for finding previously added materials.
+        mutable std::unordered_map<std::string, MaterialID> mMaterialNameIndex; ///< Map from material name to the ID of the first material with that name.
+        mutable bool mMaterialNameIndexDirty = false;               ///< Flag indicating if the name index needs to be rebuilt (materials were replaced, removed or renamed).
         std::unique_ptr<TextureManager> mpTextureManager;           ///< Texture manager holding all material textures.
         Program::ShaderModuleList mShaderModules;                   ///< Shader modules for all materials in use.
         std::map<MaterialType, Program::TypeConformanceList> mTypeConformances; ///< Type conformances for each material type in use.
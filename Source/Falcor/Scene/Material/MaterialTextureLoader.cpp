@@ -53,7 +53,9 @@ namespace Falcor
         bool srgb = mUseSrgb && pMaterial->getTextureSlotInfo(slot).srgb;
 
         // Request texture to be loaded.
-        auto handle = mTextureManager.loadTexture(path, true, srgb);
+        // The directory listings are shared by all requests of this loader, so directories searched for UDIM tiles are enumerated once.
+        auto handle = mTextureManager.loadTexture(
+            path, true, srgb, ResourceBindFlags::ShaderResource, true, nullptr, nullptr, &mDirectoryListings);
 
         // Store assignment to material for later.
         mTextureAssignments.emplace_back(TextureAssignment{ pMaterial, slot, handle });
@@ -68,5 +68,6 @@ namespace Falcor
         bool mUseSrgb;
         std::vector<TextureAssignment> mTextureAssignments;
         TextureManager& mTextureManager;
+        TextureManager::DirectoryListings mDirectoryListings; ///< Listings of the directories searched for UDIM tiles.
     };
 }
@@ -0,0 +1,214 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MeasuredBSDFCache.h"
+#include "Core/Errors.h"
+#include "Core/Platform/OS.h"
+#include "Utils/CryptoUtils.h"
+#include "Utils/Logger.h"
+#include "Utils/StringFormatters.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+namespace Falcor
+{
+    namespace
+    {
+        /// Cache format version. Increment when the file layout changes to invalidate existing cache entries.
+        const uint32_t kVersion = 1;
+        const uint32_t kMagic = 0x4346424d; // "MBFC"
+        /// Cache directory relative to the application data directory.
+        const std::filesystem::path kDirectory = "NVIDIA/Falcor/MeasuredBSDFCache";
+        const std::string kExtension = ".bsdfcache";
+        /// Alignment of the array data in the cache files.
+        const uint64_t kDataAlignment = 16;
+
+        struct FileHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t arrayCount;
+            uint32_t reserved;
+        };
+
+        struct ArrayHeader
+        {
+            char name[MeasuredBSDFCache::kMaxNameLength + 1];
+            uint64_t offset;
+            uint64_t elementSize;
+            uint64_t elementCount;
+        };
+
+        uint64_t alignData(uint64_t offset)
+        {
+            return (offset + kDataAlignment - 1) / kDataAlignment * kDataAlignment;
+        }
+    }
+
+    const MeasuredBSDFCache::Array* MeasuredBSDFCache::Entry::findArray(const std::string_view name) const
+    {
+        auto it = std::find_if(mArrays.begin(), mArrays.end(), [&](const Array& array) { return array.name == name; });
+        return it != mArrays.end() ? &*it : nullptr;
+    }
+
+    MeasuredBSDFCache::MeasuredBSDFCache(const std::filesystem::path& directory)
+        : mDirectory(directory)
+    {}
+
+    std::filesystem::path MeasuredBSDFCache::getDefaultDirectory()
+    {
+        return getAppDataDirectory() / kDirectory;
+    }
+
+    std::string MeasuredBSDFCache::computeKey(const std::filesystem::path& path, const std::string_view type)
+    {
+        std::error_code ec;
+        const std::filesystem::path absolutePath = std::filesystem::absolute(path, ec);
+        const uint64_t size = std::filesystem::file_size(absolutePath, ec);
+        if (ec) return {};
+        const auto writeTime = std::filesystem::last_write_time(absolutePath, ec);
+        if (ec) return {};
+
+        SHA1 sha1;
+        sha1.update(kVersion);
+        sha1.update(type);
+        sha1.update(absolutePath.generic_string());
+        sha1.update(size);
+        sha1.update(int64_t(writeTime.time_since_epoch().count()));
+        return SHA1::toString(sha1.finalize());
+    }
+
+    std::unique_ptr<MeasuredBSDFCache::Entry> MeasuredBSDFCache::load(const std::string& key) const
+    {
+        const std::filesystem::path path = mDirectory / (key + kExtension);
+        if (key.empty() || !std::filesystem::exists(path)) return nullptr;
+
+        auto pEntry = std::make_unique<Entry>();
+        if (!pEntry->mFile.open(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan)) return nullptr;
+
+        // Validate the file, entries may have been truncated or written by a different version.
+        const uint8_t* pData = static_cast<const uint8_t*>(pEntry->mFile.getData());
+        const uint64_t fileSize = pEntry->mFile.getSize();
+        FileHeader header;
+        if (fileSize < sizeof(header)) return nullptr;
+        std::memcpy(&header, pData, sizeof(header));
+        if (header.magic != kMagic || header.version != kVersion ||
+            sizeof(header) + uint64_t(header.arrayCount) * sizeof(ArrayHeader) > fileSize)
+        {
+            logWarning("Ignoring invalid measured BSDF cache entry '{}'.", path);
+            return nullptr;
+        }
+
+        pEntry->mArrays.resize(header.arrayCount);
+        for (uint32_t i = 0; i < header.arrayCount; i++)
+        {
+            ArrayHeader arrayHeader;
+            std::memcpy(&arrayHeader, pData + sizeof(header) + i * sizeof(ArrayHeader), sizeof(arrayHeader));
+            arrayHeader.name[kMaxNameLength] = '\0';
+
+            const uint64_t byteSize = arrayHeader.elementSize * arrayHeader.elementCount;
+            if (arrayHeader.elementSize == 0 || byteSize / arrayHeader.elementSize != arrayHeader.elementCount ||
+                arrayHeader.offset % kDataAlignment != 0 || arrayHeader.offset > fileSize || byteSize > fileSize - arrayHeader.offset)
+            {
+                logWarning("Ignoring invalid measured BSDF cache entry '{}'.", path);
+                return nullptr;
+            }
+
+            Array& array = pEntry->mArrays[i];
+            array.name = arrayHeader.name;
+            array.pData = pData + arrayHeader.offset;
+            array.elementSize = arrayHeader.elementSize;
+            array.elementCount = arrayHeader.elementCount;
+        }
+
+        return pEntry;
+    }
+
+    bool MeasuredBSDFCache::store(const std::string& key, const std::vector<Array>& arrays) const
+    {
+        FALCOR_CHECK_ARG(!key.empty());
+
+        std::error_code ec;
+        std::filesystem::create_directories(mDirectory, ec);
+        if (ec)
+        {
+            logWarning("Failed to create measured BSDF cache directory '{}': {}", mDirectory, ec.message());
+            return false;
+        }
+
+        // Write to a temporary file first and rename it, so other threads and processes never observe partially written entries.
+        thread_local std::mt19937_64 rng{std::random_device{}()};
+        const std::filesystem::path tempPath = mDirectory / fmt::format("{}.{:016x}.tmp", key, rng());
+        const std::filesystem::path path = mDirectory / (key + kExtension);
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+
+            FileHeader header = {kMagic, kVersion, uint32_t(arrays.size()), 0};
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            uint64_t offset = alignData(sizeof(header) + arrays.size() * sizeof(ArrayHeader));
+            for (const auto& array : arrays)
+            {
+                FALCOR_CHECK_ARG(array.name.size() <= kMaxNameLength && array.elementSize > 0);
+                ArrayHeader arrayHeader = {};
+                std::memcpy(arrayHeader.name, array.name.data(), array.name.size());
+                arrayHeader.offset = offset;
+                arrayHeader.elementSize = array.elementSize;
+                arrayHeader.elementCount = array.elementCount;
+                file.write(reinterpret_cast<const char*>(&arrayHeader), sizeof(arrayHeader));
+                offset = alignData(offset + array.elementSize * array.elementCount);
+            }
+
+            const char padding[kDataAlignment] = {};
+            for (const auto& array : arrays)
+            {
+                const uint64_t position = uint64_t(file.tellp());
+                file.write(padding, alignData(position) - position);
+                file.write(static_cast<const char*>(array.pData), array.elementSize * array.elementCount);
+            }
+
+            if (!file)
+            {
+                logWarning("Failed to write measured BSDF cache entry '{}'.", path);
+                file.close();
+                std::filesystem::remove(tempPath, ec);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec)
+        {
+            logWarning("Failed to write measured BSDF cache entry '{}': {}", path, ec.message());
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+        return true;
+    }
+}
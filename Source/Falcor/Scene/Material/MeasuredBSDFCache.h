@@ -0,0 +1,125 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Falcor
+{
+    /** Persistent cache of preprocessed measured BSDF data.
+
+        Loading measured BSDFs (MERL, RGL) involves parsing the source files, converting the data and integrating
+        the albedo on the GPU. The results are stored in cache entries, each holding a set of named arrays, so later
+        loads can map the cached arrays and upload them directly. Entries are keyed by a hash of the source file
+        identity (see computeKey()). The cache is safe to use from multiple threads and processes.
+    */
+    class FALCOR_API MeasuredBSDFCache
+    {
+    public:
+        /** Named array stored in a cache entry.
+        */
+        struct Array
+        {
+            std::string name;           ///< Array name. At most kMaxNameLength characters.
+            const void* pData = nullptr;
+            size_t elementSize = 0;     ///< Element size in bytes.
+            size_t elementCount = 0;
+        };
+
+        static constexpr size_t kMaxNameLength = 31;
+
+        /** Cache entry mapped into memory.
+        */
+        class FALCOR_API Entry
+        {
+        public:
+            /** Get an array.
+                \param[in] name Array name.
+                \param[out] elementCount Number of elements in the array.
+                \return Pointer to the array data, or nullptr if the array doesn't exist or has a different element size.
+            */
+            template<typename T>
+            const T* getArray(const std::string_view name, size_t& elementCount) const
+            {
+                const Array* pArray = findArray(name);
+                if (!pArray || pArray->elementSize != sizeof(T)) return nullptr;
+                elementCount = pArray->elementCount;
+                return static_cast<const T*>(pArray->pData);
+            }
+
+        private:
+            const Array* findArray(const std::string_view name) const;
+
+            MemoryMappedFile mFile;
+            std::vector<Array> mArrays;
+
+            friend class MeasuredBSDFCache;
+        };
+
+        /** Constructor.
+            \param[in] directory Directory to store the cache entries in.
+        */
+        explicit MeasuredBSDFCache(const std::filesystem::path& directory = getDefaultDirectory());
+
+        /** Get the default cache directory (subdirectory in the application data directory).
+        */
+        static std::filesystem::path getDefaultDirectory();
+
+        /** Compute the key of a cache entry derived from a source file.
+            The key hashes the absolute path, size and modification time of the source file together with the entry type.
+            Hashing the file content instead would take longer than parsing MERL files.
+            \param[in] path Path to the source file.
+            \param[in] type Entry type. Include a version number to invalidate entries when the preprocessing changes.
+            \return Cache key, or an empty string if the source file doesn't exist.
+        */
+        static std::string computeKey(const std::filesystem::path& path, const std::string_view type);
+
+        /** Load a cache entry.
+            \param[in] key Cache key.
+            \return The entry, or nullptr if it doesn't exist or is invalid.
+        */
+        std::unique_ptr<Entry> load(const std::string& key) const;
+
+        /** Store a cache entry, replacing an existing entry with the same key.
+            \param[in] key Cache key.
+            \param[in] arrays Arrays to store.
+            \return True if the entry was written.
+        */
+        bool store(const std::string& key, const std::vector<Array>& arrays) const;
+
+        const std::filesystem::path& getDirectory() const { return mDirectory; }
+
+    private:
+        std::filesystem::path mDirectory;
+    };
+}
@@ -28,12 +28,14 @@
 #include "RGLMaterial.h"
 #include "RGLFile.h"
 #include "RGLCommon.h"
+#include "MeasuredBSDFCache.h"
 #include "Core/API/Device.h"
 #include "Utils/Logger.h"
 #include "Utils/Image/ImageIO.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "GlobalState.h"
 #include "Rendering/Materials/BSDFIntegrator.h"
+#include <array>
 #include <fstream>
 
 namespace Falcor
@@ -48,6 +50,56 @@ namespace Falcor
         const ResourceFormat kAlbedoLUTFormat = ResourceFormat::RGBA32Float;
 
         const std::string kLoadFile = "load";
+
+        // Measured BSDF cache entry types. Bump the versions when the preprocessing changes.
+        const char kCacheType[] = "RGL/1";
+        const char kAlbedoCacheType[] = "RGLAlbedo/1";
+        const char kCacheSizesArray[] = "sizes";
+        const char kCacheDescriptionArray[] = "description";
+        const char kCacheAlbedoLUTArray[] = "albedoLUT";
+
+        /** Preprocessed BRDF tables uploaded to the GPU.
+        */
+        enum Table
+        {
+            kTheta,
+            kPhi,
+            kSigma,
+            kNDF,
+            kVNDF,
+            kLumi,
+            kRGB,
+            kVNDFMarginal,
+            kLumiMarginal,
+            kVNDFConditional,
+            kLumiConditional,
+            kTableCount
+        };
+
+        const char* kTableNames[kTableCount] =
+        {
+            "theta", "phi", "sigma", "ndf", "vndf", "luminance", "rgb", "vndfMarginal", "lumiMarginal", "vndfConditional", "lumiConditional"
+        };
+
+        /** Get the number of floats in each table for the given table sizes.
+        */
+        std::array<size_t, kTableCount> getTableElementCounts(const RGLMaterialData& data)
+        {
+            const size_t sliceCount = (size_t)data.phiSize * data.thetaSize;
+            std::array<size_t, kTableCount> counts;
+            counts[kTheta] = data.thetaSize;
+            counts[kPhi] = data.phiSize;
+            counts[kSigma] = (size_t)data.sigmaSize.x * data.sigmaSize.y;
+            counts[kNDF] = (size_t)data.ndfSize.x * data.ndfSize.y;
+            counts[kVNDF] = sliceCount * data.vndfSize.x * data.vndfSize.y;
+            counts[kLumi] = sliceCount * data.lumiSize.x * data.lumiSize.y;
+            counts[kRGB] = 3 * counts[kLumi];
+            counts[kVNDFMarginal] = sliceCount * data.vndfSize.y;
+            counts[kLumiMarginal] = sliceCount * data.lumiSize.y;
+            counts[kVNDFConditional] = counts[kVNDF];
+            counts[kLumiConditional] = counts[kLumi];
+            return counts;
+        }
     }
 
     RGLMaterial::RGLMaterial(ref<Device> pDevice, const std::string& name, const std::filesystem::path& path)
@@ -133,6 +185,15 @@ namespace Falcor
         return true;
     }
 
+    uint64_t RGLMaterial::getHash() const
+    {
+        FNVHash64 hash;
+        hashBase(hash);
+        size_t pathHash = std::filesystem::hash_value(mFilePath); // Consistent with path comparison.
+        hash.insert(&pathHash, sizeof(pathHash));
+        return hash.get();
+    }
+
     Program::ShaderModuleList RGLMaterial::getShaderModules() const
     {
         return { Program::ShaderModule(kShaderFile) };
@@ -152,78 +213,153 @@ namespace Falcor
             return false;
         }
 
-        std::ifstream ifs(fullPath, std::ios_base::in | std::ios_base::binary);
-        if (!ifs.good())
+        RGLMaterialData data = mData;
+        std::string description;
+        std::array<const float*, kTableCount> tables = {};
+
+        // Try loading the preprocessed tables from the cache.
+        MeasuredBSDFCache cache;
+        const std::string cacheKey = MeasuredBSDFCache::computeKey(fullPath, kCacheType);
+        std::unique_ptr<MeasuredBSDFCache::Entry> pEntry = cache.load(cacheKey);
+        if (pEntry)
         {
-            logWarning("RGLMaterial::loadBRDF() - Failed to open file '{}'.", path);
-            return false;
+            size_t count = 0;
+            const uint32_t* pSizes = pEntry->getArray<uint32_t>(kCacheSizesArray, count);
+            if (pSizes && count == 10)
+            {
+                data.phiSize = pSizes[0];
+                data.thetaSize = pSizes[1];
+                data.sigmaSize = uint2(pSizes[2], pSizes[3]);
+                data.ndfSize = uint2(pSizes[4], pSizes[5]);
+                data.vndfSize = uint2(pSizes[6], pSizes[7]);
+                data.lumiSize = uint2(pSizes[8], pSizes[9]);
+
+                const auto counts = getTableElementCounts(data);
+                for (uint32_t i = 0; i < kTableCount; i++)
+                {
+                    tables[i] = pEntry->getArray<float>(kTableNames[i], count);
+                    if (count != counts[i]) tables[i] = nullptr;
+                }
+
+                const char* pDescription = pEntry->getArray<char>(kCacheDescriptionArray, count);
+                if (pDescription) description.assign(pDescription, count);
+            }
+            if (std::find(tables.begin(), tables.end(), nullptr) != tables.end()) pEntry.reset();
         }
 
+        // Parse the RGL file and build the sampling distributions on a cache miss.
         std::unique_ptr<RGLFile> file;
-        try
+        std::unique_ptr<SamplableDistribution4D> vndfDist;
+        std::unique_ptr<SamplableDistribution4D> lumiDist;
+        if (!pEntry)
         {
-            file.reset(new RGLFile(ifs));
-        }
-        catch(const RuntimeError& e)
-        {
-            logWarning("RGLMaterial::loadBRDF() - Failed to parse RGL file '{}': {}.", path, e.what());
-            return false;
-        }
+            std::ifstream ifs(fullPath, std::ios_base::in | std::ios_base::binary);
+            if (!ifs.good())
+            {
+                logWarning("RGLMaterial::loadBRDF() - Failed to open file '{}'.", path);
+                return false;
+            }
 
-        if (!ifs.good())
-        {
-            logWarning("RGLMaterial::loadBRDF() - Failed to load BRDF data from file '{}': Read error.", path);
-            return false;
-        }
+            try
+            {
+                file.reset(new RGLFile(ifs));
+            }
+            catch(const RuntimeError& e)
+            {
+                logWarning("RGLMaterial::loadBRDF() - Failed to parse RGL file '{}': {}.", path, e.what());
+                return false;
+            }
 
-        auto theta = file->data().thetaI;
-        auto phi   = file->data().phiI;
-        auto sigma = file->data().sigma;
-        auto ndf   = file->data().ndf;
-        auto vndf  = file->data().vndf;
-        auto lumi  = file->data().luminance;
-        auto rgb   = file->data().rgb;
-
-        const uint64_t kMaxResolution = RGLMaterialData::kMaxResolution;
-        if (phi->shape[0] > kMaxResolution || theta->shape[0] > kMaxResolution || std::max(sigma->shape[0], sigma->shape[1]) > kMaxResolution
-            || std::max(ndf->shape[0], ndf->shape[1]) > kMaxResolution || std::max(vndf->shape[2], vndf->shape[3]) > kMaxResolution
-            || std::max(lumi->shape[2], lumi->shape[3]) > kMaxResolution)
-        {
-            logWarning("RGLMaterial::loadBRDF() - Failed to process BRDF data: Measurement resolution too large.", path);
-            return false;
+            if (!ifs.good())
+            {
+                logWarning("RGLMaterial::loadBRDF() - Failed to load BRDF data from file '{}': Read error.", path);
+                return false;
+            }
+
+            auto theta = file->data().thetaI;
+            auto phi   = file->data().phiI;
+            auto sigma = file->data().sigma;
+            auto ndf   = file->data().ndf;
+            auto vndf  = file->data().vndf;
+            auto lumi  = file->data().luminance;
+            auto rgb   = file->data().rgb;
+
+            const uint64_t kMaxResolution = RGLMaterialData::kMaxResolution;
+            if (phi->shape[0] > kMaxResolution || theta->shape[0] > kMaxResolution
+                || std::max(sigma->shape[0], sigma->shape[1]) > kMaxResolution || std::max(ndf->shape[0], ndf->shape[1]) > kMaxResolution
+                || std::max(vndf->shape[2], vndf->shape[3]) > kMaxResolution || std::max(lumi->shape[2], lumi->shape[3]) > kMaxResolution)
+            {
+                logWarning("RGLMaterial::loadBRDF() - Failed to process BRDF data: Measurement resolution too large.", path);
+                return false;
+            }
+
+            description = file->data().description;
+
+            data.phiSize = uint(phi->shape[0]);
+            data.thetaSize = uint(theta->shape[0]);
+            data.sigmaSize = uint2(sigma->shape[1], sigma->shape[0]);
+            data.  ndfSize = uint2(ndf  ->shape[1], ndf  ->shape[0]);
+            data. vndfSize = uint2(vndf ->shape[3], vndf ->shape[2]);
+            data. lumiSize = uint2(lumi ->shape[3], lumi ->shape[2]);
+
+            uint4 vndfSize = uint4(data.phiSize, data.thetaSize, data.vndfSize.x, data.vndfSize.y);
+            uint4 lumiSize = uint4(data.phiSize, data.thetaSize, data.lumiSize.x, data.lumiSize.y);
+            vndfDist = std::make_unique<SamplableDistribution4D>(reinterpret_cast<float*>(vndf->data.get()), vndfSize);
+            lumiDist = std::make_unique<SamplableDistribution4D>(reinterpret_cast<float*>(lumi->data.get()), lumiSize);
+
+            tables[kTheta] = reinterpret_cast<const float*>(theta->data.get());
+            tables[kPhi] = reinterpret_cast<const float*>(phi->data.get());
+            tables[kSigma] = reinterpret_cast<const float*>(sigma->data.get());
+            tables[kNDF] = reinterpret_cast<const float*>(ndf->data.get());
+            tables[kVNDF] = vndfDist->getPDF();
+            tables[kLumi] = lumiDist->getPDF();
+            tables[kRGB] = reinterpret_cast<const float*>(rgb->data.get());
+            tables[kVNDFMarginal] = vndfDist->getMarginal();
+            tables[kLumiMarginal] = lumiDist->getMarginal();
+            tables[kVNDFConditional] = vndfDist->getConditional();
+            tables[kLumiConditional] = lumiDist->getConditional();
+
+            // Store the preprocessed tables in the cache.
+            if (!cacheKey.empty())
+            {
+                const uint32_t sizes[10] =
+                {
+                    data.phiSize, data.thetaSize, data.sigmaSize.x, data.sigmaSize.y, data.ndfSize.x, data.ndfSize.y,
+                    data.vndfSize.x, data.vndfSize.y, data.lumiSize.x, data.lumiSize.y
+                };
+                const auto counts = getTableElementCounts(data);
+                std::vector<MeasuredBSDFCache::Array> arrays;
+                arrays.push_back({kCacheSizesArray, sizes, sizeof(uint32_t), 10});
+                arrays.push_back({kCacheDescriptionArray, description.data(), sizeof(char), description.size()});
+                for (uint32_t i = 0; i < kTableCount; i++) arrays.push_back({kTableNames[i], tables[i], sizeof(float), counts[i]});
+                cache.store(cacheKey, arrays);
+            }
         }
 
         mFilePath = fullPath;
         mBRDFName = std::filesystem::path(fullPath).stem().string();
-        mBRDFDescription = file->data().description;
-
-        mData.phiSize = uint(phi->shape[0]);
-        mData.thetaSize = uint(theta->shape[0]);
-        mData.sigmaSize = uint2(sigma->shape[1], sigma->shape[0]);
-        mData.  ndfSize = uint2(ndf  ->shape[1], ndf  ->shape[0]);
-        mData. vndfSize = uint2(vndf ->shape[3], vndf ->shape[2]);
-        mData. lumiSize = uint2(lumi ->shape[3], lumi ->shape[2]);
-
-        uint4 vndfSize = uint4(mData.phiSize, mData.thetaSize, mData.vndfSize.x, mData.vndfSize.y);
-        uint4 lumiSize = uint4(mData.phiSize, mData.thetaSize, mData.lumiSize.x, mData.lumiSize.y);
-        auto prod3 = [&](uint4 v) { return v.x * v.y * v.z; };
-        auto prod4 = [&](uint4 v) { return v.x * v.y * v.z * v.w; };
-
-        SamplableDistribution4D vndfDist(reinterpret_cast<float*>(vndf->data.get()), vndfSize);
-        SamplableDistribution4D lumiDist(reinterpret_cast<float*>(lumi->data.get()), lumiSize);
-
-        mpVNDFMarginalBuf    = Buffer::create(mpDevice, prod3(vndfSize) * 4, ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, vndfDist.getMarginal());
-        mpLumiMarginalBuf    = Buffer::create(mpDevice, prod3(lumiSize) * 4, ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, lumiDist.getMarginal());
-        mpVNDFConditionalBuf = Buffer::create(mpDevice, prod4(vndfSize) * 4, ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, vndfDist.getConditional());
-        mpLumiConditionalBuf = Buffer::create(mpDevice, prod4(lumiSize) * 4, ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, lumiDist.getConditional());
-
-        mpThetaBuf = Buffer::create(mpDevice, theta->numElems * sizeof(float), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, theta->data.get());
-        mpPhiBuf   = Buffer::create(mpDevice, phi  ->numElems * sizeof(float), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, phi  ->data.get());
-        mpSigmaBuf = Buffer::create(mpDevice, sigma->numElems * sizeof(float), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, sigma->data.get());
-        mpNDFBuf   = Buffer::create(mpDevice, ndf  ->numElems * sizeof(float), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, ndf  ->data.get());
-        mpVNDFBuf  = Buffer::create(mpDevice, vndf ->numElems * sizeof(float), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, vndfDist.getPDF());
-        mpLumiBuf  = Buffer::create(mpDevice, lumi ->numElems * sizeof(float), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, lumiDist.getPDF());
-        mpRGBBuf   = Buffer::create(mpDevice, rgb  ->numElems * sizeof(float), ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, rgb  ->data.get());
+        mBRDFDescription = description;
+        mData = data;
+
+        // Create GPU buffers.
+        const auto counts = getTableElementCounts(mData);
+        auto createBuffer = [&](Table table)
+        {
+            const size_t size = counts[table] * sizeof(float);
+            return Buffer::create(mpDevice, size, ResourceBindFlags::ShaderResource, Buffer::CpuAccess::None, tables[table]);
+        };
+
+        mpThetaBuf            = createBuffer(kTheta);
+        mpPhiBuf              = createBuffer(kPhi);
+        mpSigmaBuf            = createBuffer(kSigma);
+        mpNDFBuf              = createBuffer(kNDF);
+        mpVNDFBuf             = createBuffer(kVNDF);
+        mpLumiBuf             = createBuffer(kLumi);
+        mpRGBBuf              = createBuffer(kRGB);
+        mpVNDFMarginalBuf     = createBuffer(kVNDFMarginal);
+        mpLumiMarginalBuf     = createBuffer(kLumiMarginal);
+        mpVNDFConditionalBuf  = createBuffer(kVNDFConditional);
+        mpLumiConditionalBuf  = createBuffer(kLumiConditional);
 
         markUpdates(Material::UpdateFlags::ResourcesChanged);
 
@@ -232,43 +368,56 @@ namespace Falcor
         return true;
     }
 
-    void RGLMaterial::prepareAlbedoLUT(RenderContext* pRenderContext) // TODO
+    void RGLMaterial::prepareAlbedoLUT(RenderContext* pRenderContext)
     {
-        const auto texPath = mFilePath.replace_extension("dds");
+        std::vector<float4> albedoLUT;
 
-        // Try loading albedo lookup table.
-        if (std::filesystem::is_regular_file(texPath))
+        // Try loading the albedo lookup table from the cache.
+        MeasuredBSDFCache cache;
+        const std::string cacheKey = MeasuredBSDFCache::computeKey(mFilePath, kAlbedoCacheType);
+        bool loadedFromCache = false;
+        if (auto pEntry = cache.load(cacheKey))
         {
-            // Load 1D texture in non-SRGB format, no mips.
-            // If successful, verify dimensions/format/etc. match the expectations.
-            mpAlbedoLUT = Texture::createFromFile(mpDevice, texPath.string(), false, false, ResourceBindFlags::ShaderResource);
+            size_t count = 0;
+            const float4* pData = pEntry->getArray<float4>(kCacheAlbedoLUTArray, count);
+            if (pData && count == kAlbedoLUTSize)
+            {
+                albedoLUT.assign(pData, pData + count);
+                loadedFromCache = true;
+            }
+        }
 
-            if (mpAlbedoLUT)
+        // Try loading a precomputed albedo lookup table stored next to the BRDF.
+        const auto texPath = std::filesystem::path(mFilePath).replace_extension("dds");
+        if (albedoLUT.empty() && std::filesystem::is_regular_file(texPath))
+        {
+            const auto pBitmap = ImageIO::loadBitmapFromDDS(texPath);
+            if (pBitmap && pBitmap->getFormat() == kAlbedoLUTFormat && pBitmap->getWidth() == kAlbedoLUTSize && pBitmap->getHeight() == 1)
             {
-                if (mpAlbedoLUT->getFormat() == kAlbedoLUTFormat &&
-                    mpAlbedoLUT->getWidth() == kAlbedoLUTSize &&
-                    mpAlbedoLUT->getHeight() == 1 && mpAlbedoLUT->getDepth() == 1 &&
-                    mpAlbedoLUT->getMipCount() == 1 && mpAlbedoLUT->getArraySize() == 1)
-                {
-                    logInfo("Loaded albedo LUT from '{}'.", texPath.string());
-                    return;
-                }
+                const float4* pData = reinterpret_cast<const float4*>(pBitmap->getData());
+                albedoLUT.assign(pData, pData + kAlbedoLUTSize);
+                logInfo("Loaded albedo LUT from '{}'.", texPath.string());
             }
         }
 
         // Failed to load a valid lookup table. We'll recompute it.
-        computeAlbedoLUT(pRenderContext);
+        if (albedoLUT.empty())
+        {
+            albedoLUT = computeAlbedoLUT(pRenderContext);
+        }
 
-        // Cache lookup table in texture on disk.
-        // TODO: Capture texture to DDS is not yet supported. Calling ImageIO directly for now.
-        //mpAlbedoLUT->captureToFile(0, 0, texPath.string(), Bitmap::FileFormat::DdsFile, Bitmap::ExportFlags::Uncompressed);
-        FALCOR_ASSERT(mpAlbedoLUT);
-        ImageIO::saveToDDS(pRenderContext, texPath.string(), mpAlbedoLUT, ImageIO::CompressionMode::None, false);
+        // Cache lookup table on disk.
+        if (!loadedFromCache && !cacheKey.empty())
+        {
+            cache.store(cacheKey, {{kCacheAlbedoLUTArray, albedoLUT.data(), sizeof(float4), albedoLUT.size()}});
+        }
 
-        logInfo("Saved albedo LUT to '{}'.", texPath.string());
+        // Create albedo LUT texture.
+        static_assert(kAlbedoLUTFormat == ResourceFormat::RGBA32Float);
+        mpAlbedoLUT = Texture::create2D(mpDevice, kAlbedoLUTSize, 1, kAlbedoLUTFormat, 1, 1, albedoLUT.data(), ResourceBindFlags::ShaderResource);
     }
 
-    void RGLMaterial::computeAlbedoLUT(RenderContext* pRenderContext) // TODO
+    std::vector<float4> RGLMaterial::computeAlbedoLUT(RenderContext* pRenderContext)
     {
         logInfo("Computing albedo LUT for RGL BRDF '{}'...", mBRDFName);
 
@@ -295,13 +444,10 @@ namespace Falcor
         // properly would be more trouble than its worth.
         auto albedos = integrator.integrateIsotropic(pRenderContext, materialID, cosThetas);
 
-        // Copy result into format needed for texture creation.
-        static_assert(kAlbedoLUTFormat == ResourceFormat::RGBA32Float);
-        std::vector<float4> initData(kAlbedoLUTSize, float4(0.f));
-        for (uint32_t i = 0; i < kAlbedoLUTSize; i++) initData[i] = float4(albedos[i], 1.f);
-
-        // Create albedo LUT texture.
-        mpAlbedoLUT = Texture::create2D(mpDevice, kAlbedoLUTSize, 1, kAlbedoLUTFormat, 1, 1, initData.data(), ResourceBindFlags::ShaderResource);
+        // Copy result into RGBA format needed for texture creation.
+        std::vector<float4> albedoLUT(kAlbedoLUTSize);
+        for (uint32_t i = 0; i < kAlbedoLUTSize; i++) albedoLUT[i] = float4(albedos[i], 1.f);
+        return albedoLUT;
     }
 
     FALCOR_SCRIPT_BINDING(RGLMaterial)
@@ -50,6 +50,7 @@ namespace Falcor
         bool renderUI(Gui::Widgets& widget) override;
         Material::UpdateFlags update(MaterialSystem* pOwner) override;
         bool isEqual(const ref<Material>& pOther) const override;
+        uint64_t getHash() const override;
         MaterialDataBlob getDataBlob() const override { return prepareDataBlob(mData); }
         Program::ShaderModuleList getShaderModules() const override;
         Program::TypeConformanceList getTypeConformances() const override;
@@ -61,7 +62,7 @@ namespace Falcor
     protected:
         void prepareData(const int dims[3], const std::vector<double>& data);
         void prepareAlbedoLUT(RenderContext* pRenderContext);
-        void computeAlbedoLUT(RenderContext* pRenderContext);
+        std::vector<float4> computeAlbedoLUT(RenderContext* pRenderContext);
 
         std::filesystem::path mFilePath;    ///< Full path to the BRDF loaded.
         std::string mBRDFName;              ///< This is the file basename without extension.
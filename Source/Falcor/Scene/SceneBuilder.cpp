@@ -34,6 +34,7 @@
 #include "Utils/Math/Common.h"
 #include "Utils/Image/TextureAnalyzer.h"
 #include "Utils/Timing/TimeReport.h"
+#include "Utils/Threading.h"
 #include "Utils/Scripting/ScriptBindings.h"
 #include "Utils/Math/MathHelpers.h"
 #include "Utils/ObjectIDPython.h"
@@ -53,6 +54,24 @@ namespace Falcor
         // We'll log a warning if the maximum quantization error exceeds this value.
         const float kMaxTexelError = 0.5f;
 
+        // Number of vertices per task when processing large meshes in parallel.
+        const size_t kVertexGrainSize = 1 << 16;
+
+        /** Compute the bounding box of a list of vertices. Large lists are processed in parallel.
+            The result does not depend on the order of evaluation.
+        */
+        AABB computeBoundingBox(const std::vector<StaticVertexData>& vertices)
+        {
+            return Threading::parallelReduce(0, vertices.size(), AABB(),
+                [&](size_t begin, size_t end, AABB bb)
+                {
+                    for (size_t i = begin; i < end; ++i) bb.include(vertices[i].position);
+                    return bb;
+                },
+                [](AABB a, const AABB& b) { return a.include(b); },
+                kVertexGrainSize);
+        }
+
         int largestAxis(const float3& v)
         {
             if (v.x >= v.y && v.x >= v.z) return 0;
@@ -175,6 +194,294 @@ namespace Falcor
             return true;
         }
 
+        /** Key used for merging identical vertices.
+            Attributes that compareVertices() requires to match exactly are stored as raw bits. The remaining attributes
+            are quantized to cells of kCellSize times the comparison threshold. Vertices that compare equal fall into the
+            same or adjacent cells, see forEachVertexKey(). Quantized values that don't fit into 32 bits fall back to their
+            raw bits, which is recorded in a mask.
+            The key is a fixed-size block of words so that comparisons compile to wide (vectorized) compares.
+        */
+        struct VertexKey
+        {
+            static constexpr size_t kWordCount = 24;
+            static constexpr double kCellSize = 1024.0;
+            alignas(16) uint32_t words[kWordCount];
+
+            bool operator==(const VertexKey& other) const { return std::memcmp(words, other.words, sizeof(words)) == 0; }
+
+            uint64_t hash() const
+            {
+                uint64_t h = 0;
+                for (size_t i = 0; i < kWordCount; i += 2)
+                {
+                    h = (h ^ (words[i] | ((uint64_t)words[i + 1] << 32))) * 0x9e3779b97f4a7c15ull;
+                    h ^= h >> 29;
+                }
+                h ^= h >> 32;
+                return h;
+            }
+        };
+
+        /** Enumerate the keys of all cells that may contain vertices comparing equal to the given vertex.
+            The first key is the vertex's own cell, which is the key the vertex is stored under. Quantized attributes that
+            lie within the comparison threshold of a cell boundary additionally produce the keys of the neighbouring cells.
+            Cells are much larger than the threshold, so typically only the first key is produced.
+            \param[in] origIndex Original vertex index.
+            \param[in] v Vertex.
+            \param[in] func Callback receiving the keys. Enumeration stops when it returns true.
+            \param[in] threshold Comparison threshold used by compareVertices().
+        */
+        template<typename Func>
+        void forEachVertexKey(uint32_t origIndex, const SceneBuilder::Mesh::Vertex& v, Func&& func, float threshold = 1e-6f)
+        {
+            static constexpr size_t kMaxQuantizedCount = 12;
+
+            VertexKey key = {};
+            const double scale = 1.0 / (threshold * VertexKey::kCellSize);
+            // Margin (in cells) for detecting values close to a cell boundary. Twice the threshold to be safe against rounding.
+            const double margin = 2.0 / VertexKey::kCellSize;
+            size_t i = 0;
+            uint32_t fallbackMask = 0;
+            uint32_t quantizedCount = 0;
+
+            // Neighbouring cell per quantized attribute close to a cell boundary.
+            size_t neighbourWords[kMaxQuantizedCount];
+            uint32_t neighbourCells[kMaxQuantizedCount];
+            size_t neighbourCount = 0;
+
+            auto exact = [&](float x)
+            {
+                x = x == 0.f ? 0.f : x; // Treat -0 and +0 as equal.
+                std::memcpy(&key.words[i++], &x, sizeof(float));
+            };
+            auto quantized = [&](float x)
+            {
+                // Cells are centered on multiples of the cell size so that common values like 0 don't lie on a boundary.
+                double q = (double)x * scale + 0.5;
+                double cell = std::floor(q);
+                if (cell > (double)std::numeric_limits<int32_t>::min() && cell < (double)std::numeric_limits<int32_t>::max())
+                {
+                    double f = q - cell;
+                    if (f < margin || f > 1.0 - margin)
+                    {
+                        neighbourWords[neighbourCount] = i;
+                        neighbourCells[neighbourCount++] = (uint32_t)(int32_t)(f < margin ? cell - 1.0 : cell + 1.0);
+                    }
+                    key.words[i++] = (uint32_t)(int32_t)cell;
+                }
+                else
+                {
+                    // Floats of this magnitude are spaced far wider than the threshold and have to match exactly.
+                    fallbackMask |= 1u << quantizedCount;
+                    std::memcpy(&key.words[i++], &x, sizeof(float));
+                }
+                quantizedCount++;
+            };
+
+            key.words[i++] = origIndex;
+            for (int j = 0; j < 3; j++) exact(v.position[j]);
+            exact(v.tangent.w);
+            exact(v.curveRadius);
+            for (int j = 0; j < 4; j++) key.words[i++] = v.boneIDs[j];
+            for (int j = 0; j < 3; j++) quantized(v.normal[j]);
+            for (int j = 0; j < 3; j++) quantized(v.tangent[j]);
+            for (int j = 0; j < 2; j++) quantized(v.texCrd[j]);
+            for (int j = 0; j < 4; j++) quantized(v.boneWeights[j]);
+            key.words[i++] = fallbackMask;
+            FALCOR_ASSERT(i <= VertexKey::kWordCount);
+            FALCOR_ASSERT(quantizedCount <= kMaxQuantizedCount);
+
+            // Enumerate all combinations of own and neighbouring cells.
+            uint32_t baseCells[kMaxQuantizedCount];
+            for (size_t n = 0; n < neighbourCount; n++) baseCells[n] = key.words[neighbourWords[n]];
+
+            for (uint32_t combination = 0; combination < (1u << neighbourCount); combination++)
+            {
+                for (size_t n = 0; n < neighbourCount; n++)
+                {
+                    key.words[neighbourWords[n]] = (combination & (1u << n)) ? neighbourCells[n] : baseCells[n];
+                }
+                if (func(key)) return;
+            }
+        }
+
+        /// Returns the key of the cell the vertex is stored under.
+        VertexKey makeVertexKey(uint32_t origIndex, const SceneBuilder::Mesh::Vertex& v)
+        {
+            VertexKey key;
+            forEachVertexKey(origIndex, v, [&](const VertexKey& k) { key = k; return true; });
+            return key;
+        }
+
+        /** Open-addressing hash table (linear probing) mapping vertex keys to vertex indices.
+            Multiple vertices may be stored under the same key.
+        */
+        class VertexHashTable
+        {
+        public:
+            static constexpr uint32_t kInvalidIndex = 0xffffffff;
+
+            /// Clear the table. Storage is kept for reuse.
+            void clear()
+            {
+                if (mEntries.empty()) return;
+                mEntries.clear();
+                std::fill(mSlots.begin(), mSlots.end(), Slot{});
+            }
+
+            /** Find a vertex with the given key.
+                \param[in] key Vertex key.
+                \param[in] isEqual Callback for verifying that the vertex with the given index matches.
+                \return Returns the index of the matching vertex, or kInvalidIndex if not found.
+            */
+            template<typename EqualFunc>
+            uint32_t find(const VertexKey& key, EqualFunc&& isEqual) const
+            {
+                if (mSlots.empty()) return kInvalidIndex;
+
+                const uint64_t hash = key.hash();
+                const uint32_t tag = (uint32_t)(hash >> 32);
+                for (size_t slot = hash & mMask; mSlots[slot].entry != kInvalidIndex; slot = (slot + 1) & mMask)
+                {
+                    const Slot& s = mSlots[slot];
+                    if (s.tag == tag)
+                    {
+                        const Entry& e = mEntries[s.entry];
+                        if (e.key == key && isEqual(e.index)) return e.index;
+                    }
+                }
+                return kInvalidIndex;
+            }
+
+            /// Insert a vertex index under the given key.
+            void insert(const VertexKey& key, uint32_t index)
+            {
+                // Keep the load factor below 0.5.
+                if (2 * (mEntries.size() + 1) > mSlots.size()) grow();
+
+                const uint64_t hash = key.hash();
+                size_t slot = hash & mMask;
+                while (mSlots[slot].entry != kInvalidIndex) slot = (slot + 1) & mMask;
+                mSlots[slot] = { (uint32_t)(hash >> 32), (uint32_t)mEntries.size() };
+                mEntries.push_back({ key, index });
+            }
+
+        private:
+            struct Slot
+            {
+                uint32_t tag = 0;
+                uint32_t entry = kInvalidIndex;
+            };
+
+            struct Entry
+            {
+                VertexKey key;
+                uint32_t index;
+            };
+
+            void grow()
+            {
+                mSlots.assign(std::max<size_t>(64, 2 * mSlots.size()), Slot{});
+                mMask = mSlots.size() - 1;
+                for (uint32_t entry = 0; entry < (uint32_t)mEntries.size(); ++entry)
+                {
+                    const uint64_t hash = mEntries[entry].key.hash();
+                    size_t slot = hash & mMask;
+                    while (mSlots[slot].entry != kInvalidIndex) slot = (slot + 1) & mMask;
+                    mSlots[slot] = { (uint32_t)(hash >> 32), entry };
+                }
+            }
+
+            std::vector<Slot> mSlots;
+            std::vector<Entry> mEntries;
+            size_t mMask = 0;
+        };
+
+        /** Helper for merging identical vertices that share the same original vertex index.
+            Vertices are kept in a short linked list per original vertex index, which is the fastest option for
+            regular meshes. Once a list grows beyond kMaxListLength (e.g. due to faceted normals or UV seams),
+            the original vertex index switches to a hash table lookup so that merging stays linear in the vertex count.
+            The storage is reused across meshes to avoid repeated allocations.
+        */
+        class VertexMerger
+        {
+        public:
+            using Vertex = SceneBuilder::Mesh::Vertex;
+            static constexpr uint32_t kInvalidIndex = 0xffffffff;
+            static constexpr uint32_t kMaxListLength = 8;
+
+            void reset(uint32_t origVertexCount)
+            {
+                mLists.assign(origVertexCount, List{});
+                mNext.clear();
+                mTable.clear();
+            }
+
+            /** Find a matching vertex or insert a new one.
+                \param[in] origIndex Original vertex index.
+                \param[in] v Vertex.
+                \param[in] vertices Unique vertices found so far. A new vertex is expected to be appended by the caller.
+                \return Returns the vertex index. The vertex is new if the index equals vertices.size().
+            */
+            uint32_t findOrInsert(uint32_t origIndex, const Vertex& v, const std::vector<Vertex>& vertices)
+            {
+                FALCOR_ASSERT(vertices.size() < kInvalidIndex);
+                FALCOR_ASSERT(mNext.size() == vertices.size());
+                const uint32_t newIndex = (uint32_t)vertices.size();
+                List& list = mLists[origIndex];
+
+                if (list.length > kMaxListLength)
+                {
+                    // Matching vertices may be stored in a neighbouring cell, see forEachVertexKey().
+                    uint32_t index = kInvalidIndex;
+                    auto isEqual = [&](uint32_t i) { return compareVertices(v, vertices[i]); };
+                    forEachVertexKey(origIndex, v, [&](const VertexKey& key)
+                    {
+                        index = mTable.find(key, isEqual);
+                        return index != kInvalidIndex;
+                    });
+                    if (index != kInvalidIndex) return index;
+
+                    mTable.insert(makeVertexKey(origIndex, v), newIndex);
+                    mNext.push_back(kInvalidIndex);
+                    return newIndex;
+                }
+
+                // Iterate over vertex list to check if it already exists.
+                for (uint32_t index = list.head; index != kInvalidIndex; index = mNext[index])
+                {
+                    if (compareVertices(v, vertices[index])) return index;
+                }
+
+                // Insert new vertex.
+                mNext.push_back(list.head);
+                list.head = newIndex;
+
+                // Move the list to the hash table if it got too long.
+                if (++list.length > kMaxListLength)
+                {
+                    mTable.insert(makeVertexKey(origIndex, v), newIndex);
+                    for (uint32_t index = mNext[newIndex]; index != kInvalidIndex; index = mNext[index])
+                    {
+                        mTable.insert(makeVertexKey(origIndex, vertices[index]), index);
+                    }
+                }
+
+                return newIndex;
+            }
+
+        private:
+            struct List
+            {
+                uint32_t head = kInvalidIndex;
+                uint32_t length = 0;
+            };
+
+            std::vector<List> mLists;           ///< Vertex list per original vertex index.
+            std::vector<uint32_t> mNext;        ///< Next-pointer per vertex.
+            VertexHashTable mTable;
+        };
+
         std::vector<uint32_t> compact16BitIndices(const std::vector<uint32_t>& indices)
         {
             if (indices.empty()) return {};
@@ -191,7 +498,7 @@ namespace Falcor
 
         SceneCache::Key computeSceneCacheKey(const std::filesystem::path& path, SceneBuilder::Flags buildFlags)
         {
-            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache));
+            SceneBuilder::Flags cacheFlags = buildFlags & (~(SceneBuilder::Flags::UseCache | SceneBuilder::Flags::RebuildCache | SceneBuilder::Flags::HashCacheDependencies | SceneBuilder::Flags::AsyncCacheWrite));
             SHA1 sha1;
             auto pathStr = path.string();
             sha1.update(pathStr.data(), pathStr.size());
@@ -208,6 +515,7 @@ namespace Falcor
     {
         mpFence = GpuFence::create(mpDevice);
         mSceneData.pMaterials = std::make_unique<MaterialSystem>(mpDevice);
+        if (is_set(mFlags, Flags::UseCompressedTextureCache)) mSceneData.pMaterials->getTextureManager().setUseCompressedTextureCache(true);
     }
 
     SceneBuilder::SceneBuilder(ref<Device> pDevice, const std::filesystem::path& path, const Settings& settings, Flags flags)
@@ -220,6 +528,7 @@ namespace Falcor
         }
 
         // Compute scene cache key based on absolute scene path and build flags.
+        // The key only locates the cache. Its validity is determined by the dependencies stored in the cache.
         mSceneCacheKey = computeSceneCacheKey(fullPath, flags);
 
         // Determine if scene cache should be written after import.
@@ -262,6 +571,7 @@ namespace Falcor
         }
 
         mSceneData.path = fullPath;
+        addDependency(fullPath);
         if (auto importer = Importer::create(getExtensionFromPath(fullPath)))
         {
             importer->importScene(fullPath, *this, dict);
@@ -287,6 +597,25 @@ namespace Falcor
         }
     }
 
+    void SceneBuilder::addDependency(const std::filesystem::path& path)
+    {
+        if (!mWriteSceneCache || path.empty()) return;
+
+        std::filesystem::path dependency = path;
+
+        // For file patterns, depend on the directory (its last write time changes when files are added or removed).
+        std::string filename = path.filename().string();
+        if (filename.find("<UDIM>") != std::string::npos || filename.find("<MIP>") != std::string::npos)
+            dependency = path.parent_path();
+
+        std::filesystem::path fullPath;
+        if (findFileInDataDirectories(dependency, fullPath)) dependency = fullPath;
+        else if (dependency.is_relative()) dependency = std::filesystem::absolute(dependency);
+
+        std::lock_guard<std::mutex> lock(mDependencyMutex);
+        mDependencies.insert(dependency.lexically_normal());
+    }
+
     ref<Scene> SceneBuilder::getScene()
     {
         if (mpScene) return mpScene;
@@ -315,29 +644,37 @@ namespace Falcor
         // or makes sure that normal maps are removed if displacement is in use.
         prepareDisplacementMaps();
 
+        // The geometry passes run in parallel on the thread pool where possible.
+        // Timings are reported per stage.
         prepareSceneGraph();
         prepareMeshes();
         removeUnusedMeshes();
+        timeReport.measure("Preparing meshes");
         flattenStaticMeshInstances();
+        timeReport.measure("Flattening static mesh instances");
         pretransformStaticMeshes();
+        timeReport.measure("Pre-transforming static meshes");
         unifyTriangleWinding();
+        timeReport.measure("Unifying triangle winding");
         optimizeSceneGraph();
+        timeReport.measure("Optimizing scene graph");
         calculateMeshBoundingBoxes();
+        timeReport.measure("Calculating mesh bounding boxes");
         createMeshGroups();
         optimizeGeometry();
         sortMeshes();
+        timeReport.measure("Creating mesh groups");
         createGlobalBuffers();
         createCurveGlobalBuffers();
+        timeReport.measure("Creating global buffers");
         collectVolumeGrids();
         removeDuplicateSDFGrids();
 
-        timeReport.measure("Post processing geometry");
-
         optimizeMaterials();
         removeDuplicateMaterials();
-        quantizeTexCoords();
-
         timeReport.measure("Optimizing materials");
+        quantizeTexCoords();
+        timeReport.measure("Quantizing texture coordinates");
 
         // Prepare scene resources.
         createSceneGraph();
@@ -358,8 +695,19 @@ namespace Falcor
         // Write scene cache if requested.
         if (mWriteSceneCache)
         {
-            SceneCache::writeCache(mSceneData, mSceneCacheKey);
-            timeReport.measure("Writing cache");
+            bool hashDependencies = is_set(mFlags, Flags::HashCacheDependencies);
+            std::vector<std::filesystem::path> dependencies(mDependencies.begin(), mDependencies.end());
+            if (is_set(mFlags, Flags::AsyncCacheWrite))
+            {
+                // Only serialization and dependency records happen here, compression and writing the file continues in the background.
+                SceneCache::writeCacheAsync(mSceneData, mSceneCacheKey, std::move(dependencies), hashDependencies);
+                timeReport.measure("Serializing cache");
+            }
+            else
+            {
+                SceneCache::writeCache(mSceneData, mSceneCacheKey, dependencies, hashDependencies);
+                timeReport.measure("Writing cache");
+            }
         }
 
         // Create the scene object.
@@ -496,16 +844,15 @@ namespace Falcor
         }
 
         // Build new vertex/index buffers by merging identical vertices.
-        // The search is based on the topology defined by the original index buffer.
+        // The search is based on the topology defined by the original index buffer,
+        // i.e. only vertices using the same original vertex index are merged.
         //
-        // A linked-list of vertices is built for each original vertex index.
-        // We iterate over all vertices and first check if a vertex is identical to any of the other vertices
-        // using the same original vertex index. If not, a new vertex is inserted and added to the list.
-        // The 'heads' array point to the first vertex in each list, and each vertex has an associated next-pointer.
-        // This ensures that adding to the linked lists do not require any dynamic memory allocation.
+        // A short linked-list of vertices is kept for each original vertex index. Lists that grow too long
+        // (e.g. due to faceted normals or UV seams) are moved to a hash table keyed on the quantized vertex,
+        // which keeps merging linear in the number of vertices (see VertexMerger).
+        // The merger is thread local and reused across calls to avoid repeated allocations.
         //
-        const uint32_t invalidIndex = 0xffffffff;
-        std::vector<std::pair<Mesh::Vertex, uint32_t>> vertices;
+        std::vector<Mesh::Vertex> vertices;
         std::vector<uint32_t> indices(mesh.indexCount);
 
         if (pAttributeIndices)
@@ -517,7 +864,8 @@ namespace Falcor
         {
             vertices.reserve(mesh.vertexCount);
 
-            std::vector<uint32_t> heads(mesh.vertexCount, invalidIndex);
+            static thread_local VertexMerger vertexMerger;
+            vertexMerger.reset(mesh.vertexCount);
 
             for (uint32_t face = 0; face < mesh.faceCount; face++)
             {
@@ -525,36 +873,20 @@ namespace Falcor
                 {
                     const Mesh::Vertex v = mesh.getVertex(face, vert);
                     const uint32_t origIndex = mesh.pIndices[face * 3 + vert];
+                    FALCOR_ASSERT(origIndex < mesh.vertexCount);
 
-                    // Iterate over vertex list to check if it already exists.
-                    FALCOR_ASSERT(origIndex < heads.size());
-                    uint32_t index = heads[origIndex];
-                    bool found = false;
-
-                    while (index != invalidIndex)
-                    {
-                        if (compareVertices(v, vertices[index].first))
-                        {
-                            found = true;
-                            break;
-                        }
-                        index = vertices[index].second;
-                    }
+                    const uint32_t index = vertexMerger.findOrInsert(origIndex, v, vertices);
 
                     // Insert new vertex if we couldn't find it.
-                    if (!found)
+                    if (index == vertices.size())
                     {
-                        FALCOR_ASSERT(vertices.size() < std::numeric_limits<uint32_t>::max());
-                        index = (uint32_t)vertices.size();
-                        vertices.push_back({ v, heads[origIndex] });
+                        vertices.push_back(v);
 
                         if (pAttributeIndices)
                         {
                             pAttributeIndices->push_back(mesh.getAttributeIndices(face, vert));
                             FALCOR_ASSERT(vertices.size() == pAttributeIndices->size());
                         }
-
-                        heads[origIndex] = index;
                     }
 
                     // Store new vertex index.
@@ -564,7 +896,7 @@ namespace Falcor
         }
         else
         {
-            vertices = { mesh.vertexCount, std::make_pair(Mesh::Vertex{}, invalidIndex) };
+            vertices.resize(mesh.vertexCount);
 
             for (uint32_t face = 0; face < mesh.faceCount; face++)
             {
@@ -574,7 +906,7 @@ namespace Falcor
                     const uint32_t index = mesh.getAttributeIndex(mesh.positions, face, vert);
 
                     FALCOR_ASSERT(index < vertices.size());
-                    vertices[index].first = v;
+                    vertices[index] = v;
 
                     if (pAttributeIndices)
                     {
@@ -603,7 +935,7 @@ namespace Falcor
         size_t zeroCount = 0;
         for (const auto& v : vertices)
         {
-            validateVertex(v.first, invalidCount, zeroCount);
+            validateVertex(v, invalidCount, zeroCount);
         }
         if (invalidCount > 0) logWarning("The mesh '{}' has inf/nan vertex attributes at {} vertices. Please fix the asset.", mesh.name, invalidCount);
         if (zeroCount > 0) logWarning("The mesh '{}' has zero-length normals/tangents at {} vertices. Please fix the asset.", mesh.name, zeroCount);
@@ -630,7 +962,7 @@ namespace Falcor
         {
             uint32_t index = isIndexed ? i : indices[i];
             FALCOR_ASSERT(index < vertices.size());
-            const Mesh::Vertex& v = vertices[index].first;
+            const Mesh::Vertex& v = vertices[index];
 
             {
                 StaticVertexData s;
@@ -861,6 +1193,7 @@ namespace Falcor
     void SceneBuilder::loadMaterialTexture(const ref<Material>& pMaterial, Material::TextureSlot slot, const std::filesystem::path& path)
     {
         checkArgument(pMaterial != nullptr, "'pMaterial' is missing");
+        addDependency(path);
         if (!mpMaterialTextureLoader)
         {
             mpMaterialTextureLoader.reset(new MaterialTextureLoader(mSceneData.pMaterials->getTextureManager(), !is_set(mFlags, Flags::AssumeLinearSpaceTextures)));
@@ -1391,6 +1724,20 @@ namespace Falcor
 
         size_t flattenedInstanceCount = 0;
         std::vector<MeshSpec> newMeshes;
+        std::vector<MeshID> copySources; // Source mesh of each new mesh.
+
+        // Copies all mesh properties except for the vertex/index data.
+        auto copyMeshWithoutData = [](MeshSpec& mesh)
+        {
+            auto indexData = std::move(mesh.indexData);
+            auto staticData = std::move(mesh.staticData);
+            auto skinningData = std::move(mesh.skinningData);
+            MeshSpec copy = mesh;
+            mesh.indexData = std::move(indexData);
+            mesh.staticData = std::move(staticData);
+            mesh.skinningData = std::move(skinningData);
+            return copy;
+        };
 
         for (MeshID meshID{ 0 }; meshID.get() < (uint32_t)mMeshes.size(); ++meshID)
         {
@@ -1429,8 +1776,8 @@ namespace Falcor
                 else
                 {
                     // There is more than once instance, either static or dynamic.
-                    // Create a copy of the mesh. This can be expensive.
-                    meshCopy = mesh;
+                    // Create a copy of the mesh. The vertex/index data is copied in parallel below.
+                    meshCopy = copyMeshWithoutData(mesh);
                     meshCopy.name = mesh.name + "[" + std::to_string(instCount++) + "]";
                     // Make newMesh point to the copy
                     newMesh = &meshCopy;
@@ -1481,12 +1828,22 @@ namespace Falcor
                     newNode.meshes.push_back(newMeshID);
                     // Here, we do not insert nodeID into newInstances, effectively removing it.
                     // Add to vector of meshes to be appended to mMeshes
-                    newMeshes.push_back(*newMesh);
+                    copySources.push_back(meshID);
+                    newMeshes.push_back(std::move(meshCopy));
                 }
             }
             mesh.instances = newInstances;
         }
 
+        // Copy vertex/index data of the new meshes in parallel. The source data is not modified above.
+        Threading::parallelFor(0, newMeshes.size(), [&](size_t i)
+        {
+            const auto& srcMesh = mMeshes[copySources[i].get()];
+            newMeshes[i].indexData = srcMesh.indexData;
+            newMeshes[i].staticData = srcMesh.staticData;
+            newMeshes[i].skinningData = srcMesh.skinningData;
+        }, 1);
+
         if (mMeshes.size() == 0)
         {
             mMeshes = std::move(newMeshes);
@@ -1573,7 +1930,7 @@ namespace Falcor
         NodeID identityNodeID = addNode(Node{ "Identity", float4x4::identity(), float4x4::identity() });
         auto& identityNode = mSceneGraph[identityNodeID.get()];
 
-        size_t transformedMeshCount = 0;
+        std::vector<std::pair<MeshID, float4x4>> transformedMeshes;
         for (MeshID meshID{ 0 }; meshID.get() < (uint32_t)mMeshes.size(); ++meshID)
         {
             auto& mesh = mMeshes[meshID.get()];
@@ -1603,26 +1960,12 @@ namespace Falcor
             if (flippedWinding) mesh.isFrontFaceCW = !mesh.isFrontFaceCW;
 
             // Transform vertices to world space if not already identity transform.
+            // The vertices are transformed in parallel below.
             if (transform != float4x4::identity())
             {
                 FALCOR_ASSERT(!mesh.staticData.empty());
                 FALCOR_ASSERT((size_t)mesh.vertexCount == mesh.staticData.size());
-
-                float3x3 invTranspose3x3 = float3x3(transpose(inverse(transform)));
-                float3x3 transform3x3 = float3x3(transform);
-
-                for (auto& v : mesh.staticData)
-                {
-                    v.position = transformPoint(transform, v.position);
-                    v.normal = normalize(transformVector(invTranspose3x3, v.normal));
-                    v.tangent = float4(normalize(transformVector(transform3x3, v.tangent.xyz())), v.tangent.w);
-                    // TODO: We should flip the sign of v.tangent.w if flippedWinding is true.
-                    // Leaving that out for now for consistency with the shader code that needs the same fix.
-
-                    v.curveRadius = length(transformVector(transform3x3, float3(v.curveRadius, 0.f, 0.f)));
-                }
-
-                transformedMeshCount++;
+                transformedMeshes.push_back({ meshID, transform });
             }
 
             // Unlink mesh from its previous transform node.
@@ -1639,7 +1982,32 @@ namespace Falcor
             mesh.instances.insert(identityNodeID);
         }
 
-        if (transformedMeshCount > 0) logInfo("Pre-transformed {} static meshes to world space.", transformedMeshCount);
+        // Transform vertices. Meshes and vertex ranges within large meshes are processed in parallel.
+        Threading::parallelFor(0, transformedMeshes.size(), [&](size_t i)
+        {
+            const float4x4& transform = transformedMeshes[i].second;
+            auto& vertices = mMeshes[transformedMeshes[i].first.get()].staticData;
+
+            float3x3 invTranspose3x3 = float3x3(transpose(inverse(transform)));
+            float3x3 transform3x3 = float3x3(transform);
+
+            Threading::parallelForRange(0, vertices.size(), [&](size_t begin, size_t end)
+            {
+                for (size_t j = begin; j < end; ++j)
+                {
+                    auto& v = vertices[j];
+                    v.position = transformPoint(transform, v.position);
+                    v.normal = normalize(transformVector(invTranspose3x3, v.normal));
+                    v.tangent = float4(normalize(transformVector(transform3x3, v.tangent.xyz())), v.tangent.w);
+                    // TODO: We should flip the sign of v.tangent.w if flippedWinding is true.
+                    // Leaving that out for now for consistency with the shader code that needs the same fix.
+
+                    v.curveRadius = length(transformVector(transform3x3, float3(v.curveRadius, 0.f, 0.f)));
+                }
+            }, kVertexGrainSize);
+        }, 1);
+
+        if (!transformedMeshes.empty()) logInfo("Pre-transformed {} static meshes to world space.", transformedMeshes.size());
     }
 
     void SceneBuilder::flipTriangleWinding(MeshSpec& mesh)
@@ -1707,38 +2075,33 @@ namespace Falcor
         // Note that this pass needs to run *after* pre-transformation of static meshes to world space,
         // as those transforms may flip the winding.
 
-        size_t flippedMeshCount = 0;
-        for (uint32_t meshID = 0; meshID < (uint32_t)mMeshes.size(); meshID++)
+        // Collect meshes that are not already front face counter-clockwise.
+        std::vector<MeshSpec*> flippedMeshes;
+        for (auto& mesh : mMeshes)
         {
-            auto& mesh = mMeshes[meshID];
-
-            // Skip meshes that are already front face counter-clockwise.
-            if (mesh.isFrontFaceCW == false) continue;
-
-            flipTriangleWinding(mesh);
-            FALCOR_ASSERT(!mesh.isFrontFaceCW);
-
-            flippedMeshCount++;
+            if (mesh.isFrontFaceCW) flippedMeshes.push_back(&mesh);
         }
 
+        Threading::parallelFor(0, flippedMeshes.size(), [&](size_t i)
+        {
+            flipTriangleWinding(*flippedMeshes[i]);
+            FALCOR_ASSERT(!flippedMeshes[i]->isFrontFaceCW);
+        }, 1);
+
+        const size_t flippedMeshCount = flippedMeshes.size();
         if (flippedMeshCount > 0) logInfo("Flipped triangle winding for {} out of {} meshes.", flippedMeshCount, mMeshes.size());
     }
 
     void SceneBuilder::calculateMeshBoundingBoxes()
     {
-        for (auto& mesh : mMeshes)
+        Threading::parallelFor(0, mMeshes.size(), [&](size_t i)
         {
+            auto& mesh = mMeshes[i];
             FALCOR_ASSERT(!mesh.staticData.empty());
             FALCOR_ASSERT((size_t)mesh.vertexCount == mesh.staticData.size());
 
-            AABB meshBB;
-            for (auto& v : mesh.staticData)
-            {
-                meshBB.include(v.position);
-            }
-
-            mesh.boundingBox = meshBB;
-        }
+            mesh.boundingBox = computeBoundingBox(mesh.staticData);
+        }, 1);
     }
 
     void SceneBuilder::createMeshGroups()
@@ -1891,6 +2254,11 @@ namespace Falcor
     }
 
     std::pair<std::optional<MeshID>, std::optional<MeshID>> SceneBuilder::splitMesh(const MeshID meshID, const int axis, const float pos)
+    {
+        return applyMeshSplit(meshID, computeMeshSplit(meshID, axis, pos));
+    }
+
+    SceneBuilder::MeshSplit SceneBuilder::computeMeshSplit(const MeshID meshID, const int axis, const float pos) const
     {
         // Splits a mesh by an axis-aligned plane.
         // Each triangle is placed on either the left or right side of the plane with respect to its centroid.
@@ -1911,9 +2279,19 @@ namespace Falcor
             throw RuntimeError("Cannot split mesh '{}', only triangle list topology supported", mesh.name);
         }
 
+        MeshSplit split;
+
         // Early out if mesh is fully on either side of the splitting plane.
-        if (mesh.boundingBox.maxPoint[axis] < pos) return { meshID, std::nullopt };
-        else if (mesh.boundingBox.minPoint[axis] >= pos) return { std::nullopt, meshID };
+        if (mesh.boundingBox.maxPoint[axis] < pos)
+        {
+            split.hasLeft = true;
+            return split;
+        }
+        else if (mesh.boundingBox.minPoint[axis] >= pos)
+        {
+            split.hasRight = true;
+            return split;
+        }
 
         // Setup mesh specs.
         auto createSpec = [](const MeshSpec& mesh, const std::string& name)
@@ -1939,10 +2317,31 @@ namespace Falcor
         // Check that no triangles were added or removed.
         FALCOR_ASSERT(leftMesh.getTriangleCount() + rightMesh.getTriangleCount() == mesh.getTriangleCount());
 
+        split.hasLeft = leftMesh.getTriangleCount() > 0;
+        split.hasRight = rightMesh.getTriangleCount() > 0;
+
         // It is possible all triangles ended up on either side of the splitting plane.
-        // In that case, there is no need to modify the original mesh and we'll just return.
-        if (leftMesh.getTriangleCount() == 0) return { std::nullopt, meshID };
-        else if (rightMesh.getTriangleCount() == 0) return { meshID, std::nullopt };
+        // In that case, there is no need to modify the original mesh.
+        if (split.hasLeft && split.hasRight)
+        {
+            split.meshes = std::make_pair(std::move(leftMesh), std::move(rightMesh));
+        }
+
+        return split;
+    }
+
+    std::pair<std::optional<MeshID>, std::optional<MeshID>> SceneBuilder::applyMeshSplit(const MeshID meshID, MeshSplit&& split)
+    {
+        FALCOR_ASSERT_LT(meshID.get(), mMeshes.size());
+        FALCOR_ASSERT(split.hasLeft || split.hasRight);
+
+        if (!split.meshes)
+        {
+            return { split.hasLeft ? std::optional<MeshID>(meshID) : std::nullopt, split.hasRight ? std::optional<MeshID>(meshID) : std::nullopt };
+        }
+
+        auto& [leftMesh, rightMesh] = *split.meshes;
+        const auto& mesh = mMeshes[meshID.get()];
 
         logDebug(
             "Mesh '{}' with {} triangles was split into two meshes with '{}' and '{}' triangles, respectively.",
@@ -1953,19 +2352,19 @@ namespace Falcor
         // The left mesh replaces the existing mesh.
         // The right mesh is appended at the end of the mesh list and linked to the instances.
         FALCOR_ASSERT(leftMesh.vertexCount > 0 && rightMesh.vertexCount > 0);
-        mMeshes[meshID.get()] = std::move(leftMesh);
-
         MeshID rightMeshID(mMeshes.size());
         for (auto nodeID : mesh.instances)
         {
             mSceneGraph.at(nodeID.get()).meshes.push_back(rightMeshID);
         }
+
+        mMeshes[meshID.get()] = std::move(leftMesh);
         mMeshes.push_back(std::move(rightMesh));
 
         return { meshID, rightMeshID };
     }
 
-    void SceneBuilder::splitIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos)
+    void SceneBuilder::splitIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos) const
     {
         FALCOR_ASSERT(mesh.indexCount > 0 && !mesh.indexData.empty());
 
@@ -2018,15 +2417,14 @@ namespace Falcor
             m.use16BitIndices = (m.vertexCount <= (1u << 16)) && !(is_set(mFlags, Flags::Force32BitIndices));
             if (m.use16BitIndices) m.indexData = compact16BitIndices(m.indexData);
 
-            m.boundingBox = AABB();
-            for (auto& v : m.staticData) m.boundingBox.include(v.position);
+            m.boundingBox = computeBoundingBox(m.staticData);
         };
 
         finalizeMesh(leftMesh);
         finalizeMesh(rightMesh);
     }
 
-    void SceneBuilder::splitNonIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos)
+    void SceneBuilder::splitNonIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos) const
     {
         FALCOR_ASSERT(mesh.indexCount == 0 && mesh.indexData.empty());
         throw RuntimeError("SceneBuilder::splitNonIndexedMesh() not implemented");
@@ -2198,11 +2596,18 @@ namespace Falcor
         const float pos = bb.center()[axis];
 
         // Partition all meshes by the splitting plane.
+        // The splits are computed in parallel and applied in order, so mesh IDs are assigned deterministically.
+        std::vector<MeshSplit> splits(meshGroup.meshList.size());
+        Threading::parallelFor(0, splits.size(), [&](size_t i)
+        {
+            splits[i] = computeMeshSplit(meshGroup.meshList[i], axis, pos);
+        }, 1);
+
         std::vector<MeshID> leftMeshes, rightMeshes;
 
-        for (auto meshID : meshGroup.meshList)
+        for (size_t i = 0; i < splits.size(); ++i)
         {
-            auto result = splitMesh(meshID, axis, pos);
+            auto result = applyMeshSplit(meshGroup.meshList[i], std::move(splits[i]));
             if (auto leftMeshID = result.first) leftMeshes.push_back(*leftMeshID);
             if (auto rightMeshID = result.second) rightMeshes.push_back(*rightMeshID);
         }
@@ -2332,31 +2737,55 @@ namespace Falcor
             throw RuntimeError("Trying to build a scene that exceeds supported mesh data size.");
         }
 
-        mSceneData.meshIndexData.reserve(totalIndexDataCount);
-        mSceneData.meshStaticData.reserve(totalStaticVertexCount);
-        mSceneData.meshSkinningData.reserve(totalSkinningVertexCount);
-
-        // Copy all vertex and index data into the global buffers.
+        // Compute the offsets of all meshes into the global buffers.
+        size_t indexDataOffset = 0;
+        size_t staticVertexOffset = 0;
+        size_t skinningVertexOffset = 0;
         for (auto& mesh : mMeshes)
         {
-            mesh.staticVertexOffset = (uint32_t)mSceneData.meshStaticData.size();
-            mesh.skinningVertexOffset = (uint32_t)mSceneData.meshSkinningData.size();
+            mesh.staticVertexOffset = (uint32_t)staticVertexOffset;
+            mesh.skinningVertexOffset = (uint32_t)skinningVertexOffset;
             mesh.prevVertexOffset = mesh.skinningVertexOffset;
+            staticVertexOffset += mesh.staticData.size();
+
+            if (isIndexed)
+            {
+                mesh.indexOffset = (uint32_t)indexDataOffset;
+                indexDataOffset += mesh.indexData.size();
+            }
+
+            if (mesh.isSkinned())
+            {
+                FALCOR_ASSERT(!mesh.skinningData.empty());
+                skinningVertexOffset += mesh.skinningData.size();
+            }
+        }
+
+        mSceneData.meshIndexData.resize(indexDataOffset);
+        mSceneData.meshStaticData.resize(staticVertexOffset);
+        mSceneData.meshSkinningData.resize(skinningVertexOffset);
+
+        // Copy all vertex and index data into the global buffers.
+        // Each mesh writes to its own range, so meshes and vertex ranges within large meshes are processed in parallel.
+        Threading::parallelFor(0, mMeshes.size(), [&](size_t meshIndex)
+        {
+            auto& mesh = mMeshes[meshIndex];
 
             // Insert the static vertex data in the global array.
-            // The vertices are automatically converted to their packed format in this step.
-            mSceneData.meshStaticData.insert(mSceneData.meshStaticData.end(), mesh.staticData.begin(), mesh.staticData.end());
+            // The vertices are converted to their packed format in this step.
+            Threading::parallelForRange(0, mesh.staticData.size(), [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end; ++i) mSceneData.meshStaticData[mesh.staticVertexOffset + i].pack(mesh.staticData[i]);
+            }, kVertexGrainSize);
 
             if (isIndexed)
             {
-                mesh.indexOffset = (uint32_t)mSceneData.meshIndexData.size();
-                mSceneData.meshIndexData.insert(mSceneData.meshIndexData.end(), mesh.indexData.begin(), mesh.indexData.end());
+                std::copy(mesh.indexData.begin(), mesh.indexData.end(), mSceneData.meshIndexData.begin() + mesh.indexOffset);
             }
 
             if (mesh.isSkinned())
             {
-                FALCOR_ASSERT(!mesh.skinningData.empty());
-                mSceneData.meshSkinningData.insert(mSceneData.meshSkinningData.end(), mesh.skinningData.begin(), mesh.skinningData.end());
+                std::copy(mesh.skinningData.begin(), mesh.skinningData.end(), mSceneData.meshSkinningData.begin() + mesh.skinningVertexOffset);
 
                 // Patch vertex index references.
                 for (uint32_t i = 0; i < mesh.skinningData.size(); ++i)
@@ -2366,10 +2795,10 @@ namespace Falcor
             }
 
             // Free the mesh local data.
-            mesh.indexData.clear();
-            mesh.staticData.clear();
-            mesh.skinningData.clear();
-        }
+            mesh.indexData = {};
+            mesh.staticData = {};
+            mesh.skinningData = {};
+        }, 1);
 
         // Initialize offsets for prev vertex data for vertex-animated meshes
         uint32_t prevOffset = (uint32_t)mSceneData.meshSkinningData.size();
@@ -2490,49 +2919,94 @@ namespace Falcor
         // Match texture coordinate quantization for textured emissives to format of PackedEmissiveTriangle.
         // This is to avoid mismatch when sampling and evaluating emissive triangles.
         // Note that non-emissive meshes are unmodified and use full precision texcoords.
-        for (auto& mesh : mMeshes)
+
+        // Collect meshes with textured emissive materials.
+        struct QuantizedMesh
+        {
+            const MeshSpec* pMesh;
+            uint2 maxTexDim;
+            float2 minTexCrd = float2(std::numeric_limits<float>::infinity());
+            float2 maxTexCrd = float2(-std::numeric_limits<float>::infinity());
+            float2 maxError = float2(0);
+        };
+        std::vector<QuantizedMesh> quantizedMeshes;
+
+        for (const auto& mesh : mMeshes)
         {
             const auto& pMaterial = mSceneData.pMaterials->getMaterial(mesh.materialId)->toBasicMaterial();
             if (pMaterial && pMaterial->getEmissiveTexture() != nullptr)
             {
-                // Quantize texture coordinates to fp16. Also track the bounds and max error.
-                float2 minTexCrd = float2(std::numeric_limits<float>::infinity());
-                float2 maxTexCrd = float2(-std::numeric_limits<float>::infinity());
-                float2 maxError = float2(0);
+                quantizedMeshes.push_back({ &mesh, pMaterial->getMaxTextureDimensions() });
+            }
+        }
 
-                for (uint32_t i = 0; i < mesh.staticVertexCount; ++i)
-                {
-                    auto& v = mSceneData.meshStaticData[mesh.staticVertexOffset + i];
-                    float2 texCrd = v.texCrd;
-                    minTexCrd = min(minTexCrd, texCrd);
-                    maxTexCrd = max(maxTexCrd, texCrd);
-                    v.texCrd = f16tof32(f32tof16(texCrd));
-                    maxError = max(maxError, abs(v.texCrd - texCrd));
-                }
+        // Quantize texture coordinates to fp16 in parallel. Also track the bounds and max error.
+        Threading::parallelFor(0, quantizedMeshes.size(), [&](size_t i)
+        {
+            auto& q = quantizedMeshes[i];
+            const MeshSpec& mesh = *q.pMesh;
 
-                // Issue warning if quantization errors are too large.
-                float2 maxAbsCrd = max(abs(minTexCrd), abs(maxTexCrd));
-                if (maxAbsCrd.x > HLF_MAX || maxAbsCrd.y > HLF_MAX)
-                {
-                    logWarning("Texture coordinates for emissive textured mesh '{}' are outside the representable range, expect rendering errors.", mesh.name);
-                }
-                else
-                {
-                    // Compute maximum quantization error in texels.
-                    // The texcoords are used for all texture channels so taking the maximum dimensions.
-                    uint2 maxTexDim = pMaterial->getMaxTextureDimensions();
-                    maxError *= float2(maxTexDim);
-                    float maxTexelError = std::max(maxError.x, maxError.y);
+            struct Stats
+            {
+                float2 minTexCrd;
+                float2 maxTexCrd;
+                float2 maxError;
+            };
+            const Stats identity = { q.minTexCrd, q.maxTexCrd, q.maxError };
 
-                    if (maxTexelError > kMaxTexelError)
+            Stats stats = Threading::parallelReduce(0, (size_t)mesh.staticVertexCount, identity,
+                [&](size_t begin, size_t end, Stats stats)
+                {
+                    for (size_t j = begin; j < end; ++j)
                     {
-                        logWarning(
-                            "Texture coordinates for emissive textured mesh '{}' have a large quantization error of {} texels."
-                            "The coordinate range is [{},{}] x [{},{}] for maximum texture dimensions ({},{}).",
-                            mesh.name, maxTexelError,
-                            minTexCrd.x, maxTexCrd.x, minTexCrd.y, maxTexCrd.y, maxTexDim.x, maxTexDim.y
-                        );
+                        auto& v = mSceneData.meshStaticData[mesh.staticVertexOffset + j];
+                        float2 texCrd = v.texCrd;
+                        stats.minTexCrd = min(stats.minTexCrd, texCrd);
+                        stats.maxTexCrd = max(stats.maxTexCrd, texCrd);
+                        v.texCrd = f16tof32(f32tof16(texCrd));
+                        stats.maxError = max(stats.maxError, abs(v.texCrd - texCrd));
                     }
+                    return stats;
+                },
+                [](const Stats& a, const Stats& b)
+                {
+                    return Stats{ min(a.minTexCrd, b.minTexCrd), max(a.maxTexCrd, b.maxTexCrd), max(a.maxError, b.maxError) };
+                },
+                kVertexGrainSize);
+
+            q.minTexCrd = stats.minTexCrd;
+            q.maxTexCrd = stats.maxTexCrd;
+            q.maxError = stats.maxError;
+        }, 1);
+
+        for (const auto& q : quantizedMeshes)
+        {
+            const MeshSpec& mesh = *q.pMesh;
+            const float2 minTexCrd = q.minTexCrd;
+            const float2 maxTexCrd = q.maxTexCrd;
+
+            // Issue warning if quantization errors are too large.
+            float2 maxAbsCrd = max(abs(minTexCrd), abs(maxTexCrd));
+            if (maxAbsCrd.x > HLF_MAX || maxAbsCrd.y > HLF_MAX)
+            {
+                logWarning("Texture coordinates for emissive textured mesh '{}' are outside the representable range, expect rendering errors.", mesh.name);
+            }
+            else
+            {
+                // Compute maximum quantization error in texels.
+                // The texcoords are used for all texture channels so taking the maximum dimensions.
+                uint2 maxTexDim = q.maxTexDim;
+                float2 maxError = q.maxError * float2(maxTexDim);
+                float maxTexelError = std::max(maxError.x, maxError.y);
+
+                if (maxTexelError > kMaxTexelError)
+                {
+                    logWarning(
+                        "Texture coordinates for emissive textured mesh '{}' have a large quantization error of {} texels."
+                        "The coordinate range is [{},{}] x [{},{}] for maximum texture dimensions ({},{}).",
+                        mesh.name, maxTexelError,
+                        minTexCrd.x, maxTexCrd.x, minTexCrd.y, maxTexCrd.y, maxTexDim.x, maxTexDim.y
+                    );
                 }
             }
         }
@@ -2858,8 +3332,11 @@ namespace Falcor
         flags.value("DontUseDisplacement", SceneBuilder::Flags::DontUseDisplacement);
         flags.value("UseCompressedHitInfo", SceneBuilder::Flags::UseCompressedHitInfo);
         flags.value("TessellateCurvesIntoPolyTubes", SceneBuilder::Flags::TessellateCurvesIntoPolyTubes);
+        flags.value("UseCompressedTextureCache", SceneBuilder::Flags::UseCompressedTextureCache);
+        flags.value("AsyncCacheWrite", SceneBuilder::Flags::AsyncCacheWrite);
         flags.value("UseCache", SceneBuilder::Flags::UseCache);
         flags.value("RebuildCache", SceneBuilder::Flags::RebuildCache);
+        flags.value("HashCacheDependencies", SceneBuilder::Flags::HashCacheDependencies);
         ScriptBindings::addEnumBinaryOperators(flags);
 
         pybind11::class_<SceneBuilder> sceneBuilder(m, "SceneBuilder");
@@ -2882,6 +3359,7 @@ namespace Falcor
         sceneBuilder.def("getMaterial", &SceneBuilder::getMaterial, "name"_a);
         sceneBuilder.def("loadMaterialTexture", &SceneBuilder::loadMaterialTexture, "material"_a, "slot"_a, "path"_a);
         sceneBuilder.def("waitForMaterialTextureLoading", &SceneBuilder::waitForMaterialTextureLoading);
+        sceneBuilder.def("addDependency", &SceneBuilder::addDependency, "path"_a);
         sceneBuilder.def("addGridVolume", &SceneBuilder::addGridVolume, "gridVolume"_a, "nodeID"_a = NodeID::kInvalidID);
         sceneBuilder.def("addVolume", &SceneBuilder::addGridVolume, "gridVolume"_a, "nodeID"_a = NodeID::kInvalidID); // PYTHONDEPRECATED
         sceneBuilder.def("getGridVolume", &SceneBuilder::getGridVolume, "name"_a);
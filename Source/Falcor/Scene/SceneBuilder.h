@@ -46,6 +46,8 @@
 
 #include <filesystem>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -76,9 +78,12 @@ namespace Falcor
             DontUseDisplacement             = 0x4000,   ///< Don't use displacement mapping.
             UseCompressedHitInfo            = 0x8000,   ///< Use compressed hit info (on scenes with triangle meshes only).
             TessellateCurvesIntoPolyTubes   = 0x10000,  ///< Tessellate curves into poly-tubes (the default is linear swept spheres).
+            UseCompressedTextureCache       = 0x20000,  ///< Transcode material textures to block-compressed formats once and load them from a persistent on-disk cache. Not applied to scenes loaded from the scene cache.
 
+            AsyncCacheWrite                 = 0x08000000, ///< Write the scene cache in the background. The scene is available before the cache file is written.
             UseCache                        = 0x10000000, ///< Enable scene caching. This caches the runtime scene representation on disk to reduce load time.
             RebuildCache                    = 0x20000000, ///< Rebuild scene cache.
+            HashCacheDependencies           = 0x40000000, ///< Store content hashes of all scene dependencies in the scene cache. Files that are touched but not modified then don't invalidate the cache.
 
             Default = None
         };
@@ -369,6 +374,15 @@ namespace Falcor
         */
         Flags getFlags() const { return mFlags; }
 
+        /** Record a file the scene depends on.
+            Dependencies are stored in the scene cache and a cache is invalidated if any of its dependencies change.
+            Importers should call this for every file they read (included scene files, meshes, textures, grids, ...).
+            Relative paths are resolved using the data directories. Paths containing <UDIM> or <MIP> tokens record
+            the containing directory instead. This function is thread-safe.
+            \param[in] path File path.
+        */
+        void addDependency(const std::filesystem::path& path);
+
         /** Set the render settings.
         */
         void setRenderSettings(const Scene::RenderSettings& renderSettings) { mSceneData.renderSettings = renderSettings; }
@@ -754,6 +768,8 @@ namespace Falcor
         ref<Scene> mpScene;
         SceneCache::Key mSceneCacheKey;
         bool mWriteSceneCache = false;  ///< True if scene cache should be written after import.
+        std::set<std::filesystem::path> mDependencies; ///< Files the scene depends on (recorded only if the scene cache is written).
+        std::mutex mDependencyMutex;
 
         SceneGraph mSceneGraph;
 
@@ -773,13 +789,32 @@ namespace Falcor
         void flipTriangleWinding(MeshSpec& mesh);
         void updateSDFGridID(SdfGridID oldID, SdfGridID newID);
 
+        /** Result of splitting a mesh by an axis-aligned splitting plane.
+        */
+        struct MeshSplit
+        {
+            bool hasLeft = false;                                   ///< True if the mesh has triangles on the left side.
+            bool hasRight = false;                                  ///< True if the mesh has triangles on the right side.
+            std::optional<std::pair<MeshSpec, MeshSpec>> meshes;    ///< Left and right meshes, if the mesh needs to be split in two.
+        };
+
         /** Split a mesh by the given axis-aligned splitting plane.
             \return Pair of optional mesh IDs for the meshes on the left and right side, respectively.
         */
         std::pair<std::optional<MeshID>, std::optional<MeshID>> splitMesh(MeshID meshID, const int axis, const float pos);
 
-        void splitIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos);
-        void splitNonIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos);
+        /** Compute the split of a mesh by the given axis-aligned splitting plane.
+            This does not modify the scene builder and can be called from multiple threads.
+        */
+        MeshSplit computeMeshSplit(MeshID meshID, const int axis, const float pos) const;
+
+        /** Apply a mesh split computed by computeMeshSplit().
+            \return Pair of optional mesh IDs for the meshes on the left and right side, respectively.
+        */
+        std::pair<std::optional<MeshID>, std::optional<MeshID>> applyMeshSplit(MeshID meshID, MeshSplit&& split);
+
+        void splitIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos) const;
+        void splitNonIndexedMesh(const MeshSpec& mesh, MeshSpec& leftMesh, MeshSpec& rightMesh, const int axis, const float pos) const;
 
         // Mesh group helpers
         size_t countTriangles(const MeshGroup& meshGroup) const;
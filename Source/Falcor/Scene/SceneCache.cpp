@@ -30,11 +30,17 @@
 #include "Material/HairMaterial.h"
 #include "Material/ClothMaterial.h"
 #include "Material/MaterialTextureLoader.h"
+#include "Core/Platform/LockFile.h"
+#include "Core/Platform/MemoryMappedFile.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
 
-#include <lz4_stream/lz4_stream.h>
+#include <lz4.h>
 
+#include <array>
+#include <atomic>
 #include <fstream>
+#include <random>
 
 namespace Falcor
 {
@@ -43,13 +49,16 @@ namespace Falcor
         /** Specfies the current cache file version.
             This needs to be incremented every time the file format changes!
         */
-        const uint32_t kVersion = 25;
+        const uint32_t kVersion = 27;
 
         /** Scene cache directory (subdirectory in the application data directory).
         */
         const std::string kDirectory = "NVIDIA/Falcor/SceneCache";
 
-        const size_t kBlockSize = 1 * 1024 * 1024;
+        /** Size of independently compressed chunks.
+            Sections are split into chunks so they can be decompressed in parallel.
+        */
+        const size_t kChunkSize = 4 * 1024 * 1024;
 
         const char* kMagic = "FalcorS$";
         struct Header
@@ -62,18 +71,46 @@ namespace Falcor
                 return std::memcmp(magic, kMagic, sizeof(Header::magic)) == 0 && version == kVersion;
             }
         };
+
+        /** Entry in the chunk table.
+            Offsets are relative to the start of the payload (directly after the section table).
+        */
+        struct ChunkEntry
+        {
+            uint64_t offset;
+            uint32_t compressedSize;
+            uint32_t uncompressedSize;
+        };
     }
 
-    /** Wrapper around std::ostream to ease serialization of basic types.
+    /** Identifies a section in the cache file.
+    */
+    enum class SceneCache::SectionID : uint32_t
+    {
+        Scene,              ///< Path, settings, cameras, lights, env map, scene graph, metadata.
+        Grids,              ///< Grids and grid volumes.
+        Materials,          ///< Material system.
+        Animations,         ///< Animations.
+        Meshes,             ///< Mesh descriptors, instances and groups.
+        MeshIndexData,      ///< Raw mesh index data.
+        MeshStaticData,     ///< Raw static vertex data.
+        MeshSkinningData,   ///< Raw skinning vertex data.
+        Curves,             ///< Curve descriptors, instances and custom primitives.
+        CurveIndexData,     ///< Raw curve index data.
+        CurveStaticData,    ///< Raw curve vertex data.
+
+        Count
+    };
+
+    /** Serializes basic types into a memory buffer.
     */
     class SceneCache::OutputStream
     {
     public:
-        OutputStream(std::ostream& stream) : mStream(stream) {}
-
         void write(const void* data, size_t len)
         {
-            mStream.write(reinterpret_cast<const char*>(data), len);
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+            mBuffer.insert(mBuffer.end(), bytes, bytes + len);
         }
 
         template<typename T>
@@ -117,20 +154,24 @@ namespace Falcor
             if (hasValue) write(opt.value());
         }
 
+        const std::vector<uint8_t>& getBuffer() const { return mBuffer; }
+
     private:
-        std::ostream& mStream;
+        std::vector<uint8_t> mBuffer;
     };
 
-    /** Wrapper around std::istream to ease serialization of basic types.
+    /** Deserializes basic types from a memory buffer.
     */
     class SceneCache::InputStream
     {
     public:
-        InputStream(std::istream& stream) : mStream(stream) {}
+        InputStream(const void* data, size_t size) : mpData(reinterpret_cast<const uint8_t*>(data)), mSize(size) {}
 
         void read(void* data, size_t len)
         {
-            mStream.read(reinterpret_cast<char*>(data), len);
+            if (len > mSize - mOffset) throw RuntimeError("Unexpected end of scene cache data.");
+            std::memcpy(data, mpData + mOffset, len);
+            mOffset += len;
         }
 
         template<typename T>
@@ -165,13 +206,15 @@ namespace Falcor
         void read(std::vector<T>& vec)
         {
             uint64_t len = read<uint64_t>();
-            vec.resize(len);
             if constexpr (std::is_trivial<T>::value && !std::is_same<T, bool>::value)
             {
+                if (len > (mSize - mOffset) / sizeof(T)) throw RuntimeError("Unexpected end of scene cache data.");
+                vec.resize(len);
                 read(vec.data(), len * sizeof(T));
             }
             else
             {
+                vec.resize(len);
                 for (auto& item : vec) read(item);
             }
         }
@@ -188,49 +231,354 @@ namespace Falcor
             }
         }
 
+        /// Number of bytes consumed so far.
+        size_t getOffset() const { return mOffset; }
+
+    private:
+        const uint8_t* mpData;
+        size_t mSize;
+        size_t mOffset = 0;
+    };
+
+    /** Collects sections and writes them as independently compressed chunks, followed by a section table.
+        All section data is owned by the writer, so compression and writing can happen on another thread.
+    */
+    class SceneCache::SectionWriter
+    {
+    public:
+        /// Get the stream for serializing a section.
+        OutputStream& getStream(SectionID id)
+        {
+            auto& section = mSections[(size_t)id];
+            section.used = true;
+            return section.stream;
+        }
+
+        /// Add a section holding a copy of the raw contents of a vector.
+        template<typename T>
+        void addRaw(SectionID id, const std::vector<T>& vec)
+        {
+            static_assert(std::is_trivially_copyable<T>::value);
+            getStream(id).write(vec.data(), vec.size() * sizeof(T));
+        }
+
+        /// Compress all sections (in parallel) and write the section table and payload to a stream.
+        void write(std::ostream& os)
+        {
+            struct Chunk
+            {
+                const uint8_t* pData;
+                int size;
+                std::vector<uint8_t> compressed;
+            };
+
+            // Split sections into chunks.
+            std::vector<Chunk> chunks;
+            std::vector<std::pair<SectionID, std::pair<size_t, size_t>>> sectionChunks; // Section ID and range of chunks.
+            for (size_t i = 0; i < mSections.size(); ++i)
+            {
+                const auto& section = mSections[i];
+                if (!section.used) continue;
+
+                const auto& buffer = section.stream.getBuffer();
+                size_t firstChunk = chunks.size();
+                for (size_t offset = 0; offset < buffer.size(); offset += kChunkSize)
+                {
+                    chunks.push_back({ buffer.data() + offset, (int)std::min(kChunkSize, buffer.size() - offset), {} });
+                }
+                sectionChunks.push_back({ (SectionID)i, { firstChunk, chunks.size() } });
+            }
+
+            // Compress chunks.
+            std::atomic<bool> failed{ false };
+            Threading::parallelFor(0, chunks.size(), [&](size_t i)
+            {
+                auto& chunk = chunks[i];
+                chunk.compressed.resize(LZ4_compressBound(chunk.size));
+                int compressedSize = LZ4_compress_default(reinterpret_cast<const char*>(chunk.pData), reinterpret_cast<char*>(chunk.compressed.data()), chunk.size, (int)chunk.compressed.size());
+                if (compressedSize <= 0) failed = true;
+                else chunk.compressed.resize(compressedSize);
+            }, 1);
+            if (failed) throw RuntimeError("Failed to compress scene cache section.");
+
+            // Write section table.
+            OutputStream table;
+            uint64_t offset = 0;
+            table.write((uint32_t)sectionChunks.size());
+            for (const auto& [id, range] : sectionChunks)
+            {
+                table.write(id);
+                table.write((uint64_t)mSections[(size_t)id].stream.getBuffer().size());
+                table.write((uint64_t)(range.second - range.first));
+                for (size_t i = range.first; i < range.second; ++i)
+                {
+                    ChunkEntry entry{ offset, (uint32_t)chunks[i].compressed.size(), (uint32_t)chunks[i].size };
+                    table.write(entry);
+                    offset += entry.compressedSize;
+                }
+            }
+            table.write(offset);
+            os.write(reinterpret_cast<const char*>(table.getBuffer().data()), table.getBuffer().size());
+
+            // Write payload.
+            for (const auto& chunk : chunks) os.write(reinterpret_cast<const char*>(chunk.compressed.data()), chunk.compressed.size());
+        }
+
     private:
-        std::istream& mStream;
+        struct Section
+        {
+            bool used = false;
+            OutputStream stream;
+        };
+
+        std::array<Section, (size_t)SectionID::Count> mSections;
     };
 
+    /** Parses the section table of a memory-mapped cache file and decompresses sections in parallel.
+        Raw sections can be decompressed directly into their destination vectors.
+    */
+    class SceneCache::SectionReader
+    {
+    public:
+        /** Parse the section table.
+            \param[in] stream Stream positioned at the start of the section table. Its data must cover the whole payload.
+            \param[in] pData Pointer to the stream data.
+            \param[in] size Size of the stream data.
+        */
+        SectionReader(InputStream& stream, const uint8_t* pData, size_t size)
+        {
+            uint32_t sectionCount = stream.read<uint32_t>();
+            for (uint32_t i = 0; i < sectionCount; ++i)
+            {
+                auto id = stream.read<SectionID>();
+                if ((size_t)id >= mSections.size()) throw RuntimeError("Invalid section in scene cache.");
+                auto& section = mSections[(size_t)id];
+                section.present = true;
+                stream.read(section.size);
+                stream.read(section.chunks);
+            }
+            uint64_t payloadSize = stream.read<uint64_t>();
+
+            mpPayload = pData + stream.getOffset();
+            if (payloadSize > size - stream.getOffset()) throw RuntimeError("Scene cache file is truncated.");
+
+            for (const auto& section : mSections)
+            {
+                for (const auto& chunk : section.chunks)
+                {
+                    if (chunk.offset + chunk.compressedSize > payloadSize) throw RuntimeError("Invalid chunk in scene cache.");
+                }
+            }
+        }
+
+        /// Register a vector as destination of a raw section. The section is decompressed directly into the vector.
+        template<typename T>
+        void readRaw(SectionID id, std::vector<T>& vec)
+        {
+            static_assert(std::is_trivially_copyable<T>::value);
+            auto& section = getSection(id);
+            if (section.size % sizeof(T) != 0) throw RuntimeError("Invalid raw section size in scene cache.");
+            vec.resize(section.size / sizeof(T));
+            section.pDst = reinterpret_cast<uint8_t*>(vec.data());
+        }
+
+        /// Decompress all sections in parallel.
+        void decompress()
+        {
+            struct Job
+            {
+                const ChunkEntry* pChunk;
+                uint8_t* pDst;
+            };
+            std::vector<Job> jobs;
+
+            for (auto& section : mSections)
+            {
+                if (!section.present) continue;
+                if (!section.pDst)
+                {
+                    section.buffer.resize(section.size);
+                    section.pDst = section.buffer.data();
+                }
+                uint64_t dstOffset = 0;
+                for (const auto& chunk : section.chunks)
+                {
+                    if (dstOffset + chunk.uncompressedSize > section.size) throw RuntimeError("Invalid chunk in scene cache.");
+                    jobs.push_back({ &chunk, section.pDst + dstOffset });
+                    dstOffset += chunk.uncompressedSize;
+                }
+                if (dstOffset != section.size) throw RuntimeError("Invalid section size in scene cache.");
+            }
+
+            std::atomic<bool> failed{ false };
+            Threading::parallelFor(0, jobs.size(), [&](size_t i)
+            {
+                const auto& job = jobs[i];
+                int size = LZ4_decompress_safe(reinterpret_cast<const char*>(mpPayload + job.pChunk->offset), reinterpret_cast<char*>(job.pDst), (int)job.pChunk->compressedSize, (int)job.pChunk->uncompressedSize);
+                if (size != (int)job.pChunk->uncompressedSize) failed = true;
+            }, 1);
+            if (failed) throw RuntimeError("Failed to decompress scene cache.");
+        }
+
+        /// Get a stream for deserializing a (decompressed) section.
+        InputStream getStream(SectionID id)
+        {
+            auto& section = getSection(id);
+            FALCOR_ASSERT(section.pDst);
+            return InputStream(section.pDst, section.size);
+        }
+
+    private:
+        struct Section
+        {
+            bool present = false;
+            uint64_t size = 0;
+            std::vector<ChunkEntry> chunks;
+            std::vector<uint8_t> buffer;
+            uint8_t* pDst = nullptr;
+        };
+
+        Section& getSection(SectionID id)
+        {
+            auto& section = mSections[(size_t)id];
+            if (!section.present) throw RuntimeError("Missing section in scene cache.");
+            return section;
+        }
+
+        const uint8_t* mpPayload = nullptr;
+        std::array<Section, (size_t)SectionID::Count> mSections;
+    };
+
+    SceneCache::Dependency SceneCache::createDependency(const std::filesystem::path& path, bool computeHash)
+    {
+        Dependency dependency;
+        dependency.path = path;
+
+        std::error_code ec;
+        auto status = std::filesystem::status(path, ec);
+        if (ec || !std::filesystem::exists(status)) return dependency;
+
+        dependency.exists = true;
+        dependency.isDirectory = std::filesystem::is_directory(status);
+        dependency.lastWriteTime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        if (dependency.isDirectory) return dependency;
+
+        dependency.size = std::filesystem::file_size(path, ec);
+        if (computeHash)
+        {
+            if (dependency.size == 0)
+            {
+                dependency.hash = SHA1::compute(nullptr, 0);
+            }
+            else
+            {
+                MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+                if (file.isOpen()) dependency.hash = SHA1::compute(file.getData(), file.getSize());
+            }
+        }
+
+        return dependency;
+    }
+
+    bool SceneCache::isDependencyValid(const Dependency& dependency)
+    {
+        std::error_code ec;
+        auto status = std::filesystem::status(dependency.path, ec);
+        bool exists = !ec && std::filesystem::exists(status);
+        if (exists != dependency.exists) return false;
+        if (!exists) return true;
+
+        bool isDirectory = std::filesystem::is_directory(status);
+        if (isDirectory != dependency.isDirectory) return false;
+
+        int64_t lastWriteTime = std::filesystem::last_write_time(dependency.path, ec).time_since_epoch().count();
+        if (isDirectory) return lastWriteTime == dependency.lastWriteTime;
+
+        uint64_t size = std::filesystem::file_size(dependency.path, ec);
+        if (size != dependency.size) return false;
+        if (lastWriteTime == dependency.lastWriteTime) return true;
+
+        // File was touched. Fall back to comparing the content hash if available.
+        if (!dependency.hash) return false;
+        auto current = createDependency(dependency.path, true);
+        return current.hash == dependency.hash;
+    }
+
     bool SceneCache::hasValidCache(const Key& key)
     {
         auto cachePath = getCachePath(key);
         if (!std::filesystem::exists(cachePath)) return false;
 
-        // Open file.
-        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) return false;
+        // Prevent other processes from replacing the file while it is mapped.
+        LockFile lockFile(getLockPath(key));
+        if (lockFile.isOpen()) lockFile.lock(LockFile::LockType::Shared);
+
+        // Map file. Only the header and dependencies are actually paged in.
+        MemoryMappedFile file(cachePath, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::RandomAccess);
+        if (!file.isOpen() || file.getSize() < sizeof(Header)) return false;
 
         // Verify header.
         Header header;
-        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
-        return !fs.eof() && header.isValid();
+        std::memcpy(&header, file.getData(), sizeof(header));
+        if (!header.isValid()) return false;
+
+        // Verify dependencies.
+        DependencyList dependencies;
+        try
+        {
+            InputStream stream(reinterpret_cast<const uint8_t*>(file.getData()) + sizeof(Header), file.getSize() - sizeof(Header));
+            dependencies = readDependencies(stream);
+        }
+        catch (const RuntimeError&)
+        {
+            return false;
+        }
+        for (const auto& dependency : dependencies)
+        {
+            if (!isDependencyValid(dependency))
+            {
+                logInfo("Scene cache '{}' is out of date ('{}' has changed).", cachePath, dependency.path);
+                return false;
+            }
+        }
+
+        return true;
     }
 
-    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key)
+    void SceneCache::writeCache(const Scene::SceneData& sceneData, const Key& key, const std::vector<std::filesystem::path>& dependencies, bool hashDependencies)
     {
-        auto cachePath = getCachePath(key);
-
-        logInfo("Writing scene cache to '{}'.", cachePath);
+        SectionWriter writer;
+        writeSceneData(writer, sceneData);
+        writeCacheFile(key, writer, createDependencies(dependencies, hashDependencies));
+    }
 
-        // Create directories if not existing.
-        std::filesystem::create_directories(cachePath.parent_path());
+    Threading::Task SceneCache::writeCacheAsync(const Scene::SceneData& sceneData, const Key& key, std::vector<std::filesystem::path> dependencies, bool hashDependencies)
+    {
+        if (!Threading::isRunning())
+        {
+            writeCache(sceneData, key, dependencies, hashDependencies);
+            return {};
+        }
 
-        // Open file.
-        std::ofstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) throw RuntimeError("Failed to create scene cache file '{}'.", cachePath);
+        // Serialize into memory. This is the only part that needs access to the scene data.
+        auto pWriter = std::make_shared<SectionWriter>();
+        writeSceneData(*pWriter, sceneData);
 
-        // Write header (uncompressed).
-        Header header;
-        std::memcpy(header.magic, kMagic, sizeof(Header::magic));
-        header.version = kVersion;
-        fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        // Snapshot the dependency timestamps and hashes now, so that files modified while the cache
+        // is being written invalidate the cache instead of being recorded as up-to-date.
+        auto dependencyList = createDependencies(dependencies, hashDependencies);
 
-        // Write cache (compressed).
-        lz4_stream::basic_ostream<kBlockSize> zs(fs);
-        OutputStream stream(zs);
-        writeSceneData(stream, sceneData);
-        if (fs.bad()) throw RuntimeError("Failed to write scene cache file to '{}'.", cachePath);
+        return Threading::dispatchTask([pWriter, key, dependencyList = std::move(dependencyList)]()
+        {
+            try
+            {
+                writeCacheFile(key, *pWriter, dependencyList);
+            }
+            catch (const std::exception& e)
+            {
+                logWarning("Failed to write scene cache: {}", e.what());
+            }
+        });
     }
 
     Scene::SceneData SceneCache::readCache(ref<Device> pDevice, const Key& key)
@@ -239,21 +587,30 @@ namespace Falcor
 
         logInfo("Loading scene cache from '{}'.", cachePath);
 
-        // Open file.
-        std::ifstream fs(cachePath.c_str(), std::ios_base::binary);
-        if (fs.bad()) throw RuntimeError("Failed to open scene cache file '{}'.", cachePath);
+        // Prevent other processes from replacing the file while it is mapped.
+        LockFile lockFile(getLockPath(key));
+        if (lockFile.isOpen()) lockFile.lock(LockFile::LockType::Shared);
+
+        // Map file.
+        MemoryMappedFile file(cachePath, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!file.isOpen()) throw RuntimeError("Failed to open scene cache file '{}'.", cachePath);
+        if (file.getSize() < sizeof(Header)) throw RuntimeError("Invalid header in scene cache file '{}'.", cachePath);
 
-        // Read header (uncompressed).
+        // Read header.
         Header header;
-        fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+        std::memcpy(&header, file.getData(), sizeof(header));
         if (!header.isValid()) throw RuntimeError("Invalid header in scene cache file '{}'.", cachePath);
 
-        // Read cache (compressed).
-        lz4_stream::basic_istream<kBlockSize, kBlockSize> zs(fs);
-        InputStream stream(zs);
-        auto sceneData = readSceneData(stream, pDevice);
-        if (fs.bad()) throw RuntimeError("Failed to read scene cache file from '{}'.", cachePath);
-        return sceneData;
+        const uint8_t* pData = reinterpret_cast<const uint8_t*>(file.getData()) + sizeof(Header);
+        const size_t size = file.getSize() - sizeof(Header);
+        InputStream stream(pData, size);
+
+        // Skip dependencies.
+        readDependencies(stream);
+
+        // Read section table and sections.
+        SectionReader reader(stream, pData, size);
+        return readSceneData(reader, pDevice);
     }
 
     std::filesystem::path SceneCache::getCachePath(const Key& key)
@@ -261,242 +618,418 @@ namespace Falcor
         return getAppDataDirectory() / kDirectory / SHA1::toString(key);
     }
 
-    // SceneData
+    std::filesystem::path SceneCache::getLockPath(const Key& key)
+    {
+        return getAppDataDirectory() / kDirectory / (SHA1::toString(key) + ".lock");
+    }
 
-    void SceneCache::writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData)
+    SceneCache::DependencyList SceneCache::createDependencies(const std::vector<std::filesystem::path>& paths, bool computeHashes)
     {
-        writeMarker(stream, "Path");
-        stream.write(sceneData.path);
+        DependencyList dependencies(paths.size());
+        Threading::parallelFor(0, paths.size(), [&](size_t i) { dependencies[i] = createDependency(paths[i], computeHashes); });
+        return dependencies;
+    }
 
-        writeMarker(stream, "RenderSettings");
-        stream.write(sceneData.renderSettings);
+    void SceneCache::writeCacheFile(const Key& key, SectionWriter& writer, const DependencyList& dependencies)
+    {
+        auto cachePath = getCachePath(key);
 
-        writeMarker(stream, "Cameras");
-        stream.write((uint32_t)sceneData.cameras.size());
-        for (const auto& pCamera : sceneData.cameras) writeCamera(stream, pCamera);
-        stream.write(sceneData.selectedCamera);
-        stream.write(sceneData.cameraSpeed);
+        logInfo("Writing scene cache to '{}'.", cachePath);
 
-        writeMarker(stream, "Lights");
-        stream.write((uint32_t)sceneData.lights.size());
-        for (const auto& pLight : sceneData.lights) writeLight(stream, pLight);
+        // Create directories if not existing.
+        std::filesystem::create_directories(cachePath.parent_path());
 
-        writeMarker(stream, "Grids");
-        stream.write((uint32_t)sceneData.grids.size());
-        for (const auto& pGrid : sceneData.grids) writeGrid(stream, pGrid);
+        // Write to a uniquely named temporary file first so that readers never see a partially written cache.
+        static std::atomic<uint32_t> sTempFileCounter{ 0 };
+        auto tempPath = cachePath;
+        tempPath += fmt::format(".{:08x}{:08x}.tmp", std::random_device{}(), sTempFileCounter++);
 
-        writeMarker(stream, "GridVolumes");
-        stream.write((uint32_t)sceneData.gridVolumes.size());
-        for (const auto& pGridVolume : sceneData.gridVolumes) writeGridVolume(stream, pGridVolume, sceneData.grids);
+        {
+            std::ofstream fs(tempPath, std::ios_base::binary);
+            if (!fs.good()) throw RuntimeError("Failed to create scene cache file '{}'.", tempPath);
 
-        writeMarker(stream, "EnvMap");
-        bool hasEnvMap = sceneData.pEnvMap != nullptr;
-        stream.write(hasEnvMap);
-        if (hasEnvMap) writeEnvMap(stream, sceneData.pEnvMap);
+            // Write header.
+            Header header;
+            std::memcpy(header.magic, kMagic, sizeof(Header::magic));
+            header.version = kVersion;
+            fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
 
-        writeMarker(stream, "Materials");
-        writeMaterials(stream, *sceneData.pMaterials);
+            // Write dependencies (uncompressed) so they can be validated without touching the rest of the cache.
+            {
+                OutputStream stream;
+                writeDependencies(stream, dependencies);
+                fs.write(reinterpret_cast<const char*>(stream.getBuffer().data()), stream.getBuffer().size());
+            }
+
+            // Write section table and compressed sections.
+            writer.write(fs);
+
+            fs.close();
+            if (fs.fail())
+            {
+                std::error_code ec;
+                std::filesystem::remove(tempPath, ec);
+                throw RuntimeError("Failed to write scene cache file to '{}'.", tempPath);
+            }
+        }
+
+        // Atomically replace the cache file. The exclusive lock waits for other processes that currently map the file.
+        LockFile lockFile(getLockPath(key));
+        if (lockFile.isOpen()) lockFile.lock(LockFile::LockType::Exclusive);
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, cachePath, ec);
+        if (ec)
+        {
+            std::filesystem::remove(tempPath, ec);
+            throw RuntimeError("Failed to move scene cache file to '{}'.", cachePath);
+        }
+    }
+
+    // Dependencies
 
-        writeMarker(stream, "SceneGraph");
-        stream.write((uint32_t)sceneData.sceneGraph.size());
-        for (const auto& node : sceneData.sceneGraph)
+    void SceneCache::writeDependencies(OutputStream& stream, const DependencyList& dependencies)
+    {
+        stream.write((uint32_t)dependencies.size());
+        for (const auto& dependency : dependencies)
         {
-            stream.write(node.name);
-            stream.write(node.parent);
-            stream.write(node.transform);
-            stream.write(node.meshBind);
-            stream.write(node.localToBindSpace);
+            stream.write(dependency.path);
+            stream.write(dependency.exists);
+            stream.write(dependency.isDirectory);
+            stream.write(dependency.size);
+            stream.write(dependency.lastWriteTime);
+            stream.write(dependency.hash);
         }
+    }
 
-        writeMarker(stream, "Animations");
-        stream.write((uint32_t)sceneData.animations.size());
-        for (const auto& pAnimation : sceneData.animations)
+    SceneCache::DependencyList SceneCache::readDependencies(InputStream& stream)
+    {
+        DependencyList dependencies(stream.read<uint32_t>());
+        for (auto& dependency : dependencies)
         {
-            writeAnimation(stream, pAnimation);
+            stream.read(dependency.path);
+            stream.read(dependency.exists);
+            stream.read(dependency.isDirectory);
+            stream.read(dependency.size);
+            stream.read(dependency.lastWriteTime);
+            stream.read(dependency.hash);
         }
+        return dependencies;
+    }
 
-        writeMarker(stream, "Metadata");
-        writeMetadata(stream, sceneData.metadata);
+    // SceneData
 
-        writeMarker(stream, "Meshes");
-        stream.write(sceneData.meshDesc);
-        stream.write(sceneData.meshNames);
-        stream.write(sceneData.meshBBs);
-        stream.write(sceneData.meshInstanceData);
-        stream.write((uint32_t)sceneData.meshIdToInstanceIds.size());
-        for (const auto& item : sceneData.meshIdToInstanceIds)
+    void SceneCache::writeSceneData(SectionWriter& writer, const Scene::SceneData& sceneData)
+    {
         {
-            stream.write(item);
+            OutputStream& stream = writer.getStream(SectionID::Scene);
+
+            writeMarker(stream, "Path");
+            stream.write(sceneData.path);
+
+            writeMarker(stream, "RenderSettings");
+            stream.write(sceneData.renderSettings);
+
+            writeMarker(stream, "Cameras");
+            stream.write((uint32_t)sceneData.cameras.size());
+            for (const auto& pCamera : sceneData.cameras) writeCamera(stream, pCamera);
+            stream.write(sceneData.selectedCamera);
+            stream.write(sceneData.cameraSpeed);
+
+            writeMarker(stream, "Lights");
+            stream.write((uint32_t)sceneData.lights.size());
+            for (const auto& pLight : sceneData.lights) writeLight(stream, pLight);
+
+            writeMarker(stream, "EnvMap");
+            bool hasEnvMap = sceneData.pEnvMap != nullptr;
+            stream.write(hasEnvMap);
+            if (hasEnvMap) writeEnvMap(stream, sceneData.pEnvMap);
+
+            writeMarker(stream, "SceneGraph");
+            stream.write((uint32_t)sceneData.sceneGraph.size());
+            for (const auto& node : sceneData.sceneGraph)
+            {
+                stream.write(node.name);
+                stream.write(node.parent);
+                stream.write(node.transform);
+                stream.write(node.meshBind);
+                stream.write(node.localToBindSpace);
+            }
+
+            writeMarker(stream, "Metadata");
+            writeMetadata(stream, sceneData.metadata);
+
+            writeMarker(stream, "End");
         }
-        stream.write((uint32_t)sceneData.meshGroups.size());
-        for (const auto& group : sceneData.meshGroups)
+
         {
-            stream.write(group.meshList);
-            stream.write(group.isStatic);
-            stream.write(group.isDisplaced);
+            OutputStream& stream = writer.getStream(SectionID::Grids);
+
+            writeMarker(stream, "Grids");
+            stream.write((uint32_t)sceneData.grids.size());
+            for (const auto& pGrid : sceneData.grids) writeGrid(stream, pGrid);
+
+            writeMarker(stream, "GridVolumes");
+            stream.write((uint32_t)sceneData.gridVolumes.size());
+            for (const auto& pGridVolume : sceneData.gridVolumes) writeGridVolume(stream, pGridVolume, sceneData.grids);
         }
-        stream.write((uint32_t)sceneData.cachedMeshes.size());
-        for (const auto& cachedMesh : sceneData.cachedMeshes)
+
         {
-            stream.write(cachedMesh.meshID);
-            stream.write(cachedMesh.timeSamples);
-            stream.write((uint32_t)cachedMesh.vertexData.size());
-            for (const auto& data : cachedMesh.vertexData) stream.write(data);
+            OutputStream& stream = writer.getStream(SectionID::Materials);
+
+            writeMarker(stream, "Materials");
+            writeMaterials(stream, *sceneData.pMaterials);
         }
-        stream.write(sceneData.useCompressedHitInfo);
-        stream.write(sceneData.has16BitIndices);
-        stream.write(sceneData.has32BitIndices);
-        stream.write(sceneData.meshDrawCount);
-        stream.write(sceneData.meshIndexData);
-        stream.write(sceneData.meshStaticData);
-        stream.write(sceneData.meshSkinningData);
 
-        writeMarker(stream, "Curves");
-        stream.write(sceneData.curveDesc);
-        stream.write(sceneData.curveBBs);
-        stream.write(sceneData.curveInstanceData);
-        stream.write(sceneData.curveIndexData);
-        stream.write(sceneData.curveStaticData);
+        {
+            OutputStream& stream = writer.getStream(SectionID::Animations);
+
+            writeMarker(stream, "Animations");
+            stream.write((uint32_t)sceneData.animations.size());
+            for (const auto& pAnimation : sceneData.animations)
+            {
+                writeAnimation(stream, pAnimation);
+            }
+        }
 
-        stream.write((uint32_t)sceneData.cachedCurves.size());
-        for (const auto& cachedCurve : sceneData.cachedCurves)
         {
-            stream.write(cachedCurve.tessellationMode);
-            stream.write(cachedCurve.geometryID);
-            stream.write(cachedCurve.timeSamples);
-            stream.write(cachedCurve.indexData);
-            stream.write((uint32_t)cachedCurve.vertexData.size());
-            for (const auto& data : cachedCurve.vertexData) stream.write(data);
+            OutputStream& stream = writer.getStream(SectionID::Meshes);
+
+            writeMarker(stream, "Meshes");
+            stream.write(sceneData.meshDesc);
+            stream.write(sceneData.meshNames);
+            stream.write(sceneData.meshBBs);
+            stream.write(sceneData.meshInstanceData);
+            stream.write((uint32_t)sceneData.meshIdToInstanceIds.size());
+            for (const auto& item : sceneData.meshIdToInstanceIds)
+            {
+                stream.write(item);
+            }
+            stream.write((uint32_t)sceneData.meshGroups.size());
+            for (const auto& group : sceneData.meshGroups)
+            {
+                stream.write(group.meshList);
+                stream.write(group.isStatic);
+                stream.write(group.isDisplaced);
+            }
+            stream.write((uint32_t)sceneData.cachedMeshes.size());
+            for (const auto& cachedMesh : sceneData.cachedMeshes)
+            {
+                stream.write(cachedMesh.meshID);
+                stream.write(cachedMesh.timeSamples);
+                stream.write((uint32_t)cachedMesh.vertexData.size());
+                for (const auto& data : cachedMesh.vertexData) stream.write(data);
+            }
+            stream.write(sceneData.useCompressedHitInfo);
+            stream.write(sceneData.has16BitIndices);
+            stream.write(sceneData.has32BitIndices);
+            stream.write(sceneData.meshDrawCount);
         }
 
-        writeMarker(stream, "CustomPrimitives");
-        stream.write(sceneData.customPrimitiveDesc);
-        stream.write(sceneData.customPrimitiveAABBs);
+        writer.addRaw(SectionID::MeshIndexData, sceneData.meshIndexData);
+        writer.addRaw(SectionID::MeshStaticData, sceneData.meshStaticData);
+        writer.addRaw(SectionID::MeshSkinningData, sceneData.meshSkinningData);
+
+        {
+            OutputStream& stream = writer.getStream(SectionID::Curves);
+
+            writeMarker(stream, "Curves");
+            stream.write(sceneData.curveDesc);
+            stream.write(sceneData.curveBBs);
+            stream.write(sceneData.curveInstanceData);
+
+            stream.write((uint32_t)sceneData.cachedCurves.size());
+            for (const auto& cachedCurve : sceneData.cachedCurves)
+            {
+                stream.write(cachedCurve.tessellationMode);
+                stream.write(cachedCurve.geometryID);
+                stream.write(cachedCurve.timeSamples);
+                stream.write(cachedCurve.indexData);
+                stream.write((uint32_t)cachedCurve.vertexData.size());
+                for (const auto& data : cachedCurve.vertexData) stream.write(data);
+            }
+
+            writeMarker(stream, "CustomPrimitives");
+            stream.write(sceneData.customPrimitiveDesc);
+            stream.write(sceneData.customPrimitiveAABBs);
+        }
 
-        writeMarker(stream, "End");
+        writer.addRaw(SectionID::CurveIndexData, sceneData.curveIndexData);
+        writer.addRaw(SectionID::CurveStaticData, sceneData.curveStaticData);
     }
 
-    Scene::SceneData SceneCache::readSceneData(InputStream& stream, ref<Device> pDevice)
+    Scene::SceneData SceneCache::readSceneData(SectionReader& reader, ref<Device> pDevice)
     {
         Scene::SceneData sceneData;
         sceneData.pMaterials = std::make_unique<MaterialSystem>(pDevice);
 
-        readMarker(stream, "Path");
-        stream.read(sceneData.path);
-
-        readMarker(stream, "RenderSettings");
-        stream.read(sceneData.renderSettings);
-
-        readMarker(stream, "Cameras");
-        sceneData.cameras.resize(stream.read<uint32_t>());
-        for (auto& pCamera : sceneData.cameras) pCamera = readCamera(stream);
-        stream.read(sceneData.selectedCamera);
-        stream.read(sceneData.cameraSpeed);
-
-        readMarker(stream, "Lights");
-        sceneData.lights.resize(stream.read<uint32_t>());
-        for (auto& pLight : sceneData.lights) pLight = readLight(stream);
-
-        readMarker(stream, "Grids");
-        sceneData.grids.resize(stream.read<uint32_t>());
-        for (auto& pGrid : sceneData.grids) pGrid = readGrid(stream, pDevice);
+        // Decompress all sections in parallel. Large vertex/index buffers are decompressed directly into their destination.
+        reader.readRaw(SectionID::MeshIndexData, sceneData.meshIndexData);
+        reader.readRaw(SectionID::MeshStaticData, sceneData.meshStaticData);
+        reader.readRaw(SectionID::MeshSkinningData, sceneData.meshSkinningData);
+        reader.readRaw(SectionID::CurveIndexData, sceneData.curveIndexData);
+        reader.readRaw(SectionID::CurveStaticData, sceneData.curveStaticData);
+        reader.decompress();
 
-        readMarker(stream, "GridVolumes");
-        sceneData.gridVolumes.resize(stream.read<uint32_t>());
-        for (auto& pGridVolume : sceneData.gridVolumes) pGridVolume = readGridVolume(stream, sceneData.grids, pDevice);
+        // Deserialize sections that don't touch the GPU on a worker thread while loading the rest.
+        auto readCpuSections = [&]()
+        {
+            {
+                InputStream stream = reader.getStream(SectionID::Animations);
 
-        readMarker(stream, "EnvMap");
-        auto hasEnvMap = stream.read<bool>();
-        if (hasEnvMap) sceneData.pEnvMap = readEnvMap(stream, pDevice);
+                readMarker(stream, "Animations");
+                sceneData.animations.resize(stream.read<uint32_t>());
+                for (auto& pAnimation : sceneData.animations) pAnimation = readAnimation(stream);
+            }
 
-        // Material textures are loaded asynchronously to allow loading other data
-        // in parallel while loading textures from files and uploading them to the GPU.
-        // Due to the current implementation, we need to make sure no other GPU operations (transfers)
-        // are executed while loading material textures. Due to this, we load volume grids and the envmap
-        // before material textures, as they upload buffers to the GPU when created.
-        // Make sure no other GPU operations are executed until calling pMaterialTextureLoader.reset()
-        // further down which blocks until all textures are loaded.
-        auto pMaterialTextureLoader = std::make_unique<MaterialTextureLoader>(sceneData.pMaterials->getTextureManager(), true);
+            {
+                InputStream stream = reader.getStream(SectionID::Meshes);
+
+                readMarker(stream, "Meshes");
+                stream.read(sceneData.meshDesc);
+                stream.read(sceneData.meshNames);
+                stream.read(sceneData.meshBBs);
+                stream.read(sceneData.meshInstanceData);
+                sceneData.meshIdToInstanceIds.resize(stream.read<uint32_t>());
+                for (auto& item : sceneData.meshIdToInstanceIds)
+                {
+                    stream.read(item);
+                }
+                sceneData.meshGroups.resize(stream.read<uint32_t>());
+                for (auto& group : sceneData.meshGroups)
+                {
+                    stream.read(group.meshList);
+                    stream.read(group.isStatic);
+                    stream.read(group.isDisplaced);
+                }
+                sceneData.cachedMeshes.resize(stream.read<uint32_t>());
+                for (auto& cachedMesh : sceneData.cachedMeshes)
+                {
+                    stream.read(cachedMesh.meshID);
+                    stream.read(cachedMesh.timeSamples);
+                    cachedMesh.vertexData.resize(stream.read<uint32_t>());
+                    for (auto& data : cachedMesh.vertexData) stream.read(data);
+                }
+                stream.read(sceneData.useCompressedHitInfo);
+                stream.read(sceneData.has16BitIndices);
+                stream.read(sceneData.has32BitIndices);
+                stream.read(sceneData.meshDrawCount);
+            }
 
-        readMarker(stream, "Materials");
-        readMaterials(stream, *sceneData.pMaterials, *pMaterialTextureLoader, pDevice);
+            {
+                InputStream stream = reader.getStream(SectionID::Curves);
+
+                readMarker(stream, "Curves");
+                stream.read(sceneData.curveDesc);
+                stream.read(sceneData.curveBBs);
+                stream.read(sceneData.curveInstanceData);
+
+                sceneData.cachedCurves.resize(stream.read<uint32_t>());
+                for (auto& cachedCurve : sceneData.cachedCurves)
+                {
+                    stream.read(cachedCurve.tessellationMode);
+                    stream.read(cachedCurve.geometryID);
+                    stream.read(cachedCurve.timeSamples);
+                    stream.read(cachedCurve.indexData);
+                    cachedCurve.vertexData.resize(stream.read<uint32_t>());
+                    for (auto& data : cachedCurve.vertexData) stream.read(data);
+                }
+
+                readMarker(stream, "CustomPrimitives");
+                stream.read(sceneData.customPrimitiveDesc);
+                stream.read(sceneData.customPrimitiveAABBs);
+            }
+        };
+
+        Threading::Task cpuTask;
+        if (Threading::isRunning()) cpuTask = Threading::dispatchTask(readCpuSections);
+        else readCpuSections();
 
-        readMarker(stream, "SceneGraph");
-        sceneData.sceneGraph.resize(stream.read<uint32_t>());
-        for (auto &node : sceneData.sceneGraph)
+        auto readGpuSections = [&]()
         {
-            stream.read(node.name);
-            stream.read(node.parent);
-            stream.read(node.transform);
-            stream.read(node.meshBind);
-            stream.read(node.localToBindSpace);
-        }
+            {
+                InputStream stream = reader.getStream(SectionID::Scene);
+
+                readMarker(stream, "Path");
+                stream.read(sceneData.path);
+
+                readMarker(stream, "RenderSettings");
+                stream.read(sceneData.renderSettings);
+
+                readMarker(stream, "Cameras");
+                sceneData.cameras.resize(stream.read<uint32_t>());
+                for (auto& pCamera : sceneData.cameras) pCamera = readCamera(stream);
+                stream.read(sceneData.selectedCamera);
+                stream.read(sceneData.cameraSpeed);
+
+                readMarker(stream, "Lights");
+                sceneData.lights.resize(stream.read<uint32_t>());
+                for (auto& pLight : sceneData.lights) pLight = readLight(stream);
+
+                readMarker(stream, "EnvMap");
+                auto hasEnvMap = stream.read<bool>();
+                if (hasEnvMap) sceneData.pEnvMap = readEnvMap(stream, pDevice);
+
+                readMarker(stream, "SceneGraph");
+                sceneData.sceneGraph.resize(stream.read<uint32_t>());
+                for (auto &node : sceneData.sceneGraph)
+                {
+                    stream.read(node.name);
+                    stream.read(node.parent);
+                    stream.read(node.transform);
+                    stream.read(node.meshBind);
+                    stream.read(node.localToBindSpace);
+                }
+
+                readMarker(stream, "Metadata");
+                sceneData.metadata = readMetadata(stream);
+
+                readMarker(stream, "End");
+            }
+
+            {
+                InputStream stream = reader.getStream(SectionID::Grids);
 
-        readMarker(stream, "Animations");
-        sceneData.animations.resize(stream.read<uint32_t>());
-        for (auto& pAnimation : sceneData.animations) pAnimation = readAnimation(stream);
+                readMarker(stream, "Grids");
+                sceneData.grids.resize(stream.read<uint32_t>());
+                for (auto& pGrid : sceneData.grids) pGrid = readGrid(stream, pDevice);
 
-        readMarker(stream, "Metadata");
-        sceneData.metadata = readMetadata(stream);
+                readMarker(stream, "GridVolumes");
+                sceneData.gridVolumes.resize(stream.read<uint32_t>());
+                for (auto& pGridVolume : sceneData.gridVolumes) pGridVolume = readGridVolume(stream, sceneData.grids, pDevice);
+            }
 
-        readMarker(stream, "Meshes");
-        stream.read(sceneData.meshDesc);
-        stream.read(sceneData.meshNames);
-        stream.read(sceneData.meshBBs);
-        stream.read(sceneData.meshInstanceData);
-        sceneData.meshIdToInstanceIds.resize(stream.read<uint32_t>());
-        for (auto& item : sceneData.meshIdToInstanceIds)
-        {
-            stream.read(item);
-        }
-        sceneData.meshGroups.resize(stream.read<uint32_t>());
-        for (auto& group : sceneData.meshGroups)
+            // Material textures are loaded asynchronously to allow loading other data
+            // in parallel while loading textures from files and uploading them to the GPU.
+            // Due to the current implementation, we need to make sure no other GPU operations (transfers)
+            // are executed while loading material textures. Due to this, we load volume grids and the envmap
+            // before material textures, as they upload buffers to the GPU when created.
+            // Make sure no other GPU operations are executed until calling pMaterialTextureLoader.reset()
+            // further down which blocks until all textures are loaded.
+            auto pMaterialTextureLoader = std::make_unique<MaterialTextureLoader>(sceneData.pMaterials->getTextureManager(), true);
+
+            {
+                InputStream stream = reader.getStream(SectionID::Materials);
+
+                readMarker(stream, "Materials");
+                readMaterials(stream, *sceneData.pMaterials, *pMaterialTextureLoader, pDevice);
+            }
+
+            pMaterialTextureLoader.reset();
+        };
+
+        // Make sure the worker is done referencing the scene data before propagating errors.
+        try
         {
-            stream.read(group.meshList);
-            stream.read(group.isStatic);
-            stream.read(group.isDisplaced);
+            readGpuSections();
         }
-        sceneData.cachedMeshes.resize(stream.read<uint32_t>());
-        for (auto& cachedMesh : sceneData.cachedMeshes)
+        catch (...)
         {
-            stream.read(cachedMesh.meshID);
-            stream.read(cachedMesh.timeSamples);
-            cachedMesh.vertexData.resize(stream.read<uint32_t>());
-            for (auto& data : cachedMesh.vertexData) stream.read(data);
+            try { cpuTask.finish(); } catch (...) {}
+            throw;
         }
-        stream.read(sceneData.useCompressedHitInfo);
-        stream.read(sceneData.has16BitIndices);
-        stream.read(sceneData.has32BitIndices);
-        stream.read(sceneData.meshDrawCount);
-        stream.read(sceneData.meshIndexData);
-        stream.read(sceneData.meshStaticData);
-        stream.read(sceneData.meshSkinningData);
-
-        readMarker(stream, "Curves");
-        stream.read(sceneData.curveDesc);
-        stream.read(sceneData.curveBBs);
-        stream.read(sceneData.curveInstanceData);
-        stream.read(sceneData.curveIndexData);
-        stream.read(sceneData.curveStaticData);
-
-        sceneData.cachedCurves.resize(stream.read<uint32_t>());
-        for (auto& cachedCurve : sceneData.cachedCurves)
-        {
-            stream.read(cachedCurve.tessellationMode);
-            stream.read(cachedCurve.geometryID);
-            stream.read(cachedCurve.timeSamples);
-            stream.read(cachedCurve.indexData);
-            cachedCurve.vertexData.resize(stream.read<uint32_t>());
-            for (auto& data : cachedCurve.vertexData) stream.read(data);
-        }
-
-        readMarker(stream, "CustomPrimitives");
-        stream.read(sceneData.customPrimitiveDesc);
-        stream.read(sceneData.customPrimitiveAABBs);
-
-        readMarker(stream, "End");
 
-        pMaterialTextureLoader.reset();
+        cpuTask.finish();
 
         return sceneData;
     }
@@ -932,6 +1465,7 @@ namespace Falcor
         stream.read(pAnimation->mInterpolationMode);
         stream.read(pAnimation->mEnableWarping);
         stream.read(pAnimation->mKeyframes);
+        pAnimation->updateKeyframeTimes();
         return pAnimation;
     }
 
@@ -40,8 +40,10 @@
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
 #include "Utils/CryptoUtils.h"
+#include "Utils/Threading.h"
 
 #include <filesystem>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -50,23 +52,76 @@ namespace Falcor
     /** Helper class for reading and writing scene cache files.
         The scene cache is used to heavily reduce load times of more complex assets.
         The cache stores a binary representation of `Scene::SceneData` which contains everything to re-create a `Scene`.
+        The scene data is split into sections (scene, grids, materials, animations, meshes, curves and raw vertex/index data)
+        that are LZ4-compressed in independent chunks and indexed by a section table. This allows the cache to be read
+        through a memory-mapped file and decompressed in parallel.
+        In addition, the cache records all files that were used to build the scene (dependencies).
+        A cache is only considered valid if none of its dependencies have changed since it was written.
+        Cache files are written to a temporary file and atomically renamed into place. A lock file per cache entry
+        makes it safe to share a cache directory between multiple processes.
     */
     class FALCOR_API SceneCache
     {
     public:
         using Key = SHA1::MD;
 
+        /** Describes a file (or directory) the cached scene was built from.
+        */
+        struct Dependency
+        {
+            std::filesystem::path path;         ///< Absolute path.
+            bool exists = false;                ///< True if the path existed when the cache was written.
+            bool isDirectory = false;           ///< True if the path is a directory (only last write time is checked).
+            uint64_t size = 0;                  ///< File size in bytes.
+            int64_t lastWriteTime = 0;          ///< Last write time in ticks of the filesystem clock.
+            std::optional<SHA1::MD> hash;       ///< Optional SHA-1 hash of the file content.
+        };
+
+        using DependencyList = std::vector<Dependency>;
+
+        /** Create a dependency record describing the current state of a file.
+            \param[in] path Absolute path.
+            \param[in] computeHash If true, the SHA-1 hash of the file content is computed.
+            \return Returns the dependency record.
+        */
+        static Dependency createDependency(const std::filesystem::path& path, bool computeHash);
+
+        /** Check if a dependency is still up-to-date.
+            Size and last write time are compared first. If they don't match but a content hash
+            is available, the hash is recomputed so that touched but unmodified files don't invalidate the cache.
+            \param[in] dependency Dependency record.
+            \return Returns true if the dependency is unchanged.
+        */
+        static bool isDependencyValid(const Dependency& dependency);
+
         /** Check if there is a valid scene cache for a given cache key.
+            The cache is only valid if all its recorded dependencies are unchanged.
             \param[in] key Cache key.
             \return Returns true if a valid cache exists.
         */
         static bool hasValidCache(const Key& key);
 
         /** Write a scene cache.
+            Sections are compressed in parallel if the thread pool is running.
             \param[in] sceneData Scene data.
             \param[in] key Cache key.
+            \param[in] dependencies Files the scene was built from.
+            \param[in] hashDependencies If true, content hashes are stored for all dependencies.
         */
-        static void writeCache(const Scene::SceneData& sceneData, const Key& key);
+        static void writeCache(const Scene::SceneData& sceneData, const Key& key, const std::vector<std::filesystem::path>& dependencies = {}, bool hashDependencies = false);
+
+        /** Write a scene cache asynchronously.
+            The scene data is serialized into memory and the dependency records are created on the calling thread.
+            Compression and writing the file happens on the thread pool, so the scene data can be used (or destroyed)
+            as soon as this function returns. Errors are reported as warnings.
+            Falls back to writing synchronously if the thread pool is not running.
+            \param[in] sceneData Scene data.
+            \param[in] key Cache key.
+            \param[in] dependencies Files the scene was built from.
+            \param[in] hashDependencies If true, content hashes are stored for all dependencies.
+            \return Returns a task that finishes once the cache file is written.
+        */
+        static Threading::Task writeCacheAsync(const Scene::SceneData& sceneData, const Key& key, std::vector<std::filesystem::path> dependencies = {}, bool hashDependencies = false);
 
         /** Read a scene cache.
             \param[in] pDevice GPU device.
@@ -76,13 +131,23 @@ namespace Falcor
         static Scene::SceneData readCache(ref<Device> pDevice, const Key& key);
 
     private:
+        enum class SectionID : uint32_t;
         class OutputStream;
         class InputStream;
+        class SectionWriter;
+        class SectionReader;
 
         static std::filesystem::path getCachePath(const Key& key);
+        static std::filesystem::path getLockPath(const Key& key);
+
+        static DependencyList createDependencies(const std::vector<std::filesystem::path>& paths, bool computeHashes);
+        static void writeCacheFile(const Key& key, SectionWriter& writer, const DependencyList& dependencies);
+
+        static void writeDependencies(OutputStream& stream, const DependencyList& dependencies);
+        static DependencyList readDependencies(InputStream& stream);
 
-        static void writeSceneData(OutputStream& stream, const Scene::SceneData& sceneData);
-        static Scene::SceneData readSceneData(InputStream& stream, ref<Device> pDevice);
+        static void writeSceneData(SectionWriter& writer, const Scene::SceneData& sceneData);
+        static Scene::SceneData readSceneData(SectionReader& reader, ref<Device> pDevice);
 
         static void writeMetadata(OutputStream& stream, const Scene::Metadata& metadata);
         static Scene::Metadata readMetadata(InputStream& stream);
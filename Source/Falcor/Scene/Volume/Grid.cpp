@@ -329,7 +329,9 @@ namespace Falcor
 
         auto createFromFile = [] (const std::filesystem::path& path, const std::string& gridname)
         {
-            return Grid::createFromFile(accessActivePythonSceneBuilder().getDevice(), path, gridname);
+            SceneBuilder& builder = accessActivePythonSceneBuilder();
+            builder.addDependency(path);
+            return Grid::createFromFile(builder.getDevice(), path, gridname);
         };
         grid.def_static("createFromFile", createFromFile, "path"_a, "gridname"_a); // PYTHONDEPRECATED
     }
@@ -402,13 +402,29 @@ namespace Falcor
             return GridVolume::create(accessActivePythonSceneBuilder().getDevice(), name);
         };
         volume.def(pybind11::init(create), "name"_a); // PYTHONDEPRECATED
-        volume.def("loadGrid", &GridVolume::loadGrid, "slot"_a, "path"_a, "gridname"_a);
-        volume.def("loadGridSequence",
-            pybind11::overload_cast<GridVolume::GridSlot, const std::vector<std::filesystem::path>&, const std::string&, bool>(&GridVolume::loadGridSequence),
-            "slot"_a, "paths"_a, "gridname"_a, "keepEmpty"_a = true);
-        volume.def("loadGridSequence",
-            pybind11::overload_cast<GridVolume::GridSlot, const std::filesystem::path&, const std::string&, bool>(&GridVolume::loadGridSequence),
-            "slot"_a, "path"_a, "gridnames"_a, "keepEmpty"_a = true);
+        // Grid files loaded while building a scene are recorded as scene dependencies.
+        auto addDependency = [] (const std::filesystem::path& path)
+        {
+            if (auto pBuilder = getActivePythonSceneBuilder()) pBuilder->addDependency(path);
+        };
+        auto loadGrid = [addDependency] (GridVolume& volume, GridVolume::GridSlot slot, const std::filesystem::path& path, const std::string& gridname)
+        {
+            addDependency(path);
+            return volume.loadGrid(slot, path, gridname);
+        };
+        auto loadGridSequence = [addDependency] (GridVolume& volume, GridVolume::GridSlot slot, const std::vector<std::filesystem::path>& paths, const std::string& gridname, bool keepEmpty)
+        {
+            for (const auto& path : paths) addDependency(path);
+            return volume.loadGridSequence(slot, paths, gridname, keepEmpty);
+        };
+        auto loadGridSequenceFromDirectory = [addDependency] (GridVolume& volume, GridVolume::GridSlot slot, const std::filesystem::path& path, const std::string& gridname, bool keepEmpty)
+        {
+            addDependency(path);
+            return volume.loadGridSequence(slot, path, gridname, keepEmpty);
+        };
+        volume.def("loadGrid", loadGrid, "slot"_a, "path"_a, "gridname"_a);
+        volume.def("loadGridSequence", loadGridSequence, "slot"_a, "paths"_a, "gridname"_a, "keepEmpty"_a = true);
+        volume.def("loadGridSequence", loadGridSequenceFromDirectory, "slot"_a, "path"_a, "gridnames"_a, "keepEmpty"_a = true);
 
         m.attr("Volume") = m.attr("GridVolume"); // PYTHONDEPRECATED
     }
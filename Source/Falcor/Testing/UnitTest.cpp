@@ -605,6 +605,10 @@ std::vector<Test> filterTests(
             includeTags.insert(token);
     }
 
+    // Benchmarks are long running and only executed when explicitly requested by tag.
+    if (includeTags.count(kBenchmarkTag) == 0)
+        excludeTags.insert(kBenchmarkTag);
+
     auto matchTags =
         [](const std::set<std::string>& tags, const std::set<std::string>& includeTags, const std::set<std::string>& excludeTags)
     {
@@ -119,6 +119,9 @@ struct Test
 /// Enumerate all tests.
 FALCOR_API std::vector<Test> enumerateTests();
 
+/// Tag for long running benchmark tests. These are skipped unless the tag filter explicitly includes this tag.
+static constexpr char kBenchmarkTag[] = "benchmark";
+
 /// Filter tests by suite and case name.
 FALCOR_API std::vector<Test> filterTests(
     std::vector<Test> tests,
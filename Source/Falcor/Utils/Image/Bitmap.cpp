@@ -26,6 +26,7 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "Bitmap.h"
+#include "ParallelImageEncoder.h"
 #include "Core/Macros.h"
 #include "Core/API/Texture.h"
 #include "Core/Platform/MemoryMappedFile.h"
@@ -53,6 +54,46 @@ static void genWarning(const std::string& errMsg, const std::filesystem::path& p
     logWarning("Error when loading image file from '{}': {}", path, errMsg);
 }
 
+static constexpr uint32_t kCompressionLevelShift = 8;
+static constexpr uint32_t kMaxCompressionLevel = 9;
+static constexpr uint32_t kDefaultPngCompressionLevel = 9;
+static constexpr uint32_t kDefaultExrCompressionLevel = 6;
+
+// The level is stored off by one in the mask bits, so the largest stored value is kMaxCompressionLevel + 1.
+static_assert(uint32_t(Bitmap::ExportFlags::CompressionLevelMask) == (0xfu << kCompressionLevelShift));
+static_assert(((kMaxCompressionLevel + 1) << kCompressionLevelShift) <= uint32_t(Bitmap::ExportFlags::CompressionLevelMask));
+
+/**
+ * Get the deflate compression level selected with Bitmap::compressionLevel().
+ */
+static uint32_t getCompressionLevel(Bitmap::ExportFlags exportFlags, uint32_t defaultLevel)
+{
+    if (is_set(exportFlags, Bitmap::ExportFlags::Uncompressed))
+        return 0;
+    uint32_t field = uint32_t(exportFlags & Bitmap::ExportFlags::CompressionLevelMask) >> kCompressionLevelShift;
+    return field > 0 ? std::min(field - 1, kMaxCompressionLevel) : defaultLevel;
+}
+
+/**
+ * Check if a format can be written by the parallel PNG encoder.
+ */
+static bool isParallelPngFormat(ResourceFormat format)
+{
+    switch (format)
+    {
+    case ResourceFormat::RGBA8Unorm:
+    case ResourceFormat::RGBA8UnormSrgb:
+    case ResourceFormat::RGBA8Snorm:
+    case ResourceFormat::BGRA8Unorm:
+    case ResourceFormat::BGRA8UnormSrgb:
+    case ResourceFormat::BGRX8Unorm:
+    case ResourceFormat::BGRX8UnormSrgb:
+        return true;
+    default:
+        return false;
+    }
+}
+
 static bool isConvertibleToRGBA32Float(ResourceFormat format)
 {
     FormatType type = getFormatType(format);
@@ -154,40 +195,49 @@ static std::vector<float> convertToRGBA32Float(ResourceFormat format, uint32_t w
 }
 
 /**
- * Converts 96bpp to 128bpp RGBA without clamping.
- * Note that we can't use FreeImage_ConvertToRGBAF() as it clamps to [0,1].
+ * Copy a decoded FreeImage bitmap to the destination layout in a single pass.
+ * FreeImage stores scanlines bottom-up, so rows are flipped for top-down images. 24bpp BGR is expanded
+ * to BGRX and 96bpp RGB float to RGBA float (without clamping) if the destination has 4 channels.
+ * Other formats are copied as is.
  */
-static FIBITMAP* convertToRGBAF(FIBITMAP* pDib)
+static void copyFromDib(FIBITMAP* pDib, bool isTopDown, const Bitmap::ImageDesc& desc, uint8_t* pDst)
 {
-    const unsigned width = FreeImage_GetWidth(pDib);
-    const unsigned height = FreeImage_GetHeight(pDib);
+    const uint32_t srcBpp = FreeImage_GetBPP(pDib);
+    const uint32_t dstBpp = getFormatBytesPerBlock(desc.format) * 8;
 
-    auto pNew = FreeImage_AllocateT(FIT_RGBAF, width, height);
-    FreeImage_CloneMetadata(pNew, pDib);
-
-    const unsigned src_pitch = FreeImage_GetPitch(pDib);
-    const unsigned dst_pitch = FreeImage_GetPitch(pNew);
-
-    const BYTE* src_bits = (BYTE*)FreeImage_GetBits(pDib);
-    BYTE* dst_bits = (BYTE*)FreeImage_GetBits(pNew);
-
-    for (unsigned y = 0; y < height; y++)
+    for (uint32_t y = 0; y < desc.height; y++)
     {
-        const FIRGBF* src_pixel = (FIRGBF*)src_bits;
-        FIRGBAF* dst_pixel = (FIRGBAF*)dst_bits;
+        const BYTE* pSrc = FreeImage_GetScanLine(pDib, isTopDown ? desc.height - 1 - y : y);
+        uint8_t* pRow = pDst + size_t(y) * desc.rowPitch;
 
-        for (unsigned x = 0; x < width; x++)
+        if (srcBpp == 24 && dstBpp == 32)
+        {
+            for (uint32_t x = 0; x < desc.width; x++, pSrc += 3, pRow += 4)
+            {
+                pRow[0] = pSrc[0];
+                pRow[1] = pSrc[1];
+                pRow[2] = pSrc[2];
+                pRow[3] = 0xff;
+            }
+        }
+        else if (srcBpp == 96 && dstBpp == 128)
         {
-            // Convert pixels directly, while adding a "dummy" alpha of 1.0
-            dst_pixel[x].red = src_pixel[x].red;
-            dst_pixel[x].green = src_pixel[x].green;
-            dst_pixel[x].blue = src_pixel[x].blue;
-            dst_pixel[x].alpha = 1.0F;
+            const float* pSrcFloat = reinterpret_cast<const float*>(pSrc);
+            float* pDstFloat = reinterpret_cast<float*>(pRow);
+            for (uint32_t x = 0; x < desc.width; x++, pSrcFloat += 3, pDstFloat += 4)
+            {
+                pDstFloat[0] = pSrcFloat[0];
+                pDstFloat[1] = pSrcFloat[1];
+                pDstFloat[2] = pSrcFloat[2];
+                pDstFloat[3] = 1.f;
+            }
+        }
+        else
+        {
+            FALCOR_ASSERT(srcBpp == dstBpp);
+            std::memcpy(pRow, pSrc, desc.rowPitch);
         }
-        src_bits += src_pitch;
-        dst_bits += dst_pitch;
     }
-    return pNew;
 }
 
 Bitmap::UniqueConstPtr Bitmap::create(uint32_t width, uint32_t height, ResourceFormat format, const uint8_t* pData)
@@ -196,12 +246,26 @@ Bitmap::UniqueConstPtr Bitmap::create(uint32_t width, uint32_t height, ResourceF
 }
 
 Bitmap::UniqueConstPtr Bitmap::createFromFile(const std::filesystem::path& path, bool isTopDown)
+{
+    UniquePtr pBmp;
+    auto allocate = [&pBmp](const ImageDesc& desc)
+    {
+        pBmp = UniquePtr(new Bitmap(desc.width, desc.height, desc.format));
+        FALCOR_ASSERT(pBmp->getSize() == desc.size);
+        return pBmp->getData();
+    };
+    if (!decodeFromFile(path, isTopDown, allocate))
+        return nullptr;
+    return pBmp;
+}
+
+bool Bitmap::decodeFromFile(const std::filesystem::path& path, bool isTopDown, const AllocateFunc& allocate, ImageDesc* pDesc)
 {
     std::filesystem::path fullPath;
     if (!findFileInDataDirectories(path, fullPath))
     {
         logWarning("Error when loading image file. Can't find image file '{}'.", path);
-        return nullptr;
+        return false;
     }
 
     FREE_IMAGE_FORMAT fifFormat = FIF_UNKNOWN;
@@ -215,7 +279,7 @@ Bitmap::UniqueConstPtr Bitmap::createFromFile(const std::filesystem::path& path,
         if (fifFormat == FIF_UNKNOWN)
         {
             genWarning("Image type unknown", path);
-            return nullptr;
+            return false;
         }
     }
 
@@ -223,7 +287,7 @@ Bitmap::UniqueConstPtr Bitmap::createFromFile(const std::filesystem::path& path,
     if (FreeImage_FIFSupportsReading(fifFormat) == false)
     {
         genWarning("Library doesn't support the file format", path);
-        return nullptr;
+        return false;
     }
 
     // Read file using memory mapped access which is much faster than regular file IO.
@@ -231,7 +295,7 @@ Bitmap::UniqueConstPtr Bitmap::createFromFile(const std::filesystem::path& path,
     if (!file.isOpen())
     {
         genWarning("Can't open image file {}", path);
-        return nullptr;
+        return false;
     }
     FIMEMORY* memory = FreeImage_OpenMemory((BYTE*)file.getData(), file.getSize());
     FIBITMAP* pDib = FreeImage_LoadFromMemory(fifFormat, memory);
@@ -241,7 +305,7 @@ Bitmap::UniqueConstPtr Bitmap::createFromFile(const std::filesystem::path& path,
     if (pDib == nullptr)
     {
         genWarning("Can't read image file", path);
-        return nullptr;
+        return false;
     }
 
     // Create the bitmap
@@ -251,7 +315,8 @@ Bitmap::UniqueConstPtr Bitmap::createFromFile(const std::filesystem::path& path,
     if (height == 0 || width == 0 || FreeImage_GetBits(pDib) == nullptr)
     {
         genWarning("Invalid image", path);
-        return nullptr;
+        FreeImage_Unload(pDib);
+        return false;
     }
 
     // Convert palettized images to RGBA.
@@ -265,7 +330,7 @@ Bitmap::UniqueConstPtr Bitmap::createFromFile(const std::filesystem::path& path,
         if (pDib == nullptr)
         {
             genWarning("Failed to convert palettized image to RGBA format", path);
-            return nullptr;
+            return false;
         }
     }
 
@@ -296,35 +361,29 @@ Bitmap::UniqueConstPtr Bitmap::createFromFile(const std::filesystem::path& path,
         break;
     default:
         genWarning("Unknown bits-per-pixel", path);
-        return nullptr;
-    }
-
-    // Convert the image to RGBX image
-    if (bpp == 24)
-    {
-        bpp = 32;
-        auto pNew = FreeImage_ConvertTo32Bits(pDib);
-        FreeImage_Unload(pDib);
-        pDib = pNew;
-    }
-    else if (bpp == 96 && (isRGB32fSupported() == false))
-    {
-        bpp = 128;
-        auto pNew = convertToRGBAF(pDib);
         FreeImage_Unload(pDib);
-        pDib = pNew;
+        return false;
     }
 
     // PFM images are loaded y-flipped, fix this by inverting the isTopDown flag.
     if (fifFormat == FIF_PFM)
         isTopDown = !isTopDown;
 
-    UniqueConstPtr pBmp = UniqueConstPtr(new Bitmap(width, height, format));
-    FreeImage_ConvertToRawBits(
-        pBmp->getData(), pDib, pBmp->getRowPitch(), bpp, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, isTopDown
-    );
+    ImageDesc desc;
+    desc.width = width;
+    desc.height = height;
+    desc.format = format;
+    desc.rowPitch = getFormatRowPitch(format, width);
+    desc.size = size_t(desc.rowPitch) * height;
+
+    uint8_t* pDst = allocate(desc);
+    if (pDst != nullptr)
+        copyFromDib(pDib, isTopDown, desc, pDst);
     FreeImage_Unload(pDib);
-    return pBmp;
+
+    if (pDesc)
+        *pDesc = desc;
+    return pDst != nullptr;
 }
 
 Bitmap::Bitmap(uint32_t width, uint32_t height, ResourceFormat format)
@@ -466,6 +525,12 @@ void Bitmap::saveImageDialog(Texture* pTexture)
     }
 }
 
+Bitmap::ExportFlags Bitmap::compressionLevel(uint32_t level)
+{
+    // The level is stored off by one so that no bits set selects the default level.
+    return ExportFlags((std::min(level, kMaxCompressionLevel) + 1) << kCompressionLevelShift);
+}
+
 void Bitmap::saveImage(
     const std::filesystem::path& path,
     uint32_t width,
@@ -486,6 +551,28 @@ void Bitmap::saveImage(
     if (fileFormat == FileFormat::DdsFile)
         throw ArgumentError("Cannot save DDS files. Use ImageIO instead.");
 
+    if (is_set(exportFlags, ExportFlags::ExrZip) && is_set(exportFlags, ExportFlags::ExrPiz))
+        throw ArgumentError("Incompatible flags: only one EXR compression codec can be selected.");
+
+    if ((is_set(exportFlags, ExportFlags::ExrZip) || is_set(exportFlags, ExportFlags::ExrPiz)) &&
+        (is_set(exportFlags, ExportFlags::Uncompressed) || is_set(exportFlags, ExportFlags::Lossy)))
+        throw ArgumentError("Incompatible flags: EXR compression codecs cannot be combined with lossy or uncompressed.");
+
+    if (fileFormat == FileFormat::PngFile && isParallelPngFormat(resourceFormat))
+    {
+        if (is_set(exportFlags, ExportFlags::Lossy))
+            logWarning("Bitmap::saveImage: PNG format does not support lossy compression mode.");
+
+        ParallelImageEncoder::Options options;
+        options.compressionLevel = getCompressionLevel(exportFlags, kDefaultPngCompressionLevel);
+        bool isBGRA = resourceFormat != ResourceFormat::RGBA8Unorm && resourceFormat != ResourceFormat::RGBA8UnormSrgb &&
+                      resourceFormat != ResourceFormat::RGBA8Snorm;
+        ParallelImageEncoder::writePng(
+            path, width, height, (const uint8_t*)pData, isBGRA, isTopDown, is_set(exportFlags, ExportFlags::ExportAlpha), options
+        );
+        return;
+    }
+
     int flags = 0;
     FIBITMAP* pImage = nullptr;
     uint32_t bytesPerPixel = getFormatBytesPerBlock(resourceFormat);
@@ -536,6 +623,28 @@ void Bitmap::saveImage(
         if (exportAlpha && bytesPerPixel != 16)
             throw ArgumentError("Requesting to export alpha-channel to EXR file, but the resource doesn't have an alpha-channel");
 
+        // PIZ (the default) and lossy files are written by FreeImage.
+        bool useParallelExr = is_set(exportFlags, ExportFlags::ExrZip) || is_set(exportFlags, ExportFlags::Uncompressed);
+        if (fileFormat == Bitmap::FileFormat::ExrFile && useParallelExr)
+        {
+            // Same pixel types as the FreeImage path: half by default, float when uncompressed.
+            bool uncompressed = is_set(exportFlags, ExportFlags::Uncompressed);
+            ParallelImageEncoder::Options options;
+            options.compressionLevel = getCompressionLevel(exportFlags, kDefaultExrCompressionLevel);
+            ParallelImageEncoder::writeExr(
+                path,
+                width,
+                height,
+                (const float*)pData,
+                bytesPerPixel / 4,
+                exportAlpha,
+                uncompressed ? ParallelImageEncoder::ExrPixelType::Float : ParallelImageEncoder::ExrPixelType::Half,
+                uncompressed ? ParallelImageEncoder::ExrCompression::None : ParallelImageEncoder::ExrCompression::Zip,
+                options
+            );
+            return;
+        }
+
         // Upload the image manually and flip it vertically
         bool scanlineCopy = exportAlpha ? bytesPerPixel == 16 : bytesPerPixel == 12;
 
@@ -563,15 +672,7 @@ void Bitmap::saveImage(
 
         if (fileFormat == Bitmap::FileFormat::ExrFile)
         {
-            flags = 0;
-            if (is_set(exportFlags, ExportFlags::Uncompressed))
-            {
-                flags |= EXR_NONE | EXR_FLOAT;
-            }
-            else if (is_set(exportFlags, ExportFlags::Lossy))
-            {
-                flags |= EXR_B44 | EXR_ZIP;
-            }
+            flags = is_set(exportFlags, ExportFlags::Lossy) ? (EXR_B44 | EXR_ZIP) : EXR_PIZ;
         }
     }
     else
@@ -606,13 +707,17 @@ void Bitmap::saveImage(
 
         // Lossless formats
         case FileFormat::PngFile:
-            flags = is_set(exportFlags, ExportFlags::Uncompressed) ? PNG_Z_NO_COMPRESSION : PNG_Z_BEST_COMPRESSION;
+        {
+            // FreeImage takes the zlib compression level in the low bits of the flags.
+            uint32_t level = getCompressionLevel(exportFlags, kDefaultPngCompressionLevel);
+            flags = level == 0 ? PNG_Z_NO_COMPRESSION : (int)level;
 
             if (is_set(exportFlags, ExportFlags::Lossy))
             {
                 warnings.push_back("PNG format does not support lossy compression mode.");
             }
             break;
+        }
 
         case FileFormat::TgaFile:
             if (is_set(exportFlags, ExportFlags::Lossy))
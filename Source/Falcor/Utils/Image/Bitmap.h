@@ -31,6 +31,7 @@
 #include "Core/API/Formats.h"
 #include <memory>
 #include <filesystem>
+#include <functional>
 
 namespace Falcor
 {
@@ -48,6 +49,10 @@ public:
         ExportAlpha = 1u << 0,  //< Save alpha channel as well
         Lossy = 1u << 1,        //< Try to store in a lossy format
         Uncompressed = 1u << 2, //< Prefer faster load to a more compact file size
+        ExrZip = 1u << 3,       //< Use ZIP compression for EXR files. Encoded on multiple threads
+        ExrPiz = 1u << 4,       //< Use PIZ wavelet compression for EXR files (default). Encoded on a single thread
+
+        CompressionLevelMask = 0xfu << 8, //< Deflate level + 1 for PNG and ZIP EXR files (0 = default), see compressionLevel()
     };
 
     enum class FileFormat
@@ -65,6 +70,22 @@ public:
     using UniquePtr = std::unique_ptr<Bitmap>;
     using UniqueConstPtr = std::unique_ptr<const Bitmap>;
 
+    /// Layout of a decoded image.
+    struct ImageDesc
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        ResourceFormat format = ResourceFormat::Unknown;
+        uint32_t rowPitch = 0; ///< Row pitch in bytes. Rows are tightly packed.
+        size_t size = 0;       ///< Total size in bytes.
+    };
+
+    /**
+     * Allocation callback used by decodeFromFile(). It is called once the image layout is known and
+     * returns a pointer to at least desc.size bytes of memory, or nullptr to cancel decoding.
+     */
+    using AllocateFunc = std::function<uint8_t*(const ImageDesc& desc)>;
+
     /**
      * Create from memory.
      * @param[in] width Width in pixels.
@@ -85,8 +106,32 @@ public:
      */
     static UniqueConstPtr createFromFile(const std::filesystem::path& path, bool isTopDown);
 
+    /**
+     * Decode an image file directly into caller-provided memory, for example a staging buffer or a pooled allocation.
+     * The decoded image has the same format and layout as an image loaded with createFromFile(). Row flipping and
+     * expansion of 3-channel images to 4 channels are done in a single pass from the decoder output to the destination.
+     * @param[in] path Path to load from. Searched for in the data directories the same way as in createFromFile().
+     * @param[in] isTopDown Control the memory layout of the image. If true, the top-left pixel is the first pixel in the buffer, otherwise
+     * the bottom-left pixel is first.
+     * @param[in] allocate Callback returning the destination memory.
+     * @param[out] pDesc Optional layout of the decoded image.
+     * @return True if the image was decoded. On failure a warning is logged and false is returned.
+     */
+    static bool decodeFromFile(const std::filesystem::path& path, bool isTopDown, const AllocateFunc& allocate, ImageDesc* pDesc = nullptr);
+
+    /**
+     * Get the export flags selecting a deflate compression level for PNG and ZIP-compressed EXR files.
+     * Combine the result with other export flags. If no level is selected, PNG files use the best compression
+     * and ZIP-compressed EXR files use the zlib default (6).
+     * @param[in] level Compression level, 0 (stored) to 9 (smallest). Values above 9 are clamped.
+     * @return Export flags with the compression level set.
+     */
+    static ExportFlags compressionLevel(uint32_t level);
+
     /**
      * Store a memory buffer to a file.
+     * 8-bit RGBA/BGRA images saved as PNG and floating-point images saved as ZIP-compressed (ExportFlags::ExrZip) or
+     * uncompressed EXR are encoded on multiple threads, see ParallelImageEncoder. Other formats are saved using FreeImage.
      * @param[in] path Path to write to.
      * @param[in] width The width of the image.
      * @param[in] height The height of the image.
@@ -0,0 +1,217 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "CompressedTextureCache.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Core/API/Formats.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Core/Platform/OS.h"
+#include "Utils/CryptoUtils.h"
+#include "Utils/Logger.h"
+#include "Utils/Math/Float16.h"
+#include <cstring>
+#include <fstream>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+/// Cache version. Increment when the transcoding changes to invalidate existing cache entries.
+const uint32_t kVersion = 2;
+/// Cache directory relative to the application data directory.
+const std::filesystem::path kDirectory = "NVIDIA/Falcor/TextureCache";
+/// Extension of the marker files written for images that can't be block-compressed.
+const std::string kNoneExtension = ".none";
+
+const bool kTopDown = true; // Memory layout of the decoded bitmaps.
+
+/// Returns true if all alpha values of a 16-bit or 32-bit floating-point RGBA image are 1.
+bool isAlphaOne(const Bitmap& bitmap)
+{
+    const ResourceFormat format = bitmap.getFormat();
+    const uint32_t bytesPerPixel = getFormatBytesPerBlock(format);
+    const uint32_t alphaBytes = getNumChannelBits(format, 3) / 8;
+    FALCOR_ASSERT(alphaBytes == 2 || alphaBytes == 4);
+
+    for (uint32_t y = 0; y < bitmap.getHeight(); ++y)
+    {
+        const uint8_t* pAlpha = bitmap.getData() + y * bitmap.getRowPitch() + bytesPerPixel - alphaBytes;
+        for (uint32_t x = 0; x < bitmap.getWidth(); ++x, pAlpha += bytesPerPixel)
+        {
+            float alpha;
+            if (alphaBytes == 4)
+            {
+                std::memcpy(&alpha, pAlpha, 4);
+            }
+            else
+            {
+                uint16_t bits;
+                std::memcpy(&bits, pAlpha, 2);
+                alpha = math::float16ToFloat32(bits);
+            }
+            if (alpha != 1.f)
+                return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Create a unique temporary file name in the cache directory.
+ * Cache entries are first written to a temporary file and then renamed, so other threads and processes never observe
+ * partially written entries.
+ */
+std::filesystem::path getTempPath(const std::filesystem::path& directory, const std::string& name)
+{
+    thread_local std::mt19937_64 rng{std::random_device{}()};
+    return directory / fmt::format("{}.{:016x}.tmp", name, rng());
+}
+
+bool commitFile(const std::filesystem::path& tempPath, const std::filesystem::path& path)
+{
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec)
+    {
+        // Another thread or process may have created the same entry concurrently.
+        std::filesystem::remove(tempPath, ec);
+        return std::filesystem::exists(path);
+    }
+    return true;
+}
+} // namespace
+
+CompressedTextureCache::CompressedTextureCache(const std::filesystem::path& directory) : mDirectory(directory) {}
+
+std::filesystem::path CompressedTextureCache::getDefaultDirectory()
+{
+    return getAppDataDirectory() / kDirectory;
+}
+
+std::filesystem::path CompressedTextureCache::getOrCreate(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSRGB)
+{
+    // Compute the cache key from the source file content and the load parameters.
+    std::string name;
+    {
+        MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!file.isOpen())
+            return {};
+
+        SHA1 sha1;
+        sha1.update(kVersion);
+        sha1.update(file.getData(), file.getSize());
+        sha1.update(generateMipLevels);
+        sha1.update(loadAsSRGB);
+        name = SHA1::toString(sha1.finalize());
+    }
+
+    const std::filesystem::path cachePath = mDirectory / (name + ".dds");
+    const std::filesystem::path nonePath = mDirectory / (name + kNoneExtension);
+    if (std::filesystem::exists(cachePath))
+        return cachePath;
+    if (std::filesystem::exists(nonePath))
+        return {};
+
+    // Decode the source image. Failures are not cached, the regular loading path reports them.
+    Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, kTopDown);
+    if (!pBitmap)
+        return {};
+
+    std::error_code ec;
+    std::filesystem::create_directories(mDirectory, ec);
+    if (ec)
+    {
+        logWarning("Failed to create texture cache directory '{}': {}", mDirectory, ec.message());
+        return {};
+    }
+
+    ImageIO::CompressionMode mode = chooseCompressionMode(*pBitmap);
+    if (mode == ImageIO::CompressionMode::None)
+    {
+        // Remember that the image can't be block-compressed to avoid decoding it again on every load.
+        std::filesystem::path tempPath = getTempPath(mDirectory, name);
+        std::ofstream(tempPath).close();
+        commitFile(tempPath, nonePath);
+        return {};
+    }
+
+    std::filesystem::path tempPath = getTempPath(mDirectory, name);
+    try
+    {
+        ImageIO::saveToDDS(tempPath, *pBitmap, mode, generateMipLevels);
+    }
+    catch (const std::exception& e)
+    {
+        logWarning("Failed to transcode '{}' to a block-compressed texture: {}", path, e.what());
+        std::filesystem::remove(tempPath, ec);
+        return {};
+    }
+
+    if (!commitFile(tempPath, cachePath))
+    {
+        logWarning("Failed to write texture cache entry '{}'.", cachePath);
+        return {};
+    }
+
+    logDebug("Transcoded '{}' to block-compressed texture '{}'.", path, cachePath);
+    return cachePath;
+}
+
+ImageIO::CompressionMode CompressedTextureCache::chooseCompressionMode(const Bitmap& bitmap)
+{
+    // The DX spec requires the dimensions of BC encoded textures to be a multiple of 4 at the base resolution.
+    // ImageIO clamps other sizes, which would change the texture dimensions compared to the source image.
+    if (bitmap.getWidth() % 4 != 0 || bitmap.getHeight() % 4 != 0)
+        return ImageIO::CompressionMode::None;
+
+    ResourceFormat format = bitmap.getFormat();
+    if (isCompressedFormat(format))
+        return ImageIO::CompressionMode::None;
+
+    uint32_t channelCount = getFormatChannelCount(format);
+    FormatType type = getFormatType(format);
+    if (type == FormatType::Float)
+    {
+        // BC6 has no alpha channel, so images with alpha are only compressed if the alpha is constant 1.
+        if (channelCount == 3 || (channelCount == 4 && isAlphaOne(bitmap)))
+            return ImageIO::CompressionMode::BC6;
+        return ImageIO::CompressionMode::None;
+    }
+    if ((type == FormatType::Unorm || type == FormatType::UnormSrgb) && getNumChannelBits(format, 0) == 8)
+    {
+        if (channelCount == 1)
+            return ImageIO::CompressionMode::BC4;
+        if (channelCount == 2)
+            return ImageIO::CompressionMode::BC5;
+        if (channelCount >= 3)
+            return ImageIO::CompressionMode::BC7;
+    }
+    return ImageIO::CompressionMode::None;
+}
+} // namespace Falcor
@@ -0,0 +1,81 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "ImageIO.h"
+#include "Core/Macros.h"
+#include <filesystem>
+
+namespace Falcor
+{
+/**
+ * Persistent cache of block-compressed textures.
+ *
+ * Source images are transcoded once on the CPU to a block-compressed DDS file (optionally with a full mip chain).
+ * Cache entries are keyed by the content hash of the source file and the load parameters, so later loads can use the
+ * cached DDS file directly instead of decoding the source image again. The cache is safe to use from multiple threads and processes.
+ */
+class FALCOR_API CompressedTextureCache
+{
+public:
+    /**
+     * Constructor.
+     * @param[in] directory Directory to store the cached textures in.
+     */
+    explicit CompressedTextureCache(const std::filesystem::path& directory = getDefaultDirectory());
+
+    /**
+     * Get the default cache directory (subdirectory in the application data directory).
+     */
+    static std::filesystem::path getDefaultDirectory();
+
+    /**
+     * Get the path of the block-compressed version of an image file, transcoding it on the first use.
+     * @param[in] path Full path of the source image.
+     * @param[in] generateMipLevels Whether the full mip-chain should be generated.
+     * @param[in] loadAsSRGB Whether the texture will be loaded as sRGB.
+     * @return Path to the cached DDS file, or an empty path if the image can't be block-compressed.
+     */
+    std::filesystem::path getOrCreate(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSRGB);
+
+    /**
+     * Choose the block compression mode for an image.
+     * Single channel 8-bit images use BC4, two channel 8-bit images BC5, 8-bit RGB(A) images BC7 and floating-point RGB images BC6.
+     * Floating-point RGBA images use BC6 only if all alpha values are 1, as BC6 has no alpha channel.
+     * Images with other formats, or with dimensions that are not a multiple of the block size, are not compressed.
+     * @param[in] bitmap Image to compress.
+     * @return Compression mode, or CompressionMode::None if the image should not be compressed.
+     */
+    static ImageIO::CompressionMode chooseCompressionMode(const Bitmap& bitmap);
+
+    const std::filesystem::path& getDirectory() const { return mDirectory; }
+
+private:
+    std::filesystem::path mDirectory;
+};
+} // namespace Falcor
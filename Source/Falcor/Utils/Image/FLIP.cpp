@@ -0,0 +1,344 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "FLIP.h"
+#include "Utils/Threading.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include "Utils/Math/MathConstants.slangh"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+
+namespace Falcor
+{
+namespace
+{
+/// Number of image rows processed per task.
+const size_t kRowsPerTask = 16;
+
+const float kQc = 0.7f;
+const float kPc = 0.4f;
+const float kPt = 0.95f;
+const float kW = 0.082f;
+const float kQf = 0.5f;
+
+/// Planes produced by the horizontal pass.
+enum Plane
+{
+    kPlaneA,     ///< Y filtered with the achromatic CSF.
+    kPlaneRG,    ///< Cx filtered with the red-green CSF.
+    kPlaneBY1,   ///< Cz filtered with the first blue-yellow CSF term.
+    kPlaneBY2,   ///< Cz filtered with the second blue-yellow CSF term.
+    kPlaneGauss, ///< Luminance filtered with the Gaussian.
+    kPlanePoint, ///< Luminance filtered with the point detector.
+    kPlaneEdge,  ///< Luminance filtered with the edge detector.
+    kPlaneCount,
+};
+
+/// Per-pixel results of the vertical pass.
+enum Result
+{
+    kY,      ///< Spatially filtered Y.
+    kCx,     ///< Spatially filtered Cx.
+    kCz,     ///< Spatially filtered Cz.
+    kPointX, ///< Horizontal point gradient.
+    kPointY, ///< Vertical point gradient.
+    kEdgeX,  ///< Horizontal edge gradient.
+    kEdgeY,  ///< Vertical edge gradient.
+    kResultCount,
+};
+
+template<typename T>
+T sqr(T x)
+{
+    return x * x;
+}
+
+float HyAB(float3 a, float3 b)
+{
+    float3 diff = a - b;
+    return std::fabs(diff.x) + std::sqrt(diff.y * diff.y + diff.z * diff.z);
+}
+
+float3 Hunt(float3 color)
+{
+    float huntValue = 0.01f * color.x;
+    return float3(color.x, huntValue * color.y, huntValue * color.z);
+}
+
+/// Sums a row of values using independent accumulators to avoid a serial dependency chain.
+double sumRow(const float* values, uint32_t count)
+{
+    double lanes[4] = {};
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        for (uint32_t j = 0; j < 4; ++j)
+            lanes[j] += values[i + j];
+    }
+    for (; i < count; ++i)
+        lanes[0] += values[i];
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+} // namespace
+
+/**
+ * Horizontally filtered rows of a band of output rows, including the rows above and below
+ * that the vertical pass reads, for both the reference (index 0) and the test (index 1) image.
+ */
+struct FLIP::Band
+{
+    uint32_t width;
+    uint32_t firstRow; ///< First filtered image row.
+    uint32_t lastRow;  ///< Last filtered image row (inclusive).
+    std::vector<float> planes[2][kPlaneCount];
+    std::vector<float> results[2][kResultCount]; ///< Scratch space for the vertical pass of one row.
+
+    Band(const FLIP& flip, uint32_t width, size_t rowBegin, size_t rowEnd, uint32_t height) : width(width)
+    {
+        firstRow = uint32_t(std::max<int64_t>(0, int64_t(rowBegin) - flip.mRadius));
+        lastRow = uint32_t(std::min<int64_t>(height - 1, int64_t(rowEnd) - 1 + flip.mRadius));
+        const size_t size = size_t(lastRow - firstRow + 1) * width;
+        for (auto& image : planes)
+            for (auto& plane : image)
+                plane.resize(size);
+        for (auto& image : results)
+            for (auto& result : image)
+                result.resize(width);
+    }
+
+    const float* row(uint32_t image, Plane plane, int y) const
+    {
+        y = std::clamp(y, int(firstRow), int(lastRow));
+        return planes[image][plane].data() + size_t(y - firstRow) * width;
+    }
+
+    /// Converts the rows of the band to YCxCz and runs the horizontal pass.
+    void filter(const FLIP& flip, const Image& image, uint32_t index)
+    {
+        const int radius = flip.mRadius;
+        const uint32_t paddedWidth = width + 2 * radius;
+        std::vector<float> input[4]; // Y, Cx, Cz and normalized luminance with clamped borders.
+        for (auto& channel : input)
+            channel.resize(paddedWidth);
+
+        for (uint32_t y = firstRow; y <= lastRow; ++y)
+        {
+            const float* src = image.pData + size_t(y) * width * 4;
+            for (uint32_t i = 0; i < paddedWidth; ++i)
+            {
+                const float* pixel = src + 4 * std::clamp(int(i) - radius, 0, int(width) - 1);
+                float3 color = math::clamp(float3(pixel[0], pixel[1], pixel[2]), float3(0.f), float3(1.f));
+                if (image.isSrgb)
+                    color = sRGBToLinear(color);
+                float3 ycxcz = linearRGBToYCxCz(color);
+                input[0][i] = ycxcz.x;
+                input[1][i] = ycxcz.y;
+                input[2][i] = ycxcz.z;
+                input[3][i] = (ycxcz.x + 16.f) / 116.f; // Normalized Y from YCxCz.
+            }
+
+            const size_t offset = size_t(y - firstRow) * width;
+            auto convolve = [&](Plane plane, const std::vector<float>& src, const std::vector<float>& kernel)
+            {
+                float* dst = planes[index][plane].data() + offset;
+                std::fill_n(dst, width, 0.f);
+                for (size_t t = 0; t < kernel.size(); ++t)
+                {
+                    const float w = kernel[t];
+                    const float* s = src.data() + t;
+                    for (uint32_t x = 0; x < width; ++x)
+                        dst[x] += w * s[x];
+                }
+            };
+            convolve(kPlaneA, input[0], flip.mKernelA);
+            convolve(kPlaneRG, input[1], flip.mKernelRG);
+            convolve(kPlaneBY1, input[2], flip.mKernelBY1);
+            convolve(kPlaneBY2, input[2], flip.mKernelBY2);
+            convolve(kPlaneGauss, input[3], flip.mKernelGauss);
+            convolve(kPlanePoint, input[3], flip.mKernelPoint);
+            convolve(kPlaneEdge, input[3], flip.mKernelEdge);
+        }
+    }
+
+    /// Runs the vertical pass for one output row and computes the per-pixel FLIP error.
+    void evaluate(const FLIP& flip, uint32_t y, float* errorRow)
+    {
+        for (uint32_t image = 0; image < 2; ++image)
+        {
+            for (auto& result : results[image])
+                std::fill(result.begin(), result.end(), 0.f);
+
+            for (int t = -flip.mRadius; t <= flip.mRadius; ++t)
+            {
+                const size_t k = t + flip.mRadius;
+                const int sy = int(y) + t;
+                auto accumulate = [&](Result result, Plane plane, float w)
+                {
+                    const float* src = row(image, plane, sy);
+                    float* dst = results[image][result].data();
+                    for (uint32_t x = 0; x < width; ++x)
+                        dst[x] += w * src[x];
+                };
+                accumulate(kY, kPlaneA, flip.mKernelA[k] * flip.mNormA);
+                accumulate(kCx, kPlaneRG, flip.mKernelRG[k] * flip.mNormRG);
+                accumulate(kCz, kPlaneBY1, flip.mWeightBY1 * flip.mKernelBY1[k] * flip.mNormBY);
+                accumulate(kCz, kPlaneBY2, flip.mWeightBY2 * flip.mKernelBY2[k] * flip.mNormBY);
+                accumulate(kPointX, kPlanePoint, flip.mKernelGauss[k]);
+                accumulate(kPointY, kPlaneGauss, flip.mKernelPoint[k]);
+                accumulate(kEdgeX, kPlaneEdge, flip.mKernelGauss[k]);
+                accumulate(kEdgeY, kPlaneGauss, flip.mKernelEdge[k]);
+            }
+        }
+
+        const auto& ref = results[0];
+        const auto& test = results[1];
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            // Color pipeline.
+            auto filteredColor = [x](const std::vector<float>* r)
+            {
+                float3 rgb = YCxCzToLinearRGB(float3(r[kY][x], r[kCx][x], r[kCz][x]));
+                return linearRGBToCIELab(math::clamp(rgb, float3(0.f), float3(1.f)));
+            };
+            float colorDifference = HyAB(Hunt(filteredColor(ref)), Hunt(filteredColor(test)));
+
+            // Feature pipeline.
+            float edgeDifference = std::fabs(std::hypot(ref[kEdgeX][x], ref[kEdgeY][x]) - std::hypot(test[kEdgeX][x], test[kEdgeY][x]));
+            float pointDifference =
+                std::fabs(std::hypot(ref[kPointX][x], ref[kPointY][x]) - std::hypot(test[kPointX][x], test[kPointY][x]));
+            float featureDifference = std::pow(std::max(pointDifference, edgeDifference) * float(M_SQRT1_2), kQf);
+
+            float error = flip.redistributeErrors(colorDifference, featureDifference);
+            errorRow[x] = (std::isnan(error) || std::isinf(error) || error < 0.f || error > 1.f) ? 1.f : error;
+        }
+    }
+};
+
+FLIP::FLIP(float pixelsPerDegree)
+{
+    const float dx = 1.f / pixelsPerDegree;
+
+    // See FLIP paper for explanation of the 0.04 and 3.0 factors.
+    mRadius = int(std::ceil(3.f * std::sqrt(0.04f / (2.f * float(M_PI * M_PI))) * pixelsPerDegree));
+    const size_t taps = 2 * mRadius + 1;
+
+    // Contrast sensitivity function kernels: a * sqrt(pi / b) * exp(-pi^2 * d^2 / b), one 1D factor per (a, b) pair.
+    auto csfKernel = [&](float b)
+    {
+        std::vector<float> kernel(taps);
+        for (int i = -mRadius; i <= mRadius; ++i)
+            kernel[i + mRadius] = std::exp(-float(M_PI * M_PI) * sqr(i * dx) / b);
+        return kernel;
+    };
+    mKernelA = csfKernel(0.0047f);
+    mKernelRG = csfKernel(0.0053f);
+    mKernelBY1 = csfKernel(0.04f);
+    mKernelBY2 = csfKernel(0.025f);
+
+    auto sum = [](const std::vector<float>& kernel) { return std::accumulate(kernel.begin(), kernel.end(), 0.f); };
+    mWeightBY1 = 34.1f * std::sqrt(float(M_PI) / 0.04f);
+    mWeightBY2 = 13.5f * std::sqrt(float(M_PI) / 0.025f);
+    mNormA = 1.f / sqr(sum(mKernelA));
+    mNormRG = 1.f / sqr(sum(mKernelRG));
+    mNormBY = 1.f / (mWeightBY1 * sqr(sum(mKernelBY1)) + mWeightBY2 * sqr(sum(mKernelBY2)));
+
+    // Feature detection kernels: Gaussian g and its normalized first (edge) and second (point) derivatives.
+    const float sigmaFeatures = 0.5f * kW * pixelsPerDegree;
+    const float sigmaFeaturesSquared = sigmaFeatures * sigmaFeatures;
+    mKernelGauss.resize(taps);
+    mKernelPoint.resize(taps);
+    mKernelEdge.resize(taps);
+    float positiveSum = 0.f, negativeSum = 0.f, edgeSum = 0.f;
+    for (int i = -mRadius; i <= mRadius; ++i)
+    {
+        float g = std::exp(-float(i * i) / (2.f * sigmaFeaturesSquared));
+        mKernelGauss[i + mRadius] = g;
+        mKernelPoint[i + mRadius] = (float(i * i) / sigmaFeaturesSquared - 1.f) * g;
+        mKernelEdge[i + mRadius] = -float(i) * g;
+        positiveSum += std::max(mKernelPoint[i + mRadius], 0.f);
+        negativeSum += std::max(-mKernelPoint[i + mRadius], 0.f);
+        edgeSum += std::max(mKernelEdge[i + mRadius], 0.f);
+    }
+    // The shader normalizes by sums over the 2D kernel, which factor into a 1D sum times the sum of the Gaussian.
+    const float gaussSum = sum(mKernelGauss);
+    for (size_t i = 0; i < taps; ++i)
+    {
+        mKernelPoint[i] /= (mKernelPoint[i] >= 0.f ? positiveSum : negativeSum) * gaussSum;
+        mKernelEdge[i] /= edgeSum * gaussSum;
+    }
+
+    mMaxDistance = std::pow(HyAB(Hunt(linearRGBToCIELab(float3(0.f, 1.f, 0.f))), Hunt(linearRGBToCIELab(float3(0.f, 0.f, 1.f)))), kQc);
+}
+
+double FLIP::compare(const Image& reference, const Image& test, uint32_t width, uint32_t height, float* errorMap) const
+{
+    const size_t count = size_t(width) * height;
+    if (count == 0)
+        return 0.0;
+
+    double sum = Threading::parallelReduce(
+        0,
+        height,
+        0.0,
+        [&](size_t rowBegin, size_t rowEnd, double bandSum)
+        {
+            Band band(*this, width, rowBegin, rowEnd, height);
+            band.filter(*this, reference, 0);
+            band.filter(*this, test, 1);
+
+            std::vector<float> scratch(errorMap ? 0 : width);
+            for (size_t y = rowBegin; y < rowEnd; ++y)
+            {
+                float* errorRow = errorMap ? errorMap + y * width : scratch.data();
+                band.evaluate(*this, uint32_t(y), errorRow);
+                bandSum += sumRow(errorRow, width);
+            }
+            return bandSum;
+        },
+        std::plus<double>(),
+        kRowsPerTask
+    );
+
+    return sum / count;
+}
+
+float FLIP::redistributeErrors(float colorDifference, float featureDifference) const
+{
+    float error = std::pow(colorDifference, kQc);
+
+    // Normalization.
+    float perceptualCutoff = kPc * mMaxDistance;
+    if (error < perceptualCutoff)
+        error *= kPt / perceptualCutoff;
+    else
+        error = kPt + ((error - perceptualCutoff) / (mMaxDistance - perceptualCutoff)) * (1.f - kPt);
+
+    return std::pow(error, 1.f - featureDifference);
+}
+} // namespace Falcor
@@ -0,0 +1,94 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <cstdint>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * CPU implementation of LDR-FLIP, matching the FLIPPass render pass (see RenderPasses/FLIPPass/FLIPPass.cs.slang).
+ * Colors are clamped to [0,1] after converting them to linear RGB.
+ *
+ * All filter kernels used by FLIP are separable (sums of) Gaussians and Gaussian derivatives, so they are
+ * evaluated as a horizontal and a vertical pass instead of the dense 2D loop used by the shader.
+ * The image is processed in horizontal bands on the thread pool to keep the intermediate results in cache.
+ */
+class FALCOR_API FLIP
+{
+public:
+    /// Default pixels per degree, matching the default viewing conditions of FLIPPass (0.7 m wide 4K monitor at 0.7 m distance).
+    static constexpr float kDefaultPixelsPerDegree = 0.7f * (3840.f / 0.7f) * (3.14159265358979323846f / 180.f);
+
+    /// Image passed to compare().
+    struct Image
+    {
+        const float* pData = nullptr; ///< RGBA32Float pixels, rows tightly packed. Alpha is ignored.
+        bool isSrgb = false;          ///< True if the values are sRGB encoded (e.g. loaded from an 8-bit file) instead of linear.
+    };
+
+    /**
+     * Constructor.
+     * @param[in] pixelsPerDegree Viewing conditions.
+     */
+    FLIP(float pixelsPerDegree = kDefaultPixelsPerDegree);
+
+    /**
+     * Compute the mean FLIP error.
+     * The per-pixel errors are accumulated in double precision.
+     * @param[in] reference Reference image.
+     * @param[in] test Test image with the same resolution.
+     * @param[in] width Image width in pixels.
+     * @param[in] height Image height in pixels.
+     * @param[out] errorMap Optional per-pixel FLIP error (width * height values in [0,1]).
+     * @return Mean FLIP error.
+     */
+    double compare(const Image& reference, const Image& test, uint32_t width, uint32_t height, float* errorMap = nullptr) const;
+
+private:
+    struct Band;
+
+    float redistributeErrors(float colorDifference, float featureDifference) const;
+
+    int mRadius;
+    std::vector<float> mKernelA;
+    std::vector<float> mKernelRG;
+    std::vector<float> mKernelBY1;
+    std::vector<float> mKernelBY2;
+    std::vector<float> mKernelGauss;
+    std::vector<float> mKernelPoint;
+    std::vector<float> mKernelEdge;
+    float mWeightBY1;
+    float mWeightBY2;
+    float mNormA;
+    float mNormRG;
+    float mNormBY;
+    float mMaxDistance;
+};
+} // namespace Falcor
@@ -168,13 +168,14 @@ nvtt::InputFormat convertToNvttInputFormat(ResourceFormat format)
     uint32_t wBits = getNumChannelBits(format, 3);
 
     bool isR32Float = channelCount == 1 && xBits == 32;
+    bool isR8 = channelCount == 1 && xBits == 8; // Expanded to the red channel of BGRA in setImage().
     bool isSupportedTwoChannel = channelCount == 2 && xBits == yBits;                     // all RG formats
     bool isSupportedThreeChannel = channelCount == 3 && xBits == yBits && yBits == zBits; // all RGB formats
     bool isSupportedFourChannel = xBits == yBits && yBits == zBits && zBits == wBits;
 
     // These are fairly broadly sorted into the five NVTT input formats. Most resource formats will require
     // modifications to the data before being passed to NVTT for exporting; this is done later on in setImage().
-    if (isR32Float || isSupportedTwoChannel || isSupportedThreeChannel || isSupportedFourChannel)
+    if (isR32Float || isR8 || isSupportedTwoChannel || isSupportedThreeChannel || isSupportedFourChannel)
     {
         if (isSupportedThreeChannel)
         {
@@ -280,7 +281,14 @@ void setImage(
         {
             uint32_t i = h * srcWidth + w;    // Source data index
             uint32_t j = h * image.width + w; // Destination data index - Same as source index if no clamping is involved
-            if (channelCount == 1)
+            if (channelCount == 1 && reverseRB)
+            {
+                dst[4 * j] = T(0);
+                dst[4 * j + 1] = T(0);
+                dst[4 * j + 2] = T(src[i]);
+                dst[4 * j + 3] = T(0);
+            }
+            else if (channelCount == 1)
             {
                 dst[j] = T(src[i]);
             }
@@ -570,7 +578,7 @@ Bitmap::UniqueConstPtr ImageIO::loadBitmapFromDDS(const std::filesystem::path& p
     return Bitmap::create(data.width, data.height, data.format, data.imageData.data());
 }
 
-ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesystem::path& path, bool loadAsSrgb)
+std::unique_ptr<ImageIO::DDSImage> ImageIO::loadDDSImage(const std::filesystem::path& path, bool loadAsSrgb)
 {
     ImportData data;
     try
@@ -583,25 +591,52 @@ ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesys
         return nullptr;
     }
 
-    ref<Texture> pTex;
+    auto pImage = std::make_unique<DDSImage>();
+    pImage->type = data.type;
+    pImage->format = data.format;
+    pImage->width = data.width;
+    pImage->height = data.height;
+    pImage->depth = data.depth;
+    pImage->arraySize = data.arraySize;
+    pImage->mipLevels = data.mipLevels;
+    pImage->data = std::move(data.imageData);
+    return pImage;
+}
+
+ref<Texture> ImageIO::createTextureFromDDS(ref<Device> pDevice, const DDSImage& image)
+{
     // TODO: Automatic mip generation
-    switch (data.type)
+    switch (image.type)
     {
     case Resource::Type::Texture1D:
-        pTex = Texture::create1D(pDevice, data.width, data.format, data.arraySize, data.mipLevels, data.imageData.data());
-        break;
+        return Texture::create1D(pDevice, image.width, image.format, image.arraySize, image.mipLevels, image.data.data());
     case Resource::Type::Texture2D:
-        pTex = Texture::create2D(pDevice, data.width, data.height, data.format, data.arraySize, data.mipLevels, data.imageData.data());
-        break;
+        return Texture::create2D(pDevice, image.width, image.height, image.format, image.arraySize, image.mipLevels, image.data.data());
     case Resource::Type::TextureCube:
-        pTex =
-            Texture::createCube(pDevice, data.width, data.height, data.format, data.arraySize / 6, data.mipLevels, data.imageData.data());
-        break;
+        return Texture::createCube(
+            pDevice, image.width, image.height, image.format, image.arraySize / 6, image.mipLevels, image.data.data()
+        );
     case Resource::Type::Texture3D:
-        pTex = Texture::create3D(pDevice, data.width, data.height, data.depth, data.format, data.mipLevels, data.imageData.data());
-        break;
+        return Texture::create3D(pDevice, image.width, image.height, image.depth, image.format, image.mipLevels, image.data.data());
     default:
-        logWarning("Failed to load DDS image from '{}': Unrecognized texture type.", path);
+        throw RuntimeError("Unrecognized texture type.");
+    }
+}
+
+ref<Texture> ImageIO::loadTextureFromDDS(ref<Device> pDevice, const std::filesystem::path& path, bool loadAsSrgb)
+{
+    auto pImage = loadDDSImage(path, loadAsSrgb);
+    if (!pImage)
+        return nullptr;
+
+    ref<Texture> pTex;
+    try
+    {
+        pTex = createTextureFromDDS(pDevice, *pImage);
+    }
+    catch (const RuntimeError& e)
+    {
+        logWarning("Failed to load DDS image from '{}': {}", path, e.what());
         return nullptr;
     }
 
@@ -30,6 +30,8 @@
 #include "Core/Macros.h"
 #include "Core/API/Texture.h"
 #include <filesystem>
+#include <memory>
+#include <vector>
 
 namespace Falcor
 {
@@ -80,6 +82,36 @@ public:
      */
     static Bitmap::UniqueConstPtr loadBitmapFromDDS(const std::filesystem::path& path); // top down = true
 
+    /// Contents of a DDS file in CPU memory, including all mips and array images.
+    struct DDSImage
+    {
+        Resource::Type type = Resource::Type::Texture2D;
+        ResourceFormat format = ResourceFormat::Unknown;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t depth = 0;
+        uint32_t arraySize = 0;
+        uint32_t mipLevels = 0;
+        std::vector<uint8_t> data; ///< Subresource data in the layout expected by the Texture::create*() functions.
+    };
+
+    /**
+     * Load a DDS file to CPU memory. This does not access the GPU and can be called from any thread.
+     * @param[in] path Path of file to load.
+     * @param[in] loadAsSrgb If true, convert the image format property to a corresponding sRGB format if available. Image data is not
+     * changed.
+     * @return DDS image if loading was successful. Otherwise, nullptr.
+     */
+    static std::unique_ptr<DDSImage> loadDDSImage(const std::filesystem::path& path, bool loadAsSrgb);
+
+    /**
+     * Create a Texture from a DDS image loaded with loadDDSImage().
+     * Throws an exception if the texture type is not supported.
+     * @param[in] image DDS image.
+     * @return Texture object containing the image data.
+     */
+    static ref<Texture> createTextureFromDDS(ref<Device> pDevice, const DDSImage& image);
+
     /**
      * Load a DDS file to a Texture.
      * Throws an exception if the DDS file is malformed.
@@ -28,6 +28,8 @@
 #include "ImageProcessing.h"
 #include "Core/API/RenderContext.h"
 #include "Utils/Math/Vector.h"
+#include "Utils/Threading.h"
+#include <cstring>
 
 namespace Falcor
 {
@@ -108,4 +110,60 @@ void ImageProcessing::copyColorChannel(
 
     pPass->execute(pRenderContext, uint3(srcDim, 1));
 }
+
+bool ImageProcessing::canExtractColorChannel(ResourceFormat format)
+{
+    if (isCompressedFormat(format) || isDepthStencilFormat(format) || isSrgbFormat(format))
+        return false;
+    switch (format)
+    {
+    case ResourceFormat::BGRA4Unorm:
+    case ResourceFormat::BGRA8Unorm:
+    case ResourceFormat::BGRX8Unorm:
+        return false;
+    default:
+        break;
+    }
+    uint32_t bits = getNumChannelBits(format, 0);
+    if (bits == 0 || bits % 8 != 0)
+        return false;
+    for (uint32_t i = 1; i < getFormatChannelCount(format); i++)
+    {
+        if (getNumChannelBits(format, i) != bits)
+            return false;
+    }
+    return getFormatBytesPerBlock(format) == getFormatChannelCount(format) * bits / 8;
+}
+
+std::vector<uint8_t> ImageProcessing::extractColorChannel(
+    const void* pData,
+    ResourceFormat format,
+    uint32_t channel,
+    uint32_t width,
+    uint32_t height
+)
+{
+    FALCOR_ASSERT(pData);
+    if (!canExtractColorChannel(format))
+        throw ArgumentError("Can't extract color channels from format '{}' on the CPU.", to_string(format));
+    if (channel >= getFormatChannelCount(format))
+        throw ArgumentError("Channel index {} is out of range for format '{}'.", channel, to_string(format));
+
+    const size_t channelSize = getNumChannelBits(format, 0) / 8;
+    const size_t pixelSize = getFormatBytesPerBlock(format);
+
+    std::vector<uint8_t> result((size_t)width * height * channelSize);
+    const uint8_t* pSrc = reinterpret_cast<const uint8_t*>(pData) + channel * channelSize;
+    uint8_t* pDst = result.data();
+    Threading::parallelForRange(
+        0,
+        height,
+        [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin * width; i < end * width; i++)
+                std::memcpy(pDst + i * channelSize, pSrc + i * pixelSize, channelSize);
+        }
+    );
+    return result;
+}
 } // namespace Falcor
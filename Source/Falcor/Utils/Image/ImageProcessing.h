@@ -31,6 +31,7 @@
 #include "Core/API/ResourceViews.h"
 #include "Core/Pass/ComputePass.h"
 #include <memory>
+#include <vector>
 
 namespace Falcor
 {
@@ -62,6 +63,33 @@ public:
         const TextureChannelFlags srcMask
     );
 
+    /**
+     * Check if a single color channel can be extracted from image data on the CPU, see extractColorChannel().
+     * This requires all channels to be stored in RGBA order with the same byte-aligned size.
+     * sRGB formats are not supported, as copyColorChannel() returns linear values for them.
+     * @param[in] format Format of the image data.
+     * @return True if extractColorChannel() can be used for the format.
+     */
+    static bool canExtractColorChannel(ResourceFormat format);
+
+    /**
+     * Extract a single color channel from tightly packed image data on the CPU.
+     * The result matches copyColorChannel() to a single channel texture of the same bit depth.
+     * @param[in] pData Image data.
+     * @param[in] format Format of the image data. Must be supported by canExtractColorChannel().
+     * @param[in] channel Index of the channel to extract.
+     * @param[in] width Image width in pixels.
+     * @param[in] height Image height in pixels.
+     * @return Tightly packed channel data.
+     */
+    static std::vector<uint8_t> extractColorChannel(
+        const void* pData,
+        ResourceFormat format,
+        uint32_t channel,
+        uint32_t width,
+        uint32_t height
+    );
+
 private:
     ref<Device> mpDevice;
     ref<ComputePass> mpCopyFloatPass;
@@ -0,0 +1,479 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "MipChainGenerator.h"
+#include "Core/Errors.h"
+#include "Utils/Threading.h"
+#include "Utils/Math/Float16.h"
+#include "Utils/Math/Vector.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Falcor
+{
+namespace
+{
+const float kKaiserWidth = 3.f;  ///< Radius of the Kaiser filter in destination texels.
+const float kKaiserAlpha = 4.f;  ///< Shape parameter of the Kaiser window.
+const size_t kRowGrainSize = 16; ///< Number of image rows processed per task.
+
+/// Memory layout of a supported pixel format.
+struct PixelLayout
+{
+    uint32_t channelCount = 0;    ///< Number of channels stored in memory.
+    uint32_t bytesPerChannel = 0; ///< Size of each channel in bytes (1 = unorm, 2/4 = float).
+    bool isBGR = false;           ///< Red and blue channels are swapped in memory.
+    bool hasAlpha = false;        ///< The fourth channel is alpha (false for BGRX formats, where it is ignored).
+    bool isSrgb = false;          ///< Color channels are sRGB encoded.
+
+    uint32_t getBytesPerPixel() const { return channelCount * bytesPerChannel; }
+};
+
+bool findPixelLayout(ResourceFormat format, PixelLayout& layout)
+{
+    switch (format)
+    {
+    case ResourceFormat::R8Unorm:
+        layout = {1, 1};
+        break;
+    case ResourceFormat::RG8Unorm:
+        layout = {2, 1};
+        break;
+    case ResourceFormat::RGBA8Unorm:
+        layout = {4, 1, false, true};
+        break;
+    case ResourceFormat::BGRA8Unorm:
+        layout = {4, 1, true, true};
+        break;
+    case ResourceFormat::BGRX8Unorm:
+        layout = {4, 1, true, false};
+        break;
+    case ResourceFormat::R16Float:
+        layout = {1, 2};
+        break;
+    case ResourceFormat::RG16Float:
+        layout = {2, 2};
+        break;
+    case ResourceFormat::RGBA16Float:
+        layout = {4, 2, false, true};
+        break;
+    case ResourceFormat::R32Float:
+        layout = {1, 4};
+        break;
+    case ResourceFormat::RG32Float:
+        layout = {2, 4};
+        break;
+    case ResourceFormat::RGB32Float:
+        layout = {3, 4};
+        break;
+    case ResourceFormat::RGBA32Float:
+        layout = {4, 4, false, true};
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+PixelLayout getPixelLayout(ResourceFormat format, bool loadAsSrgb)
+{
+    PixelLayout layout;
+    if (!findPixelLayout(format, layout))
+        throw ArgumentError("Unsupported format '{}'.", to_string(format));
+    layout.isSrgb = loadAsSrgb && isSrgbFormat(linearToSrgbFormat(format));
+    return layout;
+}
+
+float srgbToLinear(float v)
+{
+    return v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+}
+
+float linearToSrgb(float v)
+{
+    return v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.f / 2.4f) - 0.055f;
+}
+
+const std::array<float, 256>& getSrgbToLinearTable()
+{
+    static const std::array<float, 256> table = []()
+    {
+        std::array<float, 256> t;
+        for (size_t i = 0; i < t.size(); ++i)
+            t[i] = srgbToLinear(i / 255.f);
+        return t;
+    }();
+    return table;
+}
+
+/**
+ * Decode a row of texels to RGBA fp32, the same way the GPU reads them from a texture.
+ * Missing color channels are set to zero and missing alpha to one.
+ */
+void decodeRow(const PixelLayout& layout, const uint8_t* pSrc, uint32_t width, float4* pDst)
+{
+    const auto& srgbTable = getSrgbToLinearTable();
+    const uint32_t bytesPerPixel = layout.getBytesPerPixel();
+    for (uint32_t x = 0; x < width; ++x)
+    {
+        const uint8_t* pTexel = pSrc + x * bytesPerPixel;
+        float4 value(0.f, 0.f, 0.f, 1.f);
+        for (uint32_t j = 0; j < layout.channelCount; ++j)
+        {
+            const int c = layout.isBGR && j < 3 ? 2 - j : j;
+            if (c == 3 && !layout.hasAlpha)
+                continue;
+            const uint8_t* pChannel = pTexel + j * layout.bytesPerChannel;
+            switch (layout.bytesPerChannel)
+            {
+            case 1:
+                value[c] = layout.isSrgb && c < 3 ? srgbTable[*pChannel] : *pChannel / 255.f;
+                break;
+            case 2:
+            {
+                uint16_t bits;
+                std::memcpy(&bits, pChannel, sizeof(bits));
+                value[c] = math::float16ToFloat32(bits);
+                break;
+            }
+            default:
+                std::memcpy(&value[c], pChannel, sizeof(float));
+                break;
+            }
+        }
+        pDst[x] = value;
+    }
+}
+
+/// Encode a row of RGBA fp32 texels to the pixel format. Unorm values are clamped to [0,1].
+void encodeRow(const PixelLayout& layout, const float4* pSrc, uint32_t width, uint8_t* pDst)
+{
+    const uint32_t bytesPerPixel = layout.getBytesPerPixel();
+    for (uint32_t x = 0; x < width; ++x)
+    {
+        uint8_t* pTexel = pDst + x * bytesPerPixel;
+        for (uint32_t j = 0; j < layout.channelCount; ++j)
+        {
+            const int c = layout.isBGR && j < 3 ? 2 - j : j;
+            float value = c == 3 && !layout.hasAlpha ? 1.f : pSrc[x][c];
+            uint8_t* pChannel = pTexel + j * layout.bytesPerChannel;
+            switch (layout.bytesPerChannel)
+            {
+            case 1:
+                value = std::clamp(value, 0.f, 1.f);
+                if (layout.isSrgb && c < 3)
+                    value = linearToSrgb(value);
+                *pChannel = (uint8_t)(value * 255.f + 0.5f);
+                break;
+            case 2:
+            {
+                uint16_t bits = math::float32ToFloat16(value);
+                std::memcpy(pChannel, &bits, sizeof(bits));
+                break;
+            }
+            default:
+                std::memcpy(pChannel, &value, sizeof(float));
+                break;
+            }
+        }
+    }
+}
+
+/// Partial analysis result of a set of texels.
+struct Analysis
+{
+    uint32_t mask = 0; ///< Same layout as TextureAnalyzer::Result::mask.
+    float4 minValue = float4(std::numeric_limits<float>::max());
+    float4 maxValue = float4(-std::numeric_limits<float>::max());
+};
+
+/// Accumulate a row of texels into an analysis result. This matches the per-texel logic of TextureAnalyzer.cs.slang.
+void analyzeRow(const float4* pRow, uint32_t width, const float4& reference, Analysis& analysis)
+{
+    for (uint32_t x = 0; x < width; ++x)
+    {
+        const float4 value = pRow[x];
+        for (int i = 0; i < 4; ++i)
+        {
+            const float v = value[i];
+            uint32_t range = 0;
+            if (v > 0.f)
+                range |= (uint32_t)TextureAnalyzer::Result::RangeFlags::Pos;
+            if (v < 0.f)
+                range |= (uint32_t)TextureAnalyzer::Result::RangeFlags::Neg;
+            if (std::isinf(v))
+                range |= (uint32_t)TextureAnalyzer::Result::RangeFlags::Inf;
+            if (std::isnan(v))
+                range |= (uint32_t)TextureAnalyzer::Result::RangeFlags::NaN;
+            analysis.mask |= (v != reference[i] ? 1u << i : 0u) | (range << (4 + 4 * i));
+            analysis.minValue[i] = std::fmin(analysis.minValue[i], v);
+            analysis.maxValue[i] = std::fmax(analysis.maxValue[i], v);
+        }
+    }
+}
+
+Analysis combineAnalysis(const Analysis& a, const Analysis& b)
+{
+    Analysis result;
+    result.mask = a.mask | b.mask;
+    result.minValue = min(a.minValue, b.minValue);
+    result.maxValue = max(a.maxValue, b.maxValue);
+    return result;
+}
+
+TextureAnalyzer::Result toResult(const Analysis& analysis, const float4& reference)
+{
+    TextureAnalyzer::Result result = {};
+    result.mask = analysis.mask;
+    result.value = reference;
+    // The GPU analyzer clamps to zero since it uses integer atomics.
+    result.minValue = max(analysis.minValue, float4(0.f));
+    result.maxValue = max(analysis.maxValue, float4(0.f));
+    return result;
+}
+
+float bessel0(float x)
+{
+    // Power series of the zeroth order modified Bessel function of the first kind.
+    const float halfX = 0.5f * x;
+    float sum = 1.f;
+    float term = 1.f;
+    for (int k = 1; k < 32; ++k)
+    {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+        if (term < sum * 1e-7f)
+            break;
+    }
+    return sum;
+}
+
+float kaiser(float x)
+{
+    if (std::abs(x) >= kKaiserWidth)
+        return 0.f;
+    const float t = x / kKaiserWidth;
+    const float sinc = std::abs(x) < 1e-5f ? 1.f : std::sin((float)M_PI * x) / ((float)M_PI * x);
+    return sinc * bessel0(kKaiserAlpha * std::sqrt(1.f - t * t)) / bessel0(kKaiserAlpha);
+}
+
+/// Filter taps for resampling one image dimension. All destination texels use the same number of taps.
+struct FilterTaps
+{
+    uint32_t tapCount = 0;
+    std::vector<uint32_t> indices; ///< Source texel index per tap, clamped to the image edge (dstSize * tapCount).
+    std::vector<float> weights;    ///< Normalized weight per tap (dstSize * tapCount).
+};
+
+FilterTaps computeFilterTaps(uint32_t srcSize, uint32_t dstSize, MipChainGenerator::Filter filter)
+{
+    const float scale = (float)srcSize / dstSize;
+    const float radius = (filter == MipChainGenerator::Filter::Box ? 0.5f : kKaiserWidth) * scale; // In source texels.
+
+    FilterTaps taps;
+    taps.tapCount = (uint32_t)std::ceil(2.f * radius) + 1;
+    taps.indices.resize((size_t)dstSize * taps.tapCount);
+    taps.weights.resize((size_t)dstSize * taps.tapCount);
+
+    for (uint32_t x = 0; x < dstSize; ++x)
+    {
+        const float center = (x + 0.5f) * scale;
+        const int first = (int)std::floor(center - radius);
+        uint32_t* pIndices = &taps.indices[(size_t)x * taps.tapCount];
+        float* pWeights = &taps.weights[(size_t)x * taps.tapCount];
+        float sum = 0.f;
+        for (uint32_t t = 0; t < taps.tapCount; ++t)
+        {
+            const int i = first + (int)t;
+            float w = 0.f;
+            if (filter == MipChainGenerator::Filter::Box)
+                w = std::max(0.f, std::min(i + 1.f, center + radius) - std::max((float)i, center - radius)); // Texel coverage.
+            else
+                w = kaiser((i + 0.5f - center) / scale);
+            pIndices[t] = (uint32_t)std::clamp(i, 0, (int)srcSize - 1);
+            pWeights[t] = w;
+            sum += w;
+        }
+        if (sum != 0.f)
+        {
+            for (uint32_t t = 0; t < taps.tapCount; ++t)
+                pWeights[t] /= sum;
+        }
+    }
+
+    return taps;
+}
+
+/// Resample a row of texels horizontally.
+void filterRow(const float4* pSrc, const FilterTaps& taps, uint32_t dstWidth, float4* pDst)
+{
+    for (uint32_t x = 0; x < dstWidth; ++x)
+    {
+        const uint32_t* pIndices = &taps.indices[(size_t)x * taps.tapCount];
+        const float* pWeights = &taps.weights[(size_t)x * taps.tapCount];
+        float4 sum(0.f);
+        for (uint32_t t = 0; t < taps.tapCount; ++t)
+            sum += pWeights[t] * pSrc[pIndices[t]];
+        pDst[x] = sum;
+    }
+}
+
+/// Compute destination row y by resampling an image vertically. Whole rows are accumulated so the inner loop is a contiguous multiply-add.
+void filterColumns(const float4* pSrc, uint32_t width, const FilterTaps& taps, uint32_t y, float4* pDst)
+{
+    std::fill(pDst, pDst + width, float4(0.f));
+    const uint32_t* pIndices = &taps.indices[(size_t)y * taps.tapCount];
+    const float* pWeights = &taps.weights[(size_t)y * taps.tapCount];
+    for (uint32_t t = 0; t < taps.tapCount; ++t)
+    {
+        const float w = pWeights[t];
+        if (w == 0.f)
+            continue;
+        const float4* pRow = pSrc + (size_t)pIndices[t] * width;
+        for (uint32_t x = 0; x < width; ++x)
+            pDst[x] += w * pRow[x];
+    }
+}
+} // namespace
+
+bool MipChainGenerator::isFormatSupported(ResourceFormat format)
+{
+    PixelLayout layout;
+    return findPixelLayout(format, layout);
+}
+
+std::vector<Bitmap::UniqueConstPtr> MipChainGenerator::generate(
+    const Bitmap& mip0,
+    Filter filter,
+    bool loadAsSrgb,
+    TextureAnalyzer::Result* pResult
+)
+{
+    const PixelLayout layout = getPixelLayout(mip0.getFormat(), loadAsSrgb);
+    const uint32_t bytesPerPixel = layout.getBytesPerPixel();
+
+    float4 reference;
+    decodeRow(layout, mip0.getData(), 1, &reference);
+    Analysis analysis;
+
+    std::vector<Bitmap::UniqueConstPtr> mips;
+    std::vector<float4> srcImage; // Previous mip level in RGBA fp32. The base level is decoded row by row instead.
+    std::vector<float4> tmpImage; // Horizontally filtered rows.
+    std::vector<float4> dstImage;
+    std::vector<uint8_t> dstData;
+    uint32_t srcWidth = mip0.getWidth();
+    uint32_t srcHeight = mip0.getHeight();
+
+    while (srcWidth > 1 || srcHeight > 1)
+    {
+        const uint32_t dstWidth = std::max(srcWidth / 2, 1u);
+        const uint32_t dstHeight = std::max(srcHeight / 2, 1u);
+        const FilterTaps horizontalTaps = computeFilterTaps(srcWidth, dstWidth, filter);
+        const FilterTaps verticalTaps = computeFilterTaps(srcHeight, dstHeight, filter);
+        const bool isBaseLevel = mips.empty();
+
+        // Horizontal pass. The base level is decoded and analyzed in the same pass.
+        tmpImage.resize((size_t)dstWidth * srcHeight);
+        Analysis levelAnalysis = Threading::parallelReduce(
+            0, srcHeight, Analysis{},
+            [&](size_t begin, size_t end, Analysis partial)
+            {
+                std::vector<float4> row(isBaseLevel ? srcWidth : 0);
+                for (size_t y = begin; y < end; ++y)
+                {
+                    const float4* pRow = srcImage.data() + y * srcWidth;
+                    if (isBaseLevel)
+                    {
+                        decodeRow(layout, mip0.getData() + y * mip0.getRowPitch(), srcWidth, row.data());
+                        analyzeRow(row.data(), srcWidth, reference, partial);
+                        pRow = row.data();
+                    }
+                    filterRow(pRow, horizontalTaps, dstWidth, tmpImage.data() + y * dstWidth);
+                }
+                return partial;
+            },
+            combineAnalysis, kRowGrainSize
+        );
+        if (isBaseLevel)
+            analysis = levelAnalysis;
+
+        // Vertical pass.
+        dstImage.resize((size_t)dstWidth * dstHeight);
+        Threading::parallelFor(
+            0, dstHeight, [&](size_t y) { filterColumns(tmpImage.data(), dstWidth, verticalTaps, (uint32_t)y, dstImage.data() + y * dstWidth); },
+            kRowGrainSize
+        );
+
+        // Encode to the source format.
+        dstData.resize((size_t)dstWidth * dstHeight * bytesPerPixel);
+        Threading::parallelFor(
+            0, dstHeight,
+            [&](size_t y) { encodeRow(layout, dstImage.data() + y * dstWidth, dstWidth, dstData.data() + y * dstWidth * bytesPerPixel); },
+            kRowGrainSize
+        );
+        mips.push_back(Bitmap::create(dstWidth, dstHeight, mip0.getFormat(), dstData.data()));
+
+        std::swap(srcImage, dstImage);
+        srcWidth = dstWidth;
+        srcHeight = dstHeight;
+    }
+
+    if (pResult)
+        *pResult = mips.empty() ? analyze(mip0, loadAsSrgb) : toResult(analysis, reference);
+
+    return mips;
+}
+
+TextureAnalyzer::Result MipChainGenerator::analyze(const Bitmap& bitmap, bool loadAsSrgb)
+{
+    const PixelLayout layout = getPixelLayout(bitmap.getFormat(), loadAsSrgb);
+    const uint32_t width = bitmap.getWidth();
+
+    float4 reference;
+    decodeRow(layout, bitmap.getData(), 1, &reference);
+
+    Analysis analysis = Threading::parallelReduce(
+        0, bitmap.getHeight(), Analysis{},
+        [&](size_t begin, size_t end, Analysis partial)
+        {
+            std::vector<float4> row(width);
+            for (size_t y = begin; y < end; ++y)
+            {
+                decodeRow(layout, bitmap.getData() + y * bitmap.getRowPitch(), width, row.data());
+                analyzeRow(row.data(), width, reference, partial);
+            }
+            return partial;
+        },
+        combineAnalysis, kRowGrainSize
+    );
+
+    return toResult(analysis, reference);
+}
+} // namespace Falcor
@@ -0,0 +1,92 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "TextureAnalyzer.h"
+#include "Core/Macros.h"
+#include "Core/API/Formats.h"
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * CPU mip-chain generation and texture analysis.
+ *
+ * This is used to prepare textures at decode time, before they are uploaded to the GPU.
+ * Filtering is done in linear space on RGBA fp32 rows, one pass per dimension. Texture statistics
+ * equivalent to TextureAnalyzer are computed in the same pass that reads the base level.
+ *
+ * Supported formats are 8-bit unorm (R8, RG8, RGBA8, BGRA8, BGRX8) and 16/32-bit float formats.
+ */
+class FALCOR_API MipChainGenerator
+{
+public:
+    /// Downsampling filter.
+    enum class Filter
+    {
+        Box,    ///< Box filter. Averages 2x2 texels for power-of-two textures, same as GPU mip generation.
+        Kaiser, ///< Kaiser-windowed sinc filter. Sharper than the box filter.
+    };
+
+    /**
+     * Check if a format is supported.
+     * @param[in] format Bitmap format.
+     * @return True if the format is supported by generate() and analyze().
+     */
+    static bool isFormatSupported(ResourceFormat format);
+
+    /**
+     * Generate the full mip chain of an image.
+     * Each mip level has half the dimensions of the previous level (rounded down, minimum 1), down to 1x1.
+     * This matches the mip chain created by Texture::createFromBitmaps() with 'generateMipLevels' set.
+     * Throws an exception if the format is not supported.
+     * @param[in] mip0 Base level image.
+     * @param[in] filter Downsampling filter.
+     * @param[in] loadAsSrgb Treat color channels as sRGB encoded if the format has an sRGB variant (same as Texture::createFromBitmaps()).
+     * @param[out] pResult Optional analysis result of the base level, see analyze().
+     * @return Mip levels 1 to N, in the same format as the base level.
+     */
+    static std::vector<Bitmap::UniqueConstPtr> generate(
+        const Bitmap& mip0,
+        Filter filter,
+        bool loadAsSrgb,
+        TextureAnalyzer::Result* pResult = nullptr
+    );
+
+    /**
+     * Analyze an image on the CPU.
+     * The result matches what TextureAnalyzer computes for a texture created from the image, i.e. texels are
+     * read as RGBA fp32 values (sRGB decoded if applicable, missing channels read as zero and alpha as one).
+     * Throws an exception if the format is not supported.
+     * @param[in] bitmap Image to analyze.
+     * @param[in] loadAsSrgb Treat color channels as sRGB encoded if the format has an sRGB variant.
+     * @return Analysis result.
+     */
+    static TextureAnalyzer::Result analyze(const Bitmap& bitmap, bool loadAsSrgb);
+};
+} // namespace Falcor
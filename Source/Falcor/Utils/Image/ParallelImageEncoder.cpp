@@ -0,0 +1,559 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "ParallelImageEncoder.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/Threading.h"
+#include "Utils/Math/Float16.h"
+#include "Utils/StringFormatters.h"
+#include <zlib.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace Falcor
+{
+namespace
+{
+/// Target size of uncompressed data per stripe. Large enough for deflate to reach its full compression ratio.
+const size_t kTargetStripeBytes = 256 * 1024;
+
+/// zlib stream input/output is limited to 32-bit sizes per call.
+const size_t kMaxDeflateChunk = 1u << 30;
+
+const uint8_t kPngSignature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+
+const uint32_t kExrMagic = 20000630;
+const uint32_t kExrVersion = 2;
+
+void appendBE32(std::vector<uint8_t>& buf, uint32_t value)
+{
+    buf.push_back(uint8_t(value >> 24));
+    buf.push_back(uint8_t(value >> 16));
+    buf.push_back(uint8_t(value >> 8));
+    buf.push_back(uint8_t(value));
+}
+
+template<typename T>
+void appendLE(std::vector<uint8_t>& buf, T value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    // Falcor only runs on little-endian hosts.
+    const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(&value);
+    buf.insert(buf.end(), pBytes, pBytes + sizeof(T));
+}
+
+void appendString(std::vector<uint8_t>& buf, const char* str)
+{
+    buf.insert(buf.end(), str, str + std::strlen(str) + 1);
+}
+
+/**
+ * Run func(i) for all i in [0, count). Runs on the thread pool if parallel is set, otherwise on the calling thread.
+ */
+template<typename Func>
+void forEachStripe(size_t count, bool parallel, Func&& func)
+{
+    if (parallel && count > 1)
+        Threading::parallelFor(0, count, func, 1);
+    else
+        for (size_t i = 0; i < count; i++)
+            func(i);
+}
+
+/**
+ * Compress data into a raw deflate stream (no zlib header or checksum).
+ * @param[in] finish If true, the stream is terminated with a final block. Otherwise it ends with a sync flush,
+ * which leaves it byte aligned so that another raw deflate stream can be appended.
+ */
+std::vector<uint8_t> deflateRaw(const uint8_t* pData, size_t size, int level, int strategy, bool finish)
+{
+    z_stream zs = {};
+    if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, strategy) != Z_OK)
+        throw RuntimeError("deflateInit2 failed while compressing.");
+
+    std::vector<uint8_t> out(deflateBound(&zs, (uLong)std::min(size, kMaxDeflateChunk)) + 64);
+    size_t outSize = 0;
+    size_t inOffset = 0;
+    int ret = Z_OK;
+    do
+    {
+        size_t inSize = std::min(size - inOffset, kMaxDeflateChunk);
+        bool isLastInput = inOffset + inSize == size;
+        zs.next_in = const_cast<Bytef*>(pData + inOffset);
+        zs.avail_in = (uInt)inSize;
+        inOffset += inSize;
+
+        do
+        {
+            if (out.size() - outSize < 1024)
+                out.resize(out.size() * 2);
+            size_t available = std::min(out.size() - outSize, kMaxDeflateChunk);
+            zs.next_out = out.data() + outSize;
+            zs.avail_out = (uInt)available;
+            ret = deflate(&zs, isLastInput ? (finish ? Z_FINISH : Z_SYNC_FLUSH) : Z_NO_FLUSH);
+            if (ret == Z_STREAM_ERROR)
+            {
+                deflateEnd(&zs);
+                throw RuntimeError("deflate failed while compressing.");
+            }
+            outSize += available - zs.avail_out;
+        } while (zs.avail_out == 0);
+    } while (inOffset < size);
+
+    FALCOR_ASSERT(!finish || ret == Z_STREAM_END);
+    deflateEnd(&zs);
+    out.resize(outSize);
+    return out;
+}
+
+void writeFile(const std::filesystem::path& path, const std::vector<const std::vector<uint8_t>*>& parts)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw RuntimeError("Failed to open '{}' for writing.", path);
+    for (const auto* pPart : parts)
+        file.write(reinterpret_cast<const char*>(pPart->data()), pPart->size());
+    if (!file)
+        throw RuntimeError("Failed to write '{}'.", path);
+}
+
+// PNG
+
+struct PngStripe
+{
+    std::vector<uint8_t> chunk; ///< Complete IDAT chunk (length, type, compressed data, CRC).
+    uint32_t adler = 0;         ///< Adler-32 checksum of the uncompressed stripe.
+    size_t rawSize = 0;         ///< Size of the uncompressed stripe.
+};
+
+std::vector<uint8_t> makePngChunk(const char* type, const uint8_t* pData, size_t size)
+{
+    if (size > 0x7fffffffu)
+        throw RuntimeError("PNG chunk exceeds the maximum chunk size.");
+
+    std::vector<uint8_t> chunk;
+    chunk.reserve(size + 12);
+    appendBE32(chunk, (uint32_t)size);
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), pData, pData + size);
+    uint32_t crc = crc32(0, chunk.data() + 4, (uInt)(size + 4));
+    appendBE32(chunk, crc);
+    return chunk;
+}
+
+/// Convert a source row to RGB(A) in file order.
+void loadPngRow(const uint8_t* pSrc, uint32_t width, bool isBGRA, bool exportAlpha, uint8_t* pDst)
+{
+    const uint32_t r = isBGRA ? 2 : 0;
+    const uint32_t b = isBGRA ? 0 : 2;
+    for (uint32_t x = 0; x < width; x++, pSrc += 4)
+    {
+        *pDst++ = pSrc[r];
+        *pDst++ = pSrc[1];
+        *pDst++ = pSrc[b];
+        if (exportAlpha)
+            *pDst++ = pSrc[3];
+    }
+}
+
+uint8_t paethPredictor(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc)
+        return uint8_t(a);
+    return uint8_t(pb <= pc ? b : c);
+}
+
+/**
+ * Filter one row. All five PNG filters are evaluated and the one with the minimum sum of absolute
+ * differences is chosen, which is the heuristic used by libpng.
+ * @param[in] pCur Current row.
+ * @param[in] pPrev Previous row, or all zeros for the first row of the image.
+ * @param[out] pOut Filter type followed by the filtered row.
+ * @param[in] scratch Scratch space for 5 filtered rows.
+ */
+void filterPngRow(const uint8_t* pCur, const uint8_t* pPrev, size_t rowBytes, uint32_t bpp, uint8_t* pOut, std::vector<uint8_t>& scratch)
+{
+    scratch.resize(5 * rowBytes);
+    uint8_t* pFiltered[5];
+    for (uint32_t f = 0; f < 5; f++)
+        pFiltered[f] = scratch.data() + f * rowBytes;
+
+    uint64_t cost[5] = {};
+    for (size_t i = 0; i < rowBytes; i++)
+    {
+        int a = i >= bpp ? pCur[i - bpp] : 0;
+        int b = pPrev[i];
+        int c = i >= bpp ? pPrev[i - bpp] : 0;
+        int x = pCur[i];
+
+        uint8_t values[5] = {
+            uint8_t(x),
+            uint8_t(x - a),
+            uint8_t(x - b),
+            uint8_t(x - ((a + b) >> 1)),
+            uint8_t(x - paethPredictor(a, b, c)),
+        };
+        for (uint32_t f = 0; f < 5; f++)
+        {
+            pFiltered[f][i] = values[f];
+            cost[f] += std::abs((int)(int8_t)values[f]);
+        }
+    }
+
+    uint32_t best = uint32_t(std::min_element(cost, cost + 5) - cost);
+    pOut[0] = uint8_t(best);
+    std::memcpy(pOut + 1, pFiltered[best], rowBytes);
+}
+
+/// Get the zlib stream header for a compression level.
+std::vector<uint8_t> getZlibHeader(int level)
+{
+    // CMF = deflate with 32K window. FLG encodes the compression level and makes the header a multiple of 31.
+    uint8_t flg = level <= 1 ? 0x01 : level <= 5 ? 0x5e : level == 6 ? 0x9c : 0xda;
+    return {0x78, flg};
+}
+
+// EXR
+
+struct ExrChunk
+{
+    std::vector<uint8_t> data; ///< Chunk data including the scanline and size fields.
+};
+
+/**
+ * Apply the OpenEXR ZIP predictor. The bytes are first split into even and odd bytes (the low and high
+ * bytes of each sample), then delta encoded.
+ */
+void exrZipPredict(const std::vector<uint8_t>& raw, std::vector<uint8_t>& out)
+{
+    const size_t size = raw.size();
+    out.resize(size);
+    uint8_t* t1 = out.data();
+    uint8_t* t2 = out.data() + (size + 1) / 2;
+    for (size_t i = 0; i < size; i += 2)
+    {
+        *t1++ = raw[i];
+        if (i + 1 < size)
+            *t2++ = raw[i + 1];
+    }
+
+    int p = size > 0 ? out[0] : 0;
+    for (size_t i = 1; i < size; i++)
+    {
+        int d = int(out[i]) - p + (128 + 256);
+        p = out[i];
+        out[i] = uint8_t(d);
+    }
+}
+
+void appendExrAttribute(std::vector<uint8_t>& header, const char* name, const char* type, const std::vector<uint8_t>& value)
+{
+    appendString(header, name);
+    appendString(header, type);
+    appendLE<int32_t>(header, (int32_t)value.size());
+    header.insert(header.end(), value.begin(), value.end());
+}
+
+std::vector<uint8_t> makeExrHeader(
+    uint32_t width,
+    uint32_t height,
+    const std::vector<std::pair<const char*, uint32_t>>& channels,
+    int32_t pixelType,
+    uint8_t compression
+)
+{
+    std::vector<uint8_t> header;
+    appendLE<uint32_t>(header, kExrMagic);
+    appendLE<uint32_t>(header, kExrVersion);
+
+    std::vector<uint8_t> value;
+    for (const auto& [name, srcIndex] : channels)
+    {
+        appendString(value, name);
+        appendLE<int32_t>(value, pixelType);
+        appendLE<uint32_t>(value, 0); // pLinear and reserved
+        appendLE<int32_t>(value, 1);  // xSampling
+        appendLE<int32_t>(value, 1);  // ySampling
+    }
+    value.push_back(0);
+    appendExrAttribute(header, "channels", "chlist", value);
+
+    appendExrAttribute(header, "compression", "compression", {compression});
+
+    value.clear();
+    appendLE<int32_t>(value, 0);
+    appendLE<int32_t>(value, 0);
+    appendLE<int32_t>(value, (int32_t)width - 1);
+    appendLE<int32_t>(value, (int32_t)height - 1);
+    appendExrAttribute(header, "dataWindow", "box2i", value);
+    appendExrAttribute(header, "displayWindow", "box2i", value);
+
+    appendExrAttribute(header, "lineOrder", "lineOrder", {0}); // INCREASING_Y
+
+    value.clear();
+    appendLE<float>(value, 1.f);
+    appendExrAttribute(header, "pixelAspectRatio", "float", value);
+
+    value.clear();
+    appendLE<float>(value, 0.f);
+    appendLE<float>(value, 0.f);
+    appendExrAttribute(header, "screenWindowCenter", "v2f", value);
+
+    value.clear();
+    appendLE<float>(value, 1.f);
+    appendExrAttribute(header, "screenWindowWidth", "float", value);
+
+    header.push_back(0); // End of header
+    return header;
+}
+} // namespace
+
+void ParallelImageEncoder::writePng(
+    const std::filesystem::path& path,
+    uint32_t width,
+    uint32_t height,
+    const uint8_t* pData,
+    bool isBGRA,
+    bool isTopDown,
+    bool exportAlpha,
+    const Options& options
+)
+{
+    FALCOR_CHECK_ARG(width > 0 && height > 0);
+    FALCOR_CHECK_ARG(pData != nullptr);
+
+    const int level = (int)std::min(options.compressionLevel, 9u);
+    const uint32_t bpp = exportAlpha ? 4 : 3;
+    const size_t rowBytes = size_t(width) * bpp;
+    const size_t srcRowPitch = size_t(width) * 4;
+
+    const uint32_t rowsPerStripe =
+        options.parallel ? (uint32_t)std::clamp<size_t>(kTargetStripeBytes / (rowBytes + 1), 1, height) : height;
+    const uint32_t stripeCount = (height + rowsPerStripe - 1) / rowsPerStripe;
+
+    auto getSrcRow = [&](uint32_t y) { return pData + size_t(isTopDown ? y : height - 1 - y) * srcRowPitch; };
+
+    std::vector<PngStripe> stripes(stripeCount);
+    forEachStripe(
+        stripeCount,
+        options.parallel,
+        [&](size_t s)
+        {
+            const uint32_t y0 = uint32_t(s) * rowsPerStripe;
+            const uint32_t y1 = std::min(y0 + rowsPerStripe, height);
+
+            std::vector<uint8_t> raw((y1 - y0) * (rowBytes + 1));
+            std::vector<uint8_t> prevRow(rowBytes, 0);
+            std::vector<uint8_t> curRow(rowBytes);
+            std::vector<uint8_t> scratch;
+            if (y0 > 0)
+                loadPngRow(getSrcRow(y0 - 1), width, isBGRA, exportAlpha, prevRow.data());
+
+            for (uint32_t y = y0; y < y1; y++)
+            {
+                uint8_t* pOut = raw.data() + (y - y0) * (rowBytes + 1);
+                loadPngRow(getSrcRow(y), width, isBGRA, exportAlpha, curRow.data());
+                if (level == 0)
+                {
+                    // Filtering only helps the entropy coder, which isn't used for stored blocks.
+                    pOut[0] = 0;
+                    std::memcpy(pOut + 1, curRow.data(), rowBytes);
+                }
+                else
+                {
+                    filterPngRow(curRow.data(), prevRow.data(), rowBytes, bpp, pOut, scratch);
+                }
+                std::swap(prevRow, curRow);
+            }
+
+            PngStripe& stripe = stripes[s];
+            stripe.rawSize = raw.size();
+            stripe.adler = adler32(adler32(0, nullptr, 0), raw.data(), (uInt)raw.size());
+            int strategy = level > 0 ? Z_FILTERED : Z_DEFAULT_STRATEGY;
+            auto compressed = deflateRaw(raw.data(), raw.size(), level, strategy, s + 1 == stripeCount);
+            stripe.chunk = makePngChunk("IDAT", compressed.data(), compressed.size());
+        }
+    );
+
+    // The stripes form a single zlib stream. Its header and checksum are stored in separate IDAT chunks.
+    uint32_t adler = stripes[0].adler;
+    for (uint32_t s = 1; s < stripeCount; s++)
+        adler = adler32_combine(adler, stripes[s].adler, (z_off_t)stripes[s].rawSize);
+
+    std::vector<uint8_t> header(kPngSignature, kPngSignature + sizeof(kPngSignature));
+    std::vector<uint8_t> ihdr;
+    appendBE32(ihdr, width);
+    appendBE32(ihdr, height);
+    ihdr.push_back(8);                   // Bit depth
+    ihdr.push_back(exportAlpha ? 6 : 2); // Color type (RGBA or RGB)
+    ihdr.insert(ihdr.end(), {0, 0, 0});  // Compression, filter and interlace method
+    auto ihdrChunk = makePngChunk("IHDR", ihdr.data(), ihdr.size());
+    header.insert(header.end(), ihdrChunk.begin(), ihdrChunk.end());
+    auto zlibHeader = getZlibHeader(level);
+    auto zlibHeaderChunk = makePngChunk("IDAT", zlibHeader.data(), zlibHeader.size());
+    header.insert(header.end(), zlibHeaderChunk.begin(), zlibHeaderChunk.end());
+
+    std::vector<uint8_t> trailer;
+    appendBE32(trailer, adler);
+    trailer = makePngChunk("IDAT", trailer.data(), trailer.size());
+    auto iendChunk = makePngChunk("IEND", nullptr, 0);
+    trailer.insert(trailer.end(), iendChunk.begin(), iendChunk.end());
+
+    std::vector<const std::vector<uint8_t>*> parts;
+    parts.push_back(&header);
+    for (const auto& stripe : stripes)
+        parts.push_back(&stripe.chunk);
+    parts.push_back(&trailer);
+    writeFile(path, parts);
+}
+
+void ParallelImageEncoder::writeExr(
+    const std::filesystem::path& path,
+    uint32_t width,
+    uint32_t height,
+    const float* pData,
+    uint32_t srcChannelCount,
+    bool exportAlpha,
+    ExrPixelType pixelType,
+    ExrCompression compression,
+    const Options& options
+)
+{
+    FALCOR_CHECK_ARG(width > 0 && height > 0);
+    FALCOR_CHECK_ARG(pData != nullptr);
+    FALCOR_CHECK_ARG(srcChannelCount == 3 || srcChannelCount == 4);
+    FALCOR_CHECK_ARG(!exportAlpha || srcChannelCount == 4);
+
+    // Channels are stored in alphabetical order.
+    std::vector<std::pair<const char*, uint32_t>> channels;
+    if (exportAlpha)
+        channels.push_back({"A", 3});
+    channels.push_back({"B", 2});
+    channels.push_back({"G", 1});
+    channels.push_back({"R", 0});
+
+    const bool isHalf = pixelType == ExrPixelType::Half;
+    const size_t sampleSize = isHalf ? 2 : 4;
+    const size_t rowBytes = size_t(width) * channels.size() * sampleSize;
+    const uint32_t linesPerChunk = compression == ExrCompression::Zip ? 16 : 1;
+    const uint32_t chunkCount = (height + linesPerChunk - 1) / linesPerChunk;
+    const int level = (int)std::min(options.compressionLevel, 9u);
+
+    std::vector<ExrChunk> chunks(chunkCount);
+    auto encodeChunk = [&](size_t c, std::vector<uint8_t>& raw, std::vector<uint8_t>& predicted)
+    {
+        const uint32_t y0 = uint32_t(c) * linesPerChunk;
+        const uint32_t y1 = std::min(y0 + linesPerChunk, height);
+
+        raw.resize((y1 - y0) * rowBytes);
+        uint8_t* pDst = raw.data();
+        for (uint32_t y = y0; y < y1; y++)
+        {
+            const float* pRow = pData + size_t(y) * width * srcChannelCount;
+            for (const auto& [name, srcIndex] : channels)
+            {
+                if (isHalf)
+                {
+                    for (uint32_t x = 0; x < width; x++, pDst += 2)
+                    {
+                        uint16_t value = math::float32ToFloat16(pRow[x * srcChannelCount + srcIndex]);
+                        std::memcpy(pDst, &value, 2);
+                    }
+                }
+                else
+                {
+                    for (uint32_t x = 0; x < width; x++, pDst += 4)
+                        std::memcpy(pDst, &pRow[x * srcChannelCount + srcIndex], 4);
+                }
+            }
+        }
+
+        const std::vector<uint8_t>* pPayload = &raw;
+        std::vector<uint8_t> compressed;
+        if (compression == ExrCompression::Zip)
+        {
+            exrZipPredict(raw, predicted);
+            uLongf compressedSize = compressBound((uLong)predicted.size());
+            compressed.resize(compressedSize);
+            if (compress2(compressed.data(), &compressedSize, predicted.data(), (uLong)predicted.size(), level) != Z_OK)
+                throw RuntimeError("compress2 failed while compressing.");
+            compressed.resize(compressedSize);
+            // Readers treat a chunk that is not smaller than the uncompressed data as stored uncompressed.
+            if (compressed.size() < raw.size())
+                pPayload = &compressed;
+        }
+
+        ExrChunk& chunk = chunks[c];
+        chunk.data.reserve(pPayload->size() + 8);
+        appendLE<int32_t>(chunk.data, (int32_t)y0);
+        appendLE<int32_t>(chunk.data, (int32_t)pPayload->size());
+        chunk.data.insert(chunk.data.end(), pPayload->begin(), pPayload->end());
+    };
+
+    // Uncompressed chunks are single scanlines, so they are grouped into stripes to amortize the task overhead.
+    const uint32_t chunksPerStripe =
+        options.parallel ? (uint32_t)std::max<size_t>(1, kTargetStripeBytes / (rowBytes * linesPerChunk)) : chunkCount;
+    const uint32_t stripeCount = (chunkCount + chunksPerStripe - 1) / chunksPerStripe;
+    forEachStripe(
+        stripeCount,
+        options.parallel,
+        [&](size_t s)
+        {
+            std::vector<uint8_t> raw;
+            std::vector<uint8_t> predicted;
+            const size_t begin = s * chunksPerStripe;
+            const size_t end = std::min<size_t>(begin + chunksPerStripe, chunkCount);
+            for (size_t c = begin; c < end; c++)
+                encodeChunk(c, raw, predicted);
+        }
+    );
+
+    const uint8_t compressionId = compression == ExrCompression::Zip ? 3 : 0;
+    std::vector<uint8_t> header = makeExrHeader(width, height, channels, isHalf ? 1 : 2, compressionId);
+
+    // Offset table with the absolute file position of each chunk.
+    uint64_t offset = header.size() + chunkCount * sizeof(uint64_t);
+    for (const auto& chunk : chunks)
+    {
+        appendLE<uint64_t>(header, offset);
+        offset += chunk.data.size();
+    }
+
+    std::vector<const std::vector<uint8_t>*> parts;
+    parts.push_back(&header);
+    for (const auto& chunk : chunks)
+        parts.push_back(&chunk.data);
+    writeFile(path, parts);
+}
+} // namespace Falcor
@@ -0,0 +1,122 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Macros.h"
+#include <filesystem>
+#include <cstdint>
+
+namespace Falcor
+{
+/**
+ * Multithreaded PNG and OpenEXR encoders.
+ *
+ * The image is split into independent stripes of scanlines that are filtered and compressed on the
+ * thread pool. The compressed stripes are then written to the file in order.
+ *
+ * PNG stripes are raw deflate streams terminated by a sync flush, which concatenate into a single valid
+ * zlib stream (the same approach as pigz). EXR files are written as scanline images where each chunk
+ * is compressed independently, as required by the format.
+ *
+ * This is used by Bitmap::saveImage() for the common 8-bit and floating-point cases. Other formats and
+ * codecs go through FreeImage.
+ */
+class FALCOR_API ParallelImageEncoder
+{
+public:
+    /// Encoder options.
+    struct Options
+    {
+        /// Deflate compression level (0 = stored, 1 = fastest, 9 = smallest).
+        uint32_t compressionLevel = 6;
+        /// Compress stripes on the thread pool. If false, the image is encoded as a single stream on the calling thread.
+        bool parallel = true;
+    };
+
+    /// EXR channel pixel type.
+    enum class ExrPixelType
+    {
+        Half,
+        Float,
+    };
+
+    /// EXR compression codec.
+    enum class ExrCompression
+    {
+        None, ///< Uncompressed, one scanline per chunk.
+        Zip,  ///< Deflate, 16 scanlines per chunk.
+    };
+
+    /**
+     * Write an 8-bit RGB or RGBA PNG file.
+     * Throws an exception if the file cannot be written.
+     * @param[in] path File path.
+     * @param[in] width Image width in pixels.
+     * @param[in] height Image height in pixels.
+     * @param[in] pData Image data with 4 bytes per pixel in RGBA or BGRA order, rows tightly packed.
+     * @param[in] isBGRA True if the source data is in BGRA order.
+     * @param[in] isTopDown True if the first row in the source data is the top row of the image.
+     * @param[in] exportAlpha Write an RGBA image. Otherwise the alpha channel is dropped.
+     * @param[in] options Encoder options.
+     */
+    static void writePng(
+        const std::filesystem::path& path,
+        uint32_t width,
+        uint32_t height,
+        const uint8_t* pData,
+        bool isBGRA,
+        bool isTopDown,
+        bool exportAlpha,
+        const Options& options
+    );
+
+    /**
+     * Write a scanline OpenEXR file with R, G, B and optional A channels.
+     * Throws an exception if the file cannot be written.
+     * @param[in] path File path.
+     * @param[in] width Image width in pixels.
+     * @param[in] height Image height in pixels.
+     * @param[in] pData Image data with 3 or 4 floats per pixel, rows tightly packed. The first row is the top row of the image.
+     * @param[in] srcChannelCount Number of channels in the source data (3 or 4).
+     * @param[in] exportAlpha Write an alpha channel. Requires 4 source channels.
+     * @param[in] pixelType Pixel type of the channels in the file.
+     * @param[in] compression Compression codec.
+     * @param[in] options Encoder options.
+     */
+    static void writeExr(
+        const std::filesystem::path& path,
+        uint32_t width,
+        uint32_t height,
+        const float* pData,
+        uint32_t srcChannelCount,
+        bool exportAlpha,
+        ExrPixelType pixelType,
+        ExrCompression compression,
+        const Options& options
+    );
+};
+} // namespace Falcor
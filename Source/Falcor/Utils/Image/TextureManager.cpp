@@ -26,11 +26,19 @@
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
 #include "TextureManager.h"
+#include "CompressedTextureCache.h"
+#include "ImageIO.h"
+#include "MipChainGenerator.h"
+#include "TexturePageCache.h"
 #include "Core/API/Device.h"
+#include "Core/Platform/OS.h"
+#include "Core/Platform/SearchDirectories.h"
 #include "Utils/Logger.h"
-#include "Utils/NumericRange.h"
 
-#include <execution>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <string_view>
 
 // Temporarily disable asynchronous texture loader until Falcor supports parallel GPU work submission.
 // Until then `TextureManager` should only called from the main thread.
@@ -42,10 +50,127 @@ namespace
 {
 const size_t kMaxTextureHandleCount = std::numeric_limits<uint32_t>::max();
 static_assert(TextureManager::TextureHandle::kInvalidID >= kMaxTextureHandleCount);
+
+const size_t kDecodeQueueMemoryBudget = 1ull << 30; ///< Maximum size of decoded image data waiting for upload.
+const size_t kUploadBytesPerFlush = 256ull << 20;   ///< Amount of texture data uploaded before issuing a flush (to keep upload heap from growing).
+const bool kTopDown = true;                         ///< Memory layout when loading from file.
+
+const MipChainGenerator::Filter kMipFilter = MipChainGenerator::Filter::Box; ///< Filter for mips generated at decode time.
+
+/**
+ * Matcher for UDIM tile filenames, e.g., 'albedo.<UDIM>.png' matches 'albedo.1001.png'.
+ * This is a plain prefix/suffix comparison instead of a regex, as it runs for every file in the searched directories.
+ */
+class UdimPattern
+{
+public:
+    UdimPattern(std::string_view filename, size_t udimPos) : mPrefix(filename.substr(0, udimPos)), mSuffix(filename.substr(udimPos + 6)) {}
+
+    /// Match a filename. Returns the UDIM number (four digits, 1000-9999), or zero if the filename doesn't match.
+    uint32_t match(std::string_view filename) const
+    {
+        if (filename.size() != mPrefix.size() + 4 + mSuffix.size())
+            return 0;
+        if (filename.substr(0, mPrefix.size()) != mPrefix || filename.substr(mPrefix.size() + 4) != mSuffix)
+            return 0;
+        uint32_t udim = 0;
+        for (char c : filename.substr(mPrefix.size(), 4))
+        {
+            if (c < '0' || c > '9')
+                return 0;
+            udim = udim * 10 + (c - '0');
+        }
+        return udim >= 1000 ? udim : 0;
+    }
+
+private:
+    std::string mPrefix;
+    std::string mSuffix;
+};
+
+/// List the regular files in a directory, sorted by name.
+std::vector<std::string> listDirectory(const std::filesystem::path& path)
+{
+    std::vector<std::string> listing;
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec))
+    {
+        if (it->is_regular_file(ec))
+            listing.push_back(it->path().filename().string());
+    }
+    std::sort(listing.begin(), listing.end());
+    return listing;
+}
+
+/// Texture decoded on the CPU, waiting for upload.
+struct DecodedTexture
+{
+    size_t jobIndex = 0;
+    std::vector<Bitmap::UniqueConstPtr> mips;        ///< Decoded mips, starting from mip0.
+    std::unique_ptr<ImageIO::DDSImage> pDDSImage;    ///< DDS image, created as-is with its mips and array images.
+    size_t sizeInBytes = 0;                          ///< Size of the decoded image data.
+    size_t uploadSizeInBytes = 0;                    ///< Approximate amount of data uploaded for the texture.
+    std::optional<TextureAnalyzer::Result> analysis; ///< Analysis of the base level, if computed at decode time.
+};
+
+/**
+ * Queue of decoded textures with a memory budget.
+ * Producers block while the queued image data exceeds the budget, which bounds peak memory usage when decoding is faster than uploading.
+ */
+class DecodedTextureQueue
+{
+public:
+    DecodedTextureQueue(size_t memoryBudget, size_t producerCount) : mMemoryBudget(memoryBudget), mProducerCount(producerCount) {}
+
+    void push(DecodedTexture&& item)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        // Always accept an item into an empty queue, so a single texture larger than the budget can't stall the pipeline.
+        mNotFull.wait(lock, [&]() { return mQueue.empty() || mQueuedBytes + item.sizeInBytes <= mMemoryBudget; });
+        mQueuedBytes += item.sizeInBytes;
+        mQueue.push_back(std::move(item));
+        mNotEmpty.notify_one();
+    }
+
+    /// Signal that a producer has finished.
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        FALCOR_ASSERT(mProducerCount > 0);
+        mProducerCount--;
+        mNotEmpty.notify_all();
+    }
+
+    /// Pop the next item. Blocks until an item is available. Returns false once all producers have finished and the queue is empty.
+    bool pop(DecodedTexture& item)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mNotEmpty.wait(lock, [&]() { return !mQueue.empty() || mProducerCount == 0; });
+        if (mQueue.empty())
+            return false;
+        item = std::move(mQueue.front());
+        mQueue.pop_front();
+        mQueuedBytes -= item.sizeInBytes;
+        mNotFull.notify_all();
+        return true;
+    }
+
+private:
+    std::mutex mMutex;
+    std::condition_variable mNotFull;
+    std::condition_variable mNotEmpty;
+    std::deque<DecodedTexture> mQueue;
+    size_t mQueuedBytes = 0;
+    size_t mMemoryBudget;
+    size_t mProducerCount;
+};
 } // namespace
 
 TextureManager::TextureManager(ref<Device> pDevice, size_t maxTextureCount, size_t threadCount)
-    : mpDevice(pDevice), mAsyncTextureLoader(pDevice, threadCount), mMaxTextureCount(std::min(maxTextureCount, kMaxTextureHandleCount))
+    : mpDevice(pDevice)
+    , mAsyncTextureLoader(pDevice, threadCount)
+    , mThreadCount(std::max<size_t>(threadCount, 1))
+    , mMaxTextureCount(std::min(maxTextureCount, kMaxTextureHandleCount))
 {}
 
 TextureManager::~TextureManager() {}
@@ -102,6 +227,15 @@ TextureManager::TextureHandle TextureManager::addTexture(const ref<Texture>& pTe
     return handle;
 }
 
+const std::vector<std::string>& TextureManager::DirectoryListings::get(const std::filesystem::path& path)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto [it, inserted] = mListings.try_emplace(path.lexically_normal());
+    if (inserted)
+        it->second = listDirectory(path);
+    return it->second;
+}
+
 TextureManager::TextureHandle TextureManager::loadUdimTexture(
     const std::filesystem::path& path,
     bool generateMipLevels,
@@ -109,7 +243,8 @@ TextureManager::TextureHandle TextureManager::loadUdimTexture(
     Resource::BindFlags bindFlags,
     bool async,
     const SearchDirectories* searchDirectories,
-    size_t* loadedTextureCount
+    size_t* loadedTextureCount,
+    DirectoryListings* pDirectoryListings
 )
 {
     std::string filename = path.filename().string();
@@ -123,59 +258,111 @@ TextureManager::TextureHandle TextureManager::loadUdimTexture(
     if (pos == std::string::npos)
         return loadTexture(path, generateMipLevels, loadAsSRGB, bindFlags, async);
 
+    // Find the first directory containing the pattern, in case the UDIM set lives in multiple available directories.
+    // With a shared listing cache, UDIM sets in the same directory are all resolved from a single enumeration.
+    const UdimPattern pattern(filename, pos);
     std::filesystem::path dirpath = path.parent_path();
-    filename.replace(pos, 6, "[1-9][0-9][0-9][0-9]");
-    std::regex udimRegex(filename);
-    std::vector<std::filesystem::path> texturePaths;
-    // Find the first directory containing the pattern, in case the UDIM set lives in multiple available directories
-    if (searchDirectories)
-        texturePaths = globFilesInDirectories(dirpath, udimRegex, *searchDirectories, true /* firstHitOnly */);
+    std::vector<std::filesystem::path> directories;
+    if (dirpath.is_absolute())
+    {
+        directories.push_back(dirpath);
+    }
     else
-        texturePaths = globFilesInDataDirectories(dirpath, udimRegex, true /* firstHitOnly */);
+    {
+        for (const auto& dir : searchDirectories ? searchDirectories->get() : getDataDirectoriesList())
+            directories.push_back(dir / dirpath);
+    }
+
+    std::filesystem::path loadedDir;
+    std::vector<std::string> localListing;
+    const std::vector<std::string>* pListing = nullptr;
+    std::vector<std::pair<size_t, std::string>> tiles; // UDIM number and filename of mip0.
+    for (const auto& dir : directories)
+    {
+        if (pDirectoryListings)
+        {
+            pListing = &pDirectoryListings->get(dir);
+        }
+        else
+        {
+            localListing = listDirectory(dir);
+            pListing = &localListing;
+        }
+        for (const auto& name : *pListing)
+        {
+            if (uint32_t udim = pattern.match(name))
+                tiles.emplace_back(udim, name);
+        }
+        if (!tiles.empty())
+        {
+            loadedDir = std::filesystem::canonical(dir);
+            break;
+        }
+    }
 
     // nothing found, return an invalid handle
-    if (texturePaths.empty())
+    if (tiles.empty())
     {
         logWarning("Can't find UDIM texture files '{}'.", path);
         return TextureHandle();
     }
 
-    // Now load all the files from that directory
-    std::filesystem::path loadedDir = texturePaths[0].parent_path();
-    texturePaths = globFilesInDirectory(loadedDir, udimRegex);
-
     if (loadedTextureCount)
-        *loadedTextureCount = texturePaths.size();
+        *loadedTextureCount = tiles.size();
+
+    // Reuse the handle if the same UDIM set has already been loaded.
+    const TextureKey udimKey({loadedDir / path.filename()}, generateMipLevels, loadAsSRGB, bindFlags);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (auto it = mUdimKeyToHandle.find(udimKey); it != mUdimKeyToHandle.end())
+            return it->second;
+    }
 
-    std::vector<size_t> udimIndices;
     std::vector<TextureHandle> handles;
     size_t maxIndex = 0;
-    for (auto& it : texturePaths)
-    {
-        std::string textureFilename = it.filename().string();
-        std::string udimStr = textureFilename.substr(pos, 4); // the 4 digits
-        // Insert the udim number into the original filename (before potentially stripping <MIP>)
-        std::string srcStr = path.filename().string();
-        std::string newFilename = srcStr.replace(srcStr.find("<UDIM>"), 6, udimStr);
-        it = it.parent_path() / newFilename;
-        size_t udim = std::stol(udimStr);
+    const std::string srcFilename = path.filename().string();
+    for (const auto& [udim, tileFilename] : tiles)
+    {
+        FALCOR_CHECK_ARG_GE_MSG(
+            udim, 1001, "Texture {} is not a valid UDIM texture, as it violates the valid UDIM range of 1001-9999", loadedDir / tileFilename
+        );
         maxIndex = std::max<size_t>(maxIndex, udim);
-        udimIndices.push_back(udim);
-        handles.push_back(loadTexture(it, generateMipLevels, loadAsSRGB, bindFlags, async));
 
-        FALCOR_CHECK_ARG_GE_MSG(udim, 1001, "Texture {} is not a valid UDIM texture, as it violates the valid UDIM range of 1001-9999", it);
+        // Insert the udim number into the original filename (before potentially stripping <MIP>).
+        // The tile files are known to exist, so the full paths are formed directly from the directory listing.
+        std::string tileName = std::string(srcFilename).replace(srcFilename.find("<UDIM>"), 6, std::to_string(udim));
+        std::vector<std::filesystem::path> fullPaths;
+        if (size_t tileMipPos = tileName.find("<MIP>"); tileMipPos != std::string::npos)
+        {
+            while (true)
+            {
+                std::string mipName = std::string(tileName).replace(tileMipPos, 5, "mip" + std::to_string(fullPaths.size()));
+                if (!std::binary_search(pListing->begin(), pListing->end(), mipName))
+                    break;
+                fullPaths.push_back(loadedDir / mipName);
+            }
+        }
+        else
+        {
+            fullPaths.push_back(loadedDir / tileName);
+        }
+        handles.push_back(loadTextureFromPaths(fullPaths, generateMipLevels, loadAsSRGB, bindFlags, async));
     }
 
+    std::lock_guard<std::mutex> lock(mMutex);
+
     // UDIM range needs to cover all numbers from 1001 to maxIndex inclusive, so 1001, 1002, 1003 needs 3 indices
     size_t rangeStart = getUdimRange(maxIndex - 1001 + 1);
 
-    for (size_t i = 0; i < texturePaths.size(); ++i)
+    for (size_t i = 0; i < tiles.size(); ++i)
     {
-        size_t index = udimIndices[i] - 1001;
+        size_t index = tiles[i].first - 1001;
         mUdimIndirection[rangeStart + index] = handles[i].getID();
     }
 
-    return TextureManager::TextureHandle(rangeStart, true);
+    TextureHandle handle(rangeStart, true);
+    mUdimKeyToHandle[udimKey] = handle;
+    return handle;
 }
 
 TextureManager::TextureHandle TextureManager::loadTexture(
@@ -185,11 +372,14 @@ TextureManager::TextureHandle TextureManager::loadTexture(
     Resource::BindFlags bindFlags,
     bool async,
     const SearchDirectories* searchDirectories,
-    size_t* loadedTextureCount
+    size_t* loadedTextureCount,
+    DirectoryListings* pDirectoryListings
 )
 {
     if (path.string().find("<UDIM>") != std::string::npos)
-        return loadUdimTexture(path, generateMipLevels, loadAsSRGB, bindFlags, async, searchDirectories, loadedTextureCount);
+        return loadUdimTexture(
+            path, generateMipLevels, loadAsSRGB, bindFlags, async, searchDirectories, loadedTextureCount, pDirectoryListings
+        );
 
     std::vector<std::filesystem::path> paths;
     auto addPath = [&](const std::filesystem::path& p)
@@ -229,13 +419,26 @@ TextureManager::TextureHandle TextureManager::loadTexture(
     if (loadedTextureCount)
         *loadedTextureCount = paths.empty() ? 0 : 1;
 
-    TextureHandle handle;
     if (paths.empty())
     {
         logWarning("Can't find texture file '{}'.", path);
-        return handle;
+        return TextureHandle();
     }
 
+    return loadTextureFromPaths(paths, generateMipLevels, loadAsSRGB, bindFlags, async);
+}
+
+TextureManager::TextureHandle TextureManager::loadTextureFromPaths(
+    const std::vector<std::filesystem::path>& paths,
+    bool generateMipLevels,
+    bool loadAsSRGB,
+    Resource::BindFlags bindFlags,
+    bool async
+)
+{
+    FALCOR_ASSERT(!paths.empty());
+
+    TextureHandle handle;
     std::unique_lock<std::mutex> lock(mMutex);
     const TextureKey textureKey(paths, generateMipLevels, loadAsSRGB, bindFlags);
     if (auto it = mKeyToHandle.find(textureKey); it != mKeyToHandle.end())
@@ -298,14 +501,17 @@ TextureManager::TextureHandle TextureManager::loadTexture(
         }
 #else
         // Load texture from main thread.
-        ref<Texture> pTexture;
-        if (paths.size() > 1)
+        ref<Texture> pTexture = loadCompressedTexture(textureKey);
+        if (!pTexture)
         {
-            pTexture = Texture::createMippedFromFiles(mpDevice, paths, loadAsSRGB, bindFlags);
-        }
-        else
-        {
-            pTexture = Texture::createFromFile(mpDevice, paths[0], generateMipLevels, loadAsSRGB, bindFlags);
+            if (paths.size() > 1)
+            {
+                pTexture = Texture::createMippedFromFiles(mpDevice, paths, loadAsSRGB, bindFlags);
+            }
+            else
+            {
+                pTexture = Texture::createFromFile(mpDevice, paths[0], generateMipLevels, loadAsSRGB, bindFlags);
+            }
         }
 
         // Add new texture desc.
@@ -381,35 +587,131 @@ void TextureManager::endDeferredLoading()
     if (jobs.empty())
         return;
 
-    // Load textures in parallel.
-    std::atomic<size_t> texturesLoaded;
-    NumericRange<size_t> jobRange(0, jobs.size());
-    std::for_each(
-        std::execution::par_unseq, jobRange.begin(), jobRange.end(),
-        [&](size_t i)
+    // Load textures in a two-stage pipeline.
+    // Worker threads read and decode the image files into a queue with a memory budget.
+    // The calling thread creates the textures from the decoded images and uploads them to the GPU.
+    // This keeps file I/O and decoding off the GPU submission path, which is serialized by the global gfx mutex.
+    size_t decodeThreadCount = std::min(mThreadCount, jobs.size());
+    DecodedTextureQueue queue(kDecodeQueueMemoryBudget, decodeThreadCount);
+    std::atomic<size_t> nextJob{0};
+
+    auto decodeWorker = [&]()
+    {
+        for (size_t i = nextJob.fetch_add(1); i < jobs.size(); i = nextJob.fetch_add(1))
         {
-            const auto& job = jobs[i];
-            auto& desc = getDesc(job.handle);
-            if (job.key.fullPaths.size() == 1)
+            const auto& key = jobs[i].key;
+            DecodedTexture decoded;
+            decoded.jobIndex = i;
+            try
             {
-                desc.pTexture = Texture::createFromFile(
-                    mpDevice, job.key.fullPaths[0], job.key.generateMipLevels, job.key.loadAsSRGB, job.key.bindFlags
-                );
-                logDebug("Loading texture from '{}'", job.key.fullPaths[0]);
+                // DDS files may contain pre-generated mips and arrays, so they are loaded as-is.
+                // Only the file contents are loaded here, the texture is created on the upload thread.
+                const bool isDDSFile = key.fullPaths.size() == 1 && hasExtension(key.fullPaths[0], "dds");
+                std::filesystem::path ddsPath = isDDSFile ? key.fullPaths[0] : getCompressedTexturePath(key);
+                if (!ddsPath.empty())
+                    decoded.pDDSImage = ImageIO::loadDDSImage(ddsPath, key.loadAsSRGB);
+
+                if (decoded.pDDSImage)
+                {
+                    decoded.sizeInBytes = decoded.pDDSImage->data.size();
+                    decoded.uploadSizeInBytes = decoded.sizeInBytes;
+                }
+                else if (!isDDSFile)
+                {
+                    for (const auto& path : key.fullPaths)
+                    {
+                        Bitmap::UniqueConstPtr pBitmap =
+                            hasExtension(path, "dds") ? ImageIO::loadBitmapFromDDS(path) : Bitmap::createFromFile(path, kTopDown);
+                        if (!pBitmap)
+                        {
+                            logWarning("Error loading mip {}. Loading failed for image file '{}'.", decoded.mips.size(), path);
+                            break;
+                        }
+                        decoded.sizeInBytes += pBitmap->getSize();
+                        decoded.mips.push_back(std::move(pBitmap));
+                    }
+
+                    // Generate the mip chain and analyze the base level on the CPU while the image is at hand.
+                    // This avoids GPU mip generation after upload and GPU analysis passes in material optimization.
+                    if (!decoded.mips.empty() && MipChainGenerator::isFormatSupported(decoded.mips[0]->getFormat()))
+                    {
+                        TextureAnalyzer::Result analysis;
+                        if (key.generateMipLevels && decoded.mips.size() == 1)
+                        {
+                            for (auto& pMip : MipChainGenerator::generate(*decoded.mips[0], kMipFilter, key.loadAsSRGB, &analysis))
+                            {
+                                decoded.sizeInBytes += pMip->getSize();
+                                decoded.mips.push_back(std::move(pMip));
+                            }
+                        }
+                        else
+                        {
+                            analysis = MipChainGenerator::analyze(*decoded.mips[0], key.loadAsSRGB);
+                        }
+                        decoded.analysis = analysis;
+                    }
+                    decoded.uploadSizeInBytes = decoded.sizeInBytes;
+                }
             }
-            else
+            catch (const std::exception& e)
             {
-                desc.pTexture = Texture::createMippedFromFiles(mpDevice, job.key.fullPaths, job.key.loadAsSRGB, job.key.bindFlags);
-                logDebug("Loading mipped texture from '{}'", job.key.fullPaths[0]);
+                logWarning("Error loading '{}': {}", key.fullPaths[0], e.what());
             }
-            if (texturesLoaded.fetch_add(1) % 10 == 9)
+            queue.push(std::move(decoded));
+        }
+        queue.close();
+    };
+
+    std::vector<std::thread> decodeThreads;
+    for (size_t i = 0; i < decodeThreadCount; ++i)
+        decodeThreads.emplace_back(decodeWorker);
+
+    size_t uploadedBytes = 0;
+    DecodedTexture decoded;
+    while (queue.pop(decoded))
+    {
+        const auto& job = jobs[decoded.jobIndex];
+        auto& desc = getDesc(job.handle);
+        try
+        {
+            if (decoded.pDDSImage)
             {
-                logDebug("Flush");
-                std::lock_guard<std::mutex> lock(mpDevice->getGlobalGfxMutex());
-                mpDevice->flushAndSync();
+                desc.pTexture = ImageIO::createTextureFromDDS(mpDevice, *decoded.pDDSImage);
             }
+            else if (!decoded.mips.empty())
+            {
+                std::vector<const Bitmap*> mips;
+                for (const auto& pMip : decoded.mips)
+                    mips.push_back(pMip.get());
+                desc.pTexture =
+                    Texture::createFromBitmaps(mpDevice, mips, job.key.generateMipLevels, job.key.loadAsSRGB, job.key.bindFlags);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            logWarning("Error creating texture from '{}': {}", job.key.fullPaths[0], e.what());
         }
-    );
+
+        if (desc.pTexture)
+        {
+            desc.analysis = decoded.analysis;
+            desc.pTexture->setSourcePath(job.key.fullPaths[0]);
+            logDebug("Loaded texture from '{}'", job.key.fullPaths[0]);
+        }
+        uploadedBytes += decoded.uploadSizeInBytes;
+        decoded = {};
+
+        // Flush after uploading large batches of data to release the upload heap.
+        if (uploadedBytes >= kUploadBytesPerFlush)
+        {
+            std::lock_guard<std::mutex> lock(mpDevice->getGlobalGfxMutex());
+            mpDevice->flushAndSync();
+            uploadedBytes = 0;
+        }
+    }
+
+    for (auto& thread : decodeThreads)
+        thread.join();
     mpDevice->flushAndSync();
 
     // Mark loaded textures and add them to lookup table.
@@ -421,6 +723,73 @@ void TextureManager::endDeferredLoading()
     }
 }
 
+std::optional<TextureAnalyzer::Result> TextureManager::getTextureAnalysis(const Texture* pTexture) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mTextureToHandle.find(pTexture);
+    if (it == mTextureToHandle.end())
+        return std::nullopt;
+    return mTextureDescs[it->second.getID()].analysis;
+}
+
+void TextureManager::setUseCompressedTextureCache(bool enabled)
+{
+    if (enabled && !mpCompressedTextureCache)
+        mpCompressedTextureCache = std::make_unique<CompressedTextureCache>();
+    else if (!enabled)
+        mpCompressedTextureCache.reset();
+}
+
+void TextureManager::setTexturePageCacheBudget(uint64_t budgetInBytes)
+{
+    if (budgetInBytes == 0)
+        mpTexturePageCache.reset();
+    else if (!mpTexturePageCache)
+        mpTexturePageCache = std::make_unique<TexturePageCache>(TexturePageCache::Options{budgetInBytes});
+    else
+        mpTexturePageCache->setBudget(budgetInBytes);
+}
+
+std::filesystem::path TextureManager::getCompressedTexturePath(const TextureKey& key) const
+{
+    if (!mpCompressedTextureCache || key.fullPaths.size() != 1 || key.bindFlags != Resource::BindFlags::ShaderResource)
+        return {};
+
+    const auto& path = key.fullPaths[0];
+    if (hasExtension(path, "dds"))
+        return {};
+
+    try
+    {
+        return mpCompressedTextureCache->getOrCreate(path, key.generateMipLevels, key.loadAsSRGB);
+    }
+    catch (const std::exception& e)
+    {
+        logWarning("Error loading '{}' from the texture cache: {}", path, e.what());
+        return {};
+    }
+}
+
+ref<Texture> TextureManager::loadCompressedTexture(const TextureKey& key) const
+{
+    std::filesystem::path cachedPath = getCompressedTexturePath(key);
+    if (cachedPath.empty())
+        return nullptr;
+
+    try
+    {
+        ref<Texture> pTexture = ImageIO::loadTextureFromDDS(mpDevice, cachedPath, key.loadAsSRGB);
+        if (pTexture)
+            pTexture->setSourcePath(key.fullPaths[0]);
+        return pTexture;
+    }
+    catch (const std::exception& e)
+    {
+        logWarning("Error loading '{}' from the texture cache: {}", key.fullPaths[0], e.what());
+        return nullptr;
+    }
+}
+
 void TextureManager::removeTexture(const TextureHandle& handle)
 {
     if (handle.isUdim())
@@ -539,6 +908,15 @@ TextureManager::Stats TextureManager::getStats() const
         if (isCompressedFormat(t.pTexture->getFormat()))
             s.textureCompressedCount++;
     }
+    if (mpTexturePageCache)
+    {
+        const TexturePageCache::Stats pageCacheStats = mpTexturePageCache->getStats();
+        s.pageCacheRequestCount = pageCacheStats.requestCount;
+        s.pageCacheHitCount = pageCacheStats.hitCount;
+        s.pageCacheMissCount = pageCacheStats.missCount;
+        s.pageCacheEvictionCount = pageCacheStats.evictionCount;
+        s.pageCacheResidentBytes = pageCacheStats.residentBytes;
+    }
     return s;
 }
 
@@ -620,6 +998,12 @@ void TextureManager::freeUdimRange(size_t rangeStart)
 
 void TextureManager::removeUdimTexture(const TextureHandle& handle)
 {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (auto it = mUdimKeyToHandle.begin(); it != mUdimKeyToHandle.end();)
+            it = it->second == handle ? mUdimKeyToHandle.erase(it) : std::next(it);
+    }
+
     size_t rangeStart = handle.getID();
     size_t rangeSize = mUdimIndirectionSize[rangeStart];
     for (size_t i = rangeStart; i < rangeStart + rangeSize; ++i)
@@ -27,6 +27,7 @@
  **************************************************************************/
 #pragma once
 #include "AsyncTextureLoader.h"
+#include "TextureAnalyzer.h"
 #include "Core/Macros.h"
 #include "Core/API/fwd.h"
 #include "Core/API/Resource.h"
@@ -37,11 +38,16 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <string>
 #include <thread>
+#include <vector>
 
 namespace Falcor
 {
 class SearchDirectories;
+class CompressedTextureCache;
+class TexturePageCache;
 
 /**
  * Multi-threaded texture manager.
@@ -71,6 +77,11 @@ public:
         uint64_t textureTexelCount = 0;        ///< Total number of texels in all textures.
         uint64_t textureTexelChannelCount = 0; ///< Total number of texel channels in all textures.
         uint64_t textureMemoryInBytes = 0;     ///< Total memory in bytes used by the textures.
+        uint64_t pageCacheRequestCount = 0;    ///< Number of tile requests to the texture page cache.
+        uint64_t pageCacheHitCount = 0;        ///< Number of tile requests for resident tiles.
+        uint64_t pageCacheMissCount = 0;       ///< Number of tile requests for tiles that were not resident.
+        uint64_t pageCacheEvictionCount = 0;   ///< Number of tiles evicted from the texture page cache.
+        uint64_t pageCacheResidentBytes = 0;   ///< Memory in bytes used by resident tiles.
     };
 
     /**
@@ -103,8 +114,9 @@ public:
     /// Struct describing a managed texture.
     struct TextureDesc
     {
-        TextureState state = TextureState::Invalid; ///< Current state of the texture.
-        ref<Texture> pTexture;                      ///< Valid texture object when state is 'Loaded', or nullptr if loading failed.
+        TextureState state = TextureState::Invalid;      ///< Current state of the texture.
+        ref<Texture> pTexture;                           ///< Valid texture object when state is 'Loaded', or nullptr if loading failed.
+        std::optional<TextureAnalyzer::Result> analysis; ///< Texture analysis computed on the CPU at load time, if available.
 
         bool isValid() const { return state != TextureState::Invalid; }
     };
@@ -127,6 +139,26 @@ public:
      */
     TextureHandle addTexture(const ref<Texture>& pTexture);
 
+    /**
+     * Cache of the directory listings searched for UDIM tiles.
+     * Pass the same instance to a batch of loadTexture() calls (e.g., all material textures of a scene import), so each directory
+     * is only enumerated once. The listings are never refreshed, so the instance should not outlive the batch. This class is thread-safe.
+     */
+    class FALCOR_API DirectoryListings
+    {
+    public:
+        /**
+         * Get the filenames of all regular files in a directory, sorted by name.
+         * @param[in] path Directory path.
+         * @return Sorted filenames (without the directory path). Empty if the directory doesn't exist.
+         */
+        const std::vector<std::string>& get(const std::filesystem::path& path);
+
+    private:
+        std::mutex mMutex;
+        std::map<std::filesystem::path, std::vector<std::string>> mListings;
+    };
+
     /**
      * Requst loading a texture from file.
      * This will add the texture to the set of managed textures. The function returns a handle immediately.
@@ -139,6 +171,8 @@ public:
      * @param[in] async Load asynchronously, otherwise the function blocks until the texture data is loaded.
      * @param[in] searchDirectories Optionally can pass in search directories, will be used instead of the global data directories.
      * @param[out] loadedTextureCount Optionally can provided the number of actually loaded textures (2+ can happen with UDIMs)
+     * @param[in] pDirectoryListings Optional cache of the directory listings used to find UDIM tiles.
+     * If nullptr, the directories are enumerated on each call.
      * @return Unique handle to the texture, or an invalid handle if the texture can't be found.
      */
     TextureHandle loadTexture(
@@ -148,12 +182,15 @@ public:
         Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource,
         bool async = true,
         const SearchDirectories* searchDirectories = nullptr,
-        size_t* loadedTextureCount = nullptr
+        size_t* loadedTextureCount = nullptr,
+        DirectoryListings* pDirectoryListings = nullptr
     );
 
     /**
      * Same as loadTexture, but explicitly handles Udim textures. If the texture isn't Udim, it falls back to loadTexture.
      * Also, loadTexture will detect UDIM and call loadUdimTexture if needed.
+     * Tiles are found by matching the filenames in the searched directories (see DirectoryListings), and loading the same
+     * UDIM set again returns the existing handle.
      */
     TextureHandle loadUdimTexture(
         const std::filesystem::path& path,
@@ -162,7 +199,8 @@ public:
         Resource::BindFlags bindFlags = Resource::BindFlags::ShaderResource,
         bool async = true,
         const SearchDirectories* searchDirectories = nullptr,
-        size_t* loadedTextureCount = nullptr
+        size_t* loadedTextureCount = nullptr,
+        DirectoryListings* pDirectoryListings = nullptr
     );
 
     /**
@@ -180,13 +218,48 @@ public:
     /**
      * Marks the beginning of a section where texture loading is deferred.
      * All loadTexture() and loadUdimTexture() calls after calling this will be put on a deferred list.
-     * A later call to endDeferredLoading() will load all queued up textures in parallel.
+     * A later call to endDeferredLoading() will load all queued up textures. Image files are decoded in parallel on worker threads
+     * while the calling thread uploads the decoded textures to the GPU.
      * WARNING: This is a dangerous operation because Falcor is generally not thread-safe. Only use this
      * from the main thread when it is guaranteed to not be interleaved with any other thread.
      */
     void beginDeferredLoading();
     void endDeferredLoading();
 
+    /**
+     * Get the analysis result of a texture computed on the CPU at load time.
+     * This is available for textures loaded with deferred loading from uncompressed image formats,
+     * and can be used in place of running TextureAnalyzer on the GPU.
+     * @param[in] pTexture Texture.
+     * @return Analysis result of the first mip level, or std::nullopt if not available.
+     */
+    std::optional<TextureAnalyzer::Result> getTextureAnalysis(const Texture* pTexture) const;
+
+    /**
+     * Enable/disable the persistent block-compressed texture cache.
+     * When enabled, image files are transcoded once to block-compressed DDS files stored in the cache directory,
+     * and subsequent loads read the cached files instead of decoding the source images.
+     * Only applies to textures loaded from a single non-DDS file with the default bind flags.
+     * Call this before loading textures, it is not thread-safe.
+     * @param[in] enabled True to enable the cache.
+     */
+    void setUseCompressedTextureCache(bool enabled);
+    bool getUseCompressedTextureCache() const { return mpCompressedTextureCache != nullptr; }
+
+    /**
+     * Set the memory budget of the out-of-core texture page cache.
+     * The page cache keeps only the requested tiles of tiled textures resident, see TexturePageCache.
+     * Its statistics are reported in getStats(). Call this before loading textures, it is not thread-safe.
+     * @param[in] budgetInBytes Maximum memory used by resident tiles, or 0 to disable the page cache.
+     */
+    void setTexturePageCacheBudget(uint64_t budgetInBytes);
+
+    /**
+     * Get the out-of-core texture page cache.
+     * @return The page cache, or nullptr if disabled.
+     */
+    TexturePageCache* getTexturePageCache() const { return mpTexturePageCache.get(); }
+
     /**
      * Remove a texture.
      * @param[in] handle Texture handle.
@@ -271,9 +344,34 @@ private:
         }
     };
 
+    /**
+     * Load a texture from resolved full paths (one path per mip level, or a single path).
+     * This is the common part of loadTexture() and loadUdimTexture() after the paths have been resolved.
+     */
+    TextureHandle loadTextureFromPaths(
+        const std::vector<std::filesystem::path>& paths,
+        bool generateMipLevels,
+        bool loadAsSRGB,
+        Resource::BindFlags bindFlags,
+        bool async
+    );
+
     TextureHandle addDesc(const TextureDesc& desc);
     TextureDesc& getDesc(const TextureHandle& handle);
 
+    /**
+     * Get the block-compressed version of a texture from the texture cache, transcoding it if needed.
+     * This does not access the GPU and can be called from the decode threads.
+     * @return Path of the cached DDS file, or an empty path if the cache is disabled or not applicable to the texture.
+     */
+    std::filesystem::path getCompressedTexturePath(const TextureKey& key) const;
+
+    /**
+     * Load a texture through the block-compressed texture cache.
+     * @return Texture, or nullptr if the cache is disabled or not applicable to the texture.
+     */
+    ref<Texture> loadCompressedTexture(const TextureKey& key) const;
+
     ref<Device> mpDevice;
 
     mutable std::mutex mMutex;          ///< Mutex for synchronizing access to shared resources.
@@ -283,6 +381,7 @@ private:
     std::vector<TextureDesc> mTextureDescs;                   ///< Array of all texture descs, indexed by handle ID.
     std::vector<TextureHandle> mFreeList;                     ///< List of unused handles.
     std::map<TextureKey, TextureHandle> mKeyToHandle;         ///< Map from texture key to handle.
+    std::map<TextureKey, TextureHandle> mUdimKeyToHandle;     ///< Map from UDIM texture key (resolved pattern) to UDIM handle.
     std::map<const Texture*, TextureHandle> mTextureToHandle; ///< Map from texture ptr to handle.
     /// Map from UDIM-1001 to an actual textureID, -1 if the texture does not exist (e.g., there is 1001 and 1003, so 1002 [1] == -1)
     std::vector<int32_t> mUdimIndirection;
@@ -298,6 +397,10 @@ private:
 
     AsyncTextureLoader mAsyncTextureLoader; ///< Utility for asynchronous texture loading.
     size_t mLoadRequestsInProgress = 0;     ///< Number of load requests currently in progress.
+    const size_t mThreadCount;              ///< Number of worker threads used for decoding textures in endDeferredLoading().
+
+    std::unique_ptr<CompressedTextureCache> mpCompressedTextureCache; ///< Block-compressed texture cache, nullptr if disabled.
+    std::unique_ptr<TexturePageCache> mpTexturePageCache;             ///< Out-of-core texture page cache, nullptr if disabled.
 
     const size_t mMaxTextureCount; ///< Maximum number of textures that can be simultaneously managed.
 };
@@ -0,0 +1,337 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TexturePageCache.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Core/Platform/OS.h"
+#include "Utils/CryptoUtils.h"
+#include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+/// Tiled texture file version. Increment when the conversion changes to invalidate existing files.
+const uint32_t kVersion = 1;
+/// Cache directory relative to the application data directory.
+const std::filesystem::path kDirectory = "NVIDIA/Falcor/TexturePageCache";
+} // namespace
+
+TexturePageCache::TexturePageCache() : TexturePageCache(Options()) {}
+
+TexturePageCache::TexturePageCache(const Options& options) : mOptions(options)
+{
+    if (mOptions.directory.empty())
+        mOptions.directory = getDefaultDirectory();
+}
+
+TexturePageCache::~TexturePageCache() = default;
+
+std::filesystem::path TexturePageCache::getDefaultDirectory()
+{
+    return getAppDataDirectory() / kDirectory;
+}
+
+uint32_t TexturePageCache::addTexture(const std::filesystem::path& path)
+{
+    auto pFile = std::make_unique<TiledTextureFile>(path);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mFreeTextureIDs.empty())
+    {
+        uint32_t textureID = mFreeTextureIDs.back();
+        mFreeTextureIDs.pop_back();
+        mTextures[textureID] = std::move(pFile);
+        return textureID;
+    }
+    mTextures.push_back(std::move(pFile));
+    return uint32_t(mTextures.size() - 1);
+}
+
+uint32_t TexturePageCache::addTextureFromImage(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSRGB)
+{
+    std::string name;
+    {
+        MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!file.isOpen())
+            throw RuntimeError("Failed to open image '{}'.", path);
+
+        SHA1 sha1;
+        sha1.update(kVersion);
+        sha1.update(file.getData(), file.getSize());
+        sha1.update(generateMipLevels);
+        sha1.update(loadAsSRGB);
+        name = SHA1::toString(sha1.finalize());
+    }
+
+    const std::filesystem::path tiledPath = mOptions.directory / (name + ".tiles");
+    if (!std::filesystem::exists(tiledPath))
+    {
+        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(path, true);
+        if (!pBitmap)
+            throw RuntimeError("Failed to load image '{}'.", path);
+
+        // Write to a temporary file first, so other threads and processes never observe partially written files.
+        thread_local std::mt19937_64 rng{std::random_device{}()};
+        std::filesystem::create_directories(mOptions.directory);
+        const std::filesystem::path tempPath = mOptions.directory / fmt::format("{}.{:016x}.tmp", name, rng());
+        TiledTextureFile::write(tempPath, *pBitmap, generateMipLevels, loadAsSRGB);
+
+        std::error_code ec;
+        std::filesystem::rename(tempPath, tiledPath, ec);
+        if (ec)
+        {
+            // Another thread or process may have created the same file concurrently.
+            std::filesystem::remove(tempPath, ec);
+            if (!std::filesystem::exists(tiledPath))
+                throw RuntimeError("Failed to write tiled texture file '{}'.", tiledPath);
+        }
+        logDebug("Converted '{}' to tiled texture file '{}'.", path, tiledPath);
+    }
+
+    return addTexture(tiledPath);
+}
+
+void TexturePageCache::removeTexture(uint32_t textureID)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    FALCOR_CHECK_ARG(textureID < mTextures.size() && mTextures[textureID]);
+
+    for (auto it = mLRU.begin(); it != mLRU.end();)
+    {
+        if (it->id.textureID == textureID)
+        {
+            mFreePages.push_back(it->page);
+            mResident.erase(it->id.getKey());
+            it = mLRU.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (auto it = mRequestedThisUpdate.begin(); it != mRequestedThisUpdate.end();)
+        it = uint32_t(*it >> 32) == textureID ? mRequestedThisUpdate.erase(it) : std::next(it);
+
+    auto isRemoved = [textureID](const TileID& tile) { return tile.textureID == textureID; };
+    for (const auto& tile : mPending)
+        if (isRemoved(tile))
+            mPendingSet.erase(tile.getKey());
+    mPending.erase(std::remove_if(mPending.begin(), mPending.end(), isRemoved), mPending.end());
+
+    mTextures[textureID].reset();
+    mFreeTextureIDs.push_back(textureID);
+}
+
+const TiledTextureFile& TexturePageCache::getTextureFile(uint32_t textureID) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    FALCOR_CHECK_ARG(textureID < mTextures.size() && mTextures[textureID]);
+    return *mTextures[textureID];
+}
+
+void TexturePageCache::requestTiles(const TileID* pTiles, size_t count)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (size_t i = 0; i < count; i++)
+    {
+        const TileID& tile = pTiles[i];
+        bool isValid = tile.textureID < mTextures.size() && mTextures[tile.textureID] &&
+                       tile.tileIndex < mTextures[tile.textureID]->getTileCount();
+        if (!isValid)
+            continue;
+
+        const uint64_t key = tile.getKey();
+        if (!mRequestedThisUpdate.insert(key).second)
+            continue;
+        mStats.requestCount++;
+
+        auto it = mResident.find(key);
+        if (it != mResident.end())
+        {
+            mStats.hitCount++;
+            it->second->lastRequest = mUpdateIndex;
+            mLRU.splice(mLRU.begin(), mLRU, it->second);
+        }
+        else
+        {
+            mStats.missCount++;
+            if (mPendingSet.insert(key).second)
+                mPending.push_back(tile);
+        }
+    }
+}
+
+TexturePageCache::UpdateResult TexturePageCache::update()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    UpdateResult result;
+
+    // Load the coarsest mip levels first. They cover the largest screen areas and serve as fallback for finer levels.
+    std::stable_sort(
+        mPending.begin(),
+        mPending.end(),
+        [this](const TileID& a, const TileID& b)
+        { return mTextures[a.textureID]->getTileMip(a.tileIndex) > mTextures[b.textureID]->getTileMip(b.tileIndex); }
+    );
+
+    struct Load
+    {
+        TileID id;
+        uint32_t page;
+    };
+    std::vector<Load> loads;
+    for (const TileID& tile : mPending)
+    {
+        if (loads.size() >= mOptions.maxLoadsPerUpdate)
+            break;
+
+        if (mResident.size() + loads.size() >= getMaxPageCount())
+        {
+            // Evict the least recently used tile, unless it is still in use.
+            if (mLRU.empty() || mLRU.back().lastRequest == mUpdateIndex)
+                break;
+            evictLRU(result.evictedTiles);
+        }
+        loads.push_back({tile, allocatePage()});
+    }
+
+    Threading::parallelFor(
+        0,
+        loads.size(),
+        [&](size_t i)
+        {
+            const Load& load = loads[i];
+            std::memcpy(
+                mPages[load.page].get(),
+                mTextures[load.id.textureID]->getTileData(load.id.tileIndex),
+                TiledTextureFile::kTileSizeInBytes
+            );
+        },
+        4
+    );
+
+    for (const Load& load : loads)
+    {
+        mLRU.push_front({load.id, load.page, mUpdateIndex});
+        mResident[load.id.getKey()] = mLRU.begin();
+        mPendingSet.erase(load.id.getKey());
+        result.loadedTiles.push_back(load.id);
+    }
+    mPending.erase(mPending.begin(), mPending.begin() + loads.size());
+    mStats.loadCount += loads.size();
+
+    mUpdateIndex++;
+    mRequestedThisUpdate.clear();
+    return result;
+}
+
+bool TexturePageCache::isResident(const TileID& tile) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mResident.find(tile.getKey()) != mResident.end();
+}
+
+const uint8_t* TexturePageCache::getTileData(const TileID& tile) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mResident.find(tile.getKey());
+    return it != mResident.end() ? mPages[it->second->page].get() : nullptr;
+}
+
+std::vector<TexturePageCache::TileID> TexturePageCache::setBudget(uint64_t budgetInBytes)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mOptions.budgetInBytes = budgetInBytes;
+
+    std::vector<TileID> evicted;
+    while (mResident.size() > getMaxPageCount())
+        evictLRU(evicted);
+
+    // Release the memory of unused pages.
+    for (uint32_t page : mFreePages)
+        mPages[page].reset();
+    return evicted;
+}
+
+uint64_t TexturePageCache::getBudget() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mOptions.budgetInBytes;
+}
+
+TexturePageCache::Stats TexturePageCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Stats stats = mStats;
+    stats.residentTileCount = mResident.size();
+    stats.residentBytes = mResident.size() * TiledTextureFile::kTileSizeInBytes;
+    stats.pendingTileCount = mPending.size();
+    return stats;
+}
+
+void TexturePageCache::resetStats()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats = {};
+}
+
+uint32_t TexturePageCache::allocatePage()
+{
+    uint32_t page;
+    if (!mFreePages.empty())
+    {
+        page = mFreePages.back();
+        mFreePages.pop_back();
+    }
+    else
+    {
+        page = (uint32_t)mPages.size();
+        mPages.emplace_back();
+    }
+    if (!mPages[page])
+        mPages[page].reset(new uint8_t[TiledTextureFile::kTileSizeInBytes]);
+    return page;
+}
+
+void TexturePageCache::evictLRU(std::vector<TileID>& evicted)
+{
+    FALCOR_ASSERT(!mLRU.empty());
+    const ResidentTile& tile = mLRU.back();
+    evicted.push_back(tile.id);
+    mFreePages.push_back(tile.page);
+    mResident.erase(tile.id.getKey());
+    mLRU.pop_back();
+    mStats.evictionCount++;
+}
+} // namespace Falcor
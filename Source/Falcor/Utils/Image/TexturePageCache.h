@@ -0,0 +1,203 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "TiledTextureFile.h"
+#include "Core/Macros.h"
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Out-of-core texture page cache.
+ *
+ * Textures are stored as tiled texture files (see TiledTextureFile) and only the tiles that are requested
+ * are kept resident in memory. The renderer reports the tiles it needs (typically from a feedback pass)
+ * with requestTiles(). Requests for resident tiles are cache hits and mark the tiles as recently used.
+ * Requests for other tiles are cache misses and are queued. update() loads queued tiles from the
+ * memory-mapped tile files, coarsest mip levels first, and evicts the least recently used tiles to stay
+ * within the memory budget. Tiles requested since the last update are never evicted to make room for others.
+ *
+ * All tiles have the same size (TiledTextureFile::kTileSizeInBytes), so resident tiles are stored in a pool
+ * of fixed-size pages that is reused as tiles are evicted. All operations are thread-safe.
+ */
+class FALCOR_API TexturePageCache
+{
+public:
+    /// Identifies a tile of a texture.
+    struct TileID
+    {
+        uint32_t textureID = 0; ///< Texture ID returned by addTexture().
+        uint32_t tileIndex = 0; ///< Tile index in the texture, see TiledTextureFile::getTileIndex().
+
+        uint64_t getKey() const { return (uint64_t(textureID) << 32) | tileIndex; }
+        bool operator==(const TileID& other) const { return getKey() == other.getKey(); }
+    };
+
+    struct Options
+    {
+        uint64_t budgetInBytes = 256ull << 20; ///< Maximum memory used by resident tiles.
+        uint32_t maxLoadsPerUpdate = 256;      ///< Maximum number of tiles loaded per update() call.
+        std::filesystem::path directory; ///< Directory for files created by addTextureFromImage(). Empty for the default directory.
+    };
+
+    struct Stats
+    {
+        uint64_t requestCount = 0;      ///< Number of tile requests (after removing duplicates within an update).
+        uint64_t hitCount = 0;          ///< Number of requests for resident tiles.
+        uint64_t missCount = 0;         ///< Number of requests for tiles that were not resident.
+        uint64_t loadCount = 0;         ///< Number of tiles loaded.
+        uint64_t evictionCount = 0;     ///< Number of tiles evicted.
+        uint64_t residentTileCount = 0; ///< Number of tiles currently resident in the cache.
+        uint64_t residentBytes = 0;     ///< Memory used by resident tiles in bytes.
+        uint64_t pendingTileCount = 0;  ///< Number of requested tiles waiting to be loaded.
+    };
+
+    /// Result of an update() call, used to update GPU page tables.
+    struct UpdateResult
+    {
+        std::vector<TileID> loadedTiles;  ///< Tiles that became resident.
+        std::vector<TileID> evictedTiles; ///< Tiles that were evicted.
+    };
+
+    TexturePageCache();
+    explicit TexturePageCache(const Options& options);
+    ~TexturePageCache();
+
+    /**
+     * Get the default directory for tiled texture files (subdirectory in the application data directory).
+     */
+    static std::filesystem::path getDefaultDirectory();
+
+    /**
+     * Add a texture stored in a tiled texture file. Throws an exception if the file can't be opened.
+     * @param[in] path Path of the tiled texture file.
+     * @return Texture ID.
+     */
+    uint32_t addTexture(const std::filesystem::path& path);
+
+    /**
+     * Add a texture from an image file. The image is converted to a tiled texture file in the cache directory on the
+     * first use. Files are keyed by the content hash of the image and the parameters, so later runs reuse them.
+     * Throws an exception if the image can't be loaded or converted.
+     * @param[in] path Full path of the image file.
+     * @param[in] generateMipLevels Generate the full mip chain.
+     * @param[in] loadAsSRGB Filter color channels in linear space when generating mip levels of sRGB images.
+     * @return Texture ID.
+     */
+    uint32_t addTextureFromImage(const std::filesystem::path& path, bool generateMipLevels, bool loadAsSRGB);
+
+    /**
+     * Remove a texture and evict all its resident tiles. Pending requests for the texture are dropped.
+     * @param[in] textureID Texture ID.
+     */
+    void removeTexture(uint32_t textureID);
+
+    /**
+     * Get the tiled texture file of a texture.
+     * @param[in] textureID Texture ID.
+     */
+    const TiledTextureFile& getTextureFile(uint32_t textureID) const;
+
+    /**
+     * Request tiles. Resident tiles are marked as recently used, other tiles are queued for loading.
+     * Requests for tiles of unknown textures or out-of-range tiles are ignored.
+     * @param[in] pTiles Array of requested tiles. May contain duplicates.
+     * @param[in] count Number of requested tiles.
+     */
+    void requestTiles(const TileID* pTiles, size_t count);
+    void requestTiles(const std::vector<TileID>& tiles) { requestTiles(tiles.data(), tiles.size()); }
+
+    /**
+     * Load queued tiles and evict tiles as needed to stay within the memory budget.
+     * At most Options::maxLoadsPerUpdate tiles are loaded. Tiles that don't fit in the budget stay queued.
+     * Tiles are copied from the mapped files in parallel.
+     * @return Loaded and evicted tiles.
+     */
+    UpdateResult update();
+
+    /**
+     * Check if a tile is resident.
+     */
+    bool isResident(const TileID& tile) const;
+
+    /**
+     * Get the data of a resident tile.
+     * The pointer stays valid until the tile is evicted, i.e. until the next call to update(), setBudget() or removeTexture().
+     * @return Tile data (TiledTextureFile::kTileSizeInBytes bytes), or nullptr if the tile is not resident.
+     */
+    const uint8_t* getTileData(const TileID& tile) const;
+
+    /**
+     * Set the memory budget. Least recently used tiles are evicted immediately if the resident tiles exceed the new budget.
+     * @param[in] budgetInBytes Maximum memory used by resident tiles.
+     * @return Evicted tiles.
+     */
+    std::vector<TileID> setBudget(uint64_t budgetInBytes);
+    uint64_t getBudget() const;
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    struct ResidentTile
+    {
+        TileID id;
+        uint32_t page;
+        uint64_t lastRequest; ///< Update index of the last request.
+    };
+
+    uint32_t allocatePage();
+    void evictLRU(std::vector<TileID>& evicted);
+    size_t getMaxPageCount() const { return size_t(mOptions.budgetInBytes / TiledTextureFile::kTileSizeInBytes); }
+
+    mutable std::mutex mMutex;
+    Options mOptions;
+
+    std::vector<std::unique_ptr<TiledTextureFile>> mTextures; ///< Texture files indexed by texture ID, nullptr for removed textures.
+    std::vector<uint32_t> mFreeTextureIDs;
+
+    std::list<ResidentTile> mLRU; ///< Resident tiles, most recently used first.
+    std::unordered_map<uint64_t, std::list<ResidentTile>::iterator> mResident;
+
+    std::vector<TileID> mPending; ///< Tiles waiting to be loaded, in request order.
+    std::unordered_set<uint64_t> mPendingSet;
+    std::unordered_set<uint64_t> mRequestedThisUpdate; ///< Tiles requested since the last update, used to count duplicates once.
+
+    std::vector<std::unique_ptr<uint8_t[]>> mPages; ///< Page pool.
+    std::vector<uint32_t> mFreePages;
+
+    uint64_t mUpdateIndex = 0;
+    Stats mStats;
+};
+} // namespace Falcor
@@ -0,0 +1,258 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "TiledTextureFile.h"
+#include "MipChainGenerator.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Utils/Math/Common.h"
+#include "Utils/StringFormatters.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kMagic = 0x46545446; // "FTTF"
+const uint32_t kVersion = 1;
+
+struct FileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    uint32_t mipCount;
+    uint32_t tileCount;
+    uint32_t reserved[3];
+};
+
+/// Tile dimensions in blocks for each supported block size, from the D3D12 standard swizzle tile shapes.
+uint2 getTileShapeInBlocks(uint32_t bytesPerBlock)
+{
+    switch (bytesPerBlock)
+    {
+    case 1:
+        return {256, 256};
+    case 2:
+        return {256, 128};
+    case 4:
+        return {128, 128};
+    case 8:
+        return {128, 64};
+    case 16:
+        return {64, 64};
+    default:
+        return {0, 0};
+    }
+}
+
+size_t getDataOffset(uint32_t mipCount)
+{
+    size_t headerSize = sizeof(FileHeader) + mipCount * sizeof(TiledTextureFile::MipInfo);
+    return div_round_up(headerSize, TiledTextureFile::kTileSizeInBytes) * TiledTextureFile::kTileSizeInBytes;
+}
+
+std::vector<TiledTextureFile::MipInfo> computeMipLayout(ResourceFormat format, uint32_t width, uint32_t height, uint32_t mipCount)
+{
+    const uint2 tileShape = TiledTextureFile::getTileShape(format);
+    std::vector<TiledTextureFile::MipInfo> mips(mipCount);
+    uint32_t tileCount = 0;
+    for (uint32_t mip = 0; mip < mipCount; mip++)
+    {
+        auto& info = mips[mip];
+        info.width = std::max(1u, width >> mip);
+        info.height = std::max(1u, height >> mip);
+        info.tilesX = div_round_up(info.width, tileShape.x);
+        info.tilesY = div_round_up(info.height, tileShape.y);
+        info.firstTile = tileCount;
+        tileCount += info.tilesX * info.tilesY;
+    }
+    return mips;
+}
+} // namespace
+
+uint2 TiledTextureFile::getTileShape(ResourceFormat format)
+{
+    uint2 shape = getTileShapeInBlocks(getFormatBytesPerBlock(format));
+    return {shape.x * getFormatWidthCompressionRatio(format), shape.y * getFormatHeightCompressionRatio(format)};
+}
+
+bool TiledTextureFile::isFormatSupported(ResourceFormat format)
+{
+    if (format == ResourceFormat::Unknown || isDepthStencilFormat(format))
+        return false;
+    return getTileShapeInBlocks(getFormatBytesPerBlock(format)).x > 0;
+}
+
+void TiledTextureFile::write(const std::filesystem::path& path, const std::vector<const Bitmap*>& mips)
+{
+    FALCOR_CHECK_ARG(!mips.empty());
+    const ResourceFormat format = mips[0]->getFormat();
+    if (!isFormatSupported(format))
+        throw ArgumentError("Format '{}' is not supported by tiled texture files.", to_string(format));
+
+    const auto layout = computeMipLayout(format, mips[0]->getWidth(), mips[0]->getHeight(), (uint32_t)mips.size());
+    for (size_t mip = 0; mip < mips.size(); mip++)
+    {
+        if (mips[mip]->getFormat() != format || mips[mip]->getWidth() != layout[mip].width || mips[mip]->getHeight() != layout[mip].height)
+            throw ArgumentError("Mip level {} does not match the mip chain of the base level.", mip);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw RuntimeError("Failed to open '{}' for writing.", path);
+
+    FileHeader header = {};
+    header.magic = kMagic;
+    header.version = kVersion;
+    header.format = (uint32_t)format;
+    header.mipCount = (uint32_t)mips.size();
+    header.tileCount = layout.back().firstTile + layout.back().tilesX * layout.back().tilesY;
+
+    std::vector<uint8_t> buffer(getDataOffset(header.mipCount), 0);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    std::memcpy(buffer.data() + sizeof(header), layout.data(), layout.size() * sizeof(MipInfo));
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+
+    const uint32_t bytesPerBlock = getFormatBytesPerBlock(format);
+    const uint2 blockSize = {getFormatWidthCompressionRatio(format), getFormatHeightCompressionRatio(format)};
+    const uint2 tileBlocks = getTileShapeInBlocks(bytesPerBlock);
+    const size_t tileRowPitch = tileBlocks.x * bytesPerBlock;
+
+    buffer.resize(kTileSizeInBytes);
+    for (size_t mip = 0; mip < mips.size(); mip++)
+    {
+        const Bitmap& bitmap = *mips[mip];
+        const uint32_t blocksX = div_round_up(layout[mip].width, blockSize.x);
+        const uint32_t blocksY = div_round_up(layout[mip].height, blockSize.y);
+        const uint8_t* pSrc = bitmap.getData();
+        const size_t srcRowPitch = bitmap.getRowPitch();
+        FALCOR_ASSERT(srcRowPitch >= blocksX * bytesPerBlock && bitmap.getSize() >= srcRowPitch * blocksY);
+
+        for (uint32_t tileY = 0; tileY < layout[mip].tilesY; tileY++)
+        {
+            for (uint32_t tileX = 0; tileX < layout[mip].tilesX; tileX++)
+            {
+                // Copy the tile, replicating the last row and column of blocks past the edges of the mip level.
+                const uint32_t x0 = tileX * tileBlocks.x;
+                const uint32_t y0 = tileY * tileBlocks.y;
+                const uint32_t copyBlocks = std::min(tileBlocks.x, blocksX - x0);
+                for (uint32_t row = 0; row < tileBlocks.y; row++)
+                {
+                    const uint8_t* pSrcRow = pSrc + std::min(y0 + row, blocksY - 1) * srcRowPitch + x0 * bytesPerBlock;
+                    uint8_t* pDstRow = buffer.data() + row * tileRowPitch;
+                    std::memcpy(pDstRow, pSrcRow, copyBlocks * bytesPerBlock);
+                    for (uint32_t x = copyBlocks; x < tileBlocks.x; x++)
+                        std::memcpy(pDstRow + x * bytesPerBlock, pSrcRow + (copyBlocks - 1) * bytesPerBlock, bytesPerBlock);
+                }
+                file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+            }
+        }
+    }
+
+    if (!file)
+        throw RuntimeError("Failed to write '{}'.", path);
+}
+
+void TiledTextureFile::write(const std::filesystem::path& path, const Bitmap& mip0, bool generateMipLevels, bool loadAsSRGB)
+{
+    std::vector<const Bitmap*> mips = {&mip0};
+    std::vector<Bitmap::UniqueConstPtr> generatedMips;
+    if (generateMipLevels)
+    {
+        if (!MipChainGenerator::isFormatSupported(mip0.getFormat()))
+            throw ArgumentError("Can't generate mip levels for format '{}'.", to_string(mip0.getFormat()));
+        generatedMips = MipChainGenerator::generate(mip0, MipChainGenerator::Filter::Box, loadAsSRGB);
+        for (const auto& pMip : generatedMips)
+            mips.push_back(pMip.get());
+    }
+    write(path, mips);
+}
+
+TiledTextureFile::TiledTextureFile(const std::filesystem::path& path) : mPath(path)
+{
+    if (!mFile.open(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::RandomAccess))
+        throw RuntimeError("Failed to open tiled texture file '{}'.", path);
+
+    FileHeader header;
+    if (mFile.getSize() < sizeof(header))
+        throw RuntimeError("Tiled texture file '{}' is truncated.", path);
+    std::memcpy(&header, mFile.getData(), sizeof(header));
+    if (header.magic != kMagic || header.version != kVersion)
+        throw RuntimeError("'{}' is not a tiled texture file or has an unsupported version.", path);
+
+    mFormat = (ResourceFormat)header.format;
+    if (header.format >= (uint32_t)ResourceFormat::Count || !isFormatSupported(mFormat) || header.mipCount == 0)
+        throw RuntimeError("Tiled texture file '{}' has an invalid header.", path);
+
+    mDataOffset = getDataOffset(header.mipCount);
+    if (mFile.getSize() < mDataOffset)
+        throw RuntimeError("Tiled texture file '{}' is truncated.", path);
+    mMips.resize(header.mipCount);
+    std::memcpy(mMips.data(), static_cast<const uint8_t*>(mFile.getData()) + sizeof(header), header.mipCount * sizeof(MipInfo));
+
+    // Validate the mip layout against the one implied by the base level, so that corrupt files can't cause out-of-bounds reads.
+    const auto layout = computeMipLayout(mFormat, mMips[0].width, mMips[0].height, header.mipCount);
+    for (uint32_t mip = 0; mip < header.mipCount; mip++)
+    {
+        const auto& a = mMips[mip];
+        const auto& b = layout[mip];
+        if (a.width != b.width || a.height != b.height || a.tilesX != b.tilesX || a.tilesY != b.tilesY || a.firstTile != b.firstTile)
+            throw RuntimeError("Tiled texture file '{}' has an invalid mip layout.", path);
+    }
+
+    mTileCount = header.tileCount;
+    if (mTileCount != layout.back().firstTile + layout.back().tilesX * layout.back().tilesY ||
+        mFile.getSize() < mDataOffset + mTileCount * kTileSizeInBytes)
+        throw RuntimeError("Tiled texture file '{}' is truncated.", path);
+
+    mTileShape = getTileShape(mFormat);
+    mTileRowPitch = getTileShapeInBlocks(getFormatBytesPerBlock(mFormat)).x * getFormatBytesPerBlock(mFormat);
+}
+
+uint32_t TiledTextureFile::getTileIndex(uint32_t mip, uint32_t tileX, uint32_t tileY) const
+{
+    FALCOR_ASSERT(mip < mMips.size() && tileX < mMips[mip].tilesX && tileY < mMips[mip].tilesY);
+    return mMips[mip].firstTile + tileY * mMips[mip].tilesX + tileX;
+}
+
+uint32_t TiledTextureFile::getTileMip(uint32_t tileIndex) const
+{
+    FALCOR_ASSERT(tileIndex < mTileCount);
+    auto it =
+        std::upper_bound(mMips.begin(), mMips.end(), tileIndex, [](uint32_t index, const MipInfo& info) { return index < info.firstTile; });
+    return uint32_t(it - mMips.begin()) - 1;
+}
+
+const uint8_t* TiledTextureFile::getTileData(uint32_t tileIndex) const
+{
+    FALCOR_ASSERT(tileIndex < mTileCount);
+    return static_cast<const uint8_t*>(mFile.getData()) + mDataOffset + tileIndex * kTileSizeInBytes;
+}
+} // namespace Falcor
@@ -0,0 +1,147 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Bitmap.h"
+#include "Core/Macros.h"
+#include "Core/API/Formats.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/Math/Vector.h"
+#include <filesystem>
+#include <vector>
+
+namespace Falcor
+{
+/**
+ * Memory-mapped file storing the mip levels of a texture as fixed-size tiles.
+ *
+ * Every tile occupies kTileSizeInBytes (64 KB) in the file, independent of the texture format. The tile
+ * dimensions follow the standard tile shapes of D3D12 tiled resources, e.g. 128x128 texels for 4 bytes
+ * per texel and 256x256 texels for BC7. Tiles at the right and bottom edges of a mip level are padded by
+ * replicating the edge texels. Mip levels smaller than a tile are stored in a single tile.
+ *
+ * Tiles are stored in mip order, and row-major within each mip level. A tile is identified by its index
+ * in the file, see getTileIndex().
+ */
+class FALCOR_API TiledTextureFile
+{
+public:
+    /// Size of a tile in bytes.
+    static constexpr size_t kTileSizeInBytes = 64 * 1024;
+
+    /// Layout of a mip level.
+    struct MipInfo
+    {
+        uint32_t width = 0;     ///< Width in texels.
+        uint32_t height = 0;    ///< Height in texels.
+        uint32_t tilesX = 0;    ///< Number of tiles in x.
+        uint32_t tilesY = 0;    ///< Number of tiles in y.
+        uint32_t firstTile = 0; ///< Index of the first tile of the mip level.
+    };
+
+    /**
+     * Get the tile dimensions for a format.
+     * @param[in] format Texture format. Uncompressed and block-compressed formats with power-of-two block sizes are supported.
+     * @return Tile width and height in texels.
+     */
+    static uint2 getTileShape(ResourceFormat format);
+
+    /**
+     * Check if a format can be stored in a tiled texture file.
+     */
+    static bool isFormatSupported(ResourceFormat format);
+
+    /**
+     * Write a tiled texture file. Throws an exception on failure.
+     * @param[in] path File path.
+     * @param[in] mips Mip levels, starting with the base level. All levels must have the same format and
+     * dimensions halving (rounded down, minimum 1) from one level to the next. Rows are expected in top-down order.
+     */
+    static void write(const std::filesystem::path& path, const std::vector<const Bitmap*>& mips);
+
+    /**
+     * Write a tiled texture file from an image, optionally generating its mip chain on the CPU.
+     * Throws an exception on failure.
+     * @param[in] path File path.
+     * @param[in] mip0 Base level image in top-down row order.
+     * @param[in] generateMipLevels Generate the full mip chain (requires a format supported by MipChainGenerator).
+     * @param[in] loadAsSRGB Filter color channels in linear space when generating mip levels of sRGB images.
+     */
+    static void write(const std::filesystem::path& path, const Bitmap& mip0, bool generateMipLevels, bool loadAsSRGB);
+
+    /**
+     * Open a tiled texture file. Throws an exception if the file is missing or invalid.
+     * @param[in] path File path.
+     */
+    explicit TiledTextureFile(const std::filesystem::path& path);
+
+    const std::filesystem::path& getPath() const { return mPath; }
+    ResourceFormat getFormat() const { return mFormat; }
+    uint32_t getWidth() const { return mMips[0].width; }
+    uint32_t getHeight() const { return mMips[0].height; }
+    uint32_t getMipCount() const { return (uint32_t)mMips.size(); }
+    const MipInfo& getMipInfo(uint32_t mip) const { return mMips[mip]; }
+
+    /// Get the tile dimensions in texels.
+    uint2 getTileShape() const { return mTileShape; }
+
+    /// Get the row pitch of the tile data in bytes.
+    uint32_t getTileRowPitch() const { return mTileRowPitch; }
+
+    /// Get the total number of tiles in all mip levels.
+    uint32_t getTileCount() const { return mTileCount; }
+
+    /**
+     * Get the index of a tile.
+     * @param[in] mip Mip level.
+     * @param[in] tileX Tile x coordinate.
+     * @param[in] tileY Tile y coordinate.
+     */
+    uint32_t getTileIndex(uint32_t mip, uint32_t tileX, uint32_t tileY) const;
+
+    /**
+     * Get the mip level of a tile.
+     */
+    uint32_t getTileMip(uint32_t tileIndex) const;
+
+    /**
+     * Get the data of a tile in the mapped file.
+     * The data is kTileSizeInBytes large, with rows of getTileRowPitch() bytes.
+     */
+    const uint8_t* getTileData(uint32_t tileIndex) const;
+
+private:
+    std::filesystem::path mPath;
+    MemoryMappedFile mFile;
+    ResourceFormat mFormat = ResourceFormat::Unknown;
+    uint2 mTileShape;
+    uint32_t mTileRowPitch = 0;
+    uint32_t mTileCount = 0;
+    size_t mDataOffset = 0;
+    std::vector<MipInfo> mMips;
+};
+} // namespace Falcor
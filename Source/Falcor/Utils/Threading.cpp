@@ -27,17 +27,180 @@
  **************************************************************************/
 #include "Threading.h"
 #include "Core/Assert.h"
+#include <atomic>
+#include <deque>
+#include <exception>
 
 namespace Falcor
 {
+struct Threading::Task::State
+{
+    std::function<void(void)> func;
+    std::atomic<bool> done{false};
+    std::exception_ptr exception;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<std::shared_ptr<State>> continuations; ///< Tasks to dispatch once this task is done. Guarded by mutex.
+};
+
 namespace
 {
+using TaskState = Threading::Task::State;
+
+struct Worker
+{
+    std::mutex mutex;
+    std::deque<std::shared_ptr<TaskState>> queue;
+    std::thread thread;
+};
+
 struct ThreadingData
 {
     bool initialized = false;
-    std::vector<std::thread> threads;
-    uint32_t current;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<uint32_t> nextWorker{0};
+
+    /// Number of tasks sitting in queues. Incremented under wakeMutex to avoid lost wake-ups.
+    std::atomic<size_t> queuedCount{0};
+    /// Number of tasks dispatched but not yet completed.
+    std::atomic<size_t> pendingCount{0};
+    bool stop = false;
+
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::mutex idleMutex;
+    std::condition_variable idleCondition;
 } gData; // TODO: REMOVEGLOBAL
+
+/// Index of the worker owned by the current thread, or -1 if the current thread is not a worker.
+thread_local int32_t tWorkerIndex = -1;
+
+void dispatchTaskState(std::shared_ptr<TaskState> pState);
+
+std::shared_ptr<TaskState> popTask(int32_t workerIndex)
+{
+    const size_t workerCount = gData.workers.size();
+
+    // Pop from the back of our own queue first.
+    if (workerIndex >= 0)
+    {
+        Worker& worker = *gData.workers[workerIndex];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.queue.empty())
+        {
+            auto pState = std::move(worker.queue.back());
+            worker.queue.pop_back();
+            gData.queuedCount.fetch_sub(1);
+            return pState;
+        }
+    }
+
+    // Steal from the front of the other queues.
+    const size_t first = workerIndex >= 0 ? workerIndex + 1 : 0;
+    for (size_t i = 0; i < workerCount; ++i)
+    {
+        Worker& worker = *gData.workers[(first + i) % workerCount];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.queue.empty())
+        {
+            auto pState = std::move(worker.queue.front());
+            worker.queue.pop_front();
+            gData.queuedCount.fetch_sub(1);
+            return pState;
+        }
+    }
+
+    return nullptr;
+}
+
+void runTask(const std::shared_ptr<TaskState>& pState)
+{
+    try
+    {
+        pState->func();
+    }
+    catch (...)
+    {
+        pState->exception = std::current_exception();
+    }
+    pState->func = nullptr;
+
+    std::vector<std::shared_ptr<TaskState>> continuations;
+    {
+        std::lock_guard<std::mutex> lock(pState->mutex);
+        pState->done = true;
+        continuations = std::move(pState->continuations);
+    }
+    pState->condition.notify_all();
+
+    // Dispatch continuations before marking this task as completed so that Threading::finish() also waits for them.
+    for (auto& pContinuation : continuations)
+        dispatchTaskState(std::move(pContinuation));
+
+    if (gData.pendingCount.fetch_sub(1) == 1)
+    {
+        std::lock_guard<std::mutex> lock(gData.idleMutex);
+        gData.idleCondition.notify_all();
+    }
+}
+
+void dispatchTaskState(std::shared_ptr<TaskState> pState)
+{
+    gData.pendingCount.fetch_add(1);
+
+    const size_t workerIndex = tWorkerIndex >= 0 ? tWorkerIndex : gData.nextWorker.fetch_add(1) % gData.workers.size();
+    {
+        Worker& worker = *gData.workers[workerIndex];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queue.push_back(std::move(pState));
+    }
+    {
+        std::lock_guard<std::mutex> lock(gData.wakeMutex);
+        gData.queuedCount.fetch_add(1);
+    }
+    gData.wakeCondition.notify_one();
+}
+
+void workerLoop(int32_t workerIndex)
+{
+    tWorkerIndex = workerIndex;
+
+    while (true)
+    {
+        if (auto pState = popTask(workerIndex))
+        {
+            runTask(pState);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(gData.wakeMutex);
+        gData.wakeCondition.wait(lock, []() { return gData.stop || gData.queuedCount.load() > 0; });
+        if (gData.stop && gData.queuedCount.load() == 0)
+            break;
+    }
+
+    tWorkerIndex = -1;
+}
+
+/// Wait for a task to complete. Worker threads execute other tasks while waiting to avoid deadlocks.
+void waitForTask(const std::shared_ptr<TaskState>& pState)
+{
+    if (tWorkerIndex >= 0)
+    {
+        while (!pState->done)
+        {
+            if (auto pOther = popTask(tWorkerIndex))
+                runTask(pOther);
+            else
+                std::this_thread::yield();
+        }
+    }
+    else
+    {
+        std::unique_lock<std::mutex> lock(pState->mutex);
+        pState->condition.wait(lock, [&pState]() { return pState->done.load(); });
+    }
+}
 } // namespace
 
 void Threading::start(uint32_t threadCount)
@@ -45,52 +208,196 @@ void Threading::start(uint32_t threadCount)
     if (gData.initialized)
         return;
 
-    gData.threads.resize(threadCount);
+    if (threadCount == 0)
+        threadCount = std::max(1u, getLogicalThreadCount());
+
+    gData.stop = false;
+    gData.workers.resize(threadCount);
+    for (auto& pWorker : gData.workers)
+        pWorker = std::make_unique<Worker>();
+    for (uint32_t i = 0; i < threadCount; ++i)
+        gData.workers[i]->thread = std::thread(workerLoop, int32_t(i));
+
     gData.initialized = true;
 }
 
 void Threading::shutdown()
 {
-    for (auto& t : gData.threads)
+    if (!gData.initialized)
+        return;
+
+    finish();
+
+    {
+        std::lock_guard<std::mutex> lock(gData.wakeMutex);
+        gData.stop = true;
+    }
+    gData.wakeCondition.notify_all();
+
+    for (auto& pWorker : gData.workers)
     {
-        if (t.joinable())
-            t.join();
+        if (pWorker->thread.joinable())
+            pWorker->thread.join();
     }
+    gData.workers.clear();
 
     gData.initialized = false;
 }
 
-Threading::Task Threading::dispatchTask(const std::function<void(void)>& func)
+bool Threading::isRunning()
+{
+    return gData.initialized;
+}
+
+uint32_t Threading::getThreadCount()
+{
+    return (uint32_t)gData.workers.size();
+}
+
+Threading::Task Threading::dispatchTask(std::function<void(void)> func)
 {
     FALCOR_ASSERT(gData.initialized);
 
-    std::thread& t = gData.threads[gData.current];
-    if (t.joinable())
-        t.join();
-    t = std::thread(func);
-    gData.current = (gData.current + 1) % gData.threads.size();
+    auto pState = std::make_shared<Task::State>();
+    pState->func = std::move(func);
+    dispatchTaskState(pState);
 
-    return Task();
+    return Task(pState);
 }
 
 void Threading::finish()
 {
-    for (auto& t : gData.threads)
+    if (!gData.initialized)
+        return;
+
+    // Waiting for all tasks from within a task would wait for itself.
+    FALCOR_ASSERT(tWorkerIndex < 0);
+
+    std::unique_lock<std::mutex> lock(gData.idleMutex);
+    gData.idleCondition.wait(lock, []() { return gData.pendingCount.load() == 0; });
+}
+
+void Threading::parallelForRange(size_t begin, size_t end, const std::function<void(size_t, size_t)>& func, size_t grainSize)
+{
+    if (end <= begin)
+        return;
+
+    const size_t count = end - begin;
+    const size_t threadCount = gData.initialized ? gData.workers.size() + 1 : 1;
+
+    // Default to a few chunks per thread to balance load without excessive scheduling overhead.
+    if (grainSize == 0)
+        grainSize = std::max<size_t>(1, (count + threadCount * 4 - 1) / (threadCount * 4));
+    const size_t chunkCount = (count + grainSize - 1) / grainSize;
+
+    if (threadCount == 1 || chunkCount == 1)
     {
-        if (t.joinable())
-            t.join();
+        func(begin, end);
+        return;
+    }
+
+    // Chunks are claimed through an atomic counter by the calling thread and by helper tasks.
+    // Helper tasks that start after all chunks are claimed return immediately, so we only need to
+    // wait for the claimed chunks to complete, not for the helper tasks themselves.
+    struct Shared
+    {
+        const std::function<void(size_t, size_t)>* pFunc;
+        size_t begin;
+        size_t end;
+        size_t grainSize;
+        size_t chunkCount;
+        std::atomic<size_t> nextChunk{0};
+        std::atomic<size_t> completedChunks{0};
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::exception_ptr exception;
+
+        void run()
+        {
+            while (true)
+            {
+                size_t chunk = nextChunk.fetch_add(1);
+                if (chunk >= chunkCount)
+                    return;
+                size_t chunkBegin = begin + chunk * grainSize;
+                size_t chunkEnd = std::min(chunkBegin + grainSize, end);
+                try
+                {
+                    (*pFunc)(chunkBegin, chunkEnd);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!exception)
+                        exception = std::current_exception();
+                }
+                if (completedChunks.fetch_add(1) + 1 == chunkCount)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    condition.notify_all();
+                }
+            }
+        }
+    };
+
+    auto pShared = std::make_shared<Shared>();
+    pShared->pFunc = &func;
+    pShared->begin = begin;
+    pShared->end = end;
+    pShared->grainSize = grainSize;
+    pShared->chunkCount = chunkCount;
+
+    const size_t helperCount = std::min(chunkCount, threadCount) - 1;
+    for (size_t i = 0; i < helperCount; ++i)
+    {
+        auto pState = std::make_shared<Task::State>();
+        pState->func = [pShared]() { pShared->run(); };
+        dispatchTaskState(std::move(pState));
+    }
+
+    pShared->run();
+
+    {
+        std::unique_lock<std::mutex> lock(pShared->mutex);
+        pShared->condition.wait(lock, [&]() { return pShared->completedChunks.load() == chunkCount; });
     }
-}
 
-Threading::Task::Task() {}
+    if (pShared->exception)
+        std::rethrow_exception(pShared->exception);
+}
 
-bool Threading::Task::isRunning()
+bool Threading::Task::isRunning() const
 {
-    FALCOR_UNIMPLEMENTED();
+    return mpState && !mpState->done;
 }
 
 void Threading::Task::finish()
 {
-    FALCOR_UNIMPLEMENTED();
+    if (!mpState)
+        return;
+
+    waitForTask(mpState);
+
+    if (mpState->exception)
+        std::rethrow_exception(mpState->exception);
+}
+
+Threading::Task Threading::Task::then(std::function<void(void)> func)
+{
+    FALCOR_ASSERT(mpState);
+
+    auto pContinuation = std::make_shared<State>();
+    pContinuation->func = std::move(func);
+    {
+        std::lock_guard<std::mutex> lock(mpState->mutex);
+        if (!mpState->done)
+        {
+            mpState->continuations.push_back(pContinuation);
+            return Task(pContinuation);
+        }
+    }
+
+    dispatchTaskState(pContinuation);
+    return Task(pContinuation);
 }
 } // namespace Falcor
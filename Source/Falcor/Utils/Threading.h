@@ -27,41 +27,76 @@
  **************************************************************************/
 #pragma once
 #include "Core/Macros.h"
+#include <algorithm>
 #include <condition_variable>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 #include <cstdint>
 
 namespace Falcor
 {
+/**
+ * Global work-stealing thread pool.
+ *
+ * Each worker thread owns a task deque. Workers pop tasks from the back of their own deque (LIFO)
+ * and steal from the front of other workers' deques (FIFO) when they run out of work.
+ * Tasks dispatched from a worker thread are pushed onto that worker's deque, tasks dispatched
+ * from other threads are distributed round-robin.
+ *
+ * Waiting on a task from within a worker thread executes other pending tasks while waiting,
+ * so nested parallelism (e.g. a parallelFor inside a task) does not deadlock.
+ */
 class FALCOR_API Threading
 {
 public:
-    const static uint32_t kDefaultThreadCount = 16;
+    /// Default thread count. Zero means one thread per logical core.
+    const static uint32_t kDefaultThreadCount = 0;
 
     /**
-     * Handle to a dispatched task
-     *
-     * TODO: Implementation
+     * Handle to a dispatched task.
+     * Handles are cheap to copy and can outlive the task they refer to.
      */
-    class Task
+    class FALCOR_API Task
     {
     public:
-        ///  Check if task is still executing
-        bool isRunning();
+        /// Create an invalid (empty) task handle.
+        Task() = default;
+
+        /// Check if the handle refers to a task.
+        bool isValid() const { return mpState != nullptr; }
+
+        /// Check if task is still executing (or is waiting to be executed).
+        bool isRunning() const;
 
-        /// Wait for task to finish executing
+        /**
+         * Wait for task to finish executing.
+         * If the task threw an exception, it is rethrown here.
+         */
         void finish();
 
+        /**
+         * Schedule a continuation to run after this task has finished.
+         * If the task has already finished, the continuation is dispatched immediately.
+         * @param[in] func Continuation function.
+         * @return Handle to the continuation task.
+         */
+        Task then(std::function<void(void)> func);
+
+        /// Opaque shared task state.
+        struct State;
+
     private:
-        Task();
+        Task(std::shared_ptr<State> pState) : mpState(std::move(pState)) {}
+        std::shared_ptr<State> mpState;
         friend class Threading;
     };
 
     /**
      * Initializes the global thread pool
-     * @param[in] threadCount Number of threads in the pool
+     * @param[in] threadCount Number of threads in the pool. Zero uses the number of logical cores.
      */
     static void start(uint32_t threadCount = kDefaultThreadCount);
 
@@ -75,6 +110,16 @@ public:
      */
     static void shutdown();
 
+    /**
+     * Returns true if the global thread pool is running.
+     */
+    static bool isRunning();
+
+    /**
+     * Returns the number of worker threads in the pool (0 if not started).
+     */
+    static uint32_t getThreadCount();
+
     /**
      * Returns the maximum number of concurrent threads supported by the hardware
      */
@@ -84,7 +129,92 @@ public:
      * Starts a task on an available thread.
      * @return Handle to the task
      */
-    static Task dispatchTask(const std::function<void(void)>& func);
+    static Task dispatchTask(std::function<void(void)> func);
+
+    /**
+     * Execute a function over a range in parallel.
+     * The range is split into chunks of at most grainSize elements, each invoked as func(chunkBegin, chunkEnd).
+     * The calling thread participates in the work. The call returns when all chunks are done.
+     * If the thread pool is not running or the range fits into a single chunk, the function is executed serially.
+     * Exceptions thrown by func are rethrown on the calling thread (first one wins).
+     * @param[in] begin Start of range.
+     * @param[in] end End of range (exclusive).
+     * @param[in] func Function to call for each chunk.
+     * @param[in] grainSize Maximum number of elements per chunk. Zero picks a size based on the thread count.
+     */
+    static void parallelForRange(size_t begin, size_t end, const std::function<void(size_t, size_t)>& func, size_t grainSize = 0);
+
+    /**
+     * Execute a function for each index in a range in parallel.
+     * @param[in] begin Start of range.
+     * @param[in] end End of range (exclusive).
+     * @param[in] func Function called as func(index).
+     * @param[in] grainSize Maximum number of elements per chunk. Zero picks a size based on the thread count.
+     */
+    template<typename Func>
+    static void parallelFor(size_t begin, size_t end, Func&& func, size_t grainSize = 0)
+    {
+        parallelForRange(
+            begin, end,
+            [&func](size_t chunkBegin, size_t chunkEnd)
+            {
+                for (size_t i = chunkBegin; i < chunkEnd; ++i)
+                    func(i);
+            },
+            grainSize
+        );
+    }
+
+    /**
+     * Parallel reduction over a range.
+     * The range is split into chunks whose boundaries only depend on the range and grain size.
+     * Each chunk is reduced with map(chunkBegin, chunkEnd, identity), and the per-chunk results are combined
+     * in order with reduce(a, b) on the calling thread. The result is therefore deterministic as long as the
+     * grain size is fixed, even for non-associative operations such as floating-point sums.
+     * @param[in] begin Start of range.
+     * @param[in] end End of range (exclusive).
+     * @param[in] identity Identity value of the reduction.
+     * @param[in] map Function called as T map(size_t chunkBegin, size_t chunkEnd, T init).
+     * @param[in] reduce Function called as T reduce(T a, T b).
+     * @param[in] grainSize Maximum number of elements per chunk. Zero picks a size based on the range only.
+     * @return The reduced value.
+     */
+    template<typename T, typename MapFunc, typename ReduceFunc>
+    static T parallelReduce(size_t begin, size_t end, T identity, MapFunc&& map, ReduceFunc&& reduce, size_t grainSize = 0)
+    {
+        if (end <= begin)
+            return identity;
+        const size_t count = end - begin;
+        // Use a fixed chunk count for the default grain size so results do not depend on the thread count.
+        if (grainSize == 0)
+            grainSize = std::max<size_t>(1, (count + kReduceChunkCount - 1) / kReduceChunkCount);
+        const size_t chunkCount = (count + grainSize - 1) / grainSize;
+
+        // Wrap partials to avoid the std::vector<bool> specialization, which is not safe for concurrent writes.
+        struct Partial
+        {
+            T value;
+        };
+        std::vector<Partial> partials(chunkCount, Partial{identity});
+        parallelFor(
+            0, chunkCount,
+            [&](size_t chunk)
+            {
+                size_t chunkBegin = begin + chunk * grainSize;
+                size_t chunkEnd = std::min(chunkBegin + grainSize, end);
+                partials[chunk].value = map(chunkBegin, chunkEnd, identity);
+            },
+            1
+        );
+
+        T result = identity;
+        for (auto& partial : partials)
+            result = reduce(result, partial.value);
+        return result;
+    }
+
+private:
+    static constexpr size_t kReduceChunkCount = 256;
 };
 
 /**
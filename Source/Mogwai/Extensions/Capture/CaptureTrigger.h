@@ -50,6 +50,7 @@ namespace Mogwai
         virtual void beginRange(RenderGraph* pGraph, const Range& r) {};
         virtual void triggerFrame(RenderContext* pCtx, RenderGraph* pGraph, uint64_t frameID) {};
         virtual void endRange(RenderGraph* pGraph, const Range& r) {};
+        virtual void update(RenderContext* pCtx) {}; // Called at the end of every frame, also outside of capture ranges.
 
         void addRange(const RenderGraph* pGraph, uint64_t startFrame, uint64_t count);
         void reset(const RenderGraph* pGraph = nullptr);
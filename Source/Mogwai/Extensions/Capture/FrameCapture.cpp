@@ -28,7 +28,9 @@
 #include "Falcor.h"
 #include "FrameCapture.h"
 #include "Utils/Scripting/ScriptWriter.h"
+#include "Utils/Math/Float16.h"
 #include <filesystem>
+#include <cstring>
 
 namespace Mogwai
 {
@@ -41,6 +43,10 @@ namespace Mogwai
         const std::string kUI = "ui";
         const std::string kOutputs = "outputs";
         const std::string kCapture = "capture";
+        const std::string kFlush = "flush";
+
+        const uint64_t kMaxFrameLatency = 3;    ///< Number of frames after which a readback is waited for.
+        const size_t kMaxStagingBuffers = 16;   ///< Maximum number of staging buffers kept for reuse.
 
         template<typename T>
         std::vector<typename T::value_type::first_type> getFirstOfPair(const T& pair)
@@ -50,6 +56,52 @@ namespace Mogwai
             for (auto p : pair) v.push_back(p.first);
             return v;
         }
+
+        int getChannelIndex(TextureChannelFlags mask)
+        {
+            switch (mask)
+            {
+            case TextureChannelFlags::Red: return 0;
+            case TextureChannelFlags::Green: return 1;
+            case TextureChannelFlags::Blue: return 2;
+            case TextureChannelFlags::Alpha: return 3;
+            default: return -1;
+            }
+        }
+
+        /** Expand one or two channel floating-point image data to RGBA32Float, matching a blit to an RGBA32Float texture.
+        */
+        std::vector<float> expandToRGBA32Float(const void* pData, ResourceFormat format, uint32_t width, uint32_t height)
+        {
+            const uint32_t channels = getFormatChannelCount(format);
+            const bool isHalf = getNumChannelBits(format, 0) == 16;
+            const size_t pixelCount = (size_t)width * height;
+
+            std::vector<float> result(pixelCount * 4);
+            for (size_t i = 0; i < pixelCount; i++)
+            {
+                float4 value(0.f, 0.f, 0.f, 1.f);
+                for (uint32_t c = 0; c < channels; c++)
+                {
+                    value[c] = isHalf ? math::float16ToFloat32(reinterpret_cast<const uint16_t*>(pData)[i * channels + c])
+                                      : reinterpret_cast<const float*>(pData)[i * channels + c];
+                }
+                std::memcpy(&result[i * 4], &value, sizeof(value));
+            }
+            return result;
+        }
+
+        void finishEncodeTask(Threading::Task& task)
+        {
+            try
+            {
+                task.finish();
+            }
+            catch (const std::exception& e)
+            {
+                logError("Failed to write captured image: {}", e.what());
+            }
+        }
     }
 
     MOGWAI_EXTENSION(FrameCapture);
@@ -65,6 +117,11 @@ namespace Mogwai
         mpImageProcessing = std::make_unique<ImageProcessing>(pRenderer->getDevice());
     }
 
+    FrameCapture::~FrameCapture()
+    {
+        flush();
+    }
+
     void FrameCapture::renderUI(Gui* pGui)
     {
         if (mShowUI)
@@ -95,6 +152,7 @@ namespace Mogwai
         auto printGraph = [](FrameCapture* pFC, RenderGraph* pGraph) { pybind11::print(pFC->graphFramesStr(pGraph)); };
         frameCapture.def(kPrintFrames.c_str(), printGraph, "graph"_a);
         frameCapture.def(kCapture.c_str(), &FrameCapture::capture);
+        frameCapture.def(kFlush.c_str(), &FrameCapture::flush);
         auto printAllGraphs = [](FrameCapture* pFC)
         {
             std::string s;
@@ -167,6 +225,7 @@ namespace Mogwai
         const ResourceFormat format = pOutput->getFormat();
         const uint32_t channels = getFormatChannelCount(format);
 
+        std::vector<OutputImage> images;
         for (auto mask : pGraph->getOutputMasks(outputIndex))
         {
             // Determine output color channels and filename suffix.
@@ -186,8 +245,12 @@ namespace Mogwai
                 continue;
             }
 
-            // Copy relevant channels into new texture if necessary.
-            ref<Texture> pTex = pOutput;
+            // Determine the image to write and whether a channel needs to be extracted.
+            OutputImage image;
+            image.exportFlags = Bitmap::ExportFlags::None;
+            if (mask == TextureChannelFlags::RGBA) image.exportFlags |= Bitmap::ExportFlags::ExportAlpha;
+            image.format = format;
+
             if (outputChannels == 1 && channels > 1)
             {
                 // Determine output format.
@@ -236,20 +299,122 @@ namespace Mogwai
                     logWarning("Graph output {} mask {:#x} extracting single RGB channel from SRGB format may lose precision.", outputName, (uint32_t)mask);
                 }
 
-                // Copy color channel into temporary texture.
-                pTex = Texture::create2D(mpRenderer->getDevice(), pOutput->getWidth(), pOutput->getHeight(), outputFormat, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
+                image.channel = getChannelIndex(mask);
+                image.format = outputFormat;
+            }
+
+            auto ext = Bitmap::getFileExtFromResourceFormat(image.format);
+            image.fileFormat = Bitmap::getFormatFromFileExtension(ext);
+            image.path = basename + suffix + "." + ext;
+
+            // Captured EXR files use ZIP compression, which is encoded on multiple threads.
+            if (image.fileFormat == Bitmap::FileFormat::ExrFile) image.exportFlags |= Bitmap::ExportFlags::ExrZip;
+
+            // Channels of formats that can't be split on the CPU are copied into a new texture on the GPU.
+            if (image.channel >= 0 && !ImageProcessing::canExtractColorChannel(format))
+            {
+                ref<Texture> pTex = Texture::create2D(mpRenderer->getDevice(), pOutput->getWidth(), pOutput->getHeight(), image.format, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess);
                 mpImageProcessing->copyColorChannel(pRenderContext, pOutput->getSRV(0, 1, 0, 1), pTex->getUAV(), mask);
+                image.channel = -1;
+                readback(pRenderContext, pTex, { image });
+                continue;
             }
 
-            // Write output image.
-            auto ext = Bitmap::getFileExtFromResourceFormat(pTex->getFormat());
-            auto fileformat = Bitmap::getFormatFromFileExtension(ext);
-            std::string filename = basename + suffix + "." + ext;
-            Bitmap::ExportFlags flags = Bitmap::ExportFlags::None;
-            if (mask == TextureChannelFlags::RGBA) flags |= Bitmap::ExportFlags::ExportAlpha;
+            images.push_back(std::move(image));
+        }
 
-            pTex->captureToFile(0, 0, filename, fileformat, flags);
+        // Read back the output once for all images extracted from it.
+        if (!images.empty()) readback(pRenderContext, pOutput, std::move(images));
+    }
+
+    void FrameCapture::readback(RenderContext* pRenderContext, const ref<Texture>& pTexture, std::vector<OutputImage> images)
+    {
+        PendingReadback readback;
+        readback.frameID = mpRenderer->getGlobalClock().getFrame();
+        readback.width = pTexture->getWidth();
+        readback.height = pTexture->getHeight();
+        readback.format = pTexture->getFormat();
+        readback.images = std::move(images);
+
+        ref<Buffer> pStagingBuffer;
+        if (!mStagingBuffers.empty())
+        {
+            pStagingBuffer = std::move(mStagingBuffers.back());
+            mStagingBuffers.pop_back();
+        }
+        readback.pTask = pRenderContext->asyncReadTextureSubresource(pTexture.get(), 0, std::move(pStagingBuffer));
+
+        mPendingReadbacks.push_back(std::move(readback));
+    }
+
+    void FrameCapture::retireReadbacks(bool wait)
+    {
+        const uint64_t frameID = mpRenderer->getGlobalClock().getFrame();
+
+        while (!mPendingReadbacks.empty())
+        {
+            // Retire readbacks that are done. Block on readbacks that have been in flight for too many frames.
+            auto& readback = mPendingReadbacks.front();
+            bool expired = frameID >= readback.frameID + kMaxFrameLatency;
+            if (!wait && !expired && !readback.pTask->isReady()) break;
+
+            std::vector<uint8_t> data = readback.pTask->getData();
+            if (mStagingBuffers.size() < kMaxStagingBuffers) mStagingBuffers.push_back(readback.pTask->getStagingBuffer());
+            readback.pTask = nullptr;
+
+            encode(std::move(readback), std::move(data));
+            mPendingReadbacks.pop_front();
+        }
+    }
+
+    void FrameCapture::encode(PendingReadback readback, std::vector<uint8_t> data)
+    {
+        // Bound the number of encode tasks in flight. This also bounds the memory held by captured images.
+        const size_t maxEncodeTasks = std::max<size_t>(2, Threading::getThreadCount());
+        while (!mEncodeTasks.empty() && (mEncodeTasks.size() >= maxEncodeTasks || !mEncodeTasks.front().isRunning()))
+        {
+            finishEncodeTask(mEncodeTasks.front());
+            mEncodeTasks.pop_front();
         }
+
+        auto pData = std::make_shared<std::vector<uint8_t>>(std::move(data));
+        for (auto& image : readback.images)
+        {
+            mEncodeTasks.push_back(Threading::dispatchTask([=, width = readback.width, height = readback.height, format = readback.format]()
+            {
+                std::vector<uint8_t> extracted;
+                const void* pImageData = pData->data();
+                if (image.channel >= 0)
+                {
+                    extracted = ImageProcessing::extractColorChannel(pImageData, format, image.channel, width, height);
+                    pImageData = extracted.data();
+                }
+
+                // Bitmap can't export floating-point images with less than 3 channels, expand them to RGBA32Float.
+                ResourceFormat imageFormat = image.format;
+                std::vector<float> expanded;
+                if (getFormatType(imageFormat) == FormatType::Float && getFormatChannelCount(imageFormat) < 3)
+                {
+                    expanded = expandToRGBA32Float(pImageData, imageFormat, width, height);
+                    pImageData = expanded.data();
+                    imageFormat = ResourceFormat::RGBA32Float;
+                }
+
+                Bitmap::saveImage(image.path, width, height, image.fileFormat, image.exportFlags, imageFormat, true, const_cast<void*>(pImageData));
+            }));
+        }
+    }
+
+    void FrameCapture::update(RenderContext* pRenderContext)
+    {
+        retireReadbacks(false);
+    }
+
+    void FrameCapture::flush()
+    {
+        retireReadbacks(true);
+        for (auto& task : mEncodeTasks) finishEncodeTask(task);
+        mEncodeTasks.clear();
     }
 
     void FrameCapture::addFrames(const RenderGraph* pGraph, const uint64_vec& frames)
@@ -29,12 +29,22 @@
 #include "../../Mogwai.h"
 #include "CaptureTrigger.h"
 #include "Utils/Image/ImageProcessing.h"
+#include "Utils/Threading.h"
+#include <deque>
 
 namespace Mogwai
 {
+    /** Captures render graph outputs to image files.
+
+        Outputs are read back asynchronously: each captured output is copied into a staging buffer
+        and retired once its fence has signaled, at most a few frames later. Channel extraction
+        and image encoding run on the thread pool, with at most a bounded number of encode tasks in flight.
+    */
     class FrameCapture : public CaptureTrigger
     {
     public:
+        ~FrameCapture();
+
         static UniquePtr create(Renderer* pRenderer);
         virtual void renderUI(Gui* pGui) override;
         virtual void registerScriptBindings(pybind11::module& m) override;
@@ -43,6 +53,15 @@ namespace Mogwai
         virtual void triggerFrame(RenderContext* pRenderContext, RenderGraph* pGraph, uint64_t frameID) override;
         void capture();
 
+        /** Waits for all pending readbacks and writes the captured images to disk.
+        */
+        void flush();
+
+        virtual void shutdown() override { flush(); }
+
+    protected:
+        virtual void update(RenderContext* pRenderContext) override;
+
     private:
         FrameCapture(Renderer* pRenderer);
 
@@ -52,7 +71,38 @@ namespace Mogwai
         std::string graphFramesStr(const RenderGraph* pGraph);
         void captureOutput(RenderContext* pRenderContext, RenderGraph* pGraph, const uint32_t outputIndex);
 
+        /** Image file to write from a captured output.
+        */
+        struct OutputImage
+        {
+            std::filesystem::path path;
+            Bitmap::FileFormat fileFormat;
+            Bitmap::ExportFlags exportFlags;
+            int channel = -1;                                   ///< Color channel to extract on the CPU, or -1 to write all channels.
+            ResourceFormat format = ResourceFormat::Unknown;    ///< Format of the image data after channel extraction.
+        };
+
+        /** Readback of a captured output that is in flight.
+        */
+        struct PendingReadback
+        {
+            uint64_t frameID;
+            uint32_t width;
+            uint32_t height;
+            ResourceFormat format;
+            CopyContext::ReadTextureTask::SharedPtr pTask;
+            std::vector<OutputImage> images;
+        };
+
+        void readback(RenderContext* pRenderContext, const ref<Texture>& pTexture, std::vector<OutputImage> images);
+        void retireReadbacks(bool wait);
+        void encode(PendingReadback readback, std::vector<uint8_t> data);
+
         bool mCaptureAllOutputs = false;
         std::unique_ptr<ImageProcessing> mpImageProcessing;
+
+        std::deque<PendingReadback> mPendingReadbacks;          ///< Readbacks in flight, oldest first.
+        std::vector<ref<Buffer>> mStagingBuffers;               ///< Staging buffers of retired readbacks, reused by later readbacks.
+        std::deque<Threading::Task> mEncodeTasks;               ///< Encode tasks in flight, oldest first.
     };
 }
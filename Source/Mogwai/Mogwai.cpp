@@ -84,6 +84,7 @@ namespace Mogwai
 
     void Renderer::onShutdown()
     {
+        for (auto& pe : mpExtensions) pe->shutdown();
         resetEditor();
         getDevice()->flushAndSync(); // Need to do that because clearing the graphs will try to release some state objects which might be in use
         mGraphs.clear();
@@ -0,0 +1,216 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Rendering/Lights/LightBVH.h"
+#include "Rendering/Lights/LightBVHBuilder.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <cstring>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+/// Light BVH with access to the CPU-side nodes.
+class TestLightBVH : public LightBVH
+{
+public:
+    using LightBVH::LightBVH;
+    const std::vector<PackedNode>& getNodes() const { return mNodes; }
+};
+
+/**
+ * Create a scene with randomly placed and oriented small emissive triangles.
+ * The scene needs to be kept alive while its light collection is used.
+ */
+ref<Scene> createEmissiveScene(ref<Device> pDevice, uint32_t triangleCount)
+{
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> dist;
+
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<uint32_t> indices;
+    positions.reserve(3 * triangleCount);
+    normals.reserve(3 * triangleCount);
+    indices.reserve(3 * triangleCount);
+
+    for (uint32_t i = 0; i < triangleCount; ++i)
+    {
+        float3 center = float3(dist(rng), dist(rng), dist(rng)) * 100.f;
+        float3 p[3];
+        for (uint32_t j = 0; j < 3; ++j)
+            p[j] = center + float3(dist(rng), dist(rng), dist(rng)) - 0.5f;
+        float3 n = cross(p[1] - p[0], p[2] - p[0]);
+        n = length(n) > 0.f ? normalize(n) : float3(0.f, 1.f, 0.f);
+        for (uint32_t j = 0; j < 3; ++j)
+        {
+            indices.push_back((uint32_t)positions.size());
+            positions.push_back(p[j]);
+            normals.push_back(n);
+        }
+    }
+
+    ref<StandardMaterial> pMaterial = StandardMaterial::create(pDevice, "emissive");
+    pMaterial->setEmissiveColor(float3(1.f));
+
+    float2 texCrd = float2(0.f);
+    float4 tangent = float4(1.f, 0.f, 0.f, 1.f);
+    SceneBuilder::Mesh mesh;
+    mesh.name = "triangles";
+    mesh.faceCount = triangleCount;
+    mesh.vertexCount = (uint32_t)positions.size();
+    mesh.indexCount = (uint32_t)indices.size();
+    mesh.pIndices = indices.data();
+    mesh.topology = Vao::Topology::TriangleList;
+    mesh.pMaterial = pMaterial;
+    mesh.positions = {positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+    mesh.normals = {normals.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+    mesh.texCrds = {&texCrd, SceneBuilder::Mesh::AttributeFrequency::Constant};
+    mesh.tangents = {&tangent, SceneBuilder::Mesh::AttributeFrequency::Constant};
+    mesh.useOriginalTangentSpace = true;
+
+    SceneBuilder builder(pDevice, Settings());
+    MeshID meshID = builder.addMesh(mesh);
+    NodeID nodeID = builder.addNode(SceneBuilder::Node{"node"});
+    builder.addMeshInstance(nodeID, meshID);
+    return builder.getScene();
+}
+
+/// Surface area heuristic cost of the tree relative to the root node, assuming unit traversal and intersection costs.
+float computeSAHCost(const std::vector<PackedNode>& nodes)
+{
+    auto area = [](const PackedNode& node)
+    {
+        float3 e = node.getNodeAttributes().extent;
+        return e.x * e.y + e.y * e.z + e.z * e.x;
+    };
+
+    double cost = 0.0;
+    for (const auto& node : nodes)
+        cost += node.isLeaf() ? area(node) * node.getLeafNode().triangleCount : area(node);
+    return (float)(cost / area(nodes[0]));
+}
+
+/// Check that the leaves reference consecutive triangle ranges in depth-first order.
+bool validateLeafRanges(const std::vector<PackedNode>& nodes, uint32_t triangleCount)
+{
+    uint32_t nextOffset = 0;
+    for (const auto& node : nodes)
+    {
+        if (!node.isLeaf())
+            continue;
+        auto leaf = node.getLeafNode();
+        if (leaf.triangleOffset != nextOffset)
+            return false;
+        nextOffset += leaf.triangleCount;
+    }
+    return nextOffset == triangleCount;
+}
+} // namespace
+
+GPU_TEST(LightBVHBuilder_ParallelBuild)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    // Use enough triangles for the parallel subtree build and chunked binning to kick in.
+    const uint32_t triangleCount = 50000;
+    ref<Scene> pScene = createEmissiveScene(pDevice, triangleCount);
+    ref<const LightCollection> pLightCollection = pScene->getLightCollection(pRenderContext);
+    EXPECT_EQ(pLightCollection->getActiveLightCount(pRenderContext), triangleCount);
+
+    for (auto heuristic : {LightBVHBuilder::SplitHeuristic::BinnedSAH, LightBVHBuilder::SplitHeuristic::BinnedSAOH})
+    {
+        LightBVHBuilder::Options options;
+        options.splitHeuristicSelection = heuristic;
+
+        options.useParallelBuild = false;
+        TestLightBVH serialBVH(pDevice, pLightCollection);
+        LightBVHBuilder(options).build(pRenderContext, serialBVH);
+
+        options.useParallelBuild = true;
+        TestLightBVH parallelBVH(pDevice, pLightCollection);
+        LightBVHBuilder(options).build(pRenderContext, parallelBVH);
+
+        // The parallel build produces the exact same tree as the serial build.
+        const auto& serialNodes = serialBVH.getNodes();
+        const auto& parallelNodes = parallelBVH.getNodes();
+        EXPECT(serialBVH.isValid() && parallelBVH.isValid());
+        EXPECT_EQ(serialNodes.size(), parallelNodes.size());
+        if (serialNodes.size() == parallelNodes.size())
+        {
+            EXPECT(std::memcmp(serialNodes.data(), parallelNodes.data(), serialNodes.size() * sizeof(PackedNode)) == 0);
+        }
+        EXPECT(validateLeafRanges(parallelNodes, triangleCount));
+        EXPECT_EQ(parallelBVH.getStats().triangleCount, triangleCount);
+    }
+}
+
+GPU_TEST(LightBVHBuilder_ParallelBuildBenchmark, TAGS("benchmark"))
+{
+    ref<Device> pDevice = ctx.getDevice();
+    RenderContext* pRenderContext = ctx.getRenderContext();
+
+    const uint32_t triangleCount = 1000000;
+    ref<Scene> pScene = createEmissiveScene(pDevice, triangleCount);
+    ref<const LightCollection> pLightCollection = pScene->getLightCollection(pRenderContext);
+    pLightCollection->getMeshLightTriangles(pRenderContext); // Read back the triangle data before timing.
+
+    for (auto heuristic : {LightBVHBuilder::SplitHeuristic::BinnedSAH, LightBVHBuilder::SplitHeuristic::BinnedSAOH})
+    {
+        for (bool parallel : {false, true})
+        {
+            LightBVHBuilder::Options options;
+            options.splitHeuristicSelection = heuristic;
+            options.useParallelBuild = parallel;
+
+            TestLightBVH bvh(pDevice, pLightCollection);
+            auto startTime = CpuTimer::getCurrentTimePoint();
+            LightBVHBuilder(options).build(pRenderContext, bvh);
+            double ms = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+            const auto& stats = bvh.getStats();
+            logInfo(
+                "LightBVHBuilder ({}, {}): {} triangles in {:.1f} ms, {} nodes, height {}, SAH cost {:.2f}",
+                enumToString(heuristic),
+                parallel ? "parallel" : "serial",
+                triangleCount,
+                ms,
+                stats.internalNodeCount + stats.leafNodeCount,
+                stats.treeHeight,
+                computeSAHCost(bvh.getNodes())
+            );
+            EXPECT(bvh.isValid());
+        }
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,138 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+#include <cmath>
+
+namespace Falcor
+{
+namespace
+{
+bool isNear(const float4x4& a, const float4x4& b, float eps = 1e-5f)
+{
+    for (int r = 0; r < 4; r++)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            if (std::abs(a[r][c] - b[r][c]) > eps)
+                return false;
+        }
+    }
+    return true;
+}
+
+ref<Animation> createTranslationAnimation(const std::string& name, NodeID nodeID)
+{
+    ref<Animation> pAnimation = Animation::create(name, nodeID, 1.0);
+    pAnimation->addKeyframe({0.0, float3(0.f)});
+    pAnimation->addKeyframe({1.0, float3(1.f, 0.f, 0.f)});
+    return pAnimation;
+}
+} // namespace
+
+GPU_TEST(AnimationController_IncrementalUpdate)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    const float3 positions[] = {float3(0.f), float3(1.f, 0.f, 0.f), float3(0.f, 1.f, 0.f)};
+    const uint32_t indices[] = {0, 1, 2};
+    float3 normal = float3(0.f, 0.f, 1.f);
+    float2 texCrd = float2(0.f);
+    float4 tangent = float4(1.f, 0.f, 0.f, 1.f);
+
+    SceneBuilder::Mesh mesh;
+    mesh.name = "triangle";
+    mesh.faceCount = 1;
+    mesh.vertexCount = 3;
+    mesh.indexCount = 3;
+    mesh.pIndices = indices;
+    mesh.topology = Vao::Topology::TriangleList;
+    mesh.pMaterial = StandardMaterial::create(pDevice, "material");
+    mesh.positions = {positions, SceneBuilder::Mesh::AttributeFrequency::Vertex};
+    mesh.normals = {&normal, SceneBuilder::Mesh::AttributeFrequency::Constant};
+    mesh.texCrds = {&texCrd, SceneBuilder::Mesh::AttributeFrequency::Constant};
+    mesh.tangents = {&tangent, SceneBuilder::Mesh::AttributeFrequency::Constant};
+    mesh.useOriginalTangentSpace = true;
+
+    // Scene graph:
+    // 0 animated root
+    // +- 1 scaled static node with mesh instance
+    //    +- 2 static node with mesh instance
+    // 3 static root with mesh instance
+    // 4 animated root without any references
+    SceneBuilder builder(pDevice, Settings(), SceneBuilder::Flags::DontOptimizeGraph);
+    MeshID meshID = builder.addMesh(mesh);
+    NodeID root = builder.addNode(SceneBuilder::Node{"root"});
+    NodeID child = builder.addNode(SceneBuilder::Node{"child", math::matrixFromScaling(float3(2.f)), float4x4::identity(), float4x4::identity(), root});
+    NodeID grandchild = builder.addNode(SceneBuilder::Node{"grandchild", math::matrixFromTranslation(float3(0.f, 1.f, 0.f)), float4x4::identity(), float4x4::identity(), child});
+    NodeID staticRoot = builder.addNode(SceneBuilder::Node{"static"});
+    NodeID unreferenced = builder.addNode(SceneBuilder::Node{"unreferenced"});
+    builder.addMeshInstance(child, meshID);
+    builder.addMeshInstance(grandchild, meshID);
+    builder.addMeshInstance(staticRoot, meshID);
+    builder.addAnimation(createTranslationAnimation("root", root));
+    builder.addAnimation(createTranslationAnimation("unreferenced", unreferenced));
+
+    ref<Scene> pScene = builder.getScene();
+    const AnimationController* pController = pScene->getAnimationController();
+    pScene->update(ctx.getRenderContext(), 0.0);
+    pScene->update(ctx.getRenderContext(), 0.5);
+
+    const auto& localMatrices = pController->getLocalMatrices();
+    const auto& globalMatrices = pController->getGlobalMatrices();
+    const auto& invTransposeMatrices = pController->getInvTransposeGlobalMatrices();
+
+    // Animated subtree is updated, static nodes are not flagged as changed.
+    EXPECT(isNear(globalMatrices[root.get()], math::matrixFromTranslation(float3(0.5f, 0.f, 0.f))));
+    EXPECT(isNear(globalMatrices[child.get()], mul(globalMatrices[root.get()], localMatrices[child.get()])));
+    EXPECT(isNear(globalMatrices[grandchild.get()], mul(globalMatrices[child.get()], localMatrices[grandchild.get()])));
+    EXPECT(pController->isMatrixChanged(root));
+    EXPECT(pController->isMatrixChanged(child));
+    EXPECT(pController->isMatrixChanged(grandchild));
+    EXPECT(!pController->isMatrixChanged(staticRoot));
+
+    // Animations of unreferenced nodes are not evaluated.
+    EXPECT(isNear(globalMatrices[unreferenced.get()], float4x4::identity()));
+    EXPECT(!pController->isMatrixChanged(unreferenced));
+
+    // Inverse transpose matrices match the global matrices.
+    for (size_t i = 0; i < globalMatrices.size(); i++)
+        EXPECT(isNear(mul(transpose(invTransposeMatrices[i]), globalMatrices[i]), float4x4::identity()));
+
+    // Editing a node only updates its subtree.
+    pScene->updateNodeTransform(child.get(), math::matrixFromScaling(float3(3.f)));
+    pScene->update(ctx.getRenderContext(), 0.5);
+    EXPECT(!pController->isMatrixChanged(root));
+    EXPECT(pController->isMatrixChanged(child));
+    EXPECT(pController->isMatrixChanged(grandchild));
+    EXPECT(!pController->isMatrixChanged(staticRoot));
+    EXPECT(isNear(globalMatrices[grandchild.get()], mul(globalMatrices[child.get()], localMatrices[grandchild.get()])));
+    EXPECT(isNear(mul(transpose(invTransposeMatrices[grandchild.get()]), globalMatrices[grandchild.get()]), float4x4::identity()));
+}
+} // namespace Falcor
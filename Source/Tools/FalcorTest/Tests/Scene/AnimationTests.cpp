@@ -0,0 +1,138 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Animation/Animation.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <algorithm>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+std::vector<Animation::Keyframe> createKeyframes(uint32_t count, double duration, std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    std::vector<Animation::Keyframe> keyframes(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        auto& keyframe = keyframes[i];
+        keyframe.time = duration * i / (count - 1);
+        keyframe.translation = float3(dist(rng), dist(rng), dist(rng));
+        keyframe.scaling = float3(1.f + 0.5f * dist(rng));
+        keyframe.rotation = normalize(quatf(dist(rng), dist(rng), dist(rng), 1.f));
+    }
+    return keyframes;
+}
+} // namespace
+
+CPU_TEST(Animation_AddKeyframes)
+{
+    std::mt19937 rng;
+    auto keyframes = createKeyframes(100, 10.0, rng);
+
+    // Shuffled keyframes with duplicate times, the later keyframe overrides the earlier one.
+    auto shuffled = keyframes;
+    std::shuffle(shuffled.begin(), shuffled.end(), rng);
+    shuffled.insert(shuffled.end(), keyframes.begin(), keyframes.begin() + 10);
+    shuffled.back().translation = float3(42.f);
+
+    ref<Animation> pSequential = Animation::create("sequential", NodeID{0}, 10.0);
+    for (const auto& keyframe : shuffled)
+        pSequential->addKeyframe(keyframe);
+
+    ref<Animation> pBulk = Animation::create("bulk", NodeID{0}, 10.0);
+    pBulk->addKeyframes(fstd::span<const Animation::Keyframe>(shuffled.data(), 50));
+    pBulk->addKeyframes(fstd::span<const Animation::Keyframe>(shuffled.data() + 50, shuffled.size() - 50));
+
+    for (const auto& keyframe : keyframes)
+    {
+        EXPECT(pBulk->doesKeyframeExists(keyframe.time));
+        EXPECT(all(pBulk->getKeyframe(keyframe.time).translation == pSequential->getKeyframe(keyframe.time).translation));
+    }
+    EXPECT(all(pBulk->getKeyframe(keyframes[9].time).translation == float3(42.f)));
+    EXPECT(!pBulk->doesKeyframeExists(0.05));
+
+    for (double time = 0.0; time < 10.0; time += 0.37)
+        EXPECT(pBulk->animate(time) == pSequential->animate(time));
+}
+
+CPU_TEST(Animation_Seek)
+{
+    std::mt19937 rng;
+    auto keyframes = createKeyframes(1000, 10.0, rng);
+
+    for (auto mode : {Animation::InterpolationMode::Linear, Animation::InterpolationMode::Hermite})
+    {
+        ref<Animation> pAnimation = Animation::create("animation", NodeID{0}, 10.0);
+        pAnimation->setInterpolationMode(mode);
+        pAnimation->setPreInfinityBehavior(Animation::Behavior::Linear);
+        pAnimation->setPostInfinityBehavior(Animation::Behavior::Cycle);
+        pAnimation->addKeyframes(keyframes);
+
+        // Results must not depend on the previously evaluated time.
+        const double times[] = {0.0, 0.001, 5.0, 2.5, 9.99, 0.5, -1.0, 12.5, 7.25, 7.26, 3.0};
+        for (double time : times)
+        {
+            ref<Animation> pReference = Animation::create("reference", NodeID{0}, 10.0);
+            pReference->setInterpolationMode(mode);
+            pReference->setPreInfinityBehavior(Animation::Behavior::Linear);
+            pReference->setPostInfinityBehavior(Animation::Behavior::Cycle);
+            pReference->addKeyframes(keyframes);
+            EXPECT(pAnimation->animate(time) == pReference->animate(time)) << "time = " << time;
+        }
+    }
+}
+
+CPU_TEST(Animation_AnimateAllBenchmark, TAGS("benchmark"))
+{
+    const uint32_t animationCount = 100000;
+    const uint32_t keyframeCount = 64;
+    const uint32_t frameCount = 16;
+
+    std::mt19937 rng;
+    std::vector<ref<Animation>> animations;
+    animations.reserve(animationCount);
+    for (uint32_t i = 0; i < animationCount; i++)
+    {
+        ref<Animation> pAnimation = Animation::create("animation", NodeID{i}, 10.0);
+        pAnimation->addKeyframes(createKeyframes(keyframeCount, 10.0, rng));
+        animations.push_back(pAnimation);
+    }
+
+    std::vector<float4x4> transforms(animationCount);
+    auto startTime = CpuTimer::getCurrentTimePoint();
+    for (uint32_t frame = 0; frame < frameCount; frame++)
+        Animation::animateAll(animations, frame / 60.0, transforms);
+    double ms = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+
+    logInfo("animateAll: {} animations x {} frames in {:.1f} ms ({:.0f} animated nodes/ms)", animationCount, frameCount, ms, animationCount * frameCount / ms);
+    EXPECT(transforms.back() == animations.back()->animate((frameCount - 1) / 60.0));
+}
+} // namespace Falcor
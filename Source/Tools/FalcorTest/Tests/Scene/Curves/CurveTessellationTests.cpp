@@ -0,0 +1,372 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Curves/CurveTessellation.h"
+#include "Utils/Math/CubicSpline.h"
+#include <cmath>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+struct Curves
+{
+    std::vector<uint32_t> vertexCountsPerStrand;
+    std::vector<float3> controlPoints;
+    std::vector<float> widths;
+    std::vector<float2> UVs;
+
+    uint32_t getStrandCount() const { return (uint32_t)vertexCountsPerStrand.size(); }
+};
+
+/**
+ * Create random strands growing in +y direction.
+ * Strands have 2 to 9 control points. Some control points are duplicated and some strands collapse to a single point.
+ */
+Curves createCurves(uint32_t strandCount)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> u(-1.f, 1.f);
+
+    Curves curves;
+    for (uint32_t i = 0; i < strandCount; i++)
+    {
+        uint32_t vertexCount = 2 + i % 8;
+        curves.vertexCountsPerStrand.push_back(vertexCount);
+
+        float3 p(u(rng), u(rng), u(rng));
+        for (uint32_t j = 0; j < vertexCount; j++)
+        {
+            bool duplicate = j > 0 && (i % 7 == 3 || (i % 5 == 1 && j % 3 == 1));
+            if (!duplicate)
+                p += float3(0.2f * u(rng), 1.f, 0.2f * u(rng));
+            curves.controlPoints.push_back(p);
+            curves.widths.push_back(0.1f + 0.05f * u(rng));
+            curves.UVs.push_back(float2(u(rng), u(rng)));
+        }
+    }
+    return curves;
+}
+
+/**
+ * Straightforward serial swept sphere tessellation used as reference.
+ * Consecutive duplicated control points are removed (keeping the last one) and strands collapsing to a single point are skipped.
+ */
+CurveTessellation::SweptSphereResult referenceSweptSphere(
+    const Curves& curves,
+    uint32_t subdivPerSegment,
+    uint32_t keepOneEveryXStrands,
+    uint32_t keepOneEveryXVerticesPerStrand,
+    float widthScale,
+    const float4x4& xform
+)
+{
+    CurveTessellation::SweptSphereResult result;
+    result.degree = 1;
+
+    const float scale = std::sqrt(xform[0][0] * xform[0][0] + xform[0][1] * xform[0][1] + xform[0][2] * xform[0][2]);
+
+    uint32_t pointOffset = 0;
+    for (uint32_t i = 0; i < curves.getStrandCount(); i++)
+    {
+        const uint32_t vertexCount = curves.vertexCountsPerStrand[i];
+        const uint32_t begin = pointOffset;
+        pointOffset += vertexCount;
+        if (i % keepOneEveryXStrands != 0)
+            continue;
+
+        std::vector<float3> points;
+        std::vector<float> widths;
+        std::vector<float2> UVs;
+        for (uint32_t j = begin; j < begin + vertexCount; j++)
+        {
+            if (j == begin + vertexCount - 1 || any(curves.controlPoints[j] != curves.controlPoints[j + 1]))
+            {
+                points.push_back(curves.controlPoints[j]);
+                widths.push_back(curves.widths[j]);
+                UVs.push_back(curves.UVs[j]);
+            }
+        }
+        if (points.size() < 2)
+            continue;
+
+        const uint32_t n = (uint32_t)points.size();
+        CubicSpline<float3> splinePoints(points.data(), n);
+        CubicSpline<float> splineWidths(widths.data(), n);
+        CubicSpline<float2> splineUVs(UVs.data(), n);
+
+        auto addPoint = [&](uint32_t j, float t)
+        {
+            result.points.push_back(transformPoint(xform, splinePoints.interpolate(j, t)));
+            result.radius.push_back(splineWidths.interpolate(j, t) * 0.5f * widthScale * scale);
+            result.texCrds.push_back(splineUVs.interpolate(j, t));
+        };
+
+        uint32_t count = 0;
+        for (uint32_t j = 0; j < n - 1; j++)
+        {
+            for (uint32_t k = 0; k < subdivPerSegment; k++)
+            {
+                if (count++ % keepOneEveryXVerticesPerStrand == 0)
+                {
+                    result.indices.push_back((uint32_t)result.points.size());
+                    addPoint(j, (float)k / (float)subdivPerSegment);
+                }
+            }
+        }
+        addPoint(n - 2, 1.f);
+    }
+    return result;
+}
+} // namespace
+
+CPU_TEST(CurveTessellation_SweptSphere)
+{
+    const Curves curves = createCurves(200);
+
+    float4x4 xform = float4x4::identity();
+    xform[0][0] = xform[1][1] = xform[2][2] = 2.f;
+    xform[0][3] = 1.f;
+    xform[2][3] = -3.f;
+
+    for (uint32_t subdivPerSegment : {1u, 3u})
+    {
+        for (uint32_t keepOneEveryXStrands : {1u, 3u})
+        {
+            for (uint32_t keepOneEveryXVerticesPerStrand : {1u, 2u, 5u})
+            {
+                auto result = CurveTessellation::convertToLinearSweptSphere(
+                    curves.getStrandCount(),
+                    curves.vertexCountsPerStrand.data(),
+                    curves.controlPoints.data(),
+                    curves.widths.data(),
+                    curves.UVs.data(),
+                    1,
+                    subdivPerSegment,
+                    keepOneEveryXStrands,
+                    keepOneEveryXVerticesPerStrand,
+                    0.5f,
+                    xform
+                );
+                auto ref =
+                    referenceSweptSphere(curves, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, 0.5f, xform);
+
+                // The output has to be bit-identical to the serial reference.
+                EXPECT_EQ(result.degree, 1);
+                ASSERT_EQ(result.indices.size(), ref.indices.size());
+                ASSERT_EQ(result.points.size(), ref.points.size());
+                ASSERT_EQ(result.radius.size(), ref.radius.size());
+                ASSERT_EQ(result.texCrds.size(), ref.texCrds.size());
+                for (size_t i = 0; i < ref.indices.size(); i++)
+                    EXPECT_EQ(result.indices[i], ref.indices[i]) << "index " << i;
+                for (size_t i = 0; i < ref.points.size(); i++)
+                {
+                    EXPECT(all(result.points[i] == ref.points[i])) << "point " << i;
+                    EXPECT_EQ(result.radius[i], ref.radius[i]) << "point " << i;
+                    EXPECT(all(result.texCrds[i] == ref.texCrds[i])) << "point " << i;
+                }
+            }
+        }
+    }
+}
+
+CPU_TEST(CurveTessellation_DuplicatedControlPoints)
+{
+    // Strand with duplicated control points, and the same strand without them.
+    const std::vector<float3> points = {{0, 0, 0}, {0, 1, 0}, {0, 1, 0}, {0.5f, 2, 0}, {1, 3, 0}, {1, 3, 0}, {1, 3, 0}, {1, 4, 1}};
+    const std::vector<float> widths = {0.1f, 0.2f, 0.2f, 0.3f, 0.2f, 0.2f, 0.2f, 0.1f};
+    const std::vector<float3> uniquePoints = {{0, 0, 0}, {0, 1, 0}, {0.5f, 2, 0}, {1, 3, 0}, {1, 4, 1}};
+    const std::vector<float> uniqueWidths = {0.1f, 0.2f, 0.3f, 0.2f, 0.1f};
+    const uint32_t vertexCount = (uint32_t)points.size();
+    const uint32_t uniqueVertexCount = (uint32_t)uniquePoints.size();
+
+    auto sweptSphere = CurveTessellation::convertToLinearSweptSphere(
+        1, &vertexCount, points.data(), widths.data(), nullptr, 1, 4, 1, 1, 1.f, float4x4::identity()
+    );
+    auto uniqueSweptSphere = CurveTessellation::convertToLinearSweptSphere(
+        1, &uniqueVertexCount, uniquePoints.data(), uniqueWidths.data(), nullptr, 1, 4, 1, 1, 1.f, float4x4::identity()
+    );
+    EXPECT_EQ(sweptSphere.points.size(), 4 * (uniqueVertexCount - 1) + 1);
+    EXPECT(sweptSphere.indices == uniqueSweptSphere.indices);
+    EXPECT(sweptSphere.radius == uniqueSweptSphere.radius);
+    ASSERT_EQ(sweptSphere.points.size(), uniqueSweptSphere.points.size());
+    for (size_t i = 0; i < sweptSphere.points.size(); i++)
+        EXPECT(all(sweptSphere.points[i] == uniqueSweptSphere.points[i])) << "point " << i;
+
+    auto polytube = CurveTessellation::convertToPolytube(1, &vertexCount, points.data(), widths.data(), nullptr, 4, 1, 1, 1.f, 4);
+    auto uniquePolytube =
+        CurveTessellation::convertToPolytube(1, &uniqueVertexCount, uniquePoints.data(), uniqueWidths.data(), nullptr, 4, 1, 1, 1.f, 4);
+    EXPECT(polytube.faceVertexIndices == uniquePolytube.faceVertexIndices);
+    EXPECT(polytube.radii == uniquePolytube.radii);
+    ASSERT_EQ(polytube.vertices.size(), uniquePolytube.vertices.size());
+    for (size_t i = 0; i < polytube.vertices.size(); i++)
+    {
+        EXPECT(all(polytube.vertices[i] == uniquePolytube.vertices[i])) << "vertex " << i;
+        EXPECT(all(polytube.normals[i] == uniquePolytube.normals[i])) << "vertex " << i;
+    }
+
+    // Strands collapsing to a single point produce no geometry.
+    const std::vector<float3> collapsedPoints(3, float3(1.f));
+    const uint32_t collapsedVertexCount = 3;
+    auto collapsedSweptSphere = CurveTessellation::convertToLinearSweptSphere(
+        1, &collapsedVertexCount, collapsedPoints.data(), widths.data(), nullptr, 1, 4, 1, 1, 1.f, float4x4::identity()
+    );
+    EXPECT(collapsedSweptSphere.points.empty());
+    EXPECT(collapsedSweptSphere.indices.empty());
+    auto collapsedPolytube =
+        CurveTessellation::convertToPolytube(1, &collapsedVertexCount, collapsedPoints.data(), widths.data(), nullptr, 4, 1, 1, 1.f, 4);
+    EXPECT(collapsedPolytube.vertices.empty());
+    EXPECT(collapsedPolytube.faceVertexIndices.empty());
+}
+
+CPU_TEST(CurveTessellation_Polytube)
+{
+    const Curves curves = createCurves(200);
+    const uint32_t pointCountPerCrossSection = 6;
+    const float widthScale = 0.5f;
+
+    for (uint32_t subdivPerSegment : {1u, 3u})
+    {
+        for (uint32_t keepOneEveryXStrands : {1u, 3u})
+        {
+            for (uint32_t keepOneEveryXVerticesPerStrand : {1u, 2u, 5u})
+            {
+                auto result = CurveTessellation::convertToPolytube(
+                    curves.getStrandCount(),
+                    curves.vertexCountsPerStrand.data(),
+                    curves.controlPoints.data(),
+                    curves.widths.data(),
+                    curves.UVs.data(),
+                    subdivPerSegment,
+                    keepOneEveryXStrands,
+                    keepOneEveryXVerticesPerStrand,
+                    widthScale,
+                    pointCountPerCrossSection
+                );
+                auto ref = referenceSweptSphere(
+                    curves, subdivPerSegment, keepOneEveryXStrands, keepOneEveryXVerticesPerStrand, widthScale, float4x4::identity()
+                );
+
+                // Each point of the swept sphere reference is the center of a cross-section.
+                const size_t crossSectionCount = ref.points.size();
+                const size_t segmentCount = ref.indices.size();
+                ASSERT_EQ(result.vertices.size(), crossSectionCount * pointCountPerCrossSection);
+                ASSERT_EQ(result.faceVertexCounts.size(), 2 * segmentCount * pointCountPerCrossSection);
+                ASSERT_EQ(result.faceVertexIndices.size(), 3 * result.faceVertexCounts.size());
+
+                std::vector<float3> centers(crossSectionCount);
+                for (size_t i = 0; i < crossSectionCount; i++)
+                {
+                    const size_t first = i * pointCountPerCrossSection;
+                    centers[i] = result.vertices[first] - result.radii[first] * result.normals[first];
+                    for (size_t k = first; k < first + pointCountPerCrossSection; k++)
+                    {
+                        float3 center = result.vertices[k] - result.radii[k] * result.normals[k];
+                        EXPECT_LE(length(center - ref.points[i]), 1e-4f) << "vertex " << k;
+                        EXPECT_LE(std::abs(result.radii[k] - 1.11f * ref.radius[i]), 1e-6f) << "vertex " << k;
+                        EXPECT(all(result.texCrds[k] == ref.texCrds[i])) << "vertex " << k;
+                    }
+                }
+
+                // Strands are delimited by the reference segments (a new strand starts where no segment starts at the previous point).
+                size_t segment = 0;
+                for (size_t begin = 0; begin < crossSectionCount;)
+                {
+                    size_t end = begin + 1;
+                    while (segment < segmentCount && ref.indices[segment] == end - 1)
+                    {
+                        segment++;
+                        end++;
+                    }
+
+                    // Tangents are central differences of the cross-section centers (one-sided at the ends), including the
+                    // last two cross-sections. The cross-sections are orthogonal to the tangents and don't flip.
+                    for (size_t i = begin; i < end; i++)
+                    {
+                        float3 expectedTangent = normalize(centers[std::min(i + 1, end - 1)] - centers[i == begin ? i : i - 1]);
+                        if (i == end - 1)
+                            expectedTangent = normalize(centers[i] - centers[i - 1]);
+                        for (size_t k = i * pointCountPerCrossSection; k < (i + 1) * pointCountPerCrossSection; k++)
+                        {
+                            float3 tangent = result.tangents[k].xyz();
+                            EXPECT_LE(length(tangent - expectedTangent), 1e-3f) << "vertex " << k;
+                            EXPECT_LE(std::abs(length(result.normals[k]) - 1.f), 1e-4f) << "vertex " << k;
+                            EXPECT_LE(std::abs(dot(result.normals[k], tangent)), 1e-3f) << "vertex " << k;
+                            if (i > begin)
+                                EXPECT_GT(dot(result.normals[k], result.normals[k - pointCountPerCrossSection]), 0.f) << "vertex " << k;
+                        }
+                    }
+                    begin = end;
+                }
+            }
+        }
+    }
+}
+
+CPU_TEST(CurveTessellation_TwoPointStrands)
+{
+    const std::vector<uint32_t> vertexCountsPerStrand = {2, 2};
+    const std::vector<float3> points = {{0, 0, 0}, {0, 2, 0}, {1, 0, 0}, {2, 1, 1}};
+    const std::vector<float> widths = {0.2f, 0.1f, 0.2f, 0.2f};
+    const uint32_t subdivPerSegment = 4;
+    const uint32_t pointCountPerCrossSection = 4;
+
+    auto sweptSphere = CurveTessellation::convertToLinearSweptSphere(
+        2, vertexCountsPerStrand.data(), points.data(), widths.data(), nullptr, 1, subdivPerSegment, 1, 1, 1.f, float4x4::identity()
+    );
+    ASSERT_EQ(sweptSphere.points.size(), 2 * (subdivPerSegment + 1));
+    ASSERT_EQ(sweptSphere.indices.size(), 2 * subdivPerSegment);
+    EXPECT(sweptSphere.texCrds.empty());
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        // Strand end points are interpolated exactly.
+        EXPECT_LE(length(sweptSphere.points[i * (subdivPerSegment + 1)] - points[2 * i]), 1e-6f);
+        EXPECT_LE(length(sweptSphere.points[i * (subdivPerSegment + 1) + subdivPerSegment] - points[2 * i + 1]), 1e-6f);
+        for (uint32_t j = 0; j < subdivPerSegment; j++)
+            EXPECT_EQ(sweptSphere.indices[i * subdivPerSegment + j], i * (subdivPerSegment + 1) + j);
+    }
+
+    auto polytube = CurveTessellation::convertToPolytube(
+        2, vertexCountsPerStrand.data(), points.data(), widths.data(), nullptr, subdivPerSegment, 1, 1, 1.f, pointCountPerCrossSection
+    );
+    ASSERT_EQ(polytube.vertices.size(), sweptSphere.points.size() * pointCountPerCrossSection);
+    EXPECT_EQ(polytube.faceVertexCounts.size(), 2 * sweptSphere.indices.size() * pointCountPerCrossSection);
+    for (size_t k = 0; k < polytube.vertices.size(); k++)
+    {
+        // Two-point strands are straight lines, all cross-sections have the same tangent.
+        const float3 expectedTangent = k < polytube.vertices.size() / 2 ? float3(0, 1, 0) : normalize(float3(1, 1, 1));
+        float3 tangent = polytube.tangents[k].xyz();
+        EXPECT_LE(length(tangent - expectedTangent), 1e-5f) << "vertex " << k;
+        EXPECT_LE(std::abs(dot(polytube.normals[k], tangent)), 1e-5f) << "vertex " << k;
+        EXPECT(std::isfinite(polytube.vertices[k].x) && std::isfinite(polytube.vertices[k].y) && std::isfinite(polytube.vertices[k].z));
+    }
+    for (uint32_t index : polytube.faceVertexIndices)
+        EXPECT_LT(index, polytube.vertices.size());
+}
+} // namespace Falcor
@@ -0,0 +1,171 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "LoopSubdivide.h"
+
+namespace Falcor
+{
+namespace
+{
+/**
+ * Expected result of subdividing a mesh.
+ * The values were captured from the original pointer-based implementation. The vertex data is compared
+ * bit-exact by hashing the raw bits of all positions, normals and indices.
+ */
+struct GoldenResult
+{
+    size_t vertexCount;
+    size_t faceCount;
+    uint64_t positionsHash;
+    uint64_t normalsHash;
+    uint64_t indicesHash;
+};
+
+/// Returns the FNV-1a hash of the raw bits of the elements.
+template<typename T>
+uint64_t hashBits(const std::vector<T>& data)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(data.data());
+    for (size_t i = 0; i < data.size() * sizeof(T); ++i)
+    {
+        hash ^= pBytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+/// Subdivide the mesh with 0 to 3 levels and compare against the golden results.
+void testSubdivide(
+    CPUUnitTestContext& ctx,
+    const std::vector<float3>& positions,
+    const std::vector<uint32_t>& indices,
+    const GoldenResult (&golden)[4]
+)
+{
+    for (uint32_t level = 0; level < 4; ++level)
+    {
+        pbrt::LoopSubdivideResult result = pbrt::loopSubdivide(level, positions, indices);
+        ASSERT_EQ(result.positions.size(), golden[level].vertexCount) << "level " << level;
+        ASSERT_EQ(result.normals.size(), golden[level].vertexCount) << "level " << level;
+        ASSERT_EQ(result.indices.size(), 3 * golden[level].faceCount) << "level " << level;
+        EXPECT_EQ(hashBits(result.positions), golden[level].positionsHash) << "level " << level;
+        EXPECT_EQ(hashBits(result.normals), golden[level].normalsHash) << "level " << level;
+        EXPECT_EQ(hashBits(result.indices), golden[level].indicesHash) << "level " << level;
+    }
+}
+
+const std::vector<float3> kTetrahedronPositions = {{1, 1, 1}, {-1, -1, 1}, {-1, 1, -1}, {1, -1, -1}};
+const std::vector<uint32_t> kTetrahedronIndices = {0, 1, 2, 0, 3, 1, 0, 2, 3, 1, 3, 2};
+} // namespace
+
+CPU_TEST(PBRTLoopSubdivide_Tetrahedron)
+{
+    // Closed mesh with valence 3 vertices.
+    const GoldenResult golden[4] = {
+        {4, 4, 0xf87d936d3c28dcddull, 0xff51a603eb6ac535ull, 0xc6c99c3abd170375ull},
+        {10, 16, 0x3f004dbded81bc49ull, 0x11cbdfd1e5348b27ull, 0x7aba35f2a0b66e75ull},
+        {34, 64, 0x0e8bb0ef00ccc30dull, 0x1b604c80c396d869ull, 0x858f0b9a8bbadb65ull},
+        {130, 256, 0xae96420286010905ull, 0x339615cf96972975ull, 0x7f945ce1352436d5ull},
+    };
+    testSubdivide(ctx, kTetrahedronPositions, kTetrahedronIndices, golden);
+}
+
+CPU_TEST(PBRTLoopSubdivide_Octahedron)
+{
+    // Closed mesh with valence 4 vertices.
+    const std::vector<float3> positions = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    const std::vector<uint32_t> indices = {0, 2, 4, 2, 1, 4, 1, 3, 4, 3, 0, 4, 2, 0, 5, 1, 2, 5, 3, 1, 5, 0, 3, 5};
+    const GoldenResult golden[4] = {
+        {6, 8, 0xca57b22602340a75ull, 0x22d61d2d63231e75ull, 0xbe2a8e9de8f17ca5ull},
+        {18, 32, 0x9a51510562bf72d5ull, 0x9cfb6fc2d7b43f41ull, 0x33321f6a32446855ull},
+        {66, 128, 0xece198b0a412cacdull, 0xb8e9c59c67cac5adull, 0x47a69e72609e27f5ull},
+        {258, 512, 0x824ddb83c4bbeb65ull, 0xdde1bbe03f295ce1ull, 0x4d5c2fd71f91a2cdull},
+    };
+    testSubdivide(ctx, positions, indices, golden);
+}
+
+CPU_TEST(PBRTLoopSubdivide_QuadStrip)
+{
+    // Open strip of three quads with boundary vertices of valence 2, 3 and 4.
+    const std::vector<float3> positions = {
+        {0, 0, 0}, {1, 0, 0.5f}, {2, 0, 0.25f}, {3, 0, 1}, {0, 1, 0.5f}, {1, 1, 0}, {2, 1, 1}, {3, 1, 0.75f},
+    };
+    const std::vector<uint32_t> indices = {0, 1, 5, 0, 5, 4, 1, 2, 6, 1, 6, 5, 2, 3, 7, 2, 7, 6};
+    const GoldenResult golden[4] = {
+        {8, 6, 0x298037e6fe837e17ull, 0x5e7262f1d98f5492ull, 0x6cc47f4dc401e1c2ull},
+        {21, 24, 0x1f696b9ea8749945ull, 0x4a333e7dcc18ac8dull, 0x68569535d896e4d7ull},
+        {65, 96, 0x401d2acf42328e94ull, 0x41654dc5516fcaa0ull, 0xf80bf742e0aa2827ull},
+        {225, 384, 0xab0e401ff23d6dc7ull, 0x9e984f8309c2d42dull, 0xc6338d71dce2571eull},
+    };
+    testSubdivide(ctx, positions, indices, golden);
+}
+
+CPU_TEST(PBRTLoopSubdivide_NonManifoldEdge)
+{
+    // Three faces sharing the edge (0, 1). The first two faces are neighbors, the third one is treated as a boundary.
+    const std::vector<float3> positions = {{0, 0, 0}, {1, 0, 0}, {0.5f, 1, 0}, {0.5f, -1, 0}, {0.5f, 0, 1}};
+    const std::vector<uint32_t> indices = {0, 1, 2, 1, 0, 3, 0, 1, 4};
+    const GoldenResult golden[4] = {
+        {5, 3, 0xd0cb451dbe36ba2cull, 0x5806f0ca820a9c59ull, 0x1523c7b12ef40151ull},
+        {12, 12, 0xf5c0a23976111d0full, 0xa405407245cd6a84ull, 0x9b403f38f4305fc5ull},
+        {35, 48, 0xf5504a26d847ac09ull, 0xccca0594e367cb04ull, 0x8e3c37f67942b4ffull},
+        {117, 192, 0xcafa8d055a58e747ull, 0x6645ebb0b6dc2671ull, 0x8e042f65f0781693ull},
+    };
+    testSubdivide(ctx, positions, indices, golden);
+}
+
+CPU_TEST(PBRTLoopSubdivide_InvalidMesh)
+{
+    // Out-of-range vertex index.
+    std::vector<uint32_t> indices = kTetrahedronIndices;
+    indices.back() = 4;
+    try
+    {
+        pbrt::loopSubdivide(1, kTetrahedronPositions, indices);
+        EXPECT(false);
+    }
+    catch (const RuntimeError&)
+    {
+        EXPECT(true);
+    }
+
+    // Vertex not referenced by any face.
+    std::vector<float3> positions = kTetrahedronPositions;
+    positions.push_back(float3(0.f));
+    try
+    {
+        pbrt::loopSubdivide(1, positions, kTetrahedronIndices);
+        EXPECT(false);
+    }
+    catch (const RuntimeError&)
+    {
+        EXPECT(true);
+    }
+}
+} // namespace Falcor
@@ -0,0 +1,231 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "PLYReader.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+enum class PLYFormat
+{
+    ASCII,
+    BinaryLittleEndian,
+    BinaryBigEndian,
+};
+
+// Concave quad (vertex 2 is pushed inwards), a triangle and a convex quad.
+const float3 kPositions[] = {{0, 0, 0}, {2, 0, 0}, {0.5f, 0.5f, 0}, {0, 2, 0}, {3, 3, 0}, {4, 3, 0}, {4, 4, 0}, {3, 4, 1}};
+const float3 kNormals[] = {{0, 0, 1}, {0, 0, 1}, {0, 0.6f, 0.8f}, {0, 0, 1}, {1, 0, 0}, {0, 1, 0}, {0, 0, -1}, {0.6f, 0.8f, 0}};
+const float2 kTexCoords[] = {{0, 0}, {1, 0}, {0.25f, 0.25f}, {0, 1}, {0.5f, 0.5f}, {1, 0.5f}, {1, 1}, {0.75f, 0.25f}};
+const std::vector<std::vector<int32_t>> kFaces = {{0, 1, 2, 3}, {4, 5, 6}, {4, 5, 6, 7}};
+
+template<typename T>
+void appendBinary(std::string& data, T value, bool bigEndian)
+{
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    if (bigEndian)
+        std::reverse(bytes, bytes + sizeof(T));
+    data.append(bytes, sizeof(T));
+}
+
+/**
+ * Write the test mesh to a PLY file.
+ * Each face has an additional scalar and list property and the file has an additional element, which are skipped.
+ */
+void writePLY(const std::filesystem::path& path, PLYFormat format, bool withNormals, const std::vector<std::vector<int32_t>>& faces)
+{
+    const size_t vertexCount = std::size(kPositions);
+    const bool bigEndian = format == PLYFormat::BinaryBigEndian;
+
+    std::string data = "ply\n";
+    if (format == PLYFormat::ASCII)
+        data += "format ascii 1.0\n";
+    else
+        data += bigEndian ? "format binary_big_endian 1.0\n" : "format binary_little_endian 1.0\n";
+    data += fmt::format("element vertex {}\n", vertexCount);
+    data += "property float x\nproperty float y\nproperty float z\n";
+    if (withNormals)
+        data += "property float nx\nproperty float ny\nproperty float nz\n";
+    data += "property double u\nproperty double v\n";
+    data += fmt::format("element face {}\n", faces.size());
+    data += "property uchar flags\nproperty list uchar int vertex_indices\nproperty list ushort float extra\n";
+    data += "element extra 1\nproperty list uchar int values\n";
+    data += "end_header\n";
+
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        std::vector<float> values = {kPositions[i].x, kPositions[i].y, kPositions[i].z};
+        if (withNormals)
+            values.insert(values.end(), {kNormals[i].x, kNormals[i].y, kNormals[i].z});
+        if (format == PLYFormat::ASCII)
+        {
+            for (float value : values)
+                data += fmt::format("{} ", value);
+            data += fmt::format("{} {}\n", kTexCoords[i].x, kTexCoords[i].y);
+        }
+        else
+        {
+            for (float value : values)
+                appendBinary(data, value, bigEndian);
+            appendBinary(data, (double)kTexCoords[i].x, bigEndian);
+            appendBinary(data, (double)kTexCoords[i].y, bigEndian);
+        }
+    }
+
+    for (const auto& face : faces)
+    {
+        if (format == PLYFormat::ASCII)
+        {
+            data += fmt::format("7 {}", face.size());
+            for (int32_t index : face)
+                data += fmt::format(" {}", index);
+            data += " 2 1.5 2.5\n";
+        }
+        else
+        {
+            appendBinary(data, (uint8_t)7, bigEndian);
+            appendBinary(data, (uint8_t)face.size(), bigEndian);
+            for (int32_t index : face)
+                appendBinary(data, index, bigEndian);
+            appendBinary(data, (uint16_t)2, bigEndian);
+            appendBinary(data, 1.5f, bigEndian);
+            appendBinary(data, 2.5f, bigEndian);
+        }
+    }
+
+    if (format == PLYFormat::ASCII)
+    {
+        data += "2 5 6\n";
+    }
+    else
+    {
+        appendBinary(data, (uint8_t)2, bigEndian);
+        appendBinary(data, (int32_t)5, bigEndian);
+        appendBinary(data, (int32_t)6, bigEndian);
+    }
+
+    std::ofstream(path, std::ios::binary) << data;
+}
+
+void compareMeshes(CPUUnitTestContext& ctx, const ref<TriangleMesh>& pMesh, const ref<TriangleMesh>& pRefMesh)
+{
+    ASSERT(pMesh != nullptr);
+    ASSERT(pRefMesh != nullptr);
+
+    const auto& vertices = pMesh->getVertices();
+    const auto& refVertices = pRefMesh->getVertices();
+    ASSERT_EQ(vertices.size(), refVertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        EXPECT_LE(length(vertices[i].position - refVertices[i].position), 1e-6f) << "vertex " << i;
+        EXPECT_LE(length(vertices[i].normal - refVertices[i].normal), 1e-6f) << "vertex " << i;
+        EXPECT_LE(length(vertices[i].texCoord - refVertices[i].texCoord), 1e-6f) << "vertex " << i;
+    }
+
+    const auto& indices = pMesh->getIndices();
+    const auto& refIndices = pRefMesh->getIndices();
+    ASSERT_EQ(indices.size(), refIndices.size());
+    for (size_t i = 0; i < indices.size(); ++i)
+        EXPECT_EQ(indices[i], refIndices[i]) << "index " << i;
+}
+
+std::filesystem::path getTestDirectory()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "FalcorTest" / "PBRTPLYReader";
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+} // namespace
+
+CPU_TEST(PBRTPLYReader_MatchesAssimp)
+{
+    const std::filesystem::path directory = getTestDirectory();
+
+    for (PLYFormat format : {PLYFormat::ASCII, PLYFormat::BinaryLittleEndian, PLYFormat::BinaryBigEndian})
+    {
+        for (bool withNormals : {true, false})
+        {
+            std::filesystem::path path = directory / fmt::format("mesh{}{}.ply", (int)format, withNormals ? "_normals" : "");
+            writePLY(path, format, withNormals, kFaces);
+            compareMeshes(ctx, pbrt::loadPLYMesh(path), TriangleMesh::createFromFile(path));
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+CPU_TEST(PBRTPLYReader_SkipDegenerateFaces)
+{
+    const std::filesystem::path directory = getTestDirectory();
+
+    // Faces with less than 3 vertices are skipped.
+    std::vector<std::vector<int32_t>> faces = kFaces;
+    faces.insert(faces.begin() + 1, {{4, 5}, {6}, {}});
+    writePLY(directory / "degenerate.ply", PLYFormat::ASCII, true, faces);
+    writePLY(directory / "reference.ply", PLYFormat::ASCII, true, kFaces);
+    compareMeshes(ctx, pbrt::loadPLYMesh(directory / "degenerate.ply"), pbrt::loadPLYMesh(directory / "reference.ply"));
+
+    // Files without any valid face are invalid.
+    writePLY(directory / "empty.ply", PLYFormat::ASCII, true, {{0, 1}, {2}});
+    try
+    {
+        pbrt::loadPLYMesh(directory / "empty.ply");
+        EXPECT(false);
+    }
+    catch (const RuntimeError&)
+    {
+        EXPECT(true);
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+CPU_TEST(PBRTPLYReader_UnsupportedElements)
+{
+    const std::filesystem::path directory = getTestDirectory();
+
+    // Triangle strips are not supported and signaled by returning nullptr, so the caller can fall back to ASSIMP.
+    std::ofstream(directory / "tristrips.ply") << "ply\n"
+                                                  "format ascii 1.0\n"
+                                                  "element vertex 4\n"
+                                                  "property float x\nproperty float y\nproperty float z\n"
+                                                  "element tristrips 1\n"
+                                                  "property list int int vertex_indices\n"
+                                                  "end_header\n"
+                                                  "0 0 0\n1 0 0\n0 1 0\n1 1 0\n"
+                                                  "4 0 1 2 3\n";
+    EXPECT(pbrt::loadPLYMesh(directory / "tristrips.ply") == nullptr);
+
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
@@ -0,0 +1,160 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Builder.h"
+#include "Parser.h"
+#include <fstream>
+
+namespace Falcor
+{
+namespace
+{
+std::filesystem::path getTestDirectory()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "FalcorTest" / "PBRTParser";
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+void writeFile(const std::filesystem::path& path, const std::string& contents)
+{
+    std::ofstream(path, std::ios::binary) << contents;
+}
+
+std::unique_ptr<pbrt::BasicScene> parseScene(const std::filesystem::path& path)
+{
+    auto pScene = std::make_unique<pbrt::BasicScene>(path.parent_path());
+    pbrt::BasicSceneBuilder builder(*pScene);
+    pbrt::parseFile(builder, path);
+    return pScene;
+}
+
+/// Returns the error message of parsing a scene file, or an empty string if parsing succeeded.
+std::string getParseError(const std::filesystem::path& path)
+{
+    try
+    {
+        parseScene(path);
+    }
+    catch (const RuntimeError& e)
+    {
+        return e.what();
+    }
+    return {};
+}
+} // namespace
+
+CPU_TEST(PBRTParser_Import)
+{
+    const std::filesystem::path directory = getTestDirectory();
+
+    // Named materials and textures defined in an imported file are used by the importing file after the directive.
+    writeFile(
+        directory / "materials.pbrt",
+        "Texture \"checks\" \"float\" \"checkerboard\" \"float uscale\" 4\n"
+        "MakeNamedMaterial \"red\" \"string type\" \"diffuse\" \"rgb reflectance\" [1 0 0]\n"
+        "MakeNamedMaterial \"textured\" \"string type\" \"diffuse\" \"texture reflectance\" \"base\" \"texture roughness\" \"checks\"\n"
+        "Shape \"sphere\" \"float radius\" 2\n"
+    );
+    writeFile(
+        directory / "shapes.pbrt",
+        "Material \"conductor\"\n"
+        "Shape \"sphere\" \"float radius\" 3\n"
+    );
+    writeFile(
+        directory / "main.pbrt",
+        "WorldBegin\n"
+        "Texture \"base\" \"spectrum\" \"imagemap\" \"string filename\" \"base.png\"\n"
+        "Import \"materials.pbrt\"\n"
+        "NamedMaterial \"red\"\n"
+        "Shape \"sphere\" \"float radius\" 1\n"
+        "Import \"shapes.pbrt\"\n"
+        "AttributeBegin\n"
+        "  NamedMaterial \"textured\"\n"
+        "  Shape \"sphere\" \"float radius\" 4\n"
+        "AttributeEnd\n"
+    );
+
+    auto pScene = parseScene(directory / "main.pbrt");
+
+    EXPECT_EQ(pScene->getNamedMaterials().size(), 2);
+    EXPECT(pScene->getNamedMaterials().count("red") == 1);
+    EXPECT(pScene->getNamedMaterials().count("textured") == 1);
+    EXPECT_EQ(pScene->getFloatTextures().size(), 1);
+    EXPECT(pScene->getFloatTextures().count("checks") == 1);
+    EXPECT_EQ(pScene->getSpectrumTextures().size(), 1);
+    EXPECT(pScene->getSpectrumTextures().count("base") == 1);
+    EXPECT_EQ(pScene->getIncludedFiles().size(), 2);
+
+    // Imported shapes are inserted at the position of their 'Import' directive.
+    const auto& shapes = pScene->getShapes();
+    ASSERT_EQ(shapes.size(), 4);
+    EXPECT_EQ(shapes[0].params.getFloat("radius", 0.f), 2.f);
+    EXPECT_EQ(shapes[1].params.getFloat("radius", 0.f), 1.f);
+    EXPECT_EQ(shapes[2].params.getFloat("radius", 0.f), 3.f);
+    EXPECT_EQ(shapes[3].params.getFloat("radius", 0.f), 4.f);
+
+    EXPECT(shapes[1].materialRef == pbrt::MaterialRef(std::string("red")));
+    EXPECT(shapes[3].materialRef == pbrt::MaterialRef(std::string("textured")));
+    ASSERT(std::holds_alternative<uint32_t>(shapes[2].materialRef));
+    EXPECT_EQ(pScene->getMaterial(shapes[2].materialRef).type, "conductor");
+    EXPECT_EQ(pScene->getMaterial(std::string("textured")).type, "diffuse");
+
+    std::filesystem::remove_all(directory);
+}
+
+CPU_TEST(PBRTParser_ImportErrors)
+{
+    const std::filesystem::path directory = getTestDirectory();
+
+    // Imported files are parsed in the world block, so options directives are not allowed.
+    writeFile(directory / "camera.pbrt", "Camera \"perspective\"\n");
+    writeFile(directory / "camera_main.pbrt", "WorldBegin\nImport \"camera.pbrt\"\n");
+    std::string error = getParseError(directory / "camera_main.pbrt");
+    EXPECT(error.find("camera.pbrt") != std::string::npos) << error;
+    EXPECT(error.find("'Camera' is not allowed") != std::string::npos) << error;
+
+    // 'Import' itself is only allowed in the world block.
+    writeFile(directory / "options_main.pbrt", "Import \"camera.pbrt\"\nWorldBegin\n");
+    error = getParseError(directory / "options_main.pbrt");
+    EXPECT(error.find("'Import' is not allowed") != std::string::npos) << error;
+
+    // Named entities must be unique across the importing and imported files.
+    writeFile(directory / "material.pbrt", "MakeNamedMaterial \"red\" \"string type\" \"diffuse\"\n");
+    writeFile(
+        directory / "redefine_main.pbrt",
+        "WorldBegin\n"
+        "MakeNamedMaterial \"red\" \"string type\" \"conductor\"\n"
+        "Import \"material.pbrt\"\n"
+    );
+    error = getParseError(directory / "redefine_main.pbrt");
+    EXPECT(error.find("Redefining named material 'red'") != std::string::npos) << error;
+
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
@@ -0,0 +1,96 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MaterialSystem.h"
+#include "Scene/Material/StandardMaterial.h"
+
+namespace Falcor
+{
+GPU_TEST(MaterialSystem_RemoveDuplicates)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    MaterialSystem materialSystem(pDevice);
+
+    auto createMaterial = [&](const std::string& name, float4 baseColor, float roughness)
+    {
+        ref<StandardMaterial> pMaterial = StandardMaterial::create(pDevice, name);
+        pMaterial->setBaseColor(baseColor);
+        pMaterial->setRoughness(roughness);
+        return pMaterial;
+    };
+
+    std::vector<ref<Material>> materials = {
+        createMaterial("A", float4(1.f, 0.f, 0.f, 1.f), 0.5f),
+        createMaterial("B", float4(0.f, 1.f, 0.f, 1.f), 0.5f),
+        createMaterial("C", float4(1.f, 0.f, 0.f, 1.f), 0.5f),  // Duplicate of A.
+        createMaterial("D", float4(1.f, 0.f, 0.f, 1.f), 0.25f),
+        createMaterial("E", float4(0.f, 1.f, 0.f, 1.f), 0.5f),  // Duplicate of B.
+        createMaterial("F", float4(1.f, 0.f, 0.f, 1.f), 0.5f),  // Duplicate of A.
+    };
+
+    for (size_t i = 0; i < materials.size(); i++)
+    {
+        EXPECT_EQ(materialSystem.addMaterial(materials[i]).get(), i);
+    }
+
+    // Adding the same material again returns the existing ID.
+    EXPECT_EQ(materialSystem.addMaterial(materials[3]).get(), 3u);
+    EXPECT_EQ(materialSystem.getMaterialCount(), materials.size());
+
+    // Equal materials have equal hashes.
+    EXPECT(materials[0]->isEqual(materials[2]));
+    EXPECT_EQ(materials[0]->getHash(), materials[2]->getHash());
+    EXPECT_EQ(materials[1]->getHash(), materials[4]->getHash());
+    EXPECT(!materials[0]->isEqual(materials[3]));
+
+    // Lookup by name, including renamed materials.
+    EXPECT(materialSystem.getMaterialByName("D") == materials[3]);
+    EXPECT(materialSystem.getMaterialByName("X") == nullptr);
+    materials[3]->setName("X");
+    EXPECT(materialSystem.getMaterialByName("D") == nullptr);
+    EXPECT(materialSystem.getMaterialByName("X") == materials[3]);
+
+    std::vector<MaterialID> idMap;
+    size_t removed = materialSystem.removeDuplicateMaterials(idMap);
+    EXPECT_EQ(removed, 3u);
+    EXPECT_EQ(materialSystem.getMaterialCount(), 3u);
+
+    const uint32_t expectedIDs[] = { 0, 1, 0, 2, 1, 0 };
+    EXPECT_EQ(idMap.size(), materials.size());
+    for (size_t i = 0; i < idMap.size(); i++)
+    {
+        EXPECT_EQ(idMap[i].get(), expectedIDs[i]);
+    }
+
+    // The lookup tables are updated after removing duplicates.
+    EXPECT(materialSystem.getMaterialByName("C") == nullptr);
+    EXPECT(materialSystem.getMaterialByName("X") == materials[3]);
+    EXPECT_EQ(materialSystem.addMaterial(materials[3]).get(), 2u);
+}
+} // namespace Falcor
@@ -0,0 +1,125 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/Material/MeasuredBSDFCache.h"
+#include <fstream>
+
+namespace Falcor
+{
+CPU_TEST(MeasuredBSDFCache_ComputeKey)
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "FalcorTest" / "MeasuredBSDFCacheKey";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    std::filesystem::path path = directory / "brdf.binary";
+    EXPECT(MeasuredBSDFCache::computeKey(path, "MERL/1").empty());
+
+    std::ofstream(path, std::ios::binary) << "data";
+    std::string key = MeasuredBSDFCache::computeKey(path, "MERL/1");
+    EXPECT(!key.empty());
+    EXPECT_EQ(MeasuredBSDFCache::computeKey(path, "MERL/1"), key);
+    EXPECT_NE(MeasuredBSDFCache::computeKey(path, "MERL/2"), key);
+
+    // Modifying the source file changes the key.
+    std::ofstream(path, std::ios::binary | std::ios::app) << "more data";
+    EXPECT_NE(MeasuredBSDFCache::computeKey(path, "MERL/1"), key);
+
+    std::filesystem::remove_all(directory);
+}
+
+CPU_TEST(MeasuredBSDFCache_StoreLoad)
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "FalcorTest" / "MeasuredBSDFCache";
+    std::filesystem::remove_all(directory);
+
+    MeasuredBSDFCache cache(directory);
+    EXPECT(cache.getDirectory() == directory);
+    EXPECT(cache.load("entry") == nullptr);
+
+    std::vector<float3> values(1001);
+    for (size_t i = 0; i < values.size(); i++)
+        values[i] = float3(float(i), 0.5f * i, -1.f * i);
+    const uint32_t sizes[] = {3, 5, 7};
+    const std::string description = "measured";
+
+    EXPECT(cache.store(
+        "entry",
+        {
+            {"values", values.data(), sizeof(float3), values.size()},
+            {"sizes", sizes, sizeof(uint32_t), 3},
+            {"description", description.data(), sizeof(char), description.size()},
+            {"empty", nullptr, sizeof(float), 0},
+        }
+    ));
+
+    auto pEntry = cache.load("entry");
+    ASSERT(pEntry != nullptr);
+
+    size_t count = 0;
+    const float3* pValues = pEntry->getArray<float3>("values", count);
+    ASSERT(pValues != nullptr);
+    EXPECT_EQ(count, values.size());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(pValues) % 16, 0);
+    EXPECT(std::equal(values.begin(), values.end(), pValues, [](float3 a, float3 b) { return all(a == b); }));
+
+    const uint32_t* pSizes = pEntry->getArray<uint32_t>("sizes", count);
+    ASSERT(pSizes != nullptr);
+    EXPECT_EQ(count, 3);
+    EXPECT_EQ(pSizes[2], 7);
+
+    const char* pDescription = pEntry->getArray<char>("description", count);
+    ASSERT(pDescription != nullptr);
+    EXPECT_EQ(std::string(pDescription, count), description);
+
+    EXPECT(pEntry->getArray<float>("empty", count) != nullptr);
+    EXPECT_EQ(count, 0);
+
+    // Missing arrays and element size mismatches.
+    EXPECT(pEntry->getArray<float>("missing", count) == nullptr);
+    EXPECT(pEntry->getArray<float4>("values", count) == nullptr);
+    pEntry.reset();
+
+    // Truncated entries are rejected.
+    std::filesystem::path path = directory / (std::string("entry") + ".bsdfcache");
+    ASSERT(std::filesystem::exists(path));
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 16);
+    EXPECT(cache.load("entry") == nullptr);
+
+    // Storing again replaces the entry.
+    EXPECT(cache.store("entry", {{"sizes", sizes, sizeof(uint32_t), 2}}));
+    pEntry = cache.load("entry");
+    ASSERT(pEntry != nullptr);
+    EXPECT(pEntry->getArray<uint32_t>("sizes", count) != nullptr);
+    EXPECT_EQ(count, 2);
+    EXPECT(pEntry->getArray<float3>("values", count) == nullptr);
+    pEntry.reset();
+
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
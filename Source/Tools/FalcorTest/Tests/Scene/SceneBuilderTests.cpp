@@ -0,0 +1,244 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Scene/SceneBuilder.h"
+#include "Scene/Material/StandardMaterial.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+/**
+ * Synthetic grid mesh with shared positions and optionally faceted (face-varying) normals and texture coordinates.
+ * A constant tangent is used so that processMesh() doesn't spend its time generating tangents.
+ */
+struct GridMesh
+{
+    std::vector<uint32_t> indices;
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> texCrds;
+    float4 tangent = float4(1.f, 0.f, 0.f, 1.f);
+    SceneBuilder::Mesh mesh;
+
+    GridMesh(uint32_t size, bool faceted, const ref<Material>& pMaterial)
+    {
+        std::mt19937 rng;
+        std::uniform_real_distribution<float> dist;
+
+        for (uint32_t y = 0; y <= size; ++y)
+            for (uint32_t x = 0; x <= size; ++x)
+                positions.push_back(float3((float)x, dist(rng), (float)y));
+
+        for (uint32_t y = 0; y < size; ++y)
+        {
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                uint32_t i = y * (size + 1) + x;
+                for (uint32_t index : {i, i + size + 1, i + 1, i + 1, i + size + 1, i + size + 2})
+                    indices.push_back(index);
+            }
+        }
+
+        if (faceted)
+        {
+            // One normal and a separate UV chart per face.
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                const float3& p0 = positions[indices[i]];
+                const float3& p1 = positions[indices[i + 1]];
+                const float3& p2 = positions[indices[i + 2]];
+                float3 n = normalize(cross(p1 - p0, p2 - p0));
+                for (uint32_t j = 0; j < 3; ++j)
+                {
+                    normals.push_back(n);
+                    texCrds.push_back(float2((float)i, (float)j));
+                }
+            }
+        }
+        else
+        {
+            normals.resize(positions.size(), float3(0.f, 1.f, 0.f));
+            for (const auto& p : positions)
+                texCrds.push_back(float2(p.x, p.z) / (float)size);
+        }
+
+        auto frequency = faceted ? SceneBuilder::Mesh::AttributeFrequency::FaceVarying : SceneBuilder::Mesh::AttributeFrequency::Vertex;
+        mesh.name = "grid";
+        mesh.faceCount = (uint32_t)indices.size() / 3;
+        mesh.vertexCount = (uint32_t)positions.size();
+        mesh.indexCount = (uint32_t)indices.size();
+        mesh.pIndices = indices.data();
+        mesh.topology = Vao::Topology::TriangleList;
+        mesh.pMaterial = pMaterial;
+        mesh.positions = {positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+        mesh.normals = {normals.data(), frequency};
+        mesh.texCrds = {texCrds.data(), frequency};
+        mesh.tangents = {&tangent, SceneBuilder::Mesh::AttributeFrequency::Constant};
+        mesh.useOriginalTangentSpace = true;
+    }
+};
+
+/**
+ * Synthetic mesh of closed triangle fans with face-varying attributes.
+ * The center vertex of each fan is shared by all faces, which exceeds the valence handled by the short per-vertex lists
+ * in processMesh(). Pairs of faces use texture coordinates that differ by the given delta in x, and each pair uses
+ * a distinct y. The x coordinates sweep a small range with sub-threshold steps so that they straddle quantization
+ * boundaries of any vertex hashing scheme.
+ */
+struct FanMesh
+{
+    std::vector<uint32_t> indices;
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> texCrds;
+    float4 tangent = float4(1.f, 0.f, 0.f, 1.f);
+    SceneBuilder::Mesh mesh;
+
+    FanMesh(uint32_t fanCount, uint32_t valence, float delta, const ref<Material>& pMaterial)
+    {
+        for (uint32_t fan = 0; fan < fanCount; ++fan)
+        {
+            const uint32_t center = (uint32_t)positions.size();
+            const float base = 0.1f + fan * 0.5e-6f;
+
+            positions.push_back(float3(2.f * fan, 0.f, 0.f));
+            for (uint32_t i = 0; i < valence; ++i)
+            {
+                float phi = 2.f * (float)M_PI * i / valence;
+                positions.push_back(float3(2.f * fan + std::cos(phi), 0.f, std::sin(phi)));
+            }
+
+            for (uint32_t i = 0; i < valence; ++i)
+            {
+                for (uint32_t index : {center, center + 1 + (i + 1) % valence, center + 1 + i})
+                    indices.push_back(index);
+                normals.insert(normals.end(), 3, float3(0.f, 1.f, 0.f));
+                texCrds.push_back(float2(base + (i % 2) * delta, (float)(i / 2)));
+                texCrds.insert(texCrds.end(), 2, float2(0.f));
+            }
+        }
+
+        mesh.name = "fan";
+        mesh.faceCount = (uint32_t)indices.size() / 3;
+        mesh.vertexCount = (uint32_t)positions.size();
+        mesh.indexCount = (uint32_t)indices.size();
+        mesh.pIndices = indices.data();
+        mesh.topology = Vao::Topology::TriangleList;
+        mesh.pMaterial = pMaterial;
+        mesh.positions = {positions.data(), SceneBuilder::Mesh::AttributeFrequency::Vertex};
+        mesh.normals = {normals.data(), SceneBuilder::Mesh::AttributeFrequency::FaceVarying};
+        mesh.texCrds = {texCrds.data(), SceneBuilder::Mesh::AttributeFrequency::FaceVarying};
+        mesh.tangents = {&tangent, SceneBuilder::Mesh::AttributeFrequency::Constant};
+        mesh.useOriginalTangentSpace = true;
+    }
+};
+} // namespace
+
+GPU_TEST(SceneBuilder_MergeVertices)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    SceneBuilder builder(pDevice, Settings());
+    ref<Material> pMaterial = StandardMaterial::create(pDevice, "test");
+
+    // Smooth grid: all corners sharing a position are merged.
+    {
+        GridMesh grid(64, false, pMaterial);
+        auto processed = builder.processMesh(grid.mesh);
+        EXPECT_EQ(processed.staticData.size(), grid.positions.size());
+        EXPECT_EQ(processed.indexCount, grid.indices.size());
+    }
+
+    // Faceted grid: no corners can be merged.
+    {
+        GridMesh grid(64, true, pMaterial);
+        auto processed = builder.processMesh(grid.mesh);
+        EXPECT_EQ(processed.staticData.size(), grid.indices.size());
+    }
+
+    // Faceted normals but shared texture coordinates: vertices are merged only within faces of equal normals.
+    {
+        GridMesh grid(64, true, pMaterial);
+        std::fill(grid.normals.begin(), grid.normals.end(), float3(0.f, 1.f, 0.f));
+        std::fill(grid.texCrds.begin(), grid.texCrds.end(), float2(0.f));
+        auto processed = builder.processMesh(grid.mesh);
+        EXPECT_EQ(processed.staticData.size(), grid.positions.size());
+    }
+}
+
+GPU_TEST(SceneBuilder_MergeVerticesHighValence)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    SceneBuilder builder(pDevice, Settings());
+    ref<Material> pMaterial = StandardMaterial::create(pDevice, "test");
+
+    const uint32_t fanCount = 4096;
+    const uint32_t valence = 32;
+
+    // Texture coordinates of face pairs are within the merge threshold: one center vertex per face pair.
+    {
+        FanMesh fan(fanCount, valence, 0.5e-6f, pMaterial);
+        auto processed = builder.processMesh(fan.mesh);
+        EXPECT_EQ(processed.staticData.size(), fanCount * (valence / 2 + valence));
+        EXPECT_EQ(processed.indexCount, fan.indices.size());
+    }
+
+    // Texture coordinates of face pairs differ by more than the merge threshold: one center vertex per face.
+    {
+        FanMesh fan(fanCount, valence, 4e-6f, pMaterial);
+        auto processed = builder.processMesh(fan.mesh);
+        EXPECT_EQ(processed.staticData.size(), fanCount * (valence + valence));
+    }
+}
+
+GPU_TEST(SceneBuilder_MergeVerticesBenchmark, TAGS("benchmark"))
+{
+    ref<Device> pDevice = ctx.getDevice();
+    SceneBuilder builder(pDevice, Settings());
+    ref<Material> pMaterial = StandardMaterial::create(pDevice, "test");
+
+    for (bool faceted : {false, true})
+    {
+        GridMesh grid(1024, faceted, pMaterial);
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        auto processed = builder.processMesh(grid.mesh);
+        double ms = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        logInfo(
+            "processMesh ({}): {} vertices in {:.1f} ms ({:.2f} M vertices/s)",
+            faceted ? "faceted" : "smooth",
+            grid.indices.size(),
+            ms,
+            grid.indices.size() / (ms * 1e3)
+        );
+        EXPECT_GT(processed.staticData.size(), 0u);
+    }
+}
+} // namespace Falcor
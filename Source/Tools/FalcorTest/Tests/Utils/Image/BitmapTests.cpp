@@ -27,9 +27,92 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Image/Bitmap.h"
+#include "Utils/Image/ParallelImageEncoder.h"
+#include "Utils/Logger.h"
+#include "Utils/Timing/CpuTimer.h"
+#include <cmath>
+#include <cstring>
+#include <random>
 
 namespace Falcor
 {
+namespace
+{
+std::vector<uint8_t> createTestImageRGBA8(uint32_t width, uint32_t height)
+{
+    // Gradients with some noise, so that both the PNG filters and the entropy coder have work to do.
+    std::mt19937 rng;
+    std::vector<uint8_t> data(width * height * 4);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            uint8_t* pPixel = &data[(y * width + x) * 4];
+            pPixel[0] = uint8_t(x * 255 / width + rng() % 4);
+            pPixel[1] = uint8_t(y * 255 / height + rng() % 4);
+            pPixel[2] = uint8_t((x ^ y) & 0xff);
+            pPixel[3] = uint8_t(255 - (x + y) % 256);
+        }
+    }
+    return data;
+}
+
+std::vector<float> createTestImageRGBA32F(uint32_t width, uint32_t height)
+{
+    std::vector<float> data(width * height * 4);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            float* pPixel = &data[(y * width + x) * 4];
+            pPixel[0] = std::sin(x * 0.01f) * 8.f;
+            pPixel[1] = y / (float)height;
+            pPixel[2] = (x + y) * 0.125f;
+            pPixel[3] = x / (float)width;
+        }
+    }
+    return data;
+}
+
+struct DecodeTestFile
+{
+    const char* name;
+    Bitmap::FileFormat fileFormat;
+    Bitmap::ExportFlags exportFlags;
+    ResourceFormat format;
+    ResourceFormat decodedFormat;
+};
+
+// Files covering the decoder output formats: 32bpp and 24bpp (expanded to BGRX) 8-bit images,
+// half RGBA and RGB (expanded to RGBA) EXR images, and float RGB PFM images.
+const DecodeTestFile kDecodeTestFiles[] = {
+    {"png_rgba", Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::ExportAlpha, ResourceFormat::RGBA8Unorm, ResourceFormat::BGRA8Unorm},
+    {"png_rgb", Bitmap::FileFormat::PngFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA8Unorm, ResourceFormat::BGRX8Unorm},
+    {"exr_rgba", Bitmap::FileFormat::ExrFile, Bitmap::ExportFlags::ExportAlpha, ResourceFormat::RGBA32Float, ResourceFormat::RGBA32Float},
+    {"exr_rgb", Bitmap::FileFormat::ExrFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA32Float, ResourceFormat::RGBA32Float},
+    {"pfm_rgb", Bitmap::FileFormat::PfmFile, Bitmap::ExportFlags::None, ResourceFormat::RGBA32Float, ResourceFormat::RGBA32Float},
+};
+
+std::filesystem::path writeDecodeTestFile(const DecodeTestFile& file, uint32_t width, uint32_t height)
+{
+    const char* ext = file.fileFormat == Bitmap::FileFormat::PngFile   ? "png"
+                      : file.fileFormat == Bitmap::FileFormat::ExrFile ? "exr"
+                                                                       : "pfm";
+    auto path = getRuntimeDirectory() / fmt::format("test_decode_{}.{}", file.name, ext);
+    if (file.format == ResourceFormat::RGBA8Unorm)
+    {
+        auto data = createTestImageRGBA8(width, height);
+        Bitmap::saveImage(path, width, height, file.fileFormat, file.exportFlags, file.format, true, data.data());
+    }
+    else
+    {
+        auto data = createTestImageRGBA32F(width, height);
+        Bitmap::saveImage(path, width, height, file.fileFormat, file.exportFlags, file.format, true, data.data());
+    }
+    return path;
+}
+} // namespace
+
 GPU_TEST(Bitmap_LinearRamp_PNG)
 {
     const auto path = getRuntimeDirectory() / "test_linear_ramp.png";
@@ -74,4 +157,319 @@ GPU_TEST(Bitmap_LinearRamp_PNG)
     // Delete the test file.
     std::filesystem::remove(path);
 }
+
+CPU_TEST(Bitmap_ParallelEncoder_PNG)
+{
+    const auto path = getRuntimeDirectory() / "test_parallel_encoder.png";
+    const uint32_t width = 301;
+    const uint32_t height = 257;
+    std::vector<uint8_t> data = createTestImageRGBA8(width, height);
+
+    struct TestCase
+    {
+        ResourceFormat format;
+        Bitmap::ExportFlags flags;
+        bool isTopDown;
+    };
+    const TestCase testCases[] = {
+        {ResourceFormat::RGBA8Unorm, Bitmap::ExportFlags::ExportAlpha, true},
+        {ResourceFormat::RGBA8Unorm, Bitmap::ExportFlags::None, false},
+        {ResourceFormat::BGRA8Unorm, Bitmap::ExportFlags::ExportAlpha | Bitmap::compressionLevel(1), true},
+        {ResourceFormat::BGRA8UnormSrgb, Bitmap::ExportFlags::Uncompressed, true},
+    };
+
+    for (const auto& testCase : testCases)
+    {
+        Bitmap::saveImage(
+            path, width, height, Bitmap::FileFormat::PngFile, testCase.flags, testCase.format, testCase.isTopDown, data.data()
+        );
+
+        auto bmp = Bitmap::createFromFile(path, true /* top-down */);
+        EXPECT(bmp != nullptr);
+        if (!bmp)
+            continue;
+
+        EXPECT_EQ(bmp->getWidth(), width);
+        EXPECT_EQ(bmp->getHeight(), height);
+        bool isBGRA = testCase.format != ResourceFormat::RGBA8Unorm;
+        bool exportAlpha = is_set(testCase.flags, Bitmap::ExportFlags::ExportAlpha);
+
+        // Loaded images are BGRA (or BGRX) with 4 bytes per pixel.
+        uint32_t mismatches = 0;
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const uint8_t* pSrc = &data[((testCase.isTopDown ? y : height - 1 - y) * width + x) * 4];
+                const uint8_t* pDst = bmp->getData() + y * bmp->getRowPitch() + x * 4;
+                uint8_t r = isBGRA ? pSrc[2] : pSrc[0];
+                uint8_t b = isBGRA ? pSrc[0] : pSrc[2];
+                if (pDst[0] != b || pDst[1] != pSrc[1] || pDst[2] != r || (exportAlpha && pDst[3] != pSrc[3]))
+                    mismatches++;
+            }
+        }
+        EXPECT_EQ(mismatches, 0);
+    }
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(Bitmap_ParallelEncoder_EXR)
+{
+    const auto path = getRuntimeDirectory() / "test_parallel_encoder.exr";
+    const uint32_t width = 203;
+    const uint32_t height = 99;
+    std::vector<float> data = createTestImageRGBA32F(width, height);
+
+    // Default flags write half-float data with PIZ compression (FreeImage), ExrZip selects the parallel ZIP encoder.
+    // Uncompressed files store full floats.
+    for (auto flags :
+         {Bitmap::ExportFlags::ExportAlpha,
+          Bitmap::ExportFlags::ExportAlpha | Bitmap::ExportFlags::ExrZip,
+          Bitmap::ExportFlags::ExportAlpha | Bitmap::ExportFlags::ExrZip | Bitmap::compressionLevel(9),
+          Bitmap::ExportFlags::ExportAlpha | Bitmap::ExportFlags::Uncompressed})
+    {
+        Bitmap::saveImage(path, width, height, Bitmap::FileFormat::ExrFile, flags, ResourceFormat::RGBA32Float, true, data.data());
+
+        auto bmp = Bitmap::createFromFile(path, true /* top-down */);
+        EXPECT(bmp != nullptr);
+        if (!bmp)
+            continue;
+
+        EXPECT_EQ(bmp->getWidth(), width);
+        EXPECT_EQ(bmp->getHeight(), height);
+        EXPECT_EQ((uint32_t)bmp->getFormat(), (uint32_t)ResourceFormat::RGBA32Float);
+
+        const bool isHalf = !is_set(flags, Bitmap::ExportFlags::Uncompressed);
+        const float* pLoaded = reinterpret_cast<const float*>(bmp->getData());
+        float maxError = 0.f;
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            float tolerance = isHalf ? std::abs(data[i]) * 1e-3f + 1e-4f : 0.f;
+            maxError = std::max(maxError, std::abs(pLoaded[i] - data[i]) - tolerance);
+        }
+        EXPECT_LE(maxError, 0.f);
+    }
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(Bitmap_SaveImageBenchmark, TAGS("benchmark"))
+{
+    const uint32_t width = 3840;
+    const uint32_t height = 2160;
+    const auto pngPath = getRuntimeDirectory() / "test_save_benchmark.png";
+    const auto exrPath = getRuntimeDirectory() / "test_save_benchmark.exr";
+    std::vector<uint8_t> ldrData = createTestImageRGBA8(width, height);
+    std::vector<float> hdrData = createTestImageRGBA32F(width, height);
+
+    auto measure = [&](const std::string& name, size_t bytes, const std::filesystem::path& path, auto&& save)
+    {
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        save();
+        double ms = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+        logInfo(
+            "{}: {:.1f} ms, {:.1f} MB/s, {:.1f} MB file", name, ms, bytes / (ms * 1000.0), std::filesystem::file_size(path) / 1e6
+        );
+        std::filesystem::remove(path);
+    };
+
+    // The single-threaded encoders write the same files as the parallel ones from one deflate stream, like libpng.
+    for (uint32_t level : {1, 6})
+    {
+        for (bool parallel : {false, true})
+        {
+            ParallelImageEncoder::Options options;
+            options.compressionLevel = level;
+            options.parallel = parallel;
+            measure(
+                fmt::format("PNG level {} {}", level, parallel ? "parallel" : "serial"),
+                ldrData.size(),
+                pngPath,
+                [&] { ParallelImageEncoder::writePng(pngPath, width, height, ldrData.data(), false, true, true, options); }
+            );
+        }
+    }
+
+    for (bool parallel : {false, true})
+    {
+        ParallelImageEncoder::Options options;
+        options.parallel = parallel;
+        measure(
+            fmt::format("EXR half ZIP {}", parallel ? "parallel" : "serial"),
+            hdrData.size() * sizeof(float),
+            exrPath,
+            [&]
+            {
+                ParallelImageEncoder::writeExr(
+                    exrPath,
+                    width,
+                    height,
+                    hdrData.data(),
+                    4,
+                    true,
+                    ParallelImageEncoder::ExrPixelType::Half,
+                    ParallelImageEncoder::ExrCompression::Zip,
+                    options
+                );
+            }
+        );
+    }
+
+    // Reference: the FreeImage encoder that was used for all EXR files before (half, PIZ).
+    measure(
+        "EXR half PIZ (FreeImage)",
+        hdrData.size() * sizeof(float),
+        exrPath,
+        [&]
+        {
+            Bitmap::saveImage(
+                exrPath,
+                width,
+                height,
+                Bitmap::FileFormat::ExrFile,
+                Bitmap::ExportFlags::ExportAlpha | Bitmap::ExportFlags::ExrPiz,
+                ResourceFormat::RGBA32Float,
+                true,
+                hdrData.data()
+            );
+        }
+    );
+}
+
+CPU_TEST(Bitmap_DecodeFromFile)
+{
+    const uint32_t width = 97;
+    const uint32_t height = 61;
+    const std::vector<uint8_t> srcRGBA8 = createTestImageRGBA8(width, height);
+    const std::vector<float> srcRGBA32F = createTestImageRGBA32F(width, height);
+
+    for (const auto& file : kDecodeTestFiles)
+    {
+        auto path = writeDecodeTestFile(file, width, height);
+        const bool hasAlpha = is_set(file.exportFlags, Bitmap::ExportFlags::ExportAlpha);
+        const bool isHalf = file.fileFormat == Bitmap::FileFormat::ExrFile;
+
+        for (bool isTopDown : {true, false})
+        {
+            // Decode into a caller-provided buffer with a guard region to detect overruns.
+            const uint8_t kGuard = 0xcd;
+            std::vector<uint8_t> buffer;
+            Bitmap::ImageDesc desc;
+            bool success = Bitmap::decodeFromFile(
+                path,
+                isTopDown,
+                [&](const Bitmap::ImageDesc& layout)
+                {
+                    buffer.assign(layout.size + 64, kGuard);
+                    return buffer.data();
+                },
+                &desc
+            );
+            EXPECT(success) << file.name;
+            if (!success)
+                continue;
+
+            EXPECT_EQ(desc.width, width);
+            EXPECT_EQ(desc.height, height);
+            EXPECT_EQ((uint32_t)desc.format, (uint32_t)file.decodedFormat) << file.name;
+            EXPECT_EQ(desc.rowPitch, getFormatRowPitch(file.decodedFormat, width));
+            EXPECT_EQ(desc.size, size_t(desc.rowPitch) * height);
+            EXPECT(std::all_of(buffer.begin() + desc.size, buffer.end(), [&](uint8_t v) { return v == kGuard; })) << file.name;
+            if (desc.format != file.decodedFormat)
+                continue;
+
+            // Compare against the source pixels. The test images are written top-down.
+            uint32_t mismatches = 0;
+            for (uint32_t y = 0; y < height; y++)
+            {
+                const uint32_t srcY = isTopDown ? y : height - 1 - y;
+                const uint8_t* pRow = buffer.data() + size_t(y) * desc.rowPitch;
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    if (file.format == ResourceFormat::RGBA8Unorm)
+                    {
+                        // Decoded 8-bit images are BGRA (or BGRX with opaque alpha).
+                        const uint8_t* pSrc = &srcRGBA8[(srcY * width + x) * 4];
+                        const uint8_t* pDst = pRow + x * 4;
+                        uint8_t a = hasAlpha ? pSrc[3] : 0xff;
+                        if (pDst[0] != pSrc[2] || pDst[1] != pSrc[1] || pDst[2] != pSrc[0] || pDst[3] != a)
+                            mismatches++;
+                    }
+                    else
+                    {
+                        // RGB images are expanded to RGBA with an alpha of one. EXR files store half floats.
+                        const float* pSrc = &srcRGBA32F[(srcY * width + x) * 4];
+                        const float* pDst = reinterpret_cast<const float*>(pRow) + x * 4;
+                        for (uint32_t c = 0; c < 4; c++)
+                        {
+                            float expected = c < 3 || hasAlpha ? pSrc[c] : 1.f;
+                            float tolerance = isHalf ? std::abs(expected) * 1e-3f + 1e-4f : 0.f;
+                            if (!(std::abs(pDst[c] - expected) <= tolerance))
+                                mismatches++;
+                        }
+                    }
+                }
+            }
+            EXPECT_EQ(mismatches, 0) << file.name << (isTopDown ? " top-down" : " bottom-up");
+        }
+
+        // Returning nullptr from the allocation callback cancels decoding.
+        EXPECT(!Bitmap::decodeFromFile(path, true, [](const Bitmap::ImageDesc&) { return nullptr; }));
+
+        std::filesystem::remove(path);
+    }
+}
+
+CPU_TEST(Bitmap_DecodeBenchmark, TAGS("benchmark"))
+{
+    const uint32_t width = 2048;
+    const uint32_t height = 2048;
+    const uint32_t iterations = 4;
+
+    for (const auto& file : kDecodeTestFiles)
+    {
+        auto path = writeDecodeTestFile(file, width, height);
+
+        // Allocating a new bitmap per image.
+        size_t size = 0;
+        auto startTime = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            auto pBitmap = Bitmap::createFromFile(path, true);
+            size = pBitmap ? pBitmap->getSize() : 0;
+        }
+        double createMs = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) / iterations;
+
+        // Decoding into a reused buffer, as done with pooled staging memory.
+        std::vector<uint8_t> pool;
+        startTime = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < iterations; i++)
+        {
+            Bitmap::decodeFromFile(
+                path,
+                true,
+                [&](const Bitmap::ImageDesc& desc)
+                {
+                    if (pool.size() < desc.size)
+                        pool.resize(desc.size);
+                    return pool.data();
+                }
+            );
+        }
+        double decodeMs = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint()) / iterations;
+
+        logInfo(
+            "{}: createFromFile {:.1f} ms ({:.1f} MB/s), decodeFromFile into pooled memory {:.1f} ms ({:.1f} MB/s)",
+            file.name,
+            createMs,
+            size / (createMs * 1000.0),
+            decodeMs,
+            size / (decodeMs * 1000.0)
+        );
+        EXPECT_GT(size, 0);
+
+        std::filesystem::remove(path);
+    }
+}
 } // namespace Falcor
@@ -0,0 +1,131 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/CompressedTextureCache.h"
+#include "Utils/Math/Float16.h"
+#include <cstdlib>
+
+namespace Falcor
+{
+CPU_TEST(CompressedTextureCache_ChooseCompressionMode)
+{
+    std::vector<uint8_t> data(16 * 16 * 16, 0);
+    auto choose = [&](uint32_t width, uint32_t height, ResourceFormat format)
+    { return CompressedTextureCache::chooseCompressionMode(*Bitmap::create(width, height, format, data.data())); };
+
+    EXPECT(choose(16, 16, ResourceFormat::RGBA8Unorm) == ImageIO::CompressionMode::BC7);
+    EXPECT(choose(16, 16, ResourceFormat::BGRA8Unorm) == ImageIO::CompressionMode::BC7);
+    EXPECT(choose(16, 16, ResourceFormat::R8Unorm) == ImageIO::CompressionMode::BC4);
+    EXPECT(choose(16, 16, ResourceFormat::RG8Unorm) == ImageIO::CompressionMode::BC5);
+    EXPECT(choose(16, 16, ResourceFormat::RGB32Float) == ImageIO::CompressionMode::BC6);
+    EXPECT(choose(16, 16, ResourceFormat::RGBA32Float) == ImageIO::CompressionMode::None);
+    EXPECT(choose(16, 16, ResourceFormat::RGBA16Float) == ImageIO::CompressionMode::None);
+    EXPECT(choose(16, 16, ResourceFormat::R32Float) == ImageIO::CompressionMode::None);
+    EXPECT(choose(16, 16, ResourceFormat::RGBA16Unorm) == ImageIO::CompressionMode::None);
+    EXPECT(choose(6, 16, ResourceFormat::RGBA8Unorm) == ImageIO::CompressionMode::None);
+    EXPECT(choose(16, 6, ResourceFormat::RGBA8Unorm) == ImageIO::CompressionMode::None);
+
+    // BC6 has no alpha channel, floating-point RGBA images are only compressed if the alpha is 1 everywhere.
+    std::vector<float> rgba32(16 * 16 * 4, 0.5f);
+    for (size_t i = 3; i < rgba32.size(); i += 4)
+        rgba32[i] = 1.f;
+    auto pRGBA32 = Bitmap::create(16, 16, ResourceFormat::RGBA32Float, reinterpret_cast<const uint8_t*>(rgba32.data()));
+    EXPECT(CompressedTextureCache::chooseCompressionMode(*pRGBA32) == ImageIO::CompressionMode::BC6);
+    rgba32[4 * 100 + 3] = 0.5f;
+    pRGBA32 = Bitmap::create(16, 16, ResourceFormat::RGBA32Float, reinterpret_cast<const uint8_t*>(rgba32.data()));
+    EXPECT(CompressedTextureCache::chooseCompressionMode(*pRGBA32) == ImageIO::CompressionMode::None);
+
+    std::vector<uint16_t> rgba16(16 * 16 * 4, math::float32ToFloat16(0.5f));
+    for (size_t i = 3; i < rgba16.size(); i += 4)
+        rgba16[i] = math::float32ToFloat16(1.f);
+    auto pRGBA16 = Bitmap::create(16, 16, ResourceFormat::RGBA16Float, reinterpret_cast<const uint8_t*>(rgba16.data()));
+    EXPECT(CompressedTextureCache::chooseCompressionMode(*pRGBA16) == ImageIO::CompressionMode::BC6);
+    rgba16[4 * 255 + 3] = math::float32ToFloat16(0.f);
+    pRGBA16 = Bitmap::create(16, 16, ResourceFormat::RGBA16Float, reinterpret_cast<const uint8_t*>(rgba16.data()));
+    EXPECT(CompressedTextureCache::chooseCompressionMode(*pRGBA16) == ImageIO::CompressionMode::None);
+}
+
+CPU_TEST(CompressedTextureCache_SingleChannelBC4)
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "FalcorTest" / "CompressedTextureCache";
+    std::filesystem::create_directories(directory);
+
+    // Single channel images are stored in the red channel of a BC4 texture.
+    const uint32_t width = 16;
+    const uint32_t height = 8;
+    std::vector<uint8_t> data(width * height);
+    for (uint32_t i = 0; i < data.size(); ++i)
+        data[i] = uint8_t(i * 2);
+    auto pBitmap = Bitmap::create(width, height, ResourceFormat::R8Unorm, data.data());
+    ASSERT(CompressedTextureCache::chooseCompressionMode(*pBitmap) == ImageIO::CompressionMode::BC4);
+
+    std::filesystem::path path = directory / "single_channel.dds";
+    ImageIO::saveToDDS(path, *pBitmap, ImageIO::CompressionMode::BC4, false);
+    auto pLoaded = ImageIO::loadBitmapFromDDS(path);
+    ASSERT(pLoaded != nullptr);
+    EXPECT(pLoaded->getFormat() == ResourceFormat::BC4Unorm);
+    EXPECT_EQ(pLoaded->getWidth(), width);
+    EXPECT_EQ(pLoaded->getHeight(), height);
+
+    // Each 8 byte block starts with its two red endpoints, which bracket the values of the 4x4 block.
+    const uint8_t* pBlock = pLoaded->getData();
+    EXPECT_LE(std::abs(int(std::max(pBlock[0], pBlock[1])) - int(data[3 * width + 3])), 4);
+    EXPECT_LE(int(std::min(pBlock[0], pBlock[1])), 4);
+
+    std::filesystem::remove(path);
+}
+
+CPU_TEST(CompressedTextureCache_GetOrCreate)
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "FalcorTest" / "CompressedTextureCache";
+    std::filesystem::remove_all(directory);
+
+    CompressedTextureCache cache(directory);
+    EXPECT(cache.getDirectory() == directory);
+
+    // 4x4 image is transcoded and the cache entry is reused on subsequent requests.
+    std::filesystem::path path = getRuntimeDirectory() / "data/tests/tiny_mip0.png";
+    std::filesystem::path cachedPath = cache.getOrCreate(path, true, false);
+    ASSERT(!cachedPath.empty());
+    EXPECT(std::filesystem::exists(cachedPath));
+    EXPECT(cachedPath.extension() == ".dds");
+    EXPECT(cache.getOrCreate(path, true, false) == cachedPath);
+
+    // Different load parameters use a separate cache entry.
+    std::filesystem::path cachedPathNoMips = cache.getOrCreate(path, false, false);
+    EXPECT(!cachedPathNoMips.empty());
+    EXPECT(cachedPathNoMips != cachedPath);
+
+    // 2x2 image can't be block-compressed.
+    std::filesystem::path smallPath = getRuntimeDirectory() / "data/tests/tiny_mip1.png";
+    EXPECT(cache.getOrCreate(smallPath, false, false).empty());
+    EXPECT(cache.getOrCreate(smallPath, false, false).empty());
+
+    std::filesystem::remove_all(directory);
+}
+} // namespace Falcor
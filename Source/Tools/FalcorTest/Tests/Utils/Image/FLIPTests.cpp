@@ -0,0 +1,112 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/FLIP.h"
+#include "Utils/Color/ColorHelpers.slang"
+#include <cmath>
+#include <random>
+
+namespace Falcor
+{
+namespace
+{
+const uint32_t kWidth = 64;
+const uint32_t kHeight = 48;
+
+std::vector<float> createConstantImage(float value)
+{
+    std::vector<float> data(kWidth * kHeight * 4, value);
+    for (size_t i = 3; i < data.size(); i += 4)
+        data[i] = 1.f;
+    return data;
+}
+} // namespace
+
+CPU_TEST(FLIP_ConstantImages)
+{
+    FLIP flip;
+    auto black = createConstantImage(0.f);
+    auto white = createConstantImage(1.f);
+
+    // Constant images have no features, so the error is the normalized HyAB distance of the colors.
+    // Black vs. white: HyAB = 100, 100^0.7 = 25.12 is above the perceptual cutoff 0.4 * 41.27 = 16.51,
+    // giving 0.95 + (25.12 - 16.51) / (41.27 - 16.51) * 0.05 = 0.9674.
+    std::vector<float> errorMap(kWidth * kHeight);
+    double error = flip.compare({black.data()}, {white.data()}, kWidth, kHeight, errorMap.data());
+    EXPECT_LE(std::abs(error - 0.9674), 1e-3);
+
+    double sum = 0.0;
+    for (float e : errorMap)
+        sum += e;
+    EXPECT_LE(std::abs(sum / errorMap.size() - error), 1e-6);
+
+    EXPECT_EQ(flip.compare({white.data()}, {white.data()}, kWidth, kHeight), 0.0);
+}
+
+CPU_TEST(FLIP_SrgbInput)
+{
+    FLIP flip;
+    auto black = createConstantImage(0.f);
+    auto gray = createConstantImage(128.f / 255.f);
+    auto grayLinear = createConstantImage(sRGBToLinear(128.f / 255.f));
+
+    // sRGB 128 is linear 0.2158 with L = 53.59, 53.59^0.7 = 16.23 is below the cutoff, giving 16.23 * 0.95 / 16.51 = 0.9339.
+    double srgbError = flip.compare({black.data(), true}, {gray.data(), true}, kWidth, kHeight);
+    double linearError = flip.compare({black.data()}, {grayLinear.data()}, kWidth, kHeight);
+    EXPECT_LE(std::abs(srgbError - 0.9339), 1e-3);
+    EXPECT_LE(std::abs(srgbError - linearError), 1e-5);
+
+    // Treating the sRGB values as linear overestimates the difference.
+    double unconvertedError = flip.compare({black.data()}, {gray.data()}, kWidth, kHeight);
+    EXPECT_GT(unconvertedError - srgbError, 0.02);
+}
+
+CPU_TEST(FLIP_SrgbNoise)
+{
+    // Linearizing sRGB inputs inside FLIP has to match passing linear inputs, also with features present.
+    std::mt19937 rng;
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<float> images[2], imagesLinear[2];
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        images[i].resize(kWidth * kHeight * 4);
+        imagesLinear[i].resize(kWidth * kHeight * 4);
+        for (size_t j = 0; j < images[i].size(); ++j)
+        {
+            images[i][j] = dist(rng) / 255.f;
+            imagesLinear[i][j] = sRGBToLinear(images[i][j]);
+        }
+    }
+
+    FLIP flip;
+    double srgbError = flip.compare({images[0].data(), true}, {images[1].data(), true}, kWidth, kHeight);
+    double linearError = flip.compare({imagesLinear[0].data()}, {imagesLinear[1].data()}, kWidth, kHeight);
+    EXPECT_GT(srgbError, 0.0);
+    EXPECT_LE(std::abs(srgbError - linearError), 1e-4);
+}
+} // namespace Falcor
@@ -0,0 +1,121 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/MipChainGenerator.h"
+
+namespace Falcor
+{
+namespace
+{
+Bitmap::UniqueConstPtr createGradient(uint32_t width, uint32_t height)
+{
+    std::vector<uint8_t> data(width * height * 4);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            uint8_t* pTexel = &data[(y * width + x) * 4];
+            pTexel[0] = (uint8_t)(x * 30);
+            pTexel[1] = (uint8_t)(y * 60);
+            pTexel[2] = 7;
+            pTexel[3] = 255;
+        }
+    }
+    return Bitmap::create(width, height, ResourceFormat::RGBA8Unorm, data.data());
+}
+} // namespace
+
+CPU_TEST(MipChainGenerator_Box)
+{
+    auto pBitmap = createGradient(8, 4);
+
+    TextureAnalyzer::Result result;
+    auto mips = MipChainGenerator::generate(*pBitmap, MipChainGenerator::Filter::Box, false, &result);
+    ASSERT_EQ(mips.size(), 3);
+    EXPECT_EQ(mips[0]->getWidth(), 4);
+    EXPECT_EQ(mips[0]->getHeight(), 2);
+    EXPECT_EQ(mips[1]->getWidth(), 2);
+    EXPECT_EQ(mips[1]->getHeight(), 1);
+    EXPECT_EQ(mips[2]->getWidth(), 1);
+    EXPECT_EQ(mips[2]->getHeight(), 1);
+    for (const auto& pMip : mips)
+        EXPECT(pMip->getFormat() == ResourceFormat::RGBA8Unorm);
+
+    // Box filtering averages 2x2 texels of the previous level.
+    const uint8_t* pMip1 = mips[0]->getData();
+    EXPECT_EQ(pMip1[0], 15);
+    EXPECT_EQ(pMip1[1], 30);
+    EXPECT_EQ(pMip1[2], 7);
+    EXPECT_EQ(pMip1[3], 255);
+    EXPECT_EQ(pMip1[4 * 4 + 1], 150);
+    const uint8_t* pMip3 = mips[2]->getData();
+    EXPECT_EQ(pMip3[0], 105);
+    EXPECT_EQ(pMip3[1], 90);
+
+    // The analysis of the base level is computed in the same pass.
+    EXPECT_EQ(result.mask, 0x00011113u);
+    EXPECT(result.isConstant(TextureChannelFlags::Blue | TextureChannelFlags::Alpha));
+    EXPECT_EQ(result.maxValue.x, 210 / 255.f);
+    EXPECT_EQ(result.maxValue.y, 180 / 255.f);
+}
+
+CPU_TEST(MipChainGenerator_Srgb)
+{
+    // Averaging black and white in linear space gives a brighter sRGB value than averaging the encoded values.
+    std::vector<uint8_t> data = {0, 0, 0, 255, 255, 255, 255, 255};
+    auto pBitmap = Bitmap::create(2, 1, ResourceFormat::RGBA8Unorm, data.data());
+
+    auto linearMips = MipChainGenerator::generate(*pBitmap, MipChainGenerator::Filter::Box, false);
+    auto srgbMips = MipChainGenerator::generate(*pBitmap, MipChainGenerator::Filter::Box, true);
+    ASSERT_EQ(linearMips.size(), 1);
+    ASSERT_EQ(srgbMips.size(), 1);
+    EXPECT_EQ(linearMips[0]->getData()[0], 128);
+    EXPECT_EQ(srgbMips[0]->getData()[0], 188);
+    EXPECT_EQ(srgbMips[0]->getData()[3], 255);
+}
+
+CPU_TEST(MipChainGenerator_Kaiser)
+{
+    // A constant image stays constant, including non-power-of-two sizes.
+    std::vector<float> data(7 * 5, 0.5f);
+    auto pBitmap = Bitmap::create(7, 5, ResourceFormat::R32Float, reinterpret_cast<const uint8_t*>(data.data()));
+
+    auto mips = MipChainGenerator::generate(*pBitmap, MipChainGenerator::Filter::Kaiser, false);
+    ASSERT_EQ(mips.size(), 2);
+    EXPECT_EQ(mips[0]->getWidth(), 3);
+    EXPECT_EQ(mips[0]->getHeight(), 2);
+    EXPECT_EQ(mips[1]->getWidth(), 1);
+    EXPECT_EQ(mips[1]->getHeight(), 1);
+    for (const auto& pMip : mips)
+    {
+        const float* pData = reinterpret_cast<const float*>(pMip->getData());
+        for (uint32_t i = 0; i < pMip->getWidth() * pMip->getHeight(); i++)
+            EXPECT_LE(std::abs(pData[i] - 0.5f), 1e-6f) << "i = " << i;
+    }
+}
+} // namespace Falcor
@@ -27,9 +27,39 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Image/TextureManager.h"
+#include "Utils/Image/ImageIO.h"
+#include <fstream>
 
 namespace Falcor
 {
+CPU_TEST(TextureManager_DirectoryListings)
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "FalcorTest" / "TextureManagerDirectoryListings";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory / "subdir");
+    std::ofstream(directory / "b.1002.png").close();
+    std::ofstream(directory / "b.1001.png").close();
+    std::ofstream(directory / "a.txt").close();
+
+    // Listings contain regular files only, sorted by name.
+    TextureManager::DirectoryListings listings;
+    const auto& listing = listings.get(directory);
+    ASSERT_EQ(listing.size(), 3);
+    EXPECT_EQ(listing[0], "a.txt");
+    EXPECT_EQ(listing[1], "b.1001.png");
+    EXPECT_EQ(listing[2], "b.1002.png");
+
+    // Listings are kept for the lifetime of the cache, a new cache sees the new files.
+    std::ofstream(directory / "b.1003.png").close();
+    EXPECT_EQ(listings.get(directory).size(), 3);
+    EXPECT_EQ(TextureManager::DirectoryListings().get(directory).size(), 4);
+
+    // Missing directories give empty listings.
+    EXPECT(listings.get(directory / "missing").empty());
+
+    std::filesystem::remove_all(directory);
+}
+
 GPU_TEST(TextureManager_LoadMips)
 {
     ref<Device> pDevice = ctx.getDevice();
@@ -51,4 +81,67 @@ GPU_TEST(TextureManager_LoadMips)
     EXPECT_EQ(tex->getMipCount(), 3);
     EXPECT_EQ(tex->getArraySize(), 1);
 }
+
+GPU_TEST(TextureManager_DeferredLoading)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    TextureManager textureManager(pDevice, 10, 2);
+
+    textureManager.beginDeferredLoading();
+    auto mippedHandle = textureManager.loadTexture(getRuntimeDirectory() / "data/tests/tiny_<MIP>.png", false, false);
+    auto generatedHandle = textureManager.loadTexture(getRuntimeDirectory() / "data/tests/tiny_mip0.png", true, false);
+    auto singleHandle = textureManager.loadTexture(getRuntimeDirectory() / "data/tests/tiny_mip1.png", false, true);
+    EXPECT(mippedHandle.isValid());
+    EXPECT(generatedHandle.isValid());
+    EXPECT(singleHandle.isValid());
+    EXPECT(textureManager.getTexture(mippedHandle) == nullptr);
+    textureManager.endDeferredLoading();
+
+    auto pMipped = textureManager.getTexture(mippedHandle);
+    ASSERT(pMipped != nullptr);
+    EXPECT_EQ(pMipped->getWidth(), 4);
+    EXPECT_EQ(pMipped->getMipCount(), 3);
+
+    auto pGenerated = textureManager.getTexture(generatedHandle);
+    ASSERT(pGenerated != nullptr);
+    EXPECT_EQ(pGenerated->getWidth(), 4);
+    EXPECT_EQ(pGenerated->getMipCount(), 3);
+
+    auto pSingle = textureManager.getTexture(singleHandle);
+    ASSERT(pSingle != nullptr);
+    EXPECT_EQ(pSingle->getWidth(), 2);
+    EXPECT_EQ(pSingle->getMipCount(), 1);
+}
+
+GPU_TEST(TextureManager_DeferredLoadingDDS)
+{
+    ref<Device> pDevice = ctx.getDevice();
+
+    TextureManager textureManager(pDevice, 10, 2);
+    textureManager.setUseCompressedTextureCache(true);
+
+    // DDS files and textures from the block-compressed texture cache are created from CPU copies of the DDS data.
+    std::filesystem::path ddsPath = getRuntimeDirectory() / "data/tests/BC7Unorm.dds";
+    textureManager.beginDeferredLoading();
+    auto ddsHandle = textureManager.loadTexture(ddsPath, false, false);
+    auto cachedHandle = textureManager.loadTexture(getRuntimeDirectory() / "data/tests/tiny_mip0.png", true, false);
+    textureManager.endDeferredLoading();
+
+    auto pExpected = ImageIO::loadTextureFromDDS(pDevice, ddsPath, false);
+    ASSERT(pExpected != nullptr);
+    auto pDDS = textureManager.getTexture(ddsHandle);
+    ASSERT(pDDS != nullptr);
+    EXPECT(pDDS->getFormat() == pExpected->getFormat());
+    EXPECT_EQ(pDDS->getWidth(), pExpected->getWidth());
+    EXPECT_EQ(pDDS->getHeight(), pExpected->getHeight());
+    EXPECT_EQ(pDDS->getMipCount(), pExpected->getMipCount());
+
+    auto pCached = textureManager.getTexture(cachedHandle);
+    ASSERT(pCached != nullptr);
+    EXPECT(pCached->getFormat() == ResourceFormat::BC7Unorm);
+    EXPECT_EQ(pCached->getWidth(), 4);
+    EXPECT_EQ(pCached->getMipCount(), 3);
+    EXPECT(pCached->getSourcePath() == getRuntimeDirectory() / "data/tests/tiny_mip0.png");
+}
 } // namespace Falcor
@@ -0,0 +1,266 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Image/TexturePageCache.h"
+#include <cstring>
+
+namespace Falcor
+{
+namespace
+{
+std::filesystem::path getTestDirectory()
+{
+    return std::filesystem::temp_directory_path() / "FalcorTest" / "TexturePageCache";
+}
+
+/// Create a RGBA8 image where each texel stores its coordinates, and write it as a tiled texture file.
+std::filesystem::path writeTestTexture(const std::string& name, uint32_t width, uint32_t height, bool generateMipLevels)
+{
+    std::vector<uint8_t> data(width * height * 4);
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            uint8_t* pTexel = &data[(y * width + x) * 4];
+            pTexel[0] = uint8_t(x);
+            pTexel[1] = uint8_t(x >> 8);
+            pTexel[2] = uint8_t(y);
+            pTexel[3] = uint8_t(y >> 8);
+        }
+    }
+
+    std::filesystem::create_directories(getTestDirectory());
+    std::filesystem::path path = getTestDirectory() / (name + ".tiles");
+    TiledTextureFile::write(path, *Bitmap::create(width, height, ResourceFormat::RGBA8Unorm, data.data()), generateMipLevels, false);
+    return path;
+}
+
+uint2 readTexel(const TiledTextureFile& file, uint32_t tileIndex, uint32_t x, uint32_t y)
+{
+    const uint8_t* pTexel = file.getTileData(tileIndex) + y * file.getTileRowPitch() + x * 4;
+    return uint2(pTexel[0] | (pTexel[1] << 8), pTexel[2] | (pTexel[3] << 8));
+}
+
+std::vector<uint32_t> getTileIndices(const std::vector<TexturePageCache::TileID>& tiles)
+{
+    std::vector<uint32_t> indices;
+    for (const auto& tile : tiles)
+        indices.push_back(tile.tileIndex);
+    return indices;
+}
+} // namespace
+
+CPU_TEST(TiledTextureFile_TileShape)
+{
+    EXPECT_EQ(TiledTextureFile::getTileShape(ResourceFormat::R8Unorm), uint2(256, 256));
+    EXPECT_EQ(TiledTextureFile::getTileShape(ResourceFormat::RGBA8Unorm), uint2(128, 128));
+    EXPECT_EQ(TiledTextureFile::getTileShape(ResourceFormat::RGBA16Float), uint2(128, 64));
+    EXPECT_EQ(TiledTextureFile::getTileShape(ResourceFormat::RGBA32Float), uint2(64, 64));
+    EXPECT_EQ(TiledTextureFile::getTileShape(ResourceFormat::BC1Unorm), uint2(512, 256));
+    EXPECT_EQ(TiledTextureFile::getTileShape(ResourceFormat::BC7Unorm), uint2(256, 256));
+    EXPECT(!TiledTextureFile::isFormatSupported(ResourceFormat::RGB32Float));
+    EXPECT(!TiledTextureFile::isFormatSupported(ResourceFormat::D32Float));
+}
+
+CPU_TEST(TiledTextureFile_RoundTrip)
+{
+    std::filesystem::path path = writeTestTexture("RoundTrip", 300, 200, false);
+    {
+        TiledTextureFile file(path);
+        EXPECT(file.getFormat() == ResourceFormat::RGBA8Unorm);
+        EXPECT_EQ(file.getWidth(), 300);
+        EXPECT_EQ(file.getHeight(), 200);
+        EXPECT_EQ(file.getMipCount(), 1);
+        EXPECT_EQ(file.getMipInfo(0).tilesX, 3);
+        EXPECT_EQ(file.getMipInfo(0).tilesY, 2);
+        EXPECT_EQ(file.getTileCount(), 6);
+        EXPECT_EQ(file.getTileRowPitch(), 128 * 4);
+
+        // Interior texels.
+        EXPECT_EQ(readTexel(file, file.getTileIndex(0, 0, 0), 5, 7), uint2(5, 7));
+        EXPECT_EQ(readTexel(file, file.getTileIndex(0, 1, 1), 10, 20), uint2(138, 148));
+
+        // Texels past the right and bottom edges replicate the edge texels.
+        uint32_t cornerTile = file.getTileIndex(0, 2, 1);
+        EXPECT_EQ(readTexel(file, cornerTile, 43, 71), uint2(299, 199));
+        EXPECT_EQ(readTexel(file, cornerTile, 127, 127), uint2(299, 199));
+        EXPECT_EQ(readTexel(file, cornerTile, 10, 127), uint2(266, 199));
+        EXPECT_EQ(readTexel(file, cornerTile, 127, 10), uint2(299, 138));
+    }
+
+    // Mip chain layout.
+    path = writeTestTexture("RoundTripMips", 300, 200, true);
+    {
+        TiledTextureFile file(path);
+        EXPECT_EQ(file.getMipCount(), 9);
+        EXPECT_EQ(file.getMipInfo(1).width, 150);
+        EXPECT_EQ(file.getMipInfo(1).height, 100);
+        EXPECT_EQ(file.getMipInfo(1).firstTile, 6);
+        EXPECT_EQ(file.getMipInfo(2).firstTile, 8);
+        EXPECT_EQ(file.getTileCount(), 15);
+        EXPECT_EQ(file.getTileMip(0), 0);
+        EXPECT_EQ(file.getTileMip(5), 0);
+        EXPECT_EQ(file.getTileMip(6), 1);
+        EXPECT_EQ(file.getTileMip(14), 8);
+        EXPECT_EQ(file.getMipInfo(8).width, 1);
+        EXPECT_EQ(file.getMipInfo(8).height, 1);
+    }
+
+    // Invalid files are rejected.
+    std::filesystem::resize_file(path, 1024);
+    bool threw = false;
+    try
+    {
+        TiledTextureFile file(path);
+    }
+    catch (const RuntimeError&)
+    {
+        threw = true;
+    }
+    EXPECT(threw);
+
+    std::filesystem::remove_all(getTestDirectory());
+}
+
+CPU_TEST(TexturePageCache_LRU)
+{
+    TexturePageCache::Options options;
+    options.budgetInBytes = 3 * TiledTextureFile::kTileSizeInBytes;
+    options.directory = getTestDirectory();
+    TexturePageCache cache(options);
+    {
+        uint32_t textureID = cache.addTexture(writeTestTexture("LRU", 384, 256, false));
+        const TiledTextureFile& file = cache.getTextureFile(textureID);
+        EXPECT_EQ(file.getTileCount(), 6);
+
+        auto request = [&](std::vector<uint32_t> tileIndices)
+        {
+            std::vector<TexturePageCache::TileID> tiles;
+            for (uint32_t tileIndex : tileIndices)
+                tiles.push_back({textureID, tileIndex});
+            cache.requestTiles(tiles);
+        };
+
+        request({0, 1, 2, 1, 0});
+        auto result = cache.update();
+        EXPECT(getTileIndices(result.loadedTiles) == std::vector<uint32_t>({0, 1, 2}));
+        EXPECT(result.evictedTiles.empty());
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            const uint8_t* pData = cache.getTileData({textureID, i});
+            EXPECT(pData != nullptr);
+            if (pData)
+                EXPECT(std::memcmp(pData, file.getTileData(i), TiledTextureFile::kTileSizeInBytes) == 0);
+        }
+        EXPECT(cache.getTileData({textureID, 3}) == nullptr);
+
+        // Tile 0 is the least recently used tile.
+        request({3});
+        result = cache.update();
+        EXPECT(getTileIndices(result.loadedTiles) == std::vector<uint32_t>({3}));
+        EXPECT(getTileIndices(result.evictedTiles) == std::vector<uint32_t>({0}));
+
+        // Requesting tile 1 makes tile 2 the least recently used tile.
+        request({1, 4});
+        result = cache.update();
+        EXPECT(getTileIndices(result.loadedTiles) == std::vector<uint32_t>({4}));
+        EXPECT(getTileIndices(result.evictedTiles) == std::vector<uint32_t>({2}));
+        EXPECT(cache.isResident({textureID, 1}));
+        EXPECT(cache.isResident({textureID, 3}));
+        EXPECT(cache.isResident({textureID, 4}));
+
+        // Tiles requested in the current update are never evicted, the remaining requests stay pending.
+        request({0, 1, 2, 5});
+        result = cache.update();
+        EXPECT_EQ(result.loadedTiles.size(), 2);
+        EXPECT_EQ(result.evictedTiles.size(), 2);
+        EXPECT(cache.isResident({textureID, 1}));
+        EXPECT_EQ(cache.getStats().pendingTileCount, 1);
+
+        // Shrinking the budget evicts immediately.
+        result.evictedTiles = cache.setBudget(TiledTextureFile::kTileSizeInBytes);
+        EXPECT_EQ(result.evictedTiles.size(), 2);
+        EXPECT_EQ(cache.getStats().residentTileCount, 1);
+        EXPECT_EQ(cache.getStats().residentBytes, TiledTextureFile::kTileSizeInBytes);
+    }
+    std::filesystem::remove_all(getTestDirectory());
+}
+
+CPU_TEST(TexturePageCache_Scheduling)
+{
+    TexturePageCache::Options options;
+    options.maxLoadsPerUpdate = 2;
+    options.directory = getTestDirectory();
+    TexturePageCache cache(options);
+    {
+        uint32_t textureID = cache.addTexture(writeTestTexture("Scheduling", 300, 200, true));
+        const TiledTextureFile& file = cache.getTextureFile(textureID);
+        const std::filesystem::path path = file.getPath();
+
+        // Coarser mip levels are loaded first, and at most maxLoadsPerUpdate tiles per update.
+        const uint32_t mip0Tile = file.getTileIndex(0, 1, 1);
+        const uint32_t mip1Tile = file.getTileIndex(1, 1, 0);
+        const uint32_t mip8Tile = file.getTileIndex(8, 0, 0);
+        std::vector<TexturePageCache::TileID> tiles = {{textureID, mip0Tile}, {textureID, mip1Tile}, {textureID, mip8Tile}};
+        tiles.push_back({textureID, file.getTileCount()}); // Out of range, ignored.
+        tiles.push_back({textureID + 1, 0});               // Unknown texture, ignored.
+        cache.requestTiles(tiles);
+
+        auto result = cache.update();
+        EXPECT(getTileIndices(result.loadedTiles) == std::vector<uint32_t>({mip8Tile, mip1Tile}));
+        result = cache.update();
+        EXPECT(getTileIndices(result.loadedTiles) == std::vector<uint32_t>({mip0Tile}));
+        result = cache.update();
+        EXPECT(result.loadedTiles.empty());
+
+        // Stats count duplicate requests within an update once.
+        cache.requestTiles(tiles);
+        cache.requestTiles(tiles);
+        cache.requestTiles({{textureID, 0}});
+        auto stats = cache.getStats();
+        EXPECT_EQ(stats.requestCount, 7);
+        EXPECT_EQ(stats.hitCount, 3);
+        EXPECT_EQ(stats.missCount, 4);
+        EXPECT_EQ(stats.loadCount, 3);
+        EXPECT_EQ(stats.evictionCount, 0);
+        EXPECT_EQ(stats.pendingTileCount, 1);
+
+        // Removing the texture drops its resident and pending tiles, and the texture ID is reused.
+        cache.removeTexture(textureID);
+        stats = cache.getStats();
+        EXPECT_EQ(stats.residentTileCount, 0);
+        EXPECT_EQ(stats.pendingTileCount, 0);
+        EXPECT(cache.update().loadedTiles.empty());
+        EXPECT_EQ(cache.addTexture(path), textureID);
+
+        cache.resetStats();
+        EXPECT_EQ(cache.getStats().requestCount, 0);
+    }
+    std::filesystem::remove_all(getTestDirectory());
+}
+} // namespace Falcor
@@ -27,6 +27,7 @@
  **************************************************************************/
 #include "Testing/UnitTest.h"
 #include "Utils/Image/ImageProcessing.h"
+#include <cstring>
 
 namespace Falcor
 {
@@ -105,6 +106,26 @@ void testCopyColorChannel(
         }
     }
 }
+
+std::vector<uint8_t> generateRawTestData(ResourceFormat format, size_t pixels)
+{
+    const size_t elems = pixels * getFormatChannelCount(format);
+    std::vector<uint8_t> data(pixels * getFormatBytesPerBlock(format));
+    if (getFormatType(format) == FormatType::Float)
+    {
+        // Use finite values, bit patterns of NaNs are not necessarily preserved by the GPU.
+        if (getNumChannelBits(format, 0) == 16)
+            std::memcpy(data.data(), generateTestData<float16_t>(elems).data(), data.size());
+        else
+            std::memcpy(data.data(), generateTestData<float>(elems).data(), data.size());
+    }
+    else
+    {
+        for (size_t i = 0; i < data.size(); i++)
+            data[i] = uint8_t(i * 37 + 11);
+    }
+    return data;
+}
 } // namespace
 
 GPU_TEST(CopyColorChannel)
@@ -133,4 +154,70 @@ GPU_TEST(CopyColorChannel)
     testCopyColorChannel<int8_t>(ctx, imageProcessing, w, h, ResourceFormat::RGBA8Int, ResourceFormat::RG8Int);
     testCopyColorChannel<int8_t>(ctx, imageProcessing, w, h, ResourceFormat::RGBA8Int, ResourceFormat::R8Int);
 }
+
+GPU_TEST(ExtractColorChannel)
+{
+    ref<Device> pDevice = ctx.getDevice();
+    ImageProcessing imageProcessing(pDevice);
+    const uint32_t width = 15, height = 3;
+
+    struct TestCase
+    {
+        ResourceFormat srcFormat;
+        ResourceFormat dstFormat;
+        bool canExtract;
+    };
+    const TestCase testCases[] = {
+        {ResourceFormat::RGBA8Unorm, ResourceFormat::R8Unorm, true},
+        {ResourceFormat::RGBA8UnormSrgb, ResourceFormat::R8Unorm, false},
+        {ResourceFormat::RGBA16Unorm, ResourceFormat::R16Unorm, true},
+        {ResourceFormat::RGBA16Float, ResourceFormat::R16Float, true},
+        {ResourceFormat::RGBA32Float, ResourceFormat::R32Float, true},
+        {ResourceFormat::RGBA32Uint, ResourceFormat::R32Uint, true},
+        {ResourceFormat::RG32Float, ResourceFormat::R32Float, true},
+    };
+
+    EXPECT(!ImageProcessing::canExtractColorChannel(ResourceFormat::BGRA8UnormSrgb));
+    EXPECT(!ImageProcessing::canExtractColorChannel(ResourceFormat::BGRA8Unorm));
+    EXPECT(!ImageProcessing::canExtractColorChannel(ResourceFormat::R11G11B10Float));
+
+    for (const auto& testCase : testCases)
+    {
+        const uint32_t channels = getFormatChannelCount(testCase.srcFormat);
+        const size_t channelSize = getFormatBytesPerBlock(testCase.dstFormat);
+        EXPECT_EQ(ImageProcessing::canExtractColorChannel(testCase.srcFormat), testCase.canExtract) << to_string(testCase.srcFormat);
+
+        auto data = generateRawTestData(testCase.srcFormat, width * height);
+        auto pSrc = Texture::create2D(pDevice, width, height, testCase.srcFormat, 1, 1, data.data(), ResourceBindFlags::ShaderResource);
+        auto pDst = Texture::create2D(
+            pDevice, width, height, testCase.dstFormat, 1, 1, nullptr, ResourceBindFlags::ShaderResource | ResourceBindFlags::UnorderedAccess
+        );
+
+        for (uint32_t channel = 0; channel < channels; channel++)
+        {
+            const auto mask = TextureChannelFlags(1u << channel);
+            imageProcessing.copyColorChannel(ctx.getRenderContext(), pSrc->getSRV(), pDst->getUAV(), mask);
+            auto gpuData = ctx.getRenderContext()->readTextureSubresource(pDst.get(), 0);
+
+            if (testCase.canExtract)
+            {
+                // The CPU path must produce the same result as the GPU copy.
+                auto cpuData = ImageProcessing::extractColorChannel(data.data(), testCase.srcFormat, channel, width, height);
+                EXPECT_EQ(cpuData.size(), gpuData.size());
+                EXPECT(cpuData == gpuData) << to_string(testCase.srcFormat) << " channel=" << channel;
+            }
+            else if (channel < 3)
+            {
+                // sRGB color channels are linearized by the GPU copy, so the raw bytes differ from the result.
+                size_t rawMatches = 0;
+                for (size_t i = 0; i < (size_t)width * height; i++)
+                {
+                    const uint8_t* pRaw = &data[(i * channels + channel) * channelSize];
+                    rawMatches += std::memcmp(&gpuData[i * channelSize], pRaw, channelSize) == 0;
+                }
+                EXPECT_LT(rawMatches, (size_t)width * height) << to_string(testCase.srcFormat) << " channel=" << channel;
+            }
+        }
+    }
+}
 } // namespace Falcor
@@ -0,0 +1,169 @@
+/***************************************************************************
+ # Copyright (c) 2015-22, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "Testing/UnitTest.h"
+#include "Utils/Threading.h"
+
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace Falcor
+{
+CPU_TEST(Threading_DispatchTask)
+{
+    std::atomic<uint32_t> counter{0};
+    std::vector<Threading::Task> tasks;
+    for (uint32_t i = 0; i < 1000; ++i)
+        tasks.push_back(Threading::dispatchTask([&counter]() { counter.fetch_add(1); }));
+    for (auto& task : tasks)
+    {
+        task.finish();
+        EXPECT_FALSE(task.isRunning());
+    }
+    EXPECT_EQ(counter.load(), 1000);
+}
+
+CPU_TEST(Threading_Continuation)
+{
+    std::vector<uint32_t> order;
+    std::mutex mutex;
+    auto append = [&](uint32_t value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(value);
+    };
+
+    Threading::Task task = Threading::dispatchTask([&]() { append(0); }).then([&]() { append(1); }).then([&]() { append(2); });
+    task.finish();
+
+    ASSERT_EQ(order.size(), 3);
+    for (uint32_t i = 0; i < 3; ++i)
+        EXPECT_EQ(order[i], i);
+
+    // Continuation of an already finished task.
+    Threading::Task done = Threading::dispatchTask([]() {});
+    done.finish();
+    bool ran = false;
+    done.then([&ran]() { ran = true; }).finish();
+    EXPECT_TRUE(ran);
+}
+
+CPU_TEST(Threading_Exception)
+{
+    Threading::Task task = Threading::dispatchTask([]() { throw std::runtime_error("task failed"); });
+    bool caught = false;
+    try
+    {
+        task.finish();
+    }
+    catch (const std::runtime_error&)
+    {
+        caught = true;
+    }
+    EXPECT_TRUE(caught);
+
+    caught = false;
+    try
+    {
+        Threading::parallelFor(
+            0, 1000,
+            [](size_t i)
+            {
+                if (i == 500)
+                    throw std::runtime_error("iteration failed");
+            },
+            1
+        );
+    }
+    catch (const std::runtime_error&)
+    {
+        caught = true;
+    }
+    EXPECT_TRUE(caught);
+}
+
+CPU_TEST(Threading_ParallelFor)
+{
+    std::vector<uint32_t> values(100000, 0);
+    Threading::parallelFor(0, values.size(), [&values](size_t i) { values[i] += uint32_t(i); });
+    for (size_t i = 0; i < values.size(); ++i)
+        EXPECT_EQ(values[i], i);
+
+    // Empty range.
+    Threading::parallelFor(10, 10, [](size_t) { FALCOR_UNREACHABLE(); });
+
+    // Nested parallel loops must not deadlock.
+    std::atomic<uint32_t> counter{0};
+    Threading::parallelFor(
+        0, 64, [&counter](size_t) { Threading::parallelFor(0, 1000, [&counter](size_t) { counter.fetch_add(1); }, 10); }, 1
+    );
+    EXPECT_EQ(counter.load(), 64000);
+
+    // Waiting on tasks from within worker threads must not deadlock.
+    counter = 0;
+    Threading::parallelFor(
+        0, 64, [&counter](size_t) { Threading::dispatchTask([&counter]() { counter.fetch_add(1); }).finish(); }, 1
+    );
+    EXPECT_EQ(counter.load(), 64);
+}
+
+CPU_TEST(Threading_ParallelReduce)
+{
+    std::vector<float> values(100003);
+    for (size_t i = 0; i < values.size(); ++i)
+        values[i] = 1.f / float(i + 1);
+
+    auto sum = [&values]()
+    {
+        return Threading::parallelReduce(
+            0, values.size(), 0.f,
+            [&values](size_t begin, size_t end, float acc)
+            {
+                for (size_t i = begin; i < end; ++i)
+                    acc += values[i];
+                return acc;
+            },
+            [](float a, float b) { return a + b; }
+        );
+    };
+
+    // Floating-point reduction must be deterministic.
+    float reference = sum();
+    for (uint32_t i = 0; i < 10; ++i)
+        EXPECT_EQ(sum(), reference);
+    EXPECT_LT(std::abs(reference - std::accumulate(values.begin(), values.end(), 0.f)), 1e-3f);
+
+    uint64_t count = Threading::parallelReduce(
+        0, 12345, uint64_t(0), [](size_t begin, size_t end, uint64_t acc) { return acc + (end - begin); },
+        [](uint64_t a, uint64_t b) { return a + b; }, 100
+    );
+    EXPECT_EQ(count, 12345);
+}
+} // namespace Falcor
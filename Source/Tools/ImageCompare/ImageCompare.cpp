@@ -25,17 +25,24 @@
  # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  **************************************************************************/
+#include "Utils/Threading.h"
+#include "Utils/Image/FLIP.h"
+
 #include <FreeImage.h>
 #include <args.hxx>
+#include <nlohmann/json.hpp>
 
 #include <iostream>
+#include <fstream>
 #include <memory>
 #include <string>
 #include <vector>
 #include <stdexcept>
 #include <map>
+#include <set>
 #include <functional>
 #include <filesystem>
+#include <numeric>
 
 #include <cmath>
 #include <cstring>
@@ -67,6 +74,7 @@ public:
     uint32_t getHeight() const { return mHeight; }
     const float* getData() const { return mData.get(); }
     float* getData() { return mData.get(); }
+    bool isSrgb() const { return mIsSrgb; }
 
     static std::shared_ptr<Image> create(uint32_t width, uint32_t height) { return std::make_shared<Image>(width, height); }
 
@@ -90,6 +98,10 @@ public:
         if (!srcBitmap)
             throw std::runtime_error("Cannot read image");
 
+        // Integer formats (e.g. PNG, JPG) store sRGB encoded values, FreeImage_ConvertToRGBAF does not linearize them.
+        FREE_IMAGE_TYPE type = FreeImage_GetImageType(srcBitmap);
+        bool isSrgb = type == FIT_BITMAP || type == FIT_UINT16 || type == FIT_RGB16 || type == FIT_RGBA16;
+
         // Convert to RGBA32F.
         FIBITMAP* floatBitmap = FreeImage_ConvertToRGBAF(srcBitmap);
         FreeImage_Unload(srcBitmap);
@@ -104,6 +116,7 @@ public:
             FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, true
         );
         FreeImage_Unload(floatBitmap);
+        image->mIsSrgb = isSrgb;
 
         return image;
     }
@@ -180,77 +193,108 @@ private:
     uint32_t mWidth;
     uint32_t mHeight;
     std::unique_ptr<float[]> mData;
+    bool mIsSrgb = false; ///< True if the pixel values are sRGB encoded.
+};
+
+/// Number of image rows processed per task by the metric kernels.
+static constexpr size_t kRowsPerTask = 16;
+
+struct CompareOptions
+{
+    bool alpha = false;                                  ///< Include the alpha channel (ignored by FLIP).
+    float pixelsPerDegree = Falcor::FLIP::kDefaultPixelsPerDegree; ///< Viewing conditions for FLIP.
 };
 
 struct MSE
 {
-    double operator()(const float* a, const float* b, size_t count) const
-    {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += sqr(a[i] - b[i]);
-        return error / count;
-    }
+    static constexpr double kScale = 1.0;
+    static double error(double a, double b) { return sqr(a - b); }
 };
 
 struct RMSE
 {
-    double operator()(const float* a, const float* b, size_t count) const
-    {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += sqr(a[i] - b[i]) / (sqr(a[i]) + 1e-3);
-        return error / count;
-    }
+    static constexpr double kScale = 1.0;
+    static double error(double a, double b) { return sqr(a - b) / (sqr(a) + 1e-3); }
 };
 
 struct MAE
 {
-    double operator()(const float* a, const float* b, size_t count) const
-    {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += std::fabs(sqr(a[i] - b[i]));
-        return error / count;
-    }
+    static constexpr double kScale = 1.0;
+    static double error(double a, double b) { return std::fabs(sqr(a - b)); }
 };
 
 struct MAPE
 {
-    double operator()(const float* a, const float* b, size_t count) const
-    {
-        double error = 0.0;
-        for (size_t i = 0; i < count; ++i)
-            error += std::fabs((a[i] - b[i]) / (a[i] + 1e-3));
-        return 100.0 * error / count;
-    }
+    static constexpr double kScale = 100.0;
+    static double error(double a, double b) { return std::fabs((a - b) / (a + 1e-3)); }
 };
 
-template<typename Metric>
-double compare(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)
+/**
+ * Computes the per-pixel error of one image row and returns the row sum.
+ * Errors are computed and summed in double precision. The per-pixel error is only stored if an error map is requested.
+ */
+template<typename Metric, uint32_t kChannels>
+double computeRowError(const float* a, const float* b, uint32_t width, float* errorRow)
 {
-    Metric metric;
     double sum = 0.0;
-    const float* a = imageA.getData();
-    const float* b = imageB.getData();
-    size_t count = imageA.getWidth() * imageA.getHeight();
-    for (size_t i = 0; i < count; ++i)
+    for (uint32_t x = 0; x < width; ++x)
     {
-        double error = metric(a, b, alpha ? 4 : 3);
-        if (errorMap)
-            *errorMap++ = float(error);
+        double error = 0.0;
+        for (uint32_t c = 0; c < kChannels; ++c)
+            error += Metric::error(a[4 * x + c], b[4 * x + c]);
+        error = Metric::kScale * error / kChannels;
+        if (errorRow)
+            errorRow[x] = float(error);
         sum += error;
-        a += 4;
-        b += 4;
     }
+    return sum;
+}
+
+template<typename Metric>
+double compare(const Image& imageA, const Image& imageB, const CompareOptions& options, float* errorMap)
+{
+    const uint32_t width = imageA.getWidth();
+    const uint32_t height = imageA.getHeight();
+    const size_t count = size_t(width) * height;
+    if (count == 0)
+        return 0.0;
+
+    // Each task processes a tile of rows and optionally writes the per-pixel error into the error map.
+    double sum = Falcor::Threading::parallelReduce(
+        0, height, 0.0,
+        [&](size_t rowBegin, size_t rowEnd, double tileSum)
+        {
+            for (size_t y = rowBegin; y < rowEnd; ++y)
+            {
+                const float* a = imageA.getData() + y * width * 4;
+                const float* b = imageB.getData() + y * width * 4;
+                float* errorRow = errorMap ? errorMap + y * width : nullptr;
+                if (options.alpha)
+                    tileSum += computeRowError<Metric, 4>(a, b, width, errorRow);
+                else
+                    tileSum += computeRowError<Metric, 3>(a, b, width, errorRow);
+            }
+            return tileSum;
+        },
+        std::plus<double>(), kRowsPerTask
+    );
+
     return sum / count;
 }
 
+static double compareFLIP(const Image& imageA, const Image& imageB, const CompareOptions& options, float* errorMap)
+{
+    return Falcor::FLIP(options.pixelsPerDegree)
+        .compare(
+            {imageA.getData(), imageA.isSrgb()}, {imageB.getData(), imageB.isSrgb()}, imageA.getWidth(), imageA.getHeight(), errorMap
+        );
+}
+
 struct ErrorMetric
 {
     std::string name;
     std::string desc;
-    std::function<double(const Image& imageA, const Image& imageB, bool alpha, float* errorMap)> compare;
+    std::function<double(const Image& imageA, const Image& imageB, const CompareOptions& options, float* errorMap)> compare;
 };
 
 static const std::vector<ErrorMetric> errorMetrics = {
@@ -258,6 +302,7 @@ static const std::vector<ErrorMetric> errorMetrics = {
     {"rmse", "Relative Mean Squared Error", compare<RMSE>},
     {"mae", "Mean Absolute Error", compare<MAE>},
     {"mape", "Mean Absolute Percentage Error", compare<MAPE>},
+    {"flip", "Mean LDR-FLIP Error", compareFLIP},
 };
 
 static std::shared_ptr<Image> generateHeatMap(uint32_t width, uint32_t height, const float* errorMap)
@@ -292,16 +337,28 @@ static std::shared_ptr<Image> generateHeatMap(uint32_t width, uint32_t height, c
     return image;
 }
 
-static bool compareImages(
+/// Suffix appended to image names for heat maps written in batch mode (matches the image test scripts).
+static const std::string kHeatMapSuffix = ".error.png";
+
+struct CompareResult
+{
+    bool success = false; ///< True if the error is within the threshold.
+    double error = 0.0;   ///< Error value (only valid if message is empty).
+    std::string message;  ///< Description of why the images could not be compared (empty on success).
+};
+
+static CompareResult compareImages(
     const std::filesystem::path& pathA,
     const std::filesystem::path& pathB,
-    ErrorMetric metric,
+    const ErrorMetric& metric,
     float threshold,
-    bool alpha,
+    const CompareOptions& options,
     const std::filesystem::path& heatMapPath
 )
 {
-    auto loadImage = [](const std::filesystem::path& path)
+    CompareResult result;
+
+    auto loadImage = [&result](const std::filesystem::path& path)
     {
         try
         {
@@ -309,7 +366,7 @@ static bool compareImages(
         }
         catch (const std::runtime_error& e)
         {
-            std::cerr << "Cannot load image from '" << path.string() << "' (Error: " << e.what() << ")." << std::endl;
+            result.message = "Cannot load image from '" + path.string() + "' (Error: " + e.what() + ").";
             return std::shared_ptr<Image>{};
         }
     };
@@ -329,39 +386,135 @@ static bool compareImages(
     // Load images.
     auto imageA = loadImage(pathA);
     if (!imageA)
-        return false;
+        return result;
     auto imageB = loadImage(pathB);
     if (!imageB)
-        return false;
+        return result;
 
     // Check resolution.
     if (imageA->getWidth() != imageB->getWidth() || imageA->getHeight() != imageB->getHeight())
     {
-        std::cerr << "Cannot compare images with different resolutions." << std::endl;
-        return false;
+        result.message = "Cannot compare images with different resolutions.";
+        return result;
     }
 
     uint32_t width = imageA->getWidth();
     uint32_t height = imageB->getHeight();
 
     // Compare images.
-    std::unique_ptr<float[]> errorMap = heatMapPath.empty() ? nullptr : std::make_unique<float[]>(width * height);
-    double error = metric.compare(*imageA, *imageB, alpha, errorMap.get());
+    std::unique_ptr<float[]> errorMap = heatMapPath.empty() ? nullptr : std::make_unique<float[]>(size_t(width) * height);
+    result.error = metric.compare(*imageA, *imageB, options, errorMap.get());
 
     // Generate heat map.
     if (errorMap)
     {
         auto heatMap = generateHeatMap(width, height, errorMap.get());
+        std::error_code ec;
+        std::filesystem::create_directories(heatMapPath.parent_path(), ec);
         saveImage(*heatMap, heatMapPath);
     }
 
-    std::cout << error << std::endl;
-
     // Treat nans and infs as errors.
-    if (std::isnan(error) || std::isinf(error))
-        return false;
+    result.success = !std::isnan(result.error) && !std::isinf(result.error) && result.error <= threshold;
+    return result;
+}
+
+/// Returns the relative paths of all images in a directory tree, excluding heat maps.
+static std::set<std::filesystem::path> collectImages(const std::filesystem::path& dir)
+{
+    std::set<std::filesystem::path> images;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(dir))
+    {
+        if (!entry.is_regular_file())
+            continue;
+        auto pathStr = entry.path().string();
+        bool isHeatMap = pathStr.size() >= kHeatMapSuffix.size() &&
+                         pathStr.compare(pathStr.size() - kHeatMapSuffix.size(), kHeatMapSuffix.size(), kHeatMapSuffix) == 0;
+        if (isHeatMap)
+            continue;
+        if (FreeImage_GetFIFFromFilename(pathStr.c_str()) == FIF_UNKNOWN)
+            continue;
+        images.insert(entry.path().lexically_relative(dir));
+    }
+    return images;
+}
 
-    return error <= threshold;
+static nlohmann::json toJson(const std::string& name, const CompareResult& result)
+{
+    nlohmann::json json = {{"name", name}, {"success", result.success}};
+    if (result.message.empty())
+        json["error"] = result.error;
+    else
+        json["message"] = result.message;
+    return json;
+}
+
+/**
+ * Compares all images found in either of two directory trees.
+ * Image pairs are loaded and compared in parallel. Images that only exist in one tree are reported as failures.
+ * @return True if all image pairs are within the error threshold.
+ */
+static bool compareDirectories(
+    const std::filesystem::path& dirA,
+    const std::filesystem::path& dirB,
+    const ErrorMetric& metric,
+    float threshold,
+    const CompareOptions& options,
+    const std::filesystem::path& heatMapDir,
+    nlohmann::json& report
+)
+{
+    for (const auto& dir : {dirA, dirB})
+    {
+        if (!std::filesystem::is_directory(dir))
+        {
+            std::cerr << "'" << dir.string() << "' is not a directory." << std::endl;
+            return false;
+        }
+    }
+
+    auto imagesA = collectImages(dirA);
+    auto imagesB = collectImages(dirB);
+    std::vector<std::filesystem::path> images;
+    std::set_union(imagesA.begin(), imagesA.end(), imagesB.begin(), imagesB.end(), std::back_inserter(images));
+
+    std::vector<CompareResult> results(images.size());
+    Falcor::Threading::parallelFor(
+        0, images.size(),
+        [&](size_t i)
+        {
+            const auto& image = images[i];
+            if (!imagesA.count(image) || !imagesB.count(image))
+            {
+                results[i].message = "Image only exists in '" + (imagesA.count(image) ? dirA : dirB).string() + "'.";
+                return;
+            }
+            auto heatMapPath = heatMapDir.empty() ? std::filesystem::path() : heatMapDir / (image.string() + kHeatMapSuffix);
+            results[i] = compareImages(dirA / image, dirB / image, metric, threshold, options, heatMapPath);
+        },
+        1
+    );
+
+    bool success = true;
+    size_t failedCount = 0;
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        const auto& result = results[i];
+        auto name = images[i].generic_string();
+        report["images"].push_back(toJson(name, result));
+        if (!result.success)
+        {
+            success = false;
+            ++failedCount;
+            if (result.message.empty())
+                std::cerr << "'" << name << "' failed with error " << result.error << "." << std::endl;
+            else
+                std::cerr << "'" << name << "' failed: " << result.message << std::endl;
+        }
+    }
+
+    std::cout << "Compared " << images.size() << " images, " << failedCount << " failed." << std::endl;
+    return success;
 }
 
 static void printMetrics(std::ostream& stream = std::cout)
@@ -382,9 +535,14 @@ int main(int argc, char** argv)
     args::ValueFlag<std::string> metricFlag(parser, "metric", "The error metric.", {'m'});
     args::ValueFlag<float> thresholdFlag(parser, "threshold", "The error threshold.", {'t'});
     args::Flag alphaFlag(parser, "", "Include alpha channel.", {'a'});
-    args::ValueFlag<std::string> heatMapFlag(parser, "filename", "Generate error heat map.", {'e'});
-    args::Positional<std::string> image1(parser, "image1", "The first image.", args::Options::Required);
-    args::Positional<std::string> image2(parser, "image2", "The second image.", args::Options::Required);
+    args::ValueFlag<std::string> heatMapFlag(
+        parser, "filename", "Generate error heat map. In batch mode, this is the directory to write the heat maps to.", {'e'}
+    );
+    args::Flag batchFlag(parser, "", "Batch mode. Compare all images in two directory trees.", {'b', "batch"});
+    args::ValueFlag<std::string> reportFlag(parser, "filename", "Write a JSON report of the comparison.", {'r', "report"});
+    args::ValueFlag<float> ppdFlag(parser, "ppd", "Pixels per degree used by the FLIP metric.", {"ppd"});
+    args::Positional<std::string> image1(parser, "image1", "The first image (or directory in batch mode).", args::Options::Required);
+    args::Positional<std::string> image2(parser, "image2", "The second image (or directory in batch mode).", args::Options::Required);
     args::CompletionFlag completionFlag(parser, {"complete"});
 
     try
@@ -435,9 +593,46 @@ int main(int argc, char** argv)
         metric = *it;
     }
 
-    bool success = compareImages(
-        args::get(image1), args::get(image2), metric, thresholdFlag ? args::get(thresholdFlag) : 0.f,
-        alphaFlag ? args::get(alphaFlag) : false, heatMapFlag ? args::get(heatMapFlag) : ""
-    );
+    float threshold = thresholdFlag ? args::get(thresholdFlag) : 0.f;
+    CompareOptions options;
+    options.alpha = alphaFlag ? args::get(alphaFlag) : false;
+    if (ppdFlag)
+        options.pixelsPerDegree = args::get(ppdFlag);
+    std::filesystem::path heatMapPath = heatMapFlag ? args::get(heatMapFlag) : "";
+
+    nlohmann::json report = {{"metric", metric.name}, {"threshold", threshold}, {"images", nlohmann::json::array()}};
+
+    Falcor::Threading::start();
+
+    bool success;
+    if (batchFlag)
+    {
+        success = compareDirectories(args::get(image1), args::get(image2), metric, threshold, options, heatMapPath, report);
+    }
+    else
+    {
+        CompareResult result = compareImages(args::get(image1), args::get(image2), metric, threshold, options, heatMapPath);
+        if (result.message.empty())
+            std::cout << result.error << std::endl;
+        else
+            std::cerr << result.message << std::endl;
+        report["images"].push_back(toJson(args::get(image2), result));
+        success = result.success;
+    }
+
+    Falcor::Threading::shutdown();
+
+    if (reportFlag)
+    {
+        report["success"] = success;
+        std::ofstream ofs(args::get(reportFlag));
+        ofs << report.dump(4) << std::endl;
+        if (!ofs)
+        {
+            std::cerr << "Cannot write report to '" << args::get(reportFlag) << "'." << std::endl;
+            return 1;
+        }
+    }
+
     return success ? 0 : 1;
 }
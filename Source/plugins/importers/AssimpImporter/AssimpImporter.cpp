@@ -255,6 +255,7 @@ void createAnimation(ImporterData& data, const aiAnimation* pAiAnim, ImportMode
 
         uint32_t pos = 0, rot = 0, scale = 0;
         Animation::Keyframe keyframe;
+        std::vector<Animation::Keyframe> keyframes;
         bool done = false;
 
         auto nextKeyTime = [&]()
@@ -281,9 +282,11 @@ void createAnimation(ImporterData& data, const aiAnimation* pAiAnim, ImportMode
             done = parseAnimationChannel(pAiNode->mRotationKeys, pAiNode->mNumRotationKeys, time, rot, keyframe.rotation) && done;
             done = parseAnimationChannel(pAiNode->mScalingKeys, pAiNode->mNumScalingKeys, time, scale, keyframe.scaling) && done;
 
-            for (auto pAnimation : animations)
-                pAnimation->addKeyframe(keyframe);
+            keyframes.push_back(keyframe);
         }
+
+        for (auto pAnimation : animations)
+            pAnimation->addKeyframes(keyframes);
     }
 }
 
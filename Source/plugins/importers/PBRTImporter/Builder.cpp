@@ -55,7 +55,9 @@ std::string to_string(const MaterialRef& materialRef)
     }
 }
 
-BasicScene::BasicScene(const std::filesystem::path& searchPath) : mSearchPath(searchPath) {}
+BasicScene::BasicScene(const std::filesystem::path& searchPath, uint32_t materialIndexOffset, uint32_t areaLightIndexOffset)
+    : mSearchPath(searchPath), mMaterialIndexOffset(materialIndexOffset), mAreaLightIndexOffset(areaLightIndexOffset)
+{}
 
 void BasicScene::setOptions(
     SceneEntity filter,
@@ -82,7 +84,7 @@ void BasicScene::addNamedMaterial(std::string name, MaterialSceneEntity material
 uint32_t BasicScene::addMaterial(MaterialSceneEntity material)
 {
     mMaterials.push_back(material);
-    return (uint32_t)(mMaterials.size() - 1);
+    return mMaterialIndexOffset + (uint32_t)(mMaterials.size() - 1);
 }
 
 void BasicScene::addMedium(MediumSceneEntity medium)
@@ -108,7 +110,7 @@ void BasicScene::addLight(LightSceneEntity light)
 uint32_t BasicScene::addAreaLight(SceneEntity light)
 {
     mAreaLights.push_back(light);
-    return (uint32_t)(mAreaLights.size() - 1);
+    return mAreaLightIndexOffset + (uint32_t)(mAreaLights.size() - 1);
 }
 
 void BasicScene::addShapes(std::vector<ShapeSceneEntity>& shapes)
@@ -126,12 +128,57 @@ void BasicScene::addInstances(std::vector<InstanceSceneEntity>& instances)
     std::move(instances.begin(), instances.end(), std::back_inserter(mInstances));
 }
 
+void BasicScene::addIncludedFile(const std::filesystem::path& path)
+{
+    // Files included multiple times (or recursively) are recorded once.
+    mIncludedFiles.insert(path.lexically_normal());
+}
+
+void BasicScene::remapFragmentShapes(const BasicScene& fragment, std::vector<ShapeSceneEntity>& shapes) const
+{
+    // Indices below the fragment offsets refer to entities that existed when the fragment was created.
+    for (auto& shape : shapes)
+    {
+        if (uint32_t* pIndex = std::get_if<uint32_t>(&shape.materialRef); pIndex && *pIndex >= fragment.mMaterialIndexOffset)
+            *pIndex = getNextMaterialIndex() + (*pIndex - fragment.mMaterialIndexOffset);
+        if (shape.lightIndex >= (int)fragment.mAreaLightIndexOffset)
+            shape.lightIndex = (int)getNextAreaLightIndex() + (shape.lightIndex - (int)fragment.mAreaLightIndexOffset);
+    }
+}
+
+void BasicScene::mergeFragment(BasicScene& fragment)
+{
+    for (auto& [name, instanceDefinition] : fragment.mInstanceDefinitions)
+    {
+        remapFragmentShapes(fragment, instanceDefinition.shapes);
+        mInstanceDefinitions.emplace(name, std::move(instanceDefinition));
+    }
+
+    // Unnamed materials are named after their index.
+    for (auto& material : fragment.mMaterials)
+    {
+        material.name = fmt::format("Unnamed{}", getNextMaterialIndex());
+        mMaterials.push_back(std::move(material));
+    }
+    std::move(fragment.mAreaLights.begin(), fragment.mAreaLights.end(), std::back_inserter(mAreaLights));
+
+    for (auto& [name, material] : fragment.mNamedMaterials)
+        mNamedMaterials.emplace(name, std::move(material));
+    for (auto& [name, texture] : fragment.mFloatTextures)
+        mFloatTextures.emplace(name, std::move(texture));
+    for (auto& [name, texture] : fragment.mSpectrumTextures)
+        mSpectrumTextures.emplace(name, std::move(texture));
+    std::move(fragment.mMedia.begin(), fragment.mMedia.end(), std::back_inserter(mMedia));
+    std::move(fragment.mLights.begin(), fragment.mLights.end(), std::back_inserter(mLights));
+    mIncludedFiles.insert(fragment.mIncludedFiles.begin(), fragment.mIncludedFiles.end());
+}
+
 const MaterialSceneEntity& BasicScene::getMaterial(const MaterialRef& materialRef) const
 {
     if (const uint32_t* pIndex = std::get_if<uint32_t>(&materialRef))
     {
-        FALCOR_ASSERT(*pIndex >= 0 && *pIndex <= mMaterials.size());
-        return mMaterials[*pIndex];
+        FALCOR_ASSERT(*pIndex >= mMaterialIndexOffset && *pIndex - mMaterialIndexOffset < mMaterials.size());
+        return mMaterials[*pIndex - mMaterialIndexOffset];
     }
     else if (const std::string* pName = std::get_if<std::string>(&materialRef))
     {
@@ -147,8 +194,8 @@ const MaterialSceneEntity& BasicScene::getMaterial(const MaterialRef& materialRe
 
 const SceneEntity& BasicScene::getAreaLight(int lightIndex)
 {
-    FALCOR_ASSERT(lightIndex >= 0 && lightIndex < mAreaLights.size());
-    return mAreaLights[lightIndex];
+    FALCOR_ASSERT(lightIndex >= (int)mAreaLightIndexOffset && lightIndex - mAreaLightIndexOffset < mAreaLights.size());
+    return mAreaLights[lightIndex - mAreaLightIndexOffset];
 }
 
 std::filesystem::path BasicScene::resolvePath(const std::filesystem::path& path) const
@@ -214,6 +261,21 @@ std::string BasicScene::toString() const
 
 BasicSceneBuilder::BasicSceneBuilder(BasicScene& scene) : mScene(scene) {}
 
+BasicSceneBuilder::~BasicSceneBuilder()
+{
+    // Imports still running when parsing failed reference this builder's fragments.
+    for (auto& import : mImports)
+    {
+        try
+        {
+            if (import.task.isValid())
+                import.task.finish();
+        }
+        catch (...)
+        {}
+    }
+}
+
 void BasicSceneBuilder::onReverseOrientation(FileLoc loc)
 {
     VERIFY_WORLD("ReverseOrientation");
@@ -420,7 +482,8 @@ void BasicSceneBuilder::onObjectEnd(FileLoc loc)
 {
     VERIFY_WORLD("ObjectEnd");
 
-    if (!mpActiveInstanceDefinition)
+    // The stack is empty if the instance definition was started in a file importing this one.
+    if (!mpActiveInstanceDefinition || mStack.empty())
     {
         throwError(loc, "ObjectEnd called outside of instance definition.");
     }
@@ -437,6 +500,7 @@ void BasicSceneBuilder::onObjectEnd(FileLoc loc)
     mGraphicsState = std::move(mStack.back().graphicsState);
     mStack.pop_back();
 
+    mergeImports(true);
     mScene.addInstanceDefinition(std::move(mpActiveInstanceDefinition->entity));
 
     mpActiveInstanceDefinition = nullptr;
@@ -455,6 +519,35 @@ void BasicSceneBuilder::onObjectInstance(const std::string& name, FileLoc loc)
     mInstances.push_back(std::move(instance));
 }
 
+void BasicSceneBuilder::onInclude(const std::filesystem::path& path, FileLoc loc)
+{
+    mScene.addIncludedFile(path);
+}
+
+void BasicSceneBuilder::onImport(const std::filesystem::path& path, const std::filesystem::path& searchPath, FileLoc loc)
+{
+    VERIFY_WORLD("Import");
+
+    mScene.addIncludedFile(path);
+
+    PendingImport import;
+    import.pFragment = std::make_unique<BasicScene>(mScene.getSearchPath(), mScene.getNextMaterialIndex(), mScene.getNextAreaLightIndex());
+    import.pBuilder = createImportBuilder(*import.pFragment);
+    import.instanceDefinition = mpActiveInstanceDefinition != nullptr;
+    import.shapeIndex = mpActiveInstanceDefinition ? mpActiveInstanceDefinition->entity.shapes.size() : mShapes.size();
+    import.instanceIndex = mInstances.size();
+
+    // Imported files can only contain shapes and attributes, so they are parsed in parallel into separate scene fragments.
+    // The fragments are merged in the order of the 'Import' directives, so the result does not depend on scheduling.
+    auto parseImport = [pBuilder = import.pBuilder.get(), path, searchPath]() { parseFile(*pBuilder, path, searchPath); };
+    if (Threading::isRunning())
+        import.task = Threading::dispatchTask(parseImport);
+    else
+        parseImport();
+
+    mImports.push_back(std::move(import));
+}
+
 void BasicSceneBuilder::onEndOfFiles()
 {
     if (mCurrentBlock != BlockState::WorldBlock)
@@ -465,13 +558,120 @@ void BasicSceneBuilder::onEndOfFiles()
     // Ensure there are no pushed graphics states.
     if (!mStack.empty())
     {
+        if (mStack.back().type == StackEntry::Type::Object)
+            throwError("Missing end to ObjectBegin.");
         throwError("Missing end to AttributeBegin.");
     }
 
+    // Files imported inside an instance definition that was started in the importing file.
+    if (mpActiveInstanceDefinition)
+        mergeImports(true);
+    mergeImports(false);
+
+    // Imported fragments are merged into the importing scene by the parent builder.
+    if (mIsImport)
+        return;
+
     mScene.addShapes(mShapes);
     mScene.addInstances(mInstances);
 }
 
+std::unique_ptr<BasicSceneBuilder> BasicSceneBuilder::createImportBuilder(BasicScene& fragment) const
+{
+    auto pBuilder = std::make_unique<BasicSceneBuilder>(fragment);
+    pBuilder->mIsImport = true;
+    pBuilder->mCurrentBlock = mCurrentBlock;
+    pBuilder->mGraphicsState = mGraphicsState;
+    pBuilder->mNamedCoordinateSystems = mNamedCoordinateSystems;
+    pBuilder->mNamedMaterialNames = mNamedMaterialNames;
+    pBuilder->mMediumNames = mMediumNames;
+    pBuilder->mFloatTextureNames = mFloatTextureNames;
+    pBuilder->mSpectrumTextureNames = mSpectrumTextureNames;
+    pBuilder->mInstanceNames = mInstanceNames;
+
+    // Shapes of a file imported inside an instance definition belong to the definition.
+    if (mpActiveInstanceDefinition)
+    {
+        const auto& entity = mpActiveInstanceDefinition->entity;
+        pBuilder->mpActiveInstanceDefinition = std::make_unique<ActiveInstanceDefinition>(entity.name, entity.loc);
+    }
+    return pBuilder;
+}
+
+void BasicSceneBuilder::mergeImports(bool instanceDefinition)
+{
+    FALCOR_ASSERT(!instanceDefinition || mpActiveInstanceDefinition);
+    std::vector<ShapeSceneEntity>& shapes = instanceDefinition ? mpActiveInstanceDefinition->entity.shapes : mShapes;
+    std::vector<ShapeSceneEntity> mergedShapes;
+    std::vector<InstanceSceneEntity> mergedInstances;
+    size_t shapeIndex = 0;
+    size_t instanceIndex = 0;
+
+    auto mergeNames = [](std::set<std::string>& names, const auto& importedEntities, const char* type)
+    {
+        for (const auto& [name, entity] : importedEntities)
+        {
+            if (!names.insert(name).second)
+                throwError(entity.loc, "Redefining {} '{}'.", type, name);
+        }
+    };
+
+    for (auto it = mImports.begin(); it != mImports.end();)
+    {
+        if (it->instanceDefinition != instanceDefinition)
+        {
+            ++it;
+            continue;
+        }
+
+        if (it->task.isValid())
+            it->task.finish();
+
+        BasicScene& fragment = *it->pFragment;
+        BasicSceneBuilder& builder = *it->pBuilder;
+
+        // Named entities have to be unique across the importing file and all imported files.
+        mergeNames(mNamedMaterialNames, fragment.getNamedMaterials(), "named material");
+        mergeNames(mFloatTextureNames, fragment.getFloatTextures(), "texture");
+        mergeNames(mSpectrumTextureNames, fragment.getSpectrumTextures(), "texture");
+        mergeNames(mInstanceNames, fragment.getInstanceDefinitions(), "object instance");
+        for (const auto& medium : fragment.getMedia())
+        {
+            if (!mMediumNames.insert(medium.name).second)
+                throwError(medium.loc, "Redefining named medium '{}'.", medium.name);
+        }
+
+        std::vector<ShapeSceneEntity>& importedShapes =
+            instanceDefinition ? builder.mpActiveInstanceDefinition->entity.shapes : builder.mShapes;
+        mScene.remapFragmentShapes(fragment, importedShapes);
+        mScene.mergeFragment(fragment);
+
+        // Insert shapes and instances at the position of the 'Import' directive.
+        auto splice = [](auto& merged, auto& items, size_t& index, size_t end, auto& imported)
+        {
+            std::move(items.begin() + index, items.begin() + end, std::back_inserter(merged));
+            std::move(imported.begin(), imported.end(), std::back_inserter(merged));
+            index = end;
+        };
+        splice(mergedShapes, shapes, shapeIndex, it->shapeIndex, importedShapes);
+        if (!instanceDefinition)
+            splice(mergedInstances, mInstances, instanceIndex, it->instanceIndex, builder.mInstances);
+
+        it = mImports.erase(it);
+    }
+
+    if (shapeIndex > 0 || !mergedShapes.empty())
+    {
+        std::move(shapes.begin() + shapeIndex, shapes.end(), std::back_inserter(mergedShapes));
+        shapes = std::move(mergedShapes);
+    }
+    if (instanceIndex > 0 || !mergedInstances.empty())
+    {
+        std::move(mInstances.begin() + instanceIndex, mInstances.end(), std::back_inserter(mergedInstances));
+        mInstances = std::move(mergedInstances);
+    }
+}
+
 void BasicSceneBuilder::onOption(const std::string& name, const std::string& value, FileLoc loc)
 {
     // Options:
@@ -612,7 +812,7 @@ void BasicSceneBuilder::onMaterial(const std::string& name, ParsedParameterVecto
     ParameterDictionary dict(std::move(params), mGraphicsState.materialAttributes, mGraphicsState.pColorSpace);
 
     mGraphicsState.currentMaterial =
-        mScene.addMaterial(MaterialSceneEntity(fmt::format("Unnamed{}", mUnamedMaterialIndex++), name, std::move(dict), loc));
+        mScene.addMaterial(MaterialSceneEntity(fmt::format("Unnamed{}", mScene.getNextMaterialIndex()), name, std::move(dict), loc));
 }
 
 void BasicSceneBuilder::onMakeNamedMaterial(const std::string& name, ParsedParameterVector params, FileLoc loc)
@@ -36,6 +36,7 @@
 #include "Parser.h"
 #include "Core/Assert.h"
 #include "Utils/Math/Matrix.h"
+#include "Utils/Threading.h"
 
 #include <filesystem>
 #include <map>
@@ -224,7 +225,15 @@ struct InstanceSceneEntity
 class BasicScene
 {
 public:
-    BasicScene(const std::filesystem::path& searchPath);
+    /**
+     * Constructor.
+     * @param[in] searchPath Directory used to resolve relative paths.
+     * @param[in] materialIndexOffset Index of the first material added to the scene.
+     * @param[in] areaLightIndexOffset Index of the first area light added to the scene.
+     * Scene fragments built from imported files use non-zero offsets, so that the indices of their entities
+     * can be told apart from the indices of the entities in the importing scene.
+     */
+    BasicScene(const std::filesystem::path& searchPath, uint32_t materialIndexOffset = 0, uint32_t areaLightIndexOffset = 0);
 
     void setOptions(
         SceneEntity filter,
@@ -245,6 +254,24 @@ public:
     void addShapes(std::vector<ShapeSceneEntity>& shapes);
     void addInstanceDefinition(InstanceDefinitionSceneEntity instanceDefinition);
     void addInstances(std::vector<InstanceSceneEntity>& instances);
+    void addIncludedFile(const std::filesystem::path& path);
+
+    /**
+     * Remap the material and area light indices of shapes from a scene fragment,
+     * such that they refer to the entities of this scene after merging the fragment with mergeFragment().
+     * Must be called before mergeFragment().
+     */
+    void remapFragmentShapes(const BasicScene& fragment, std::vector<ShapeSceneEntity>& shapes) const;
+
+    /**
+     * Merge a scene fragment into this scene. All entities are moved from the fragment.
+     * Named entities are expected to be unique, i.e. the caller checks for redefinitions.
+     */
+    void mergeFragment(BasicScene& fragment);
+
+    const std::filesystem::path& getSearchPath() const { return mSearchPath; }
+    uint32_t getNextMaterialIndex() const { return mMaterialIndexOffset + (uint32_t)mMaterials.size(); }
+    uint32_t getNextAreaLightIndex() const { return mAreaLightIndexOffset + (uint32_t)mAreaLights.size(); }
 
     const CameraSceneEntity& getCamera() const { return mCamera; }
 
@@ -257,6 +284,7 @@ public:
     const std::vector<ShapeSceneEntity>& getShapes() const { return mShapes; }
     const std::map<std::string, InstanceDefinitionSceneEntity>& getInstanceDefinitions() const { return mInstanceDefinitions; }
     const std::vector<InstanceSceneEntity>& getInstances() const { return mInstances; }
+    const std::set<std::filesystem::path>& getIncludedFiles() const { return mIncludedFiles; }
 
     /**
      * Get a named or unnamed material.
@@ -271,6 +299,8 @@ public:
 
 private:
     std::filesystem::path mSearchPath;
+    uint32_t mMaterialIndexOffset = 0;
+    uint32_t mAreaLightIndexOffset = 0;
 
     SceneEntity mFilter;
     SceneEntity mFilm;
@@ -290,6 +320,8 @@ private:
 
     std::map<std::string, InstanceDefinitionSceneEntity> mInstanceDefinitions;
     std::vector<InstanceSceneEntity> mInstances;
+
+    std::set<std::filesystem::path> mIncludedFiles;
 };
 
 constexpr uint32_t kMaxTransforms = 2;
@@ -338,6 +370,7 @@ class BasicSceneBuilder : public ParserTarget
 {
 public:
     BasicSceneBuilder(BasicScene& scene);
+    ~BasicSceneBuilder();
 
     void onOption(const std::string& name, const std::string& value, FileLoc loc) override;
     void onIdentity(FileLoc loc) override;
@@ -379,11 +412,27 @@ public:
     void onObjectEnd(FileLoc loc) override;
     void onObjectInstance(const std::string& name, FileLoc loc) override;
 
+    void onInclude(const std::filesystem::path& path, FileLoc loc) override;
+    void onImport(const std::filesystem::path& path, const std::filesystem::path& searchPath, FileLoc loc) override;
+
     void onEndOfFiles() override;
 
 private:
     float4x4 getTransform() const { return mGraphicsState.ctm[0]; }
 
+    /**
+     * Create a builder for an imported file. The builder starts with a copy of the current graphics state
+     * and builds into the given scene fragment.
+     */
+    std::unique_ptr<BasicSceneBuilder> createImportBuilder(BasicScene& fragment) const;
+
+    /**
+     * Wait for pending imports and merge them in the order of their 'Import' directives.
+     * @param[in] instanceDefinition Merge the imports issued inside the active instance definition if true,
+     * the imports issued outside of instance definitions otherwise.
+     */
+    void mergeImports(bool instanceDefinition);
+
     static constexpr int kStartTransformBits = 1 << 0;
     static constexpr int kEndTransformBits = 1 << 1;
     static constexpr int kAllTransformsBits = (1 << kMaxTransforms) - 1;
@@ -452,7 +501,20 @@ private:
     };
     std::unique_ptr<ActiveInstanceDefinition> mpActiveInstanceDefinition;
 
-    uint32_t mUnamedMaterialIndex = 0;
+    /// True if building the scene fragment of an imported file.
+    bool mIsImport = false;
+
+    struct PendingImport
+    {
+        std::unique_ptr<BasicScene> pFragment;
+        std::unique_ptr<BasicSceneBuilder> pBuilder;
+        Threading::Task task;
+        bool instanceDefinition = false; ///< True if issued inside an instance definition.
+        size_t shapeIndex = 0;           ///< Insertion position for the imported shapes.
+        size_t instanceIndex = 0;        ///< Insertion position for the imported instances.
+    };
+    std::vector<PendingImport> mImports; ///< Imports in the order of their 'Import' directives.
+
     std::set<std::string> mNamedMaterialNames;
     std::set<std::string> mMediumNames;
     std::set<std::string> mFloatTextureNames;
@@ -30,60 +30,50 @@
 // pbrt is Copyright(c) 1998-2020 Matt Pharr, Wenzel Jakob, and Greg Humphreys.
 // The pbrt source code is licensed under the Apache License, Version 2.0.
 // SPDX: Apache-2.0
-
 #include "LoopSubdivide.h"
 #include "Core/Assert.h"
 #include "Core/Errors.h"
+#include "Utils/Threading.h"
 
 #include <algorithm>
-#include <map>
-#include <memory>
 #include <memory_resource>
-#include <set>
 
 #include <cmath>
 
 namespace Falcor::pbrt
 {
 
-struct SDFace;
-struct SDVertex;
-
 #define NEXT(i) (((i) + 1) % 3)
 #define PREV(i) (((i) + 2) % 3)
 
-struct SDVertex
+namespace
 {
-    SDVertex(const float3& p = float3(0.f)) : p(p) {}
+constexpr uint32_t kInvalidIndex = uint32_t(-1);
 
-    int valence();
-    void oneRing(float3* p);
+/// Vector allocating from the subdivision arena.
+template<typename T>
+using ArenaVector = std::pmr::vector<T>;
 
-    float3 p;
-    SDFace* startFace = nullptr;
-    SDVertex* child = nullptr;
+struct SDVertex
+{
+    float3 p = float3(0.f);
+    uint32_t startFace = kInvalidIndex;
     bool regular = false;
     bool boundary = false;
 };
 
+/**
+ * Triangle of the subdivision mesh.
+ * The neighbor face f[i] is adjacent across the edge (v[i], v[NEXT(i)]).
+ */
 struct SDFace
 {
-    SDFace()
-    {
-        for (uint32_t i = 0; i < 3; ++i)
-        {
-            v[i] = nullptr;
-            f[i] = nullptr;
-        }
-        for (uint32_t i = 0; i < 4; ++i)
-        {
-            children[i] = nullptr;
-        }
-    }
+    uint32_t v[3];
+    uint32_t f[3];
 
-    uint32_t vnum(SDVertex* vert) const
+    uint32_t vnum(uint32_t vert) const
     {
-        for (int i = 0; i < 3; ++i)
+        for (uint32_t i = 0; i < 3; ++i)
         {
             if (v[i] == vert)
                 return i;
@@ -91,11 +81,11 @@ struct SDFace
         throw RuntimeError("Basic logic error in SDFace::vnum().");
     }
 
-    SDFace* nextFace(SDVertex* vert) const { return f[vnum(vert)]; }
-    SDFace* prevFace(SDVertex* vert) const { return f[PREV(vnum(vert))]; }
-    SDVertex* nextVert(SDVertex* vert) const { return v[NEXT(vnum(vert))]; }
-    SDVertex* prevVert(SDVertex* vert) const { return v[PREV(vnum(vert))]; }
-    SDVertex* otherVert(SDVertex* v0, SDVertex* v1)
+    uint32_t nextFace(uint32_t vert) const { return f[vnum(vert)]; }
+    uint32_t prevFace(uint32_t vert) const { return f[PREV(vnum(vert))]; }
+    uint32_t nextVert(uint32_t vert) const { return v[NEXT(vnum(vert))]; }
+    uint32_t prevVert(uint32_t vert) const { return v[PREV(vnum(vert))]; }
+    uint32_t otherVert(uint32_t v0, uint32_t v1) const
     {
         for (uint32_t i = 0; i < 3; ++i)
         {
@@ -104,60 +94,109 @@ struct SDFace
         }
         throw RuntimeError("Basic logic error in SDFace::otherVert()");
     }
-
-    SDVertex* v[3];
-    SDFace* f[3];
-    SDFace* children[4];
 };
 
-struct SDEdge
+/**
+ * Subdivision mesh at a single level of refinement.
+ * Vertices and faces reference each other by index. When refining, the children of face i are
+ * the faces 4 * i + k of the next level, and the child of vertex i is vertex i of the next level.
+ * The new (odd) edge vertices are appended after these.
+ */
+struct SDMesh
 {
-    SDEdge(SDVertex* v0 = nullptr, SDVertex* v1 = nullptr)
+    ArenaVector<SDVertex> vertices;
+    ArenaVector<SDFace> faces;
+
+    SDMesh(size_t vertexCount, size_t faceCount, std::pmr::memory_resource* pArena)
+        : vertices(vertexCount, pArena), faces(faceCount, pArena)
+    {}
+
+    int valence(uint32_t vert) const
     {
-        v[0] = std::min(v0, v1);
-        v[1] = std::max(v0, v1);
-        f[0] = f[1] = nullptr;
-        f0edgeNum = -1;
+        const SDVertex& vertex = vertices[vert];
+        uint32_t f = vertex.startFace;
+        if (!vertex.boundary)
+        {
+            // Compute valence of interior vertex.
+            int nf = 1;
+            while ((f = faces[f].nextFace(vert)) != vertex.startFace)
+                ++nf;
+            return nf;
+        }
+        else
+        {
+            // Compute valence of boundary vertex
+            int nf = 1;
+            while ((f = faces[f].nextFace(vert)) != kInvalidIndex)
+                ++nf;
+            f = vertex.startFace;
+            while ((f = faces[f].prevFace(vert)) != kInvalidIndex)
+                ++nf;
+            return nf + 1;
+        }
     }
 
-    bool operator<(const SDEdge& e2) const
+    void oneRing(uint32_t vert, float3* p) const
     {
-        if (v[0] == e2.v[0])
-            return v[1] < e2.v[1];
-        return v[0] < e2.v[0];
+        const SDVertex& vertex = vertices[vert];
+        if (!vertex.boundary)
+        {
+            // Get one-ring vertices for interior vertex.
+            uint32_t face = vertex.startFace;
+            do
+            {
+                *p++ = vertices[faces[face].nextVert(vert)].p;
+                face = faces[face].nextFace(vert);
+            } while (face != vertex.startFace);
+        }
+        else
+        {
+            // Get one-ring vertices for boundary vertex.
+            uint32_t face = vertex.startFace;
+            uint32_t f2;
+            while ((f2 = faces[face].nextFace(vert)) != kInvalidIndex)
+            {
+                face = f2;
+            }
+            *p++ = vertices[faces[face].nextVert(vert)].p;
+            do
+            {
+                *p++ = vertices[faces[face].prevVert(vert)].p;
+                face = faces[face].prevFace(vert);
+            } while (face != kInvalidIndex);
+        }
     }
 
-    SDVertex* v[2];
-    SDFace* f[2];
-    int f0edgeNum;
-};
-
-static float3 weightOneRing(SDVertex* vert, float beta);
-static float3 weightBoundary(SDVertex* vert, float beta);
-
-inline int SDVertex::valence()
-{
-    SDFace* f = startFace;
-    if (!boundary)
+    float3 weightOneRing(uint32_t vert, float beta) const
     {
-        // Compute valence of interior vertex.
-        int nf = 1;
-        while ((f = f->nextFace(this)) != startFace)
-            ++nf;
-        return nf;
+        // Put vert one-ring in pRing.
+        uint32_t valence = this->valence(vert);
+        FALCOR_ASSERT(valence < 16);
+        float3 pRing[16];
+
+        oneRing(vert, pRing);
+        float3 p = (1 - valence * beta) * vertices[vert].p;
+        for (uint32_t i = 0; i < valence; ++i)
+        {
+            p += beta * pRing[i];
+        }
+        return p;
     }
-    else
+
+    float3 weightBoundary(uint32_t vert, float beta) const
     {
-        // Compute valence of boundary vertex
-        int nf = 1;
-        while ((f = f->nextFace(this)) != nullptr)
-            ++nf;
-        f = startFace;
-        while ((f = f->prevFace(this)) != nullptr)
-            ++nf;
-        return nf + 1;
+        // Put vert one-ring in pRing.
+        uint32_t valence = this->valence(vert);
+        FALCOR_ASSERT(valence < 16);
+        float3 pRing[16];
+
+        oneRing(vert, pRing);
+        float3 p = (1 - 2 * beta) * vertices[vert].p;
+        p += beta * pRing[0];
+        p += beta * pRing[valence - 1];
+        return p;
     }
-}
+};
 
 inline float beta(uint32_t valence)
 {
@@ -172,372 +211,385 @@ inline float loopGamma(uint32_t valence)
     return 1.f / (valence + 3.f / (8.f * beta(valence)));
 }
 
-LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> indices)
+/**
+ * Match face edges by their (unordered) vertex pairs.
+ * Face edges are identified by the index 3 * face + edge. They are distributed to buckets by hashing the
+ * vertex pair, and the buckets are sorted in parallel by vertex pair and face edge index. The result
+ * only depends on the mesh, not on the number of threads.
+ * @param[in] faces Faces.
+ * @param[in] pArena Arena for temporary allocations.
+ * @param[in] func Called as func(const uint32_t* pEdges, size_t count) for every group of face edges that
+ * share a vertex pair, with the edges in increasing order. Calls for different groups may run in parallel.
+ */
+template<typename Func>
+void matchEdges(const ArenaVector<SDFace>& faces, std::pmr::memory_resource* pArena, Func func)
 {
-    std::vector<SDVertex*> vertices;
-    std::vector<SDFace*> faces;
-
-    // Allocate vertices and faces.
-    std::unique_ptr<SDVertex[]> vertexBuffer = std::make_unique<SDVertex[]>(positions.size());
-    for (size_t i = 0; i < positions.size(); ++i)
+    struct Edge
     {
-        vertexBuffer[i] = SDVertex(positions[i]);
-        vertices.push_back(&vertexBuffer[i]);
-    }
-    size_t faceCount = indices.size() / 3;
-    std::unique_ptr<SDFace[]> fs = std::make_unique<SDFace[]>(faceCount);
-    for (size_t i = 0; i < faceCount; ++i)
+        uint64_t key;
+        uint32_t index;
+        bool operator<(const Edge& other) const { return key != other.key ? key < other.key : index < other.index; }
+    };
+
+    const size_t edgeCount = faces.size() * 3;
+    ArenaVector<uint64_t> keys(edgeCount, pArena);
+    Threading::parallelFor(
+        0,
+        faces.size(),
+        [&](size_t i)
+        {
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                uint64_t v0 = faces[i].v[k], v1 = faces[i].v[NEXT(k)];
+                keys[3 * i + k] = (std::min(v0, v1) << 32) | std::max(v0, v1);
+            }
+        }
+    );
+
+    // Distribute edges to buckets.
+    uint32_t bucketBits = 0;
+    while (bucketBits < 12 && (size_t(1024) << bucketBits) < edgeCount)
+        ++bucketBits;
+    auto getBucket = [bucketBits](uint64_t key)
+    { return bucketBits == 0 ? 0 : size_t((key * 0x9e3779b97f4a7c15ull) >> (64 - bucketBits)); };
+
+    ArenaVector<size_t> bucketOffsets((size_t(1) << bucketBits) + 1, pArena);
+    for (uint64_t key : keys)
+        ++bucketOffsets[getBucket(key) + 1];
+    for (size_t i = 1; i < bucketOffsets.size(); ++i)
+        bucketOffsets[i] += bucketOffsets[i - 1];
+
+    ArenaVector<Edge> edges(edgeCount, pArena);
     {
-        faces.push_back(&fs[i]);
+        ArenaVector<size_t> offsets(bucketOffsets.begin(), bucketOffsets.end() - 1, pArena);
+        for (size_t i = 0; i < edgeCount; ++i)
+            edges[offsets[getBucket(keys[i])]++] = {keys[i], (uint32_t)i};
     }
 
-    // Set face to vertex pointers.
-    {
-        const uint32_t* vp = indices.data();
-        for (size_t i = 0; i < faceCount; ++i, vp += 3)
+    // Sort buckets and report groups of edges.
+    Threading::parallelFor(
+        0,
+        bucketOffsets.size() - 1,
+        [&](size_t bucket)
         {
-            SDFace* f = faces[i];
-            for (uint32_t j = 0; j < 3; ++j)
+            auto begin = edges.begin() + bucketOffsets[bucket];
+            auto end = edges.begin() + bucketOffsets[bucket + 1];
+            std::sort(begin, end);
+
+            std::vector<uint32_t> group;
+            for (auto it = begin; it != end;)
             {
-                SDVertex* v = vertices[vp[j]];
-                f->v[j] = v;
-                v->startFace = f;
+                group.clear();
+                uint64_t key = it->key;
+                for (; it != end && it->key == key; ++it)
+                    group.push_back(it->index);
+                func(group.data(), group.size());
             }
-        }
-    }
+        },
+        1
+    );
+}
+} // namespace
+
+LoopSubdivideResult loopSubdivide(uint32_t levels, fstd::span<const float3> positions, fstd::span<const uint32_t> indices)
+{
+    // All vertices, faces and temporary data are allocated from a single arena that is released at once.
+    std::pmr::monotonic_buffer_resource arena;
+
+    size_t faceCount = indices.size() / 3;
+    SDMesh mesh(positions.size(), faceCount, &arena);
 
-    // Set neighbor pointers in faces.
-    std::set<SDEdge> edges;
+    // Set face to vertex indices.
+    for (size_t i = 0; i < positions.size(); ++i)
+        mesh.vertices[i].p = positions[i];
     for (size_t i = 0; i < faceCount; ++i)
     {
-        SDFace* f = faces[i];
-        for (uint32_t edgeNum = 0; edgeNum < 3; ++edgeNum)
+        SDFace& f = mesh.faces[i];
+        for (uint32_t j = 0; j < 3; ++j)
         {
-            // Update neighbor pointer for edgeNum.
-            int v0 = edgeNum, v1 = NEXT(edgeNum);
-            SDEdge e(f->v[v0], f->v[v1]);
-            if (edges.find(e) == edges.end())
-            {
-                // Handle new edge.
-                e.f[0] = f;
-                e.f0edgeNum = edgeNum;
-                edges.insert(e);
-            }
-            else
+            uint32_t v = indices[3 * i + j];
+            if (v >= positions.size())
+                throw RuntimeError("Vertex index {} is out of range.", v);
+            f.v[j] = v;
+            f.f[j] = kInvalidIndex;
+            mesh.vertices[v].startFace = (uint32_t)i;
+        }
+    }
+
+    // Set neighbor indices in faces.
+    // Face edges sharing a vertex pair are paired up in the order they appear.
+    matchEdges(
+        mesh.faces,
+        &arena,
+        [&](const uint32_t* pEdges, size_t count)
+        {
+            for (size_t i = 0; i + 1 < count; i += 2)
             {
-                // Handle previously seen edge.
-                e = *edges.find(e);
-                e.f[0]->f[e.f0edgeNum] = f;
-                f->f[edgeNum] = e.f[0];
-                edges.erase(e);
+                uint32_t e0 = pEdges[i], e1 = pEdges[i + 1];
+                mesh.faces[e0 / 3].f[e0 % 3] = e1 / 3;
+                mesh.faces[e1 / 3].f[e1 % 3] = e0 / 3;
             }
         }
-    }
+    );
 
     // Finish vertex initialization.
     for (size_t i = 0; i < positions.size(); ++i)
     {
-        SDVertex* v = vertices[i];
-        SDFace* f = v->startFace;
-        do
-        {
-            f = f->nextFace(v);
-        } while ((f != nullptr) && f != v->startFace);
-        v->boundary = (f == nullptr);
-        if (!v->boundary && v->valence() == 6)
-            v->regular = true;
-        else if (v->boundary && v->valence() == 4)
-            v->regular = true;
-        else
-            v->regular = false;
+        if (mesh.vertices[i].startFace == kInvalidIndex)
+            throw RuntimeError("Vertex {} is not referenced by any face.", i);
     }
+    Threading::parallelFor(
+        0,
+        mesh.vertices.size(),
+        [&](size_t i)
+        {
+            SDVertex& v = mesh.vertices[i];
+            uint32_t f = v.startFace;
+            do
+            {
+                f = mesh.faces[f].nextFace((uint32_t)i);
+            } while (f != kInvalidIndex && f != v.startFace);
+            v.boundary = (f == kInvalidIndex);
+            if (!v.boundary && mesh.valence((uint32_t)i) == 6)
+                v.regular = true;
+            else if (v.boundary && mesh.valence((uint32_t)i) == 4)
+                v.regular = true;
+            else
+                v.regular = false;
+        }
+    );
 
     // Refine LoopSubdiv into triangles.
-    std::vector<SDFace*> f = faces;
-    std::vector<SDVertex*> v = vertices;
-
-    std::pmr::monotonic_buffer_resource buffer;
-    std::pmr::polymorphic_allocator<SDVertex> vertexAllocator(&buffer);
-    std::pmr::polymorphic_allocator<SDFace> faceAllocator(&buffer);
-
     for (size_t i = 0; i < levels; ++i)
     {
-        // Update f and v for next level of subdivision.
-        std::vector<SDFace*> newFaces;
-        std::vector<SDVertex*> newVertices;
-
-        // Allocate next level of children in mesh tree.
-        for (SDVertex* vertex : v)
-        {
-            vertex->child = vertexAllocator.allocate(1);
-            vertex->child->regular = vertex->regular;
-            vertex->child->boundary = vertex->boundary;
-            newVertices.push_back(vertex->child);
-        }
-        for (SDFace* face : f)
-        {
-            for (uint32_t k = 0; k < 4; ++k)
+        const size_t vertexCount = mesh.vertices.size();
+        const size_t edgeCount = mesh.faces.size() * 3;
+
+        // Assign new odd vertices to edges. Each vertex pair gets one vertex, numbered in order of
+        // first appearance, the first face edge of the pair is its owner.
+        ArenaVector<uint32_t> edgeVerts(edgeCount, &arena);
+        matchEdges(
+            mesh.faces,
+            &arena,
+            [&](const uint32_t* pEdges, size_t count)
             {
-                face->children[k] = faceAllocator.allocate(1);
-                newFaces.push_back(face->children[k]);
+                for (size_t j = 0; j < count; ++j)
+                    edgeVerts[pEdges[j]] = pEdges[0];
             }
-        }
-
-        // Update vertex positions and create new edge vertices.
-
-        // Update vertex positions for even vertices.
-        for (SDVertex* vertex : v)
+        );
+        ArenaVector<uint32_t> ownerEdges(&arena);
+        for (uint32_t e = 0; e < edgeCount; ++e)
         {
-            if (!vertex->boundary)
+            uint32_t owner = edgeVerts[e];
+            if (owner == e)
             {
-                // Apply one-ring rule for even vertex.
-                if (vertex->regular)
-                    vertex->child->p = weightOneRing(vertex, 1.f / 16.f);
-                else
-                    vertex->child->p = weightOneRing(vertex, beta(vertex->valence()));
+                edgeVerts[e] = uint32_t(vertexCount + ownerEdges.size());
+                ownerEdges.push_back(e);
             }
             else
             {
-                // Apply boundary rule for even vertex.
-                vertex->child->p = weightBoundary(vertex, 1.f / 8.f);
+                edgeVerts[e] = edgeVerts[owner];
             }
         }
 
-        // Compute new odd edge vertices.
-        std::map<SDEdge, SDVertex*> edgeVerts;
-        for (SDFace* face : f)
-        {
-            for (uint32_t k = 0; k < 3; ++k)
+        SDMesh child(vertexCount + ownerEdges.size(), mesh.faces.size() * 4, &arena);
+
+        // Update vertex positions for even vertices.
+        Threading::parallelFor(
+            0,
+            vertexCount,
+            [&](size_t j)
             {
-                // Compute odd vertex on kth edge.
-                SDEdge edge(face->v[k], face->v[NEXT(k)]);
-                SDVertex* vert = edgeVerts[edge];
-                if (vert == nullptr)
+                const SDVertex& vertex = mesh.vertices[j];
+                SDVertex& vert = child.vertices[j];
+                vert.regular = vertex.regular;
+                vert.boundary = vertex.boundary;
+                if (!vertex.boundary)
                 {
-                    // Create and initialize new odd vertex
-                    vert = vertexAllocator.allocate(1);
-                    newVertices.push_back(vert);
-                    vert->regular = true;
-                    vert->boundary = (face->f[k] == nullptr);
-                    vert->startFace = face->children[3];
-
-                    // Apply edge rules to compute new vertex position
-                    if (vert->boundary)
-                    {
-                        vert->p = 0.5f * edge.v[0]->p;
-                        vert->p += 0.5f * edge.v[1]->p;
-                    }
+                    // Apply one-ring rule for even vertex.
+                    if (vertex.regular)
+                        vert.p = mesh.weightOneRing((uint32_t)j, 1.f / 16.f);
                     else
-                    {
-                        vert->p = 3.f / 8.f * edge.v[0]->p;
-                        vert->p += 3.f / 8.f * edge.v[1]->p;
-                        vert->p += 1.f / 8.f * face->otherVert(edge.v[0], edge.v[1])->p;
-                        vert->p += 1.f / 8.f * face->f[k]->otherVert(edge.v[0], edge.v[1])->p;
-                    }
-                    edgeVerts[edge] = vert;
+                        vert.p = mesh.weightOneRing((uint32_t)j, beta(mesh.valence((uint32_t)j)));
+                }
+                else
+                {
+                    // Apply boundary rule for even vertex.
+                    vert.p = mesh.weightBoundary((uint32_t)j, 1.f / 8.f);
                 }
-            }
-        }
-
-        // Update new mesh topology.
 
-        // Update even vertex face pointers.
-        for (SDVertex* vertex : v)
-        {
-            int vertNum = vertex->startFace->vnum(vertex);
-            vertex->child->startFace = vertex->startFace->children[vertNum];
-        }
+                // Update even vertex face index.
+                const SDFace& startFace = mesh.faces[vertex.startFace];
+                vert.startFace = 4 * vertex.startFace + startFace.vnum((uint32_t)j);
+            }
+        );
 
-        // Update face neighbor pointers.
-        for (SDFace* face : f)
-        {
-            for (uint32_t j = 0; j < 3; ++j)
+        // Compute new odd edge vertices.
+        Threading::parallelFor(
+            0,
+            ownerEdges.size(),
+            [&](size_t j)
             {
-                // Update children f pointers for siblings.
-                face->children[3]->f[j] = face->children[NEXT(j)];
-                face->children[j]->f[NEXT(j)] = face->children[3];
-
-                // Update children f pointers for neighbor children.
-                SDFace* f2 = face->f[j];
-                face->children[j]->f[j] = f2 != nullptr ? f2->children[f2->vnum(face->v[j])] : nullptr;
-                f2 = face->f[PREV(j)];
-                face->children[j]->f[PREV(j)] = f2 != nullptr ? f2->children[f2->vnum(face->v[j])] : nullptr;
+                uint32_t faceIndex = ownerEdges[j] / 3, k = ownerEdges[j] % 3;
+                const SDFace& face = mesh.faces[faceIndex];
+                uint32_t v0 = std::min(face.v[k], face.v[NEXT(k)]);
+                uint32_t v1 = std::max(face.v[k], face.v[NEXT(k)]);
+
+                SDVertex& vert = child.vertices[vertexCount + j];
+                vert.regular = true;
+                vert.boundary = (face.f[k] == kInvalidIndex);
+                vert.startFace = 4 * faceIndex + 3;
+
+                // Apply edge rules to compute new vertex position
+                if (vert.boundary)
+                {
+                    vert.p = 0.5f * mesh.vertices[v0].p;
+                    vert.p += 0.5f * mesh.vertices[v1].p;
+                }
+                else
+                {
+                    vert.p = 3.f / 8.f * mesh.vertices[v0].p;
+                    vert.p += 3.f / 8.f * mesh.vertices[v1].p;
+                    vert.p += 1.f / 8.f * mesh.vertices[face.otherVert(v0, v1)].p;
+                    vert.p += 1.f / 8.f * mesh.vertices[mesh.faces[face.f[k]].otherVert(v0, v1)].p;
+                }
             }
-        }
+        );
 
-        // Update face vertex pointers.
-        for (SDFace* face : f)
-        {
-            for (uint32_t j = 0; j < 3; ++j)
+        // Update new mesh topology.
+        Threading::parallelFor(
+            0,
+            mesh.faces.size(),
+            [&](size_t j)
             {
-                // Update child vertex pointer to new even vertex
-                face->children[j]->v[j] = face->v[j]->child;
-
-                // Update child vertex pointer to new odd vertex
-                SDVertex* vert = edgeVerts[SDEdge(face->v[j], face->v[NEXT(j)])];
-                face->children[j]->v[NEXT(j)] = vert;
-                face->children[NEXT(j)]->v[j] = vert;
-                face->children[3]->v[j] = vert;
+                const SDFace& face = mesh.faces[j];
+                SDFace* children = &child.faces[4 * j];
+                const uint32_t firstChild = uint32_t(4 * j);
+
+                for (uint32_t k = 0; k < 3; ++k)
+                {
+                    // Update children f indices for siblings.
+                    children[3].f[k] = firstChild + NEXT(k);
+                    children[k].f[NEXT(k)] = firstChild + 3;
+
+                    // Update children f indices for neighbor children.
+                    uint32_t f2 = face.f[k];
+                    children[k].f[k] = f2 != kInvalidIndex ? 4 * f2 + mesh.faces[f2].vnum(face.v[k]) : kInvalidIndex;
+                    f2 = face.f[PREV(k)];
+                    children[k].f[PREV(k)] = f2 != kInvalidIndex ? 4 * f2 + mesh.faces[f2].vnum(face.v[k]) : kInvalidIndex;
+                }
+
+                for (uint32_t k = 0; k < 3; ++k)
+                {
+                    // Update child vertex index to new even vertex
+                    children[k].v[k] = face.v[k];
+
+                    // Update child vertex index to new odd vertex
+                    uint32_t vert = edgeVerts[3 * j + k];
+                    children[k].v[NEXT(k)] = vert;
+                    children[NEXT(k)].v[k] = vert;
+                    children[3].v[k] = vert;
+                }
             }
-        }
+        );
 
         // Prepare for next level of subdivision
-        f = newFaces;
-        v = newVertices;
+        mesh = std::move(child);
     }
 
     // Push vertices to limit surface.
-    std::vector<float3> pLimit(v.size());
-    for (size_t i = 0; i < v.size(); ++i)
-    {
-        if (v[i]->boundary)
-            pLimit[i] = weightBoundary(v[i], 1.f / 5.f);
-        else
-            pLimit[i] = weightOneRing(v[i], loopGamma(v[i]->valence()));
-    }
-    for (size_t i = 0; i < v.size(); ++i)
+    const size_t vertexCount = mesh.vertices.size();
+    std::vector<float3> pLimit(vertexCount);
+    Threading::parallelFor(
+        0,
+        vertexCount,
+        [&](size_t i)
+        {
+            if (mesh.vertices[i].boundary)
+                pLimit[i] = mesh.weightBoundary((uint32_t)i, 1.f / 5.f);
+            else
+                pLimit[i] = mesh.weightOneRing((uint32_t)i, loopGamma(mesh.valence((uint32_t)i)));
+        }
+    );
+    for (size_t i = 0; i < vertexCount; ++i)
     {
-        v[i]->p = pLimit[i];
+        mesh.vertices[i].p = pLimit[i];
     }
 
     // Compute vertex tangents on limit surface.
-    std::vector<float3> Ns;
-    Ns.reserve(v.size());
-    std::vector<float3> pRing(16, float3());
-    for (SDVertex* vertex : v)
-    {
-        float3 S(0.f);
-        float3 T(0.f);
-        uint32_t valence = vertex->valence();
-        if (valence > pRing.size())
-            pRing.resize(valence);
-        vertex->oneRing(&pRing[0]);
-        if (!vertex->boundary)
+    std::vector<float3> Ns(vertexCount);
+    Threading::parallelForRange(
+        0,
+        vertexCount,
+        [&](size_t begin, size_t end)
         {
-            // Compute tangents of interior face
-            for (uint32_t j = 0; j < valence; ++j)
+            std::vector<float3> pRing(16, float3());
+            for (size_t i = begin; i < end; ++i)
             {
-                S += std::cos(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
-                T += std::sin(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
-            }
-        }
-        else
-        {
-            // Compute tangents of boundary face
-            S = pRing[valence - 1] - pRing[0];
-            if (valence == 2)
-            {
-                T = float3(pRing[0] + pRing[1] - 2.f * vertex->p);
-            }
-            else if (valence == 3)
-            {
-                T = pRing[1] - vertex->p;
-            }
-            else if (valence == 4) // regular
-            {
-                T = float3(-1.f * pRing[0] + 2.f * pRing[1] + 2.f * pRing[2] + -1.f * pRing[3] + -2.f * vertex->p);
-            }
-            else
-            {
-                float theta = float(M_PI) / float(valence - 1);
-                T = float3(std::sin(theta) * (pRing[0] + pRing[valence - 1]));
-                for (uint32_t k = 1; k < valence - 1; ++k)
+                const SDVertex& vertex = mesh.vertices[i];
+                float3 S(0.f);
+                float3 T(0.f);
+                uint32_t valence = mesh.valence((uint32_t)i);
+                if (valence > pRing.size())
+                    pRing.resize(valence);
+                mesh.oneRing((uint32_t)i, &pRing[0]);
+                if (!vertex.boundary)
                 {
-                    float wt = (2 * std::cos(theta) - 2) * std::sin((k)*theta);
-                    T += float3(wt * pRing[k]);
+                    // Compute tangents of interior face
+                    for (uint32_t j = 0; j < valence; ++j)
+                    {
+                        S += std::cos(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
+                        T += std::sin(2.f * float(M_PI) * j / valence) * float3(pRing[j]);
+                    }
                 }
-                T = -T;
+                else
+                {
+                    // Compute tangents of boundary face
+                    S = pRing[valence - 1] - pRing[0];
+                    if (valence == 2)
+                    {
+                        T = float3(pRing[0] + pRing[1] - 2.f * vertex.p);
+                    }
+                    else if (valence == 3)
+                    {
+                        T = pRing[1] - vertex.p;
+                    }
+                    else if (valence == 4) // regular
+                    {
+                        T = float3(-1.f * pRing[0] + 2.f * pRing[1] + 2.f * pRing[2] + -1.f * pRing[3] + -2.f * vertex.p);
+                    }
+                    else
+                    {
+                        float theta = float(M_PI) / float(valence - 1);
+                        T = float3(std::sin(theta) * (pRing[0] + pRing[valence - 1]));
+                        for (uint32_t k = 1; k < valence - 1; ++k)
+                        {
+                            float wt = (2 * std::cos(theta) - 2) * std::sin((k)*theta);
+                            T += float3(wt * pRing[k]);
+                        }
+                        T = -T;
+                    }
+                }
+                Ns[i] = cross(S, T);
             }
         }
-        Ns.push_back(cross(S, T));
-    }
+    );
 
     // Create triangle mesh from subdivision mesh
-    {
-        size_t ntris = f.size();
-        std::vector<uint32_t> verts(3 * ntris);
-        uint32_t* vp = verts.data();
-        uint32_t totVerts = (uint32_t)v.size();
-        std::map<SDVertex*, uint32_t> usedVerts;
-        for (uint32_t i = 0; i < totVerts; ++i)
-        {
-            usedVerts[v[i]] = i;
-        }
-        for (size_t i = 0; i < ntris; ++i)
+    LoopSubdivideResult result;
+    result.indices.resize(3 * mesh.faces.size());
+    Threading::parallelFor(
+        0,
+        mesh.faces.size(),
+        [&](size_t i)
         {
             for (uint32_t j = 0; j < 3; ++j)
-            {
-                *vp = usedVerts[f[i]->v[j]];
-                ++vp;
-            }
+                result.indices[3 * i + j] = mesh.faces[i].v[j];
         }
-
-        LoopSubdivideResult result;
-        result.positions = std::move(pLimit);
-        result.normals = std::move(Ns);
-        result.indices = std::move(verts);
-        return result;
-    }
-}
-
-static float3 weightOneRing(SDVertex* vert, float beta)
-{
-    // Put vert one-ring in pRing.
-    uint32_t valence = vert->valence();
-    FALCOR_ASSERT(valence < 16);
-    float3 pRing[16];
-
-    vert->oneRing(pRing);
-    float3 p = (1 - valence * beta) * vert->p;
-    for (uint32_t i = 0; i < valence; ++i)
-    {
-        p += beta * pRing[i];
-    }
-    return p;
-}
-
-void SDVertex::oneRing(float3* p_)
-{
-    if (!boundary)
-    {
-        // Get one-ring vertices for interior vertex.
-        SDFace* face = startFace;
-        do
-        {
-            *p_++ = face->nextVert(this)->p;
-            face = face->nextFace(this);
-        } while (face != startFace);
-    }
-    else
-    {
-        // Get one-ring vertices for boundary vertex.
-        SDFace* face = startFace;
-        SDFace* f2;
-        while ((f2 = face->nextFace(this)) != nullptr)
-        {
-            face = f2;
-        }
-        *p_++ = face->nextVert(this)->p;
-        do
-        {
-            *p_++ = face->prevVert(this)->p;
-            face = face->prevFace(this);
-        } while (face != nullptr);
-    }
-}
-
-static float3 weightBoundary(SDVertex* vert, float beta)
-{
-    // Put vert one-ring in pRing.
-    uint32_t valence = vert->valence();
-    FALCOR_ASSERT(valence < 16);
-    float3 pRing[16];
-
-    vert->oneRing(pRing);
-    float3 p = (1 - 2 * beta) * vert->p;
-    p += beta * pRing[0];
-    p += beta * pRing[valence - 1];
-    return p;
+    );
+    result.positions = std::move(pLimit);
+    result.normals = std::move(Ns);
+    return result;
 }
 
 } // namespace Falcor::pbrt
@@ -63,12 +63,15 @@
 #include "Builder.h"
 #include "Helpers.h"
 #include "LoopSubdivide.h"
+#include "PLYReader.h"
 #include "EnvMapConverter.h"
 #include "Core/Assert.h"
 #include "Core/Errors.h"
 #include "Core/API/Device.h"
 #include "Utils/Settings.h"
 #include "Utils/Logger.h"
+#include "Utils/Threading.h"
+#include "Utils/Image/Bitmap.h"
 #include "Utils/Timing/TimeReport.h"
 #include "Utils/Math/FalcorMath.h"
 #include "Utils/Math/FNVHash.h"
@@ -87,6 +90,9 @@
 
 #include <pybind11/pybind11.h>
 
+#include <exception>
+#include <mutex>
+#include <optional>
 #include <unordered_map>
 
 namespace Falcor
@@ -165,19 +171,30 @@ struct SpectrumTexture
 struct Medium
 {};
 
+/**
+ * Holds a single curve strand.
+ * PBRT's curve shape only contains a single strand.
+ */
+struct CurveStrand
+{
+    uint32_t splitDepth;
+    std::vector<float3> points;
+    std::vector<float> widths;
+};
+
 /**
  * Holds the results from creating a shape.
  */
 struct Shape
 {
     Falcor::ref<Falcor::TriangleMesh> pTriangleMesh;
+    std::optional<CurveStrand> curve; ///< Curve strand ('curve' shapes only).
     float4x4 transform = float4x4::identity();
     Falcor::ref<Falcor::Material> pMaterial;
 };
 
 /**
  * Holds a list of aggregated curve shapes (strands).
- * PBRT's curve shape only contains a single strand.
  * We aggregate strands that have the same transform/material
  * so we can process them as a collection.
  */
@@ -196,8 +213,21 @@ struct CurveAggregate
     std::vector<uint32_t> strands; ///< Contains the number of points in each strand.
     std::vector<float3> points;    ///< Concatenated list of points of all strands.
     std::vector<float> widths;     ///< Concatenated list of widths of all strands.
+
+    void append(const CurveStrand& strand)
+    {
+        strands.push_back((uint32_t)strand.points.size());
+        points.insert(points.end(), strand.points.begin(), strand.points.end());
+        widths.insert(widths.end(), strand.widths.begin(), strand.widths.end());
+    }
 };
 
+/**
+ * Tessellated curve aggregate.
+ * This can either be curve or mesh geometry depending on the tesselation mode.
+ */
+using CurveGeometry = std::variant<Falcor::CurveTessellation::SweptSphereResult, Falcor::CurveTessellation::MeshResult>;
+
 struct InstanceDefinition
 {
     std::vector<std::pair<MeshID, float4x4>> meshes;  // List of meshID + transform
@@ -219,7 +249,8 @@ struct BuilderContext
 
     Falcor::ref<Falcor::Material> pDefaultMaterial;
 
-    std::unordered_map<CurveAggregate::Key, CurveAggregate, CurveAggregate::KeyHash> curveAggregates;
+    std::vector<CurveAggregate> curveAggregates; ///< Curve aggregates in order of creation.
+    std::unordered_map<CurveAggregate::Key, size_t, CurveAggregate::KeyHash> curveAggregateIndices;
 
     std::map<std::string, InstanceDefinition> instanceDefinitions;
 
@@ -256,7 +287,53 @@ struct BuilderContext
         return pMaterial;
     }
 
-    Resolver resolver = [this](const std::filesystem::path& path) { return scene.resolvePath(path); };
+    /// Image decoded ahead of texture creation.
+    struct DecodedImage
+    {
+        std::filesystem::path fullPath; ///< Full path of the image file, empty if the file was not found.
+        Bitmap::UniqueConstPtr pBitmap; ///< Decoded image, or nullptr if decoding failed.
+        size_t useCount = 0;            ///< Number of textures still to be created from the image.
+    };
+
+    std::map<std::filesystem::path, DecodedImage> decodedImages;
+
+    /**
+     * Create a texture from an image file, using the decoded image if available.
+     * The decoded image is released after creating its last texture. This is not thread-safe.
+     */
+    Falcor::ref<Falcor::Texture> createTexture(const std::filesystem::path& path, bool generateMips, bool sRGB)
+    {
+        auto it = decodedImages.find(path);
+        if (it == decodedImages.end() || it->second.fullPath.empty())
+            return Falcor::Texture::createFromFile(builder.getDevice(), path, generateMips, sRGB);
+
+        Falcor::ref<Falcor::Texture> pTexture;
+        if (const Bitmap* pBitmap = it->second.pBitmap.get())
+        {
+            pTexture =
+                Falcor::Texture::createFromBitmaps(builder.getDevice(), fstd::span<const Bitmap* const>(&pBitmap, 1), generateMips, sRGB);
+            if (pTexture)
+                pTexture->setSourcePath(it->second.fullPath);
+        }
+
+        if (--it->second.useCount == 0)
+            decodedImages.erase(it);
+        return pTexture;
+    }
+
+    std::mutex dependencyMutex;
+
+    /// Resolves file references and records them as scene dependencies. This is thread-safe.
+    Resolver resolver = [this](const std::filesystem::path& path)
+    {
+        auto resolved = scene.resolvePath(path);
+        if (!path.empty())
+        {
+            std::lock_guard<std::mutex> lock(dependencyMutex);
+            builder.addDependency(resolved);
+        }
+        return resolved;
+    };
 };
 
 inline void warnUnsupportedType(const FileLoc& loc, const std::string_view category, const std::string_view name)
@@ -816,7 +893,7 @@ FloatTexture createFloatTexture(BuilderContext& ctx, const TextureSceneEntity& e
         }
         bool sRGB = encoding == "sRGB";
 
-        floatTexture.texture = Falcor::Texture::createFromFile(ctx.builder.getDevice(), path, generateMips, sRGB);
+        floatTexture.texture = ctx.createTexture(path, generateMips, sRGB);
     }
     else if (type == "checkerboard")
     {
@@ -933,7 +1010,7 @@ SpectrumTexture createSpectrumTexture(BuilderContext& ctx, const TextureSceneEnt
         }
         bool sRGB = encoding == "sRGB";
 
-        spectrumTexture.texture = Falcor::Texture::createFromFile(ctx.builder.getDevice(), path, generateMips, sRGB);
+        spectrumTexture.texture = ctx.createTexture(path, generateMips, sRGB);
     }
     else if (type == "checkerboard")
     {
@@ -1322,7 +1399,7 @@ Falcor::ref<Falcor::Material> createMaterial(BuilderContext& ctx, const Material
         auto normalmap = params.getString("normalmap", "");
         if (!normalmap.empty())
         {
-            auto pNormalMap = Texture::createFromFile(ctx.builder.getDevice(), ctx.resolver(normalmap), true, false);
+            auto pNormalMap = ctx.createTexture(ctx.resolver(normalmap), true, false);
             pMaterial->setTexture(Material::TextureSlot::Normal, pNormalMap);
         }
     }
@@ -1465,31 +1542,20 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
 
         auto P = params.getPoint3Array("P");
 
-        // Create or get existing curve aggregate.
-        auto pMaterial = ctx.getMaterial(entity.materialRef);
-        CurveAggregate::Key key{entity.transform, pMaterial.get()};
-        auto it = ctx.curveAggregates.find(key);
-        if (it == ctx.curveAggregates.end())
-        {
-            it = ctx.curveAggregates.emplace(key, CurveAggregate{}).first;
-            it->second.transform = entity.transform;
-            it->second.pMaterial = pMaterial;
-            it->second.splitDepth = splitdepth;
-        }
-        CurveAggregate& aggregate = it->second;
-
-        // Append curve to aggregate.
+        // Create the strand. Strands are aggregated after all shapes have been created.
+        CurveStrand strand;
+        strand.splitDepth = splitdepth;
         size_t pointCount = P.size();
-        size_t offset = aggregate.points.size();
-        aggregate.strands.push_back(pointCount);
-        aggregate.points.resize(aggregate.points.size() + pointCount);
-        aggregate.widths.resize(aggregate.widths.size() + pointCount);
+        strand.points.resize(pointCount);
+        strand.widths.resize(pointCount);
         for (size_t i = 0; i < pointCount; ++i)
         {
             float t = float(i) / pointCount;
-            aggregate.points[offset + i] = P[i];
-            aggregate.widths[offset + i] = math::lerp(width0, width1, t);
+            strand.points[i] = P[i];
+            strand.widths[i] = math::lerp(width0, width1, t);
         }
+        shape.curve = std::move(strand);
+        shape.transform = entity.transform;
     }
     else if (type == "trianglemesh")
     {
@@ -1571,7 +1637,17 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
         auto filename = params.getString("filename", "");
         auto path = ctx.resolver(filename);
 
-        shape.pTriangleMesh = Falcor::TriangleMesh::createFromFile(path.string());
+        try
+        {
+            shape.pTriangleMesh = loadPLYMesh(path);
+            // Fall back to ASSIMP for files using elements the PLY reader does not support.
+            if (!shape.pTriangleMesh)
+                shape.pTriangleMesh = Falcor::TriangleMesh::createFromFile(path);
+        }
+        catch (const RuntimeError& e)
+        {
+            logWarning(entity.loc, "{}", e.what());
+        }
         if (shape.pTriangleMesh)
             shape.pTriangleMesh->setName(filename);
         shape.transform = entity.transform;
@@ -1617,6 +1693,15 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
     if (entity.reverseOrientation && shape.pTriangleMesh)
         shape.pTriangleMesh->setFrontFaceCW(!shape.pTriangleMesh->getFrontFaceCW());
 
+    return shape;
+}
+
+/**
+ * Assign the material of a shape and create its area light.
+ * This is not thread-safe, as it may create new materials.
+ */
+void assignShapeMaterial(BuilderContext& ctx, const ShapeSceneEntity& entity, Shape& shape)
+{
     // Get the material.
     shape.pMaterial = ctx.getMaterial(entity.materialRef);
 
@@ -1641,15 +1726,70 @@ Shape createShape(BuilderContext& ctx, const ShapeSceneEntity& entity)
         const SceneEntity& areaLightEntity = ctx.scene.getAreaLight(entity.lightIndex);
         createAreaLight(ctx, areaLightEntity, shape.pMaterial);
     }
+}
 
-    return shape;
+/**
+ * Call a function for all indices in [0, count) in parallel and collect the results.
+ * If calls throw, the exception of the lowest index is rethrown, so errors are reported deterministically.
+ */
+template<typename Func>
+auto createInParallel(size_t count, Func func) -> std::vector<decltype(func(size_t(0)))>
+{
+    std::vector<decltype(func(size_t(0)))> results(count);
+    std::vector<std::exception_ptr> exceptions(count);
+    Threading::parallelFor(
+        0,
+        count,
+        [&](size_t i)
+        {
+            try
+            {
+                results[i] = func(i);
+            }
+            catch (...)
+            {
+                exceptions[i] = std::current_exception();
+            }
+        },
+        1
+    );
+    for (const auto& exception : exceptions)
+    {
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+    return results;
 }
 
 /**
- * Create curve geometry from a curve aggregate.
- * This can either result in mesh or curve geometry depending on the tesselation mode.
+ * Add a curve strand to the aggregate with matching transform and material.
+ */
+void addCurveStrand(BuilderContext& ctx, const ShapeSceneEntity& entity, const Shape& shape)
+{
+    FALCOR_ASSERT(shape.curve);
+
+    // Create or get existing curve aggregate.
+    auto pMaterial = ctx.getMaterial(entity.materialRef);
+    CurveAggregate::Key key{shape.transform, pMaterial.get()};
+    auto it = ctx.curveAggregateIndices.find(key);
+    if (it == ctx.curveAggregateIndices.end())
+    {
+        it = ctx.curveAggregateIndices.emplace(key, ctx.curveAggregates.size()).first;
+        auto& aggregate = ctx.curveAggregates.emplace_back();
+        aggregate.transform = shape.transform;
+        aggregate.pMaterial = pMaterial;
+        aggregate.splitDepth = shape.curve->splitDepth;
+    }
+
+    // Append curve to aggregate.
+    ctx.curveAggregates[it->second].append(*shape.curve);
+}
+
+/**
+ * Tessellate a curve aggregate.
+ * This only depends on the aggregate and the builder flags and can be called from multiple threads.
  */
-std::variant<Falcor::MeshID, Falcor::CurveID> createCurveGeometry(BuilderContext& ctx, const CurveAggregate& curveAggregate)
+CurveGeometry tessellateCurves(const BuilderContext& ctx, const CurveAggregate& curveAggregate)
 {
     CurveTessellationMode mode = CurveTessellationMode::LinearSweptSphere;
 
@@ -1662,10 +1802,36 @@ std::variant<Falcor::MeshID, Falcor::CurveID> createCurveGeometry(BuilderContext
 
     if (mode == CurveTessellationMode::LinearSweptSphere)
     {
-        auto result = CurveTessellation::convertToLinearSweptSphere(
+        return CurveTessellation::convertToLinearSweptSphere(
             curveAggregate.strands.size(), curveAggregate.strands.data(), curveAggregate.points.data(), curveAggregate.widths.data(),
             nullptr, 1, subdivPerSegment, 1, 1, 1.f, float4x4::identity()
         );
+    }
+    else if (mode == CurveTessellationMode::PolyTube)
+    {
+        return CurveTessellation::convertToPolytube(
+            curveAggregate.strands.size(), curveAggregate.strands.data(), curveAggregate.points.data(), curveAggregate.widths.data(),
+            nullptr, subdivPerSegment, 1, 1, 1.f, 4
+        );
+    }
+
+    FALCOR_UNREACHABLE();
+    return {};
+}
+
+/**
+ * Add tessellated curve geometry to the scene builder.
+ * This can either result in mesh or curve geometry depending on the tesselation mode.
+ */
+std::variant<Falcor::MeshID, Falcor::CurveID> addCurveGeometry(
+    BuilderContext& ctx,
+    const CurveAggregate& curveAggregate,
+    const CurveGeometry& curveGeometry
+)
+{
+    if (auto pResult = std::get_if<Falcor::CurveTessellation::SweptSphereResult>(&curveGeometry))
+    {
+        const auto& result = *pResult;
 
         Falcor::SceneBuilder::Curve curve;
         curve.degree = result.degree;
@@ -1680,18 +1846,7 @@ std::variant<Falcor::MeshID, Falcor::CurveID> createCurveGeometry(BuilderContext
     }
     else
     {
-        Falcor::CurveTessellation::MeshResult result;
-        if (mode == CurveTessellationMode::PolyTube)
-        {
-            result = CurveTessellation::convertToPolytube(
-                curveAggregate.strands.size(), curveAggregate.strands.data(), curveAggregate.points.data(), curveAggregate.widths.data(),
-                nullptr, subdivPerSegment, 1, 1, 1.f, 4
-            );
-        }
-        else
-        {
-            FALCOR_UNREACHABLE();
-        }
+        const auto& result = std::get<Falcor::CurveTessellation::MeshResult>(curveGeometry);
 
         Falcor::SceneBuilder::Mesh mesh;
         mesh.faceCount = result.faceVertexIndices.size() / 3;
@@ -1715,49 +1870,64 @@ std::variant<Falcor::MeshID, Falcor::CurveID> createCurveGeometry(BuilderContext
     }
 }
 
-InstanceDefinition createInstanceDefinition(BuilderContext& ctx, const InstanceDefinitionSceneEntity& entity)
+/**
+ * Decode the images of image map textures and normal maps in parallel.
+ * Creating textures accesses the GPU, which is not thread-safe, so the textures are created serially from the decoded images.
+ * DDS files may contain mips and arrays, they are loaded when creating the texture.
+ */
+void decodeImages(BuilderContext& ctx)
 {
-    InstanceDefinition instanceDefinition;
-
-    for (const auto& shapeEntity : entity.shapes)
+    auto addImage = [&](const std::string& filename)
     {
-        // Process shapes and create meshes.
-        auto shape = createShape(ctx, shapeEntity);
-        if (shape.pTriangleMesh)
+        auto path = ctx.scene.resolvePath(filename);
+        if (!filename.empty() && !hasExtension(path, "dds"))
+            ctx.decodedImages[path].useCount++;
+    };
+    for (const auto* pTextures : {&ctx.scene.getFloatTextures(), &ctx.scene.getSpectrumTextures()})
+    {
+        for (const auto& [name, entity] : *pTextures)
         {
-            auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
-            instanceDefinition.meshes.emplace_back(meshID, shape.transform);
+            if (entity.name == "imagemap")
+                addImage(entity.params.getString("filename", ""));
         }
+    }
+    for (const auto& [name, entity] : ctx.scene.getNamedMaterials())
+        addImage(entity.params.getString("normalmap", ""));
+    for (const auto& entity : ctx.scene.getMaterials())
+        addImage(entity.params.getString("normalmap", ""));
+
+    std::vector<std::pair<const std::filesystem::path, BuilderContext::DecodedImage>*> images;
+    for (auto& item : ctx.decodedImages)
+        images.push_back(&item);
 
-        // Create curves from curve aggregates assembled during the processing step above.
-        for (const auto& [_, curveAggregate] : ctx.curveAggregates)
+    auto bitmaps = createInParallel(
+        images.size(),
+        [&](size_t i) -> Bitmap::UniqueConstPtr
         {
-            auto meshOrCurveID = createCurveGeometry(ctx, curveAggregate);
-            if (auto meshID = std::get_if<Falcor::MeshID>(&meshOrCurveID))
-            {
-                instanceDefinition.meshes.emplace_back(*meshID, curveAggregate.transform);
-            }
-            else if (auto curveID = std::get_if<Falcor::CurveID>(&meshOrCurveID))
-            {
-                instanceDefinition.curves.emplace_back(*curveID, curveAggregate.transform);
-            }
-            else
-            {
-                FALCOR_UNREACHABLE();
-            }
+            auto& [path, image] = *images[i];
+            if (!findFileInDataDirectories(path, image.fullPath))
+                return nullptr;
+            return Bitmap::createFromFile(image.fullPath, true);
         }
-        ctx.curveAggregates.clear();
-    }
-
-    return instanceDefinition;
+    );
+    for (size_t i = 0; i < images.size(); ++i)
+        images[i]->second.pBitmap = std::move(bitmaps[i]);
 }
 
+/**
+ * Build the Falcor scene.
+ * Scene entities are converted in stages. The CPU heavy work (image decoding, shapes, curve tessellation) runs in parallel.
+ * Textures and materials are created serially, as creating GPU resources is not thread-safe. The results are added
+ * to the scene builder serially in scene order, so the generated scene does not depend on the scheduling of the tasks.
+ */
 void buildScene(BuilderContext& ctx)
 {
-    // Load float textures.
+    // Decode the images in parallel, then create the textures and materials serially as they create GPU resources.
+    decodeImages(ctx);
+
+    // Load float and spectrum textures.
     for (const auto& [name, entity] : ctx.scene.getFloatTextures())
         ctx.floatTextures.emplace(name, createFloatTexture(ctx, entity));
-
     for (const auto& [name, entity] : ctx.scene.getSpectrumTextures())
         ctx.spectrumTextures.emplace(name, createSpectrumTexture(ctx, entity));
 
@@ -1765,11 +1935,9 @@ void buildScene(BuilderContext& ctx)
     for (const auto& entity : ctx.scene.getMedia())
         ctx.media.emplace(entity.name, createMedium(ctx, entity));
 
-    // Create named materials.
+    // Create named and unnamed materials.
     for (const auto& [name, entity] : ctx.scene.getNamedMaterials())
         ctx.namedMaterials.emplace(name, createMaterial(ctx, entity));
-
-    // Create unnamed materials.
     for (const auto& entity : ctx.scene.getMaterials())
         ctx.materials.push_back(createMaterial(ctx, entity));
 
@@ -1803,23 +1971,81 @@ void buildScene(BuilderContext& ctx)
         }
     }
 
-    // Process shapes and create meshes.
+    // Collect the instanced object definitions in order of first use.
+    std::vector<std::pair<std::string, const InstanceDefinitionSceneEntity*>> definitionEntities;
+    for (const auto& entity : ctx.scene.getInstances())
+    {
+        auto it = ctx.scene.getInstanceDefinitions().find(entity.name);
+        if (it == ctx.scene.getInstanceDefinitions().end())
+        {
+            throwError(entity.loc, "Object instance '{}' not defined.", entity.name);
+        }
+        if (ctx.instanceDefinitions.emplace(entity.name, InstanceDefinition{}).second)
+            definitionEntities.emplace_back(entity.name, &it->second);
+    }
+
+    // Create all shapes in parallel, the top-level shapes followed by the shapes of the instanced object definitions.
+    std::vector<const ShapeSceneEntity*> shapeEntities;
     for (const auto& entity : ctx.scene.getShapes())
+        shapeEntities.push_back(&entity);
+    const size_t topLevelShapeCount = shapeEntities.size();
+    for (const auto& [name, pDefinition] : definitionEntities)
+    {
+        for (const auto& entity : pDefinition->shapes)
+            shapeEntities.push_back(&entity);
+    }
+
+    auto shapes = createInParallel(shapeEntities.size(), [&](size_t i) { return createShape(ctx, *shapeEntities[i]); });
+
+    // Assign materials and aggregate curves. Curves of top-level shapes are aggregated by transform/material,
+    // curves in instanced object definitions are kept separate per shape.
+    std::vector<size_t> curveAggregateIndices(shapes.size(), size_t(-1));
+    for (size_t i = 0; i < shapes.size(); ++i)
+    {
+        auto& shape = shapes[i];
+        assignShapeMaterial(ctx, *shapeEntities[i], shape);
+        if (!shape.curve)
+            continue;
+
+        if (i < topLevelShapeCount)
+        {
+            addCurveStrand(ctx, *shapeEntities[i], shape);
+        }
+        else
+        {
+            auto& aggregate = ctx.curveAggregates.emplace_back();
+            aggregate.transform = shape.transform;
+            aggregate.pMaterial = ctx.getMaterial(shapeEntities[i]->materialRef);
+            aggregate.splitDepth = shape.curve->splitDepth;
+            aggregate.append(*shape.curve);
+            curveAggregateIndices[i] = ctx.curveAggregates.size() - 1;
+        }
+        shape.curve.reset();
+    }
+    const size_t topLevelCurveAggregateCount = ctx.curveAggregateIndices.size();
+
+    // Tessellate all curve aggregates in parallel.
+    auto curveGeometries =
+        createInParallel(ctx.curveAggregates.size(), [&](size_t i) { return tessellateCurves(ctx, ctx.curveAggregates[i]); });
+
+    // Add top-level meshes.
+    for (size_t i = 0; i < topLevelShapeCount; ++i)
     {
-        auto shape = createShape(ctx, entity);
+        const auto& shape = shapes[i];
         if (shape.pTriangleMesh)
         {
-            auto nodeID = ctx.builder.addNode({entity.name, shape.transform});
+            auto nodeID = ctx.builder.addNode({shapeEntities[i]->name, shape.transform});
             auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
             ctx.builder.addMeshInstance(nodeID, meshID);
         }
     }
 
-    // Create curves from curve aggregates assembled during the processing step above.
-    for (const auto& [_, curveAggregate] : ctx.curveAggregates)
+    // Add top-level curves.
+    for (size_t i = 0; i < topLevelCurveAggregateCount; ++i)
     {
+        const auto& curveAggregate = ctx.curveAggregates[i];
         auto nodeID = ctx.builder.addNode({"curves", curveAggregate.transform});
-        auto meshOrCurveID = createCurveGeometry(ctx, curveAggregate);
+        auto meshOrCurveID = addCurveGeometry(ctx, curveAggregate, curveGeometries[i]);
         if (auto meshID = std::get_if<Falcor::MeshID>(&meshOrCurveID))
         {
             ctx.builder.addMeshInstance(nodeID, *meshID);
@@ -1833,27 +2059,48 @@ void buildScene(BuilderContext& ctx)
             FALCOR_UNREACHABLE();
         }
     }
-    ctx.curveAggregates.clear();
 
-    auto getInstanceDefinition = [&ctx](const InstanceSceneEntity& entity)
+    // Add meshes and curves of instanced object definitions.
+    size_t shapeIndex = topLevelShapeCount;
+    for (const auto& [name, pDefinition] : definitionEntities)
     {
-        auto it = ctx.instanceDefinitions.find(entity.name);
-        if (it == ctx.instanceDefinitions.end())
+        auto& instanceDefinition = ctx.instanceDefinitions[name];
+        for (size_t i = 0; i < pDefinition->shapes.size(); ++i, ++shapeIndex)
         {
-            auto it2 = ctx.scene.getInstanceDefinitions().find(entity.name);
-            if (it2 == ctx.scene.getInstanceDefinitions().end())
+            const auto& shape = shapes[shapeIndex];
+            if (shape.pTriangleMesh)
+            {
+                auto meshID = ctx.builder.addTriangleMesh(shape.pTriangleMesh, shape.pMaterial);
+                instanceDefinition.meshes.emplace_back(meshID, shape.transform);
+            }
+
+            size_t aggregateIndex = curveAggregateIndices[shapeIndex];
+            if (aggregateIndex == size_t(-1))
+                continue;
+
+            const auto& curveAggregate = ctx.curveAggregates[aggregateIndex];
+            auto meshOrCurveID = addCurveGeometry(ctx, curveAggregate, curveGeometries[aggregateIndex]);
+            if (auto meshID = std::get_if<Falcor::MeshID>(&meshOrCurveID))
+            {
+                instanceDefinition.meshes.emplace_back(*meshID, curveAggregate.transform);
+            }
+            else if (auto curveID = std::get_if<Falcor::CurveID>(&meshOrCurveID))
+            {
+                instanceDefinition.curves.emplace_back(*curveID, curveAggregate.transform);
+            }
+            else
             {
-                throwError(entity.loc, "Object instance '{}' not defined.", entity.name);
+                FALCOR_UNREACHABLE();
             }
-            it = ctx.instanceDefinitions.emplace(entity.name, createInstanceDefinition(ctx, it2->second)).first;
         }
-        return it->second;
-    };
+    }
+    ctx.curveAggregates.clear();
+    ctx.curveAggregateIndices.clear();
 
     // Create instanced shapes.
     for (const auto& entity : ctx.scene.getInstances())
     {
-        const auto& instanceDefinition = getInstanceDefinition(entity);
+        const auto& instanceDefinition = ctx.instanceDefinitions.at(entity.name);
         auto instanceTransform = entity.transform;
 
         // Instantiate meshes.
@@ -1883,6 +2130,8 @@ void PBRTImporter::importScene(const std::filesystem::path& path, SceneBuilder&
         pbrt::BasicScene pbrtScene(path.parent_path());
         pbrt::BasicSceneBuilder pbrtBuilder(pbrtScene);
         pbrt::parseFile(pbrtBuilder, path);
+        for (const auto& includedPath : pbrtScene.getIncludedFiles())
+            builder.addDependency(includedPath);
         timeReport.measure("Parsing pbrt scene");
 
         pbrt::BuilderContext ctx{pbrtScene, builder};
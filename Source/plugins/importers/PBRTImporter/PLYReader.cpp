@@ -0,0 +1,784 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#include "PLYReader.h"
+#include "Core/Assert.h"
+#include "Core/Errors.h"
+#include "Core/Platform/OS.h"
+#include "Core/Platform/MemoryMappedFile.h"
+#include "Utils/Logger.h"
+#include "Utils/Math/Vector.h"
+
+#include <fast_float/fast_float.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Falcor::pbrt
+{
+
+namespace
+{
+
+enum class Format
+{
+    ASCII,
+    BinaryLittleEndian,
+    BinaryBigEndian,
+};
+
+enum class Type
+{
+    Int8,
+    UInt8,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Float32,
+    Float64,
+};
+
+std::optional<Type> parseType(std::string_view name)
+{
+    if (name == "char" || name == "int8")
+        return Type::Int8;
+    if (name == "uchar" || name == "uint8")
+        return Type::UInt8;
+    if (name == "short" || name == "int16")
+        return Type::Int16;
+    if (name == "ushort" || name == "uint16")
+        return Type::UInt16;
+    if (name == "int" || name == "int32")
+        return Type::Int32;
+    if (name == "uint" || name == "uint32")
+        return Type::UInt32;
+    if (name == "float" || name == "float32")
+        return Type::Float32;
+    if (name == "double" || name == "float64")
+        return Type::Float64;
+    return {};
+}
+
+size_t getTypeSize(Type type)
+{
+    switch (type)
+    {
+    case Type::Int8:
+    case Type::UInt8:
+        return 1;
+    case Type::Int16:
+    case Type::UInt16:
+        return 2;
+    case Type::Int32:
+    case Type::UInt32:
+    case Type::Float32:
+        return 4;
+    case Type::Float64:
+        return 8;
+    }
+    FALCOR_UNREACHABLE();
+    return 0;
+}
+
+/**
+ * Call func with a default constructed value of the C++ type corresponding to a property type.
+ */
+template<typename Func>
+void dispatchType(Type type, Func func)
+{
+    switch (type)
+    {
+    case Type::Int8:
+        return func(int8_t{});
+    case Type::UInt8:
+        return func(uint8_t{});
+    case Type::Int16:
+        return func(int16_t{});
+    case Type::UInt16:
+        return func(uint16_t{});
+    case Type::Int32:
+        return func(int32_t{});
+    case Type::UInt32:
+        return func(uint32_t{});
+    case Type::Float32:
+        return func(float{});
+    case Type::Float64:
+        return func(double{});
+    }
+    FALCOR_UNREACHABLE();
+}
+
+template<typename T, bool Swap>
+T loadValue(const uint8_t* p)
+{
+    T value;
+    if constexpr (Swap)
+    {
+        uint8_t bytes[sizeof(T)];
+        for (size_t i = 0; i < sizeof(T); ++i)
+            bytes[i] = p[sizeof(T) - 1 - i];
+        std::memcpy(&value, bytes, sizeof(T));
+    }
+    else
+    {
+        std::memcpy(&value, p, sizeof(T));
+    }
+    return value;
+}
+
+double loadAsDouble(Type type, const uint8_t* p, bool swap)
+{
+    double value = 0.0;
+    dispatchType(
+        type,
+        [&](auto tag)
+        {
+            using T = decltype(tag);
+            value = swap ? (double)loadValue<T, true>(p) : (double)loadValue<T, false>(p);
+        }
+    );
+    return value;
+}
+
+struct Property
+{
+    std::string name;
+    Type type = Type::Float32;    ///< Value type (item type for lists).
+    bool isList = false;          ///< True if property is a list.
+    Type countType = Type::UInt8; ///< Type of the list size.
+};
+
+struct Element
+{
+    std::string name;
+    size_t count = 0;
+    std::vector<Property> properties;
+
+    /// Returns the size of an item in bytes, or 0 if the item size is variable (contains lists).
+    size_t getFixedStride() const
+    {
+        size_t stride = 0;
+        for (const auto& property : properties)
+        {
+            if (property.isList)
+                return 0;
+            stride += getTypeSize(property.type);
+        }
+        return stride;
+    }
+
+    /// Returns the index of a property or -1 if it does not exist.
+    int findProperty(std::initializer_list<std::string_view> names) const
+    {
+        for (size_t i = 0; i < properties.size(); ++i)
+            for (auto name : names)
+                if (properties[i].name == name)
+                    return (int)i;
+        return -1;
+    }
+};
+
+struct Header
+{
+    Format format = Format::ASCII;
+    std::vector<Element> elements;
+    size_t dataOffset = 0;
+};
+
+/// Polygons of the face element, stored as flat index list with per-polygon vertex counts.
+struct Polygons
+{
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> sizes;
+};
+
+/// Vertex attributes stored as separate arrays.
+struct VertexArrays
+{
+    std::vector<float3> positions;
+    std::vector<float3> normals;
+    std::vector<float2> texCoords;
+};
+
+/// Property indices of the vertex attributes in the vertex element (-1 if not present).
+struct VertexLayout
+{
+    int position[3];
+    int normal[3];
+    int texCoord[2];
+
+    explicit VertexLayout(const Element& element)
+    {
+        // Same property names as recognized by the ASSIMP PLY importer.
+        position[0] = element.findProperty({"x"});
+        position[1] = element.findProperty({"y"});
+        position[2] = element.findProperty({"z"});
+        normal[0] = element.findProperty({"nx"});
+        normal[1] = element.findProperty({"ny"});
+        normal[2] = element.findProperty({"nz"});
+        texCoord[0] = element.findProperty({"u", "s", "tx", "texture_u", "texture_s"});
+        texCoord[1] = element.findProperty({"v", "t", "ty", "texture_v", "texture_t"});
+    }
+
+    bool hasNormals() const { return normal[0] >= 0 && normal[1] >= 0 && normal[2] >= 0; }
+    bool hasTexCoords() const { return texCoord[0] >= 0 && texCoord[1] >= 0; }
+
+    /// Calls func(propertyIndex, dstArray, dstComponent) for all properties to decode.
+    template<typename Func>
+    void forEachAttribute(VertexArrays& arrays, Func func) const
+    {
+        for (uint32_t c = 0; c < 3; ++c)
+            func(position[c], &arrays.positions[0][0], 3, c);
+        if (hasNormals())
+            for (uint32_t c = 0; c < 3; ++c)
+                func(normal[c], &arrays.normals[0][0], 3, c);
+        if (hasTexCoords())
+            for (uint32_t c = 0; c < 2; ++c)
+                func(texCoord[c], &arrays.texCoords[0][0], 2, c);
+    }
+};
+
+class PLYParser
+{
+public:
+    PLYParser(const std::filesystem::path& path, const char* pData, size_t size) : mPath(path), mpData(pData), mSize(size) {}
+
+    /// Parse the file. Returns false if the file contains elements that are not supported (triangle strips).
+    bool parse(VertexArrays& vertices, Polygons& polygons)
+    {
+        parseHeader();
+
+        for (const auto& element : mHeader.elements)
+        {
+            if (element.name == "tristrips")
+                return false;
+        }
+
+        bool hasVertices = false;
+        bool hasFaces = false;
+        size_t pos = mHeader.dataOffset;
+        for (const auto& element : mHeader.elements)
+        {
+            if (element.name == "vertex" && !hasVertices)
+            {
+                parseVertices(element, pos, vertices);
+                hasVertices = true;
+            }
+            else if (element.name == "face" && !hasFaces)
+            {
+                parseFaces(element, pos, polygons);
+                hasFaces = true;
+            }
+            else
+            {
+                skipElement(element, pos);
+            }
+        }
+
+        if (!hasVertices)
+            fail("Missing vertex element.");
+        if (!hasFaces || polygons.sizes.empty())
+            fail("Missing faces.");
+        return true;
+    }
+
+private:
+    template<typename... Args>
+    [[noreturn]] void fail(fmt::format_string<Args...> format, Args&&... args) const
+    {
+        throw RuntimeError("Failed to load PLY file '{}': {}", mPath, fmt::format(format, std::forward<Args>(args)...));
+    }
+
+    static std::vector<std::string_view> splitTokens(std::string_view line)
+    {
+        std::vector<std::string_view> tokens;
+        size_t pos = 0;
+        while (pos < line.size())
+        {
+            while (pos < line.size() && std::isspace((unsigned char)line[pos]))
+                ++pos;
+            size_t end = pos;
+            while (end < line.size() && !std::isspace((unsigned char)line[end]))
+                ++end;
+            if (end > pos)
+                tokens.push_back(line.substr(pos, end - pos));
+            pos = end;
+        }
+        return tokens;
+    }
+
+    void parseHeader()
+    {
+        size_t pos = 0;
+        auto nextLine = [&]() -> std::string_view
+        {
+            if (pos >= mSize)
+                fail("Unexpected end of header.");
+            const char* pEnd = static_cast<const char*>(std::memchr(mpData + pos, '\n', mSize - pos));
+            size_t end = pEnd ? size_t(pEnd - mpData) : mSize;
+            std::string_view line(mpData + pos, end - pos);
+            pos = std::min(end + 1, mSize);
+            return line;
+        };
+
+        if (splitTokens(nextLine()) != std::vector<std::string_view>{"ply"})
+            fail("Not a PLY file.");
+
+        bool hasFormat = false;
+        while (true)
+        {
+            auto tokens = splitTokens(nextLine());
+            if (tokens.empty())
+                continue;
+
+            const auto& keyword = tokens[0];
+            if (keyword == "end_header")
+            {
+                break;
+            }
+            else if (keyword == "format")
+            {
+                if (tokens.size() != 3)
+                    fail("Invalid format declaration.");
+                if (tokens[1] == "ascii")
+                    mHeader.format = Format::ASCII;
+                else if (tokens[1] == "binary_little_endian")
+                    mHeader.format = Format::BinaryLittleEndian;
+                else if (tokens[1] == "binary_big_endian")
+                    mHeader.format = Format::BinaryBigEndian;
+                else
+                    fail("Unknown format '{}'.", tokens[1]);
+                hasFormat = true;
+            }
+            else if (keyword == "element")
+            {
+                Element element;
+                if (tokens.size() != 3 || !parseInteger(tokens[2], element.count))
+                    fail("Invalid element declaration.");
+                element.name = tokens[1];
+                mHeader.elements.push_back(std::move(element));
+            }
+            else if (keyword == "property")
+            {
+                if (mHeader.elements.empty())
+                    fail("Property declared outside of element.");
+                Property property;
+                std::optional<Type> type, countType;
+                if (tokens.size() == 5 && tokens[1] == "list")
+                {
+                    property.isList = true;
+                    countType = parseType(tokens[2]);
+                    type = parseType(tokens[3]);
+                    property.name = tokens[4];
+                    if (!countType || *countType == Type::Float32 || *countType == Type::Float64)
+                        fail("Invalid list size type '{}'.", tokens[2]);
+                    property.countType = *countType;
+                }
+                else if (tokens.size() == 3)
+                {
+                    type = parseType(tokens[1]);
+                    property.name = tokens[2];
+                }
+                else
+                {
+                    fail("Invalid property declaration.");
+                }
+                if (!type)
+                    fail("Unknown property type in declaration of '{}'.", property.name);
+                property.type = *type;
+                mHeader.elements.back().properties.push_back(std::move(property));
+            }
+            else if (keyword != "comment" && keyword != "obj_info")
+            {
+                fail("Unknown header keyword '{}'.", keyword);
+            }
+        }
+
+        if (!hasFormat)
+            fail("Missing format declaration.");
+        mHeader.dataOffset = pos;
+    }
+
+    static bool parseInteger(std::string_view token, size_t& value)
+    {
+        auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+        return result.ec == std::errc() && result.ptr == token.data() + token.size();
+    }
+
+    bool isBinary() const { return mHeader.format != Format::ASCII; }
+    bool isSwapped() const { return mHeader.format == Format::BinaryBigEndian; }
+
+    // Binary data access.
+
+    void checkSize(size_t pos, size_t size) const
+    {
+        if (size > mSize || pos > mSize - size)
+            fail("Unexpected end of file.");
+    }
+
+    const uint8_t* getBytes(size_t pos) const { return reinterpret_cast<const uint8_t*>(mpData) + pos; }
+
+    size_t loadListSize(const Property& property, size_t& pos) const
+    {
+        checkSize(pos, getTypeSize(property.countType));
+        double count = loadAsDouble(property.countType, getBytes(pos), isSwapped());
+        if (count < 0.0)
+            fail("Negative list size in property '{}'.", property.name);
+        pos += getTypeSize(property.countType);
+        return (size_t)count;
+    }
+
+    // ASCII data access.
+
+    double nextNumber(size_t& pos) const
+    {
+        while (pos < mSize && std::isspace((unsigned char)mpData[pos]))
+            ++pos;
+        double value = 0.0;
+        auto result = fast_float::from_chars(mpData + pos, mpData + mSize, value);
+        if (result.ec != std::errc())
+            fail("Invalid number at offset {}.", pos);
+        pos = size_t(result.ptr - mpData);
+        return value;
+    }
+
+    size_t nextListSize(const Property& property, size_t& pos) const
+    {
+        double count = nextNumber(pos);
+        if (count < 0.0 || count != std::floor(count))
+            fail("Invalid list size in property '{}'.", property.name);
+        return (size_t)count;
+    }
+
+    // Element parsing.
+
+    void parseVertices(const Element& element, size_t& pos, VertexArrays& vertices)
+    {
+        VertexLayout layout(element);
+        if (layout.position[0] < 0 || layout.position[1] < 0 || layout.position[2] < 0)
+            fail("Missing vertex positions.");
+        for (const auto& index : {layout.position[0], layout.position[1], layout.position[2]})
+            if (element.properties[index].isList)
+                fail("Vertex property '{}' is a list.", element.properties[index].name);
+
+        const size_t count = element.count;
+        vertices.positions.resize(count);
+        if (layout.hasNormals())
+            vertices.normals.resize(count);
+        if (layout.hasTexCoords())
+            vertices.texCoords.resize(count);
+        if (count == 0)
+            return;
+
+        const size_t stride = element.getFixedStride();
+        if (isBinary() && stride > 0)
+        {
+            // Decode one property of all vertices at a time with the type and byte order resolved outside the loop.
+            checkSize(pos, count * stride);
+            std::vector<size_t> offsets(element.properties.size());
+            for (size_t i = 1; i < offsets.size(); ++i)
+                offsets[i] = offsets[i - 1] + getTypeSize(element.properties[i - 1].type);
+
+            const uint8_t* pItems = getBytes(pos);
+            layout.forEachAttribute(
+                vertices,
+                [&](int propertyIndex, float* pDst, size_t dstStride, uint32_t component)
+                {
+                    const uint8_t* pSrc = pItems + offsets[propertyIndex];
+                    dispatchType(
+                        element.properties[propertyIndex].type,
+                        [&](auto tag)
+                        {
+                            using T = decltype(tag);
+                            float* pOut = pDst + component;
+                            if (isSwapped())
+                                for (size_t i = 0; i < count; ++i)
+                                    pOut[i * dstStride] = (float)loadValue<T, true>(pSrc + i * stride);
+                            else
+                                for (size_t i = 0; i < count; ++i)
+                                    pOut[i * dstStride] = (float)loadValue<T, false>(pSrc + i * stride);
+                        }
+                    );
+                }
+            );
+            pos += count * stride;
+            return;
+        }
+
+        // Generic path: read all values of a vertex and pick the attributes.
+        std::vector<double> values(element.properties.size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (size_t p = 0; p < element.properties.size(); ++p)
+            {
+                const Property& property = element.properties[p];
+                if (property.isList)
+                    skipList(property, pos);
+                else
+                    values[p] = readScalar(property, pos);
+            }
+            layout.forEachAttribute(
+                vertices,
+                [&](int propertyIndex, float* pDst, size_t dstStride, uint32_t component)
+                { pDst[i * dstStride + component] = (float)values[propertyIndex]; }
+            );
+        }
+    }
+
+    void parseFaces(const Element& element, size_t& pos, Polygons& polygons)
+    {
+        const int indicesProperty = element.findProperty({"vertex_indices", "vertex_index"});
+        if (indicesProperty < 0 || !element.properties[indicesProperty].isList)
+            fail("Missing face vertex indices.");
+
+        polygons.sizes.reserve(element.count);
+        polygons.indices.reserve(element.count * 3);
+
+        for (size_t i = 0; i < element.count; ++i)
+        {
+            for (size_t p = 0; p < element.properties.size(); ++p)
+            {
+                const Property& property = element.properties[p];
+                if (p != (size_t)indicesProperty)
+                {
+                    if (property.isList)
+                        skipList(property, pos);
+                    else
+                        skipScalar(property, pos);
+                    continue;
+                }
+
+                if (isBinary())
+                {
+                    const size_t size = loadListSize(property, pos);
+                    const size_t typeSize = getTypeSize(property.type);
+                    checkSize(pos, size * typeSize);
+                    const uint8_t* pSrc = getBytes(pos);
+                    for (size_t j = 0; j < size; ++j)
+                        addIndex(polygons, loadAsDouble(property.type, pSrc + j * typeSize, isSwapped()));
+                    pos += size * typeSize;
+                    polygons.sizes.push_back((uint32_t)size);
+                }
+                else
+                {
+                    const size_t size = nextListSize(property, pos);
+                    for (size_t j = 0; j < size; ++j)
+                        addIndex(polygons, nextNumber(pos));
+                    polygons.sizes.push_back((uint32_t)size);
+                }
+            }
+        }
+    }
+
+    void addIndex(Polygons& polygons, double index) const
+    {
+        if (index < 0.0 || index > (double)std::numeric_limits<uint32_t>::max())
+            fail("Invalid vertex index {}.", index);
+        polygons.indices.push_back((uint32_t)index);
+    }
+
+    double readScalar(const Property& property, size_t& pos) const
+    {
+        if (!isBinary())
+            return nextNumber(pos);
+        checkSize(pos, getTypeSize(property.type));
+        double value = loadAsDouble(property.type, getBytes(pos), isSwapped());
+        pos += getTypeSize(property.type);
+        return value;
+    }
+
+    void skipScalar(const Property& property, size_t& pos) const
+    {
+        if (isBinary())
+            pos += getTypeSize(property.type);
+        else
+            nextNumber(pos);
+    }
+
+    void skipList(const Property& property, size_t& pos) const
+    {
+        if (isBinary())
+        {
+            pos += loadListSize(property, pos) * getTypeSize(property.type);
+        }
+        else
+        {
+            const size_t size = nextListSize(property, pos);
+            for (size_t j = 0; j < size; ++j)
+                nextNumber(pos);
+        }
+    }
+
+    void skipElement(const Element& element, size_t& pos) const
+    {
+        const size_t stride = element.getFixedStride();
+        if (isBinary() && stride > 0)
+        {
+            checkSize(pos, element.count * stride);
+            pos += element.count * stride;
+            return;
+        }
+        for (size_t i = 0; i < element.count; ++i)
+        {
+            for (const auto& property : element.properties)
+            {
+                if (property.isList)
+                    skipList(property, pos);
+                else
+                    skipScalar(property, pos);
+            }
+        }
+    }
+
+    std::filesystem::path mPath;
+    const char* mpData;
+    size_t mSize;
+    Header mHeader;
+};
+
+/**
+ * Triangulate polygons the same way as the ASSIMP triangulation post-process for triangles and quads.
+ * Quads are split starting at their concave vertex (if any). Larger polygons are triangulated as fans.
+ */
+std::vector<uint32_t> triangulate(const Polygons& polygons, const std::vector<float3>& positions)
+{
+    std::vector<uint32_t> indices;
+    indices.reserve(polygons.indices.size() * 3 / 2);
+
+    const uint32_t* pIndices = polygons.indices.data();
+    for (uint32_t size : polygons.sizes)
+    {
+        if (size == 4)
+        {
+            uint32_t start = 0;
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                const float3& v = positions[pIndices[i]];
+                float3 left = normalize(positions[pIndices[(i + 3) % 4]] - v);
+                float3 diag = normalize(positions[pIndices[(i + 2) % 4]] - v);
+                float3 right = normalize(positions[pIndices[(i + 1) % 4]] - v);
+                float angle = std::acos(dot(left, diag)) + std::acos(dot(right, diag));
+                if (angle > (float)M_PI)
+                {
+                    start = i;
+                    break;
+                }
+            }
+            for (uint32_t i : {0u, 1u, 2u, 0u, 2u, 3u})
+                indices.push_back(pIndices[(start + i) % 4]);
+        }
+        else
+        {
+            for (uint32_t i = 2; i < size; ++i)
+            {
+                indices.push_back(pIndices[0]);
+                indices.push_back(pIndices[i - 1]);
+                indices.push_back(pIndices[i]);
+            }
+        }
+        pIndices += size;
+    }
+
+    return indices;
+}
+
+} // namespace
+
+ref<TriangleMesh> loadPLYMesh(const std::filesystem::path& path)
+{
+    VertexArrays vertices;
+    Polygons polygons;
+
+    bool supported = false;
+    if (hasExtension(path, "gz"))
+    {
+        std::string data = decompressFile(path);
+        supported = PLYParser(path, data.data(), data.size()).parse(vertices, polygons);
+    }
+    else
+    {
+        MemoryMappedFile file(path, MemoryMappedFile::kWholeFile, MemoryMappedFile::AccessHint::SequentialScan);
+        if (!file.isOpen())
+            throw RuntimeError("Failed to open PLY file '{}'.", path);
+        supported = PLYParser(path, static_cast<const char*>(file.getData()), file.getSize()).parse(vertices, polygons);
+    }
+    if (!supported)
+        return nullptr;
+
+    // Faces with less than 3 vertices produce no triangles in triangulate().
+    const size_t vertexCount = vertices.positions.size();
+    size_t degenerateFaceCount = std::count_if(polygons.sizes.begin(), polygons.sizes.end(), [](uint32_t size) { return size < 3; });
+    if (degenerateFaceCount == polygons.sizes.size())
+        throw RuntimeError("Failed to load PLY file '{}': All faces have less than 3 vertices.", path);
+    if (degenerateFaceCount > 0)
+        logWarning("PLY file '{}' has {} faces with less than 3 vertices. Skipping them.", path, degenerateFaceCount);
+    for (uint32_t index : polygons.indices)
+    {
+        if (index >= vertexCount)
+            throw RuntimeError("Failed to load PLY file '{}': Vertex index {} is out of range.", path, index);
+    }
+
+    TriangleMesh::IndexList indices = triangulate(polygons, vertices.positions);
+
+    // Generate face normals if the file has none. Shared vertices get the normal of the last triangle.
+    if (vertices.normals.empty())
+    {
+        vertices.normals.resize(vertexCount, float3(0.f));
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const float3& p0 = vertices.positions[indices[i]];
+            float3 n = cross(vertices.positions[indices[i + 1]] - p0, vertices.positions[indices[i + 2]] - p0);
+            float len = length(n);
+            if (len > 0.f)
+                n /= len;
+            for (size_t j = 0; j < 3; ++j)
+                vertices.normals[indices[i + j]] = n;
+        }
+    }
+
+    TriangleMesh::VertexList vertexList(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        auto& vertex = vertexList[i];
+        vertex.position = vertices.positions[i];
+        vertex.normal = vertices.normals[i];
+        vertex.texCoord = vertices.texCoords.empty() ? float2(0.f) : float2(vertices.texCoords[i].x, 1.f - vertices.texCoords[i].y);
+    }
+
+    return TriangleMesh::create(vertexList, indices);
+}
+
+} // namespace Falcor::pbrt
@@ -0,0 +1,60 @@
+/***************************************************************************
+ # Copyright (c) 2015-23, NVIDIA CORPORATION. All rights reserved.
+ #
+ # Redistribution and use in source and binary forms, with or without
+ # modification, are permitted provided that the following conditions
+ # are met:
+ #  * Redistributions of source code must retain the above copyright
+ #    notice, this list of conditions and the following disclaimer.
+ #  * Redistributions in binary form must reproduce the above copyright
+ #    notice, this list of conditions and the following disclaimer in the
+ #    documentation and/or other materials provided with the distribution.
+ #  * Neither the name of NVIDIA CORPORATION nor the names of its
+ #    contributors may be used to endorse or promote products derived
+ #    from this software without specific prior written permission.
+ #
+ # THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS "AS IS" AND ANY
+ # EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ # IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ # PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ # CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ # EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ # PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ # PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ # OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************/
+#pragma once
+#include "Core/Object.h"
+#include "Scene/TriangleMesh.h"
+#include <filesystem>
+
+namespace Falcor::pbrt
+{
+
+/**
+ * Load a triangle mesh from a PLY file.
+ *
+ * Supports ASCII and binary (little and big endian) files, optionally gzip-compressed (.ply.gz).
+ * Vertex positions, normals and texture coordinates are read from the 'vertex' element and polygons
+ * from the 'vertex_indices' (or 'vertex_index') list of the 'face' element. All other elements and
+ * properties are skipped. Faces with less than 3 vertices are skipped with a warning.
+ *
+ * The result matches TriangleMesh::createFromFile() (which uses ASSIMP with triangulation,
+ * flipped texture coordinates and face normals):
+ * - Quads are split into two triangles starting at the concave vertex (if any), other polygons are triangulated as fans.
+ * - The v texture coordinate is flipped (v' = 1 - v).
+ * - If the file has no normals, each vertex gets the normal of the last triangle referencing it.
+ *
+ * Files containing triangle strips ('tristrips' element) are not supported. For those, nullptr is returned
+ * and the caller should fall back to TriangleMesh::createFromFile().
+ *
+ * This function is thread-safe. Throws a RuntimeError if the file can't be read or is invalid.
+ *
+ * @param[in] path File path.
+ * @return The triangle mesh, or nullptr if the file uses unsupported elements.
+ */
+ref<TriangleMesh> loadPLYMesh(const std::filesystem::path& path);
+
+} // namespace Falcor::pbrt
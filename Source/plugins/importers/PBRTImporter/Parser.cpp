@@ -40,6 +40,7 @@
 #include <fast_float/fast_float.h>
 
 #include <atomic>
+#include <mutex>
 #include <utility>
 #include <charconv>
 
@@ -107,9 +108,7 @@ std::unique_ptr<Tokenizer> Tokenizer::createFromString(std::string str)
 
 Tokenizer::Tokenizer(std::string str, const std::filesystem::path& path) : mPath(path), mContents(std::move(str))
 {
-    auto pFilename = std::make_unique<std::string>(path.string());
-    mLoc = FileLoc(*pFilename);
-    getFilenames().push_back(std::move(pFilename));
+    mLoc = FileLoc(registerFilename(path));
 
     mPos = mContents.data();
     mEnd = mPos + mContents.size();
@@ -117,6 +116,16 @@ Tokenizer::Tokenizer(std::string str, const std::filesystem::path& path) : mPath
         throwError("File is encoded with UTF-16, which is not currently supported.");
 }
 
+std::string_view Tokenizer::registerFilename(const std::filesystem::path& path)
+{
+    static std::mutex mutex;
+    static std::vector<std::unique_ptr<std::string>> filenames;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    filenames.push_back(std::make_unique<std::string>(path.string()));
+    return *filenames.back();
+}
+
 bool Tokenizer::isUTF16(const void* ptr, size_t len) const
 {
     auto c = reinterpret_cast<const unsigned char*>(ptr);
@@ -448,13 +457,14 @@ static ParsedParameterVector parseParameters(Next nextToken, Unget ungetToken)
     return parameterVector;
 }
 
-void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
+void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer, std::filesystem::path searchPath)
 {
     static std::atomic<bool> warnedTransformBeginEndDeprecated{false};
 
     logInfo("PBRTImporter: Started parsing '{}'.", tokenizer->getPath().string());
 
-    auto searchPath = tokenizer->getPath().parent_path();
+    if (searchPath.empty())
+        searchPath = tokenizer->getPath().parent_path();
 
     std::vector<std::unique_ptr<Tokenizer>> fileStack;
     fileStack.push_back(std::move(tokenizer));
@@ -635,11 +645,15 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
                 auto path = searchPath / filename;
                 std::unique_ptr<Tokenizer> includeTokenizer = Tokenizer::createFromFile(path);
                 logInfo("PBRTImporter: Started parsing '{}'.", includeTokenizer->getPath().string());
+                target.onInclude(includeTokenizer->getPath(), tok->loc);
                 fileStack.push_back(std::move(includeTokenizer));
             }
             else if (tok->token == "Import")
             {
-                throwError(tok->loc, "'Import' directive not supported yet.");
+                // Imported files are parsed by the target, potentially in parallel to the current file.
+                Token filenameToken = *nextToken(TokenRequired);
+                std::string filename = toString(dequoteString(filenameToken));
+                target.onImport(searchPath / filename, searchPath, tok->loc);
             }
             else if (tok->token == "Identity")
             {
@@ -876,17 +890,17 @@ void parse(ParserTarget& target, std::unique_ptr<Tokenizer> tokenizer)
     }
 }
 
-void parseFile(ParserTarget& target, const std::filesystem::path& path)
+void parseFile(ParserTarget& target, const std::filesystem::path& path, const std::filesystem::path& searchPath)
 {
     auto tokenizer = Tokenizer::createFromFile(path);
-    parse(target, std::move(tokenizer));
+    parse(target, std::move(tokenizer), searchPath);
     target.onEndOfFiles();
 }
 
 void parseString(ParserTarget& target, std::string str)
 {
     auto tokenizer = Tokenizer::createFromString(std::move(str));
-    parse(target, std::move(tokenizer));
+    parse(target, std::move(tokenizer), {});
     target.onEndOfFiles();
 }
 
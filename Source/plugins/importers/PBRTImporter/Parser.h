@@ -98,10 +98,19 @@ public:
     virtual void onObjectEnd(FileLoc loc) = 0;
     virtual void onObjectInstance(const std::string& name, FileLoc loc) = 0;
 
+    virtual void onInclude(const std::filesystem::path& path, FileLoc loc) = 0;
+    virtual void onImport(const std::filesystem::path& path, const std::filesystem::path& searchPath, FileLoc loc) = 0;
+
     virtual void onEndOfFiles() = 0;
 };
 
-void parseFile(ParserTarget& target, const std::filesystem::path& path);
+/**
+ * Parse a scene file.
+ * @param[in] target Parser target receiving the parsed directives.
+ * @param[in] path Path of the scene file.
+ * @param[in] searchPath Directory used to resolve 'Include' and 'Import' directives. Defaults to the directory of the scene file.
+ */
+void parseFile(ParserTarget& target, const std::filesystem::path& path, const std::filesystem::path& searchPath = {});
 void parseString(ParserTarget& target, std::string str);
 
 struct Token
@@ -131,14 +140,10 @@ public:
 
 private:
     /**
-     * Static list of filenames to allow file locations (FileLoc::filename) to be valid
-     * even after the tokenizer is destroyed.
+     * Store a filename in a static list to allow file locations (FileLoc::filename) to be valid
+     * even after the tokenizer is destroyed. Thread-safe, as files may be imported in parallel.
      */
-    static std::vector<std::unique_ptr<std::string>>& getFilenames()
-    {
-        static std::vector<std::unique_ptr<std::string>> filenames;
-        return filenames;
-    }
+    static std::string_view registerFilename(const std::filesystem::path& path);
 
     bool isUTF16(const void* ptr, size_t len) const;
 
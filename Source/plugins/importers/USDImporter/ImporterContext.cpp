@@ -1187,10 +1187,7 @@ namespace Falcor
                     if (protoInstance.keyframes.size() > 0)
                     {
                         ref<Animation> pAnimation = Animation::create(protoInstance.name, rootNodeID, protoInstance.keyframes.back().time);
-                        for (const auto& keyframe : protoInstance.keyframes)
-                        {
-                            pAnimation->addKeyframe(keyframe);
-                        }
+                        pAnimation->addKeyframes(protoInstance.keyframes);
                         ctx.builder.addAnimation(pAnimation);
                     }
 
@@ -1224,10 +1221,7 @@ namespace Falcor
                         std::string animationName = protoGeom.nodes[animation.targetNodeID.get()].name;
                         NodeID targetNodeID{ animation.targetNodeID.get() + protoRootID.get() };
                         ref<Animation> pAnimation = Animation::create(animationName, targetNodeID, animation.keyframes.back().time);
-                        for (const auto& keyframe : animation.keyframes)
-                        {
-                            pAnimation->addKeyframe(keyframe);
-                        }
+                        pAnimation->addKeyframes(animation.keyframes);
                         ctx.builder.addAnimation(pAnimation);
                     }
 
@@ -1723,11 +1717,13 @@ namespace Falcor
         // Gather keyframes
         auto pAnimation = Animation::create(xformable.GetPath().GetString(), NodeID::Invalid(), times.back() / timeCodesPerSecond);
 
+        std::vector<Animation::Keyframe> keyframes;
+        keyframes.reserve(times.size());
         for (double t : times)
         {
-            Animation::Keyframe keyframe = createKeyframe(xformAPI, t, timeCodesPerSecond);
-            pAnimation->addKeyframe(keyframe);
+            keyframes.push_back(createKeyframe(xformAPI, t, timeCodesPerSecond));
         }
+        pAnimation->addKeyframes(keyframes);
 
         NodeID nodeID = builder.addNode(makeNode(xformable.GetPath().GetString(), nodeStack.back()));
         pAnimation->setNodeID(nodeID);
@@ -2330,6 +2326,7 @@ namespace Falcor
             VtArray<GfVec3f> trans;
             VtArray<GfQuatf> rot;
             VtArray<GfVec3h> scales;
+            std::vector<std::vector<Animation::Keyframe>> boneKeyframes(subskeleton.bones.size());
 
             for (double t : times)
             {
@@ -2344,9 +2341,14 @@ namespace Falcor
                     keyframe.rotation = quatf(toFalcor(rot[i].GetImaginary()), rot[i].GetReal());
                     keyframe.scaling = toFalcor(scales[i]);
 
-                    subskeleton.animations[i]->addKeyframe(keyframe);
+                    boneKeyframes[i].push_back(keyframe);
                 }
             }
+
+            for (size_t i = 0; i < subskeleton.bones.size(); i++)
+            {
+                subskeleton.animations[i]->addKeyframes(boneKeyframes[i]);
+            }
         }
     }
 
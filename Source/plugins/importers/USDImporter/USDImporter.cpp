@@ -39,6 +39,7 @@ BEGIN_DISABLE_USD_WARNINGS
 #include <pxr/usd/usd/primRange.h>
 #include <pxr/usd/ar/resolver.h>
 #include <pxr/usd/ar/resolverContextBinder.h>
+#include <pxr/usd/sdf/layer.h>
 #include <pxr/usd/usdGeom/bboxCache.h>
 #include <pxr/usd/usdGeom/camera.h>
 #include <pxr/usd/usdGeom/mesh.h>
@@ -332,6 +333,13 @@ namespace Falcor
 
         timeReport.measure("Open stage");
 
+        // Record all layers composed into the stage (sublayers, references, payloads) as scene dependencies.
+        for (const auto& layer : pStage->GetUsedLayers())
+        {
+            const std::string& realPath = layer->GetRealPath();
+            if (!realPath.empty()) builder.addDependency(realPath);
+        }
+
         Falcor::addDataDirectory(path.parent_path());
         ImporterContext ctx(path, pStage, builder, dict, timeReport);
 